@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "seanet-metrics-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+#include "ns3/seanet-protocol.h"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SeanetMetricsHelper");
+
+/// Application and protocol types of the message counters, in CSV column order
+static const struct
+{
+  uint8_t applicationType; //!< SEANET application type
+  uint8_t protocolType;    //!< SEANET protocol type
+  const char *name;        //!< CSV column name
+} g_seanetMessageColumns[] = {
+  { MULTICAST_APPLICATION, REGIST_TO_SOURCE_DR, "regist_to_source_dr" },
+  { MULTICAST_APPLICATION, REGIST_TO_RN, "regist_to_rn" },
+  { MULTICAST_APPLICATION, GRAFITING_REQUEST, "grafting_request" },
+  { MULTICAST_APPLICATION, MULTICAST_DATA_TRANS, "multicast_data_trans" },
+  { MULTICAST_APPLICATION, REGIST_TO_DEST_DR, "regist_to_dest_dr" },
+  { MULTICAST_APPLICATION, REGIST_TO_RN_ACK, "regist_to_rn_ack" },
+  { NEIGH_INFO_APPLICATION, NEIGH_INFO_RECEIVE, "neigh_info_receive" },
+  { NEIGH_INFO_APPLICATION, NEIGH_INFO_REPLY, "neigh_info_reply" },
+  { SWITCH_APPLICATION, REQUEST_DATA, "request_data" },
+  { SWITCH_APPLICATION, RESEIVE_DATA, "receive_data" },
+};
+
+SeanetMetricsHelper::SeanetMetricsHelper ()
+{
+}
+
+void
+SeanetMetricsHelper::Add (ApplicationContainer apps)
+{
+  for (ApplicationContainer::Iterator i = apps.Begin (); i != apps.End (); ++i)
+    {
+      Ptr<SwitchApplicationv4> app = DynamicCast<SwitchApplicationv4> (*i);
+      if (app != 0)
+        {
+          m_switches.push_back (app);
+        }
+    }
+}
+
+void
+SeanetMetricsHelper::EnableCsv (std::string fileName, Time interval)
+{
+  NS_LOG_FUNCTION (this << fileName << interval);
+  Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper> (fileName, std::ios::out);
+  WriteCsvHeader (stream);
+  Simulator::Schedule (interval, &SeanetMetricsHelper::PeriodicWriteCsv, stream, m_switches, interval);
+}
+
+void
+SeanetMetricsHelper::WriteCsvHeader (Ptr<OutputStreamWrapper> stream)
+{
+  std::ostream *os = stream->GetStream ();
+  *os << "time,node,received";
+  for (uint32_t i = 0; i < sizeof (g_seanetMessageColumns) / sizeof (g_seanetMessageColumns[0]); i++)
+    {
+      *os << "," << g_seanetMessageColumns[i].name;
+    }
+  *os << ",grafts,graft_mean_s,registrations,registration_mean_s"
+      << ",resolution_hits,resolution_misses"
+      << ",eid_table,unicast_entries,multicast_entries,resolution_entries" << std::endl;
+}
+
+void
+SeanetMetricsHelper::WriteCsv (Ptr<OutputStreamWrapper> stream,
+                               const std::vector<Ptr<SwitchApplicationv4> > &switches)
+{
+  std::ostream *os = stream->GetStream ();
+  double now = Simulator::Now ().GetSeconds ();
+  for (std::vector<Ptr<SwitchApplicationv4> >::const_iterator i = switches.begin ();
+       i != switches.end (); ++i)
+    {
+      Ptr<SwitchApplicationv4> app = *i;
+      *os << now << "," << app->GetNode ()->GetId () << "," << app->GetReceived ();
+      for (uint32_t j = 0; j < sizeof (g_seanetMessageColumns) / sizeof (g_seanetMessageColumns[0]); j++)
+        {
+          *os << "," << app->GetMessageCount (g_seanetMessageColumns[j].applicationType,
+                                              g_seanetMessageColumns[j].protocolType);
+        }
+      uint64_t nGrafts = app->GetGraftsCompleted ();
+      uint64_t nRegistrations = app->GetRegistrationsCompleted ();
+      *os << "," << nGrafts << ","
+          << (nGrafts ? app->GetGraftTimeSum ().GetSeconds () / nGrafts : 0)
+          << "," << nRegistrations << ","
+          << (nRegistrations ? app->GetRegistrationTimeSum ().GetSeconds () / nRegistrations : 0)
+          << "," << app->GetResolutionHits () << "," << app->GetResolutionMisses ()
+          << "," << app->GetEidTableSize () << "," << app->GetUnicastEntries ()
+          << "," << app->GetMulticastEntries () << "," << app->GetResolutionEntries ()
+          << std::endl;
+    }
+}
+
+void
+SeanetMetricsHelper::WriteHistogramCsv (std::string fileName) const
+{
+  NS_LOG_FUNCTION (this << fileName);
+  Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper> (fileName, std::ios::out);
+  WriteHistograms (stream, m_switches);
+}
+
+void
+SeanetMetricsHelper::WriteHistograms (Ptr<OutputStreamWrapper> stream,
+                                      const std::vector<Ptr<SwitchApplicationv4> > &switches)
+{
+  std::ostream *os = stream->GetStream ();
+  *os << "node,kind,eid,bin_start_s,bin_end_s,count" << std::endl;
+  for (std::vector<Ptr<SwitchApplicationv4> >::const_iterator i = switches.begin ();
+       i != switches.end (); ++i)
+    {
+      uint32_t node = (*i)->GetNode ()->GetId ();
+      WriteHistograms (*os, node, "graft", (*i)->GetGraftTimes ());
+      WriteHistograms (*os, node, "registration", (*i)->GetRegistrationTimes ());
+    }
+}
+
+void
+SeanetMetricsHelper::WriteHistograms (std::ostream &os, uint32_t node, const char *kind,
+                                      const std::map<SeanetEID, Histogram> &times)
+{
+  for (std::map<SeanetEID, Histogram>::const_iterator i = times.begin (); i != times.end (); ++i)
+    {
+      uint8_t eid[EIDSIZE];
+      i->first.getSeanetEID (eid);
+      std::ostringstream eidHex;
+      eidHex << std::hex << std::setfill ('0');
+      for (uint32_t j = 0; j < EIDSIZE; j++)
+        {
+          eidHex << std::setw (2) << (uint32_t) eid[j];
+        }
+      // the bin accessors of Histogram are not const
+      Histogram histogram = i->second;
+      for (uint32_t j = 0; j < histogram.GetNBins (); j++)
+        {
+          if (histogram.GetBinCount (j) == 0)
+            {
+              continue;
+            }
+          os << node << "," << kind << "," << eidHex.str ()
+             << "," << histogram.GetBinStart (j) << "," << histogram.GetBinEnd (j)
+             << "," << histogram.GetBinCount (j) << std::endl;
+        }
+    }
+}
+
+void
+SeanetMetricsHelper::PeriodicWriteCsv (Ptr<OutputStreamWrapper> stream,
+                                       std::vector<Ptr<SwitchApplicationv4> > switches,
+                                       Time interval)
+{
+  WriteCsv (stream, switches);
+  Simulator::Schedule (interval, &SeanetMetricsHelper::PeriodicWriteCsv, stream, switches, interval);
+}
+
+} // namespace ns3
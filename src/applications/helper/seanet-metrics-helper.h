@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SEANET_METRICS_HELPER_H
+#define SEANET_METRICS_HELPER_H
+
+#include <stdint.h>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "ns3/application-container.h"
+#include "ns3/nstime.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/switch-application-v4.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup udpclientserver
+ * \brief Periodically dump the control-plane metrics of SEANET switches to a CSV file.
+ *
+ * Each dump writes one line per switch with the current value of its
+ * message counters, completion time statistics, resolution hits and misses
+ * and table sizes.  The counters are cumulative since the start of the
+ * simulation.  The per-EID completion time histograms can be written to
+ * another CSV file at the end of the simulation.
+ */
+class SeanetMetricsHelper
+{
+public:
+  SeanetMetricsHelper ();
+
+  /**
+   * \brief Add the SwitchApplicationv4 instances of a container to the
+   * monitored switches.  Other applications are ignored.
+   * \param apps the applications
+   */
+  void Add (ApplicationContainer apps);
+
+  /**
+   * \brief Start dumping the metrics of the monitored switches.
+   *
+   * The metrics are written at the current simulation time plus
+   * interval, and then every interval, so the simulation must be
+   * ended with Simulator::Stop.
+   *
+   * \param fileName the name of the CSV file
+   * \param interval the interval between two dumps
+   */
+  void EnableCsv (std::string fileName, Time interval);
+
+  /**
+   * \brief Write the header line of the CSV file.
+   * \param stream the output stream
+   */
+  static void WriteCsvHeader (Ptr<OutputStreamWrapper> stream);
+
+  /**
+   * \brief Write one line of metrics per switch.
+   * \param stream the output stream
+   * \param switches the switches
+   */
+  static void WriteCsv (Ptr<OutputStreamWrapper> stream,
+                        const std::vector<Ptr<SwitchApplicationv4> > &switches);
+
+  /**
+   * \brief Write the graft and registration completion time histograms
+   * of the monitored switches.
+   *
+   * Call it after Simulator::Run and before Simulator::Destroy.
+   *
+   * \param fileName the name of the CSV file
+   */
+  void WriteHistogramCsv (std::string fileName) const;
+
+  /**
+   * \brief Write a header line, and one line per non-empty bin of the
+   * completion time histogram of each EID, per switch.
+   * \param stream the output stream
+   * \param switches the switches
+   */
+  static void WriteHistograms (Ptr<OutputStreamWrapper> stream,
+                               const std::vector<Ptr<SwitchApplicationv4> > &switches);
+
+private:
+  /**
+   * \brief Write the metrics, and schedule the next dump.
+   * \param stream the output stream
+   * \param switches the switches
+   * \param interval the interval between two dumps
+   */
+  static void PeriodicWriteCsv (Ptr<OutputStreamWrapper> stream,
+                                std::vector<Ptr<SwitchApplicationv4> > switches,
+                                Time interval);
+
+  /**
+   * \brief Write one line per non-empty bin of each histogram.
+   * \param os the output stream
+   * \param node the node id of the switch
+   * \param kind the kind of completion time, graft or registration
+   * \param times the histograms, by EID
+   */
+  static void WriteHistograms (std::ostream &os, uint32_t node, const char *kind,
+                               const std::map<SeanetEID, Histogram> &times);
+
+  std::vector<Ptr<SwitchApplicationv4> > m_switches; //!< Monitored switches
+};
+
+} // namespace ns3
+
+#endif /* SEANET_METRICS_HELPER_H */
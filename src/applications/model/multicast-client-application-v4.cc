@@ -30,6 +30,7 @@
 #include <cstdlib>
 #include <cstdio>
 #include "multicast-client-application-v4.h"
+#include "seanet-event-log.h"
 #include <ns3/string.h>
 #include "ns3/ipv4.h"
 #include "ns3/inet-socket-address.h"
@@ -225,9 +226,7 @@ MulticastClientApplicationv4::Write (void)
       buffer[18]+=m_sent%100;
       buffer[17]+=(uint8_t)(m_sent/100);
       buffer[16]+=switch_index;
-      NS_LOG_INFO("client Write "<<(uint32_t)m_sent<<" total "<<(uint32_t)m_count<<" EID "
-                      <<(uint32_t)(buffer[16]-'0')<<" "<<(uint32_t)(buffer[17]-'0')<<" "
-                      <<(uint32_t)(buffer[18]-'0')<<" "<<(uint32_t)(buffer[19]-'0'));
+      SeanetEventLog::Log (SeanetEventLog::CLIENT_WRITE, GetNode (), buffer, m_switch_address);
       SendPacket(buffer,20,ssenh,m_switch_address,m_switch_port);
       Simulator::Schedule (Seconds(0.01), &MulticastClientApplicationv4::Write, this);
   }
@@ -246,11 +245,7 @@ MulticastClientApplicationv4::Read (void)
       buffer[18]+= m_sent%100;
       buffer[17]+= (uint8_t)(m_sent/100)%(EID_UNIT/100);
       buffer[16]+= (uint8_t)(m_sent/EID_UNIT + switch_index)%total_switch_num;
-      if(buffer[16]-'0'==2&&buffer[17]-'0'==2&&buffer[18]-'0'==2){
-      NS_LOG_INFO("client Read "<<(uint32_t)m_sent<<" total "<<(uint32_t)m_count<<" EID "
-                      <<(uint32_t)(buffer[16]-'0')<<" "<<(uint32_t)(buffer[17]-'0')<<" "
-                      <<(uint32_t)(buffer[18]-'0')<<" "<<(uint32_t)(buffer[19]-'0'));
-      }
+      SeanetEventLog::Log (SeanetEventLog::CLIENT_READ, GetNode (), buffer, m_switch_address);
 
       SendPacket(buffer,20,ssenh,m_switch_address,m_switch_port);
       Simulator::Schedule (Seconds(0.01), &MulticastClientApplicationv4::Read, this);
@@ -296,16 +291,10 @@ void MulticastClientApplicationv4::ReceiveCallback (Ptr<Socket> socket){
               break;
             }
             case MULTICAST_APPLICATION:{
-                uint8_t addr[20];
-                from.CopyTo(addr);
-                Ipv4Address ipv4 = Ipv4Address::Deserialize (addr);
-                InetSocketAddress i4a = InetSocketAddress (ipv4, m_switch_port);
-
-                m_local_address.CopyTo(addr);
-                Ipv4Address m_ipv4 = Ipv4Address::Deserialize (addr);
-                InetSocketAddress m_i4a = InetSocketAddress (m_ipv4, m_switch_port);
-
-                NS_LOG_INFO("client "<<m_i4a.GetIpv4()<<" receive multicast reply from address"<<i4a.GetIpv4());
+                uint8_t eid[EIDSIZE];
+                memset (eid, 0, EIDSIZE);
+                packet->CopyData (eid, EIDSIZE);
+                SeanetEventLog::Log (SeanetEventLog::CLIENT_MULTICAST_REPLY, GetNode (), eid, from);
             }
             default:
             break;
@@ -366,13 +355,7 @@ void MulticastClientApplicationv4::ResolutionProtocolHandle(uint8_t* buffer, uin
   }
 }
 void MulticastClientApplicationv4::SwitchReplyHandle(uint8_t* buffer, uint8_t buffer_len, Address from){
-  SeanetEID se(buffer);
-  uint8_t addr[20];
-  from.CopyTo(addr);
-  Ipv4Address ipv4 = Ipv4Address::Deserialize (addr);
-  InetSocketAddress i4a = InetSocketAddress (ipv4, m_switch_port);
-  NS_LOG_INFO("client receive switch reply: switch address"<<i4a.GetIpv4());
-  se.Print();
+  SeanetEventLog::Log (SeanetEventLog::CLIENT_SWITCH_REPLY, GetNode (), buffer, from);
   // NS_ASSERT (m_readEvent.IsExpired ());
   // m_readEvent = Simulator::Schedule (m_interval, &MulticastClientApplicationv4::Write, this);
 }
@@ -32,6 +32,7 @@
 #include "ns3/drop-tail-queue.h"
 #include "seanet-header.h"
 #include "resolution-application-v4.h"
+#include "seanet-event-log.h"
 #include "ns3/seanet-eid.h"
 namespace ns3 {
 
@@ -242,8 +243,9 @@ ResolutionApplicationv4::LISTIP* ResolutionApplicationv4::AddEIDNATable(SeanetEI
   to.CopyTo(buf);
   Ipv4Address ipv4=Ipv4Address::Deserialize (buf);
   // Ipv4Address ipv4 = Ipv4Address::ConvertFrom(to);
-  InetSocketAddress i4a = InetSocketAddress (ipv4, 4000);
-  NS_LOG_INFO("resolution add info "<<i4a.GetIpv4());
+  uint8_t eid[EIDSIZE];
+  se.getSeanetEID (eid);
+  SeanetEventLog::Log (SeanetEventLog::RESOLUTION_ADD, GetNode (), eid, ipv4);
   if(lh==NULL){
     lh = new ResolutionApplicationv4::LISTIP;
 
@@ -294,16 +296,14 @@ void ResolutionApplicationv4::RequestHandle(uint8_t* buffer, uint8_t buffer_len,
         res[EIDSIZE+1] = 10;
         SeanetHeader ssenh(RESOLUTION_APPLICATION,REPLY_EID_NA);
         ResolutionApplicationv4::SendPacket(res,MAX_PAYLOAD_LEN,ssenh,from); 
-        NS_LOG_INFO("1:Resolution reply request "<<ipnum<<" "<<buffer[15]<<buffer[16]<<buffer[17]<<buffer[18]
-      <<buffer[19]);
+        SeanetEventLog::Log (SeanetEventLog::RESOLUTION_REPLY, GetNode (), buffer, from);
         memset(res+EIDSIZE,0,MAX_PAYLOAD_LEN-EIDSIZE);    
       }else if(ipnum%10==0 && itnext==value->end()){
         res[EIDSIZE]=PACKET_FINISH;//
         res[EIDSIZE+1] = 10;
         SeanetHeader ssenh(RESOLUTION_APPLICATION,REPLY_EID_NA);
         ResolutionApplicationv4::SendPacket(res,MAX_PAYLOAD_LEN,ssenh,from);  
-        NS_LOG_INFO("2:Resolution reply request "<<ipnum<<" "<<buffer[15]<<buffer[16]<<buffer[17]<<buffer[18]
-      <<buffer[19]);
+        SeanetEventLog::Log (SeanetEventLog::RESOLUTION_REPLY, GetNode (), buffer, from);
         memset(res+EIDSIZE,0,MAX_PAYLOAD_LEN-EIDSIZE);    
       }
     }
@@ -311,8 +311,7 @@ void ResolutionApplicationv4::RequestHandle(uint8_t* buffer, uint8_t buffer_len,
       res[EIDSIZE]=PACKET_FINISH;//
       res[EIDSIZE+1] = ipnum%10;
       // memcpy(res+EIDSIZE,value,EID_NA_TABLE_VALUE_SIZE);
-      NS_LOG_INFO("3:Resolution reply request "<<ipnum<<" "<<buffer[15]<<buffer[16]<<buffer[17]<<buffer[18]
-      <<buffer[19]);
+      SeanetEventLog::Log (SeanetEventLog::RESOLUTION_REPLY, GetNode (), buffer, from);
       SeanetHeader ssenh(RESOLUTION_APPLICATION,REPLY_EID_NA);
       ResolutionApplicationv4::SendPacket(res,MAX_PAYLOAD_LEN,ssenh,from);
     }
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "seanet-event-log.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SeanetEventLog");
+
+/// Version of the file format
+#define SEANET_EVENT_LOG_VERSION 1
+
+static_assert (sizeof (SeanetEventLog::Record) == 40, "SeanetEventLog::Record must not be padded");
+
+bool SeanetEventLog::m_enabled = false;
+
+/// Output file of the event log
+static std::FILE *g_seanetEventLogFile = 0;
+/// Records not written yet
+static std::vector<SeanetEventLog::Record> g_seanetEventLogBuffer;
+/// Number of records buffered before a write
+static uint32_t g_seanetEventLogBufferSize = 0;
+
+void
+SeanetEventLog::Enable (std::string fileName, uint32_t bufferSize)
+{
+  NS_LOG_FUNCTION (fileName << bufferSize);
+  NS_ASSERT (bufferSize > 0);
+  Disable ();
+  g_seanetEventLogFile = std::fopen (fileName.c_str (), "wb");
+  if (g_seanetEventLogFile == 0)
+    {
+      NS_FATAL_ERROR ("Can not open event log file " << fileName);
+    }
+  uint32_t header[3] = { SEANET_EVENT_LOG_VERSION, sizeof (Record), 0x01020304 };
+  std::fwrite ("SEANETEV", 1, 8, g_seanetEventLogFile);
+  std::fwrite (header, sizeof (header), 1, g_seanetEventLogFile);
+  g_seanetEventLogBufferSize = bufferSize;
+  g_seanetEventLogBuffer.clear ();
+  g_seanetEventLogBuffer.reserve (bufferSize);
+  m_enabled = true;
+  Simulator::ScheduleDestroy (&SeanetEventLog::Disable);
+}
+
+void
+SeanetEventLog::Disable (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (g_seanetEventLogFile == 0)
+    {
+      return;
+    }
+  Flush ();
+  std::fclose (g_seanetEventLogFile);
+  g_seanetEventLogFile = 0;
+  m_enabled = false;
+}
+
+void
+SeanetEventLog::Flush (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (g_seanetEventLogFile == 0)
+    {
+      return;
+    }
+  if (!g_seanetEventLogBuffer.empty ())
+    {
+      std::fwrite (&g_seanetEventLogBuffer[0], sizeof (Record),
+                   g_seanetEventLogBuffer.size (), g_seanetEventLogFile);
+      g_seanetEventLogBuffer.clear ();
+    }
+  std::fflush (g_seanetEventLogFile);
+}
+
+void
+SeanetEventLog::Log (EventKind kind, Ptr<Node> node, const uint8_t *eid, const Address &peer)
+{
+  if (!m_enabled)
+    {
+      return;
+    }
+  Ipv4Address ipv4;
+  if (peer.GetLength () >= 4)
+    {
+      uint8_t buf[Address::MAX_SIZE];
+      peer.CopyTo (buf);
+      ipv4 = Ipv4Address::Deserialize (buf);
+    }
+  DoLog (kind, node, eid, ipv4);
+}
+
+void
+SeanetEventLog::DoLog (EventKind kind, Ptr<Node> node, const uint8_t *eid, Ipv4Address peer)
+{
+  Record record;
+  record.time = Simulator::Now ().GetNanoSeconds ();
+  record.node = node != 0 ? node->GetId () : 0xffffffff;
+  record.peer = peer.IsInitialized () ? peer.Get () : 0;
+  record.kind = kind;
+  std::memset (record.reserved, 0, sizeof (record.reserved));
+  if (eid != 0)
+    {
+      std::memcpy (record.eid, eid, EIDSIZE);
+    }
+  else
+    {
+      std::memset (record.eid, 0, EIDSIZE);
+    }
+  g_seanetEventLogBuffer.push_back (record);
+  if (g_seanetEventLogBuffer.size () >= g_seanetEventLogBufferSize)
+    {
+      Flush ();
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SEANET_EVENT_LOG_H
+#define SEANET_EVENT_LOG_H
+
+#include <stdint.h>
+#include <string>
+#include "ns3/ptr.h"
+#include "ns3/address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/seanet-eid.h"
+
+namespace ns3 {
+
+class Node;
+
+/**
+ * \ingroup udpclientserver
+ * \brief A binary log of the events of the SEANET applications.
+ *
+ * Each event is stored as a fixed-size Record (time, node, peer, kind
+ * and EID).  The records are buffered in memory and written to the file
+ * when the buffer is full, when the log is disabled, and when the
+ * simulator is destroyed.  Logging an event when the log is not enabled
+ * costs a single test.
+ *
+ * The file starts with the 8 bytes "SEANETEV", followed by three
+ * uint32_t: the format version, the record size, and 0x01020304 to
+ * identify the byte order of the file.  utils/read-seanet-event-log.py
+ * reads it.
+ */
+class SeanetEventLog
+{
+public:
+  /// Kinds of logged events
+  enum EventKind
+  {
+    CLIENT_WRITE = 1,        //!< A client sent a multicast registration (peer: switch)
+    CLIENT_READ = 2,         //!< A client sent a multicast join request (peer: switch)
+    CLIENT_MULTICAST_REPLY = 3, //!< A client received multicast data (peer: sender)
+    CLIENT_SWITCH_REPLY = 4, //!< A client received a data reply from a switch (peer: switch)
+    SWITCH_REGIST_SELF = 5,  //!< A source DR registered an EID as its own root node
+    SWITCH_REGIST_TO_RN = 6, //!< A source DR forwarded a registration (peer: root node)
+    SWITCH_GRAFT_REPLY = 7,  //!< A multicast switch answered a graft request (peer: requester)
+    SWITCH_GRAFT_REQUEST = 8, //!< A switch sent a graft request (peer: nearest switch)
+    SWITCH_RESOLUTION_MISS = 9, //!< A switch did not find an EID in the resolution table
+    SWITCH_RESOLUTION_ADD = 10, //!< A switch added an EID to the resolution table (peer: address)
+    SWITCH_RESOLUTION_REPLY = 11, //!< A switch received a resolution reply (peer: resolver)
+    RESOLUTION_ADD = 12,     //!< The resolution node registered an EID (peer: address)
+    RESOLUTION_REPLY = 13    //!< The resolution node answered a request (peer: requester)
+  };
+
+  /// A logged event, as stored in the file
+  struct Record
+  {
+    int64_t time;           //!< Simulation time, in ns
+    uint32_t node;          //!< Identifier of the node of the application
+    uint32_t peer;          //!< IPv4 address of the peer, or 0
+    uint8_t kind;           //!< EventKind
+    uint8_t reserved[3];    //!< Reserved, zero
+    uint8_t eid[EIDSIZE];   //!< EID of the event, or zeros
+  };
+
+  /**
+   * \brief Start logging the events to a file.
+   * \param fileName the name of the file, which is truncated
+   * \param bufferSize the number of records buffered before a write
+   */
+  static void Enable (std::string fileName, uint32_t bufferSize = 4096);
+
+  /**
+   * \brief Write the buffered records, and stop logging.
+   */
+  static void Disable (void);
+
+  /**
+   * \brief Write the buffered records to the file.
+   */
+  static void Flush (void);
+
+  /**
+   * \return true if the events are being logged
+   */
+  static bool IsEnabled (void)
+  {
+    return m_enabled;
+  }
+
+  /**
+   * \brief Log an event, if the log is enabled.
+   * \param kind the kind of event
+   * \param node the node of the application
+   * \param eid the EID of the event (EIDSIZE bytes), or 0
+   * \param peer the address of the peer
+   */
+  static void Log (EventKind kind, Ptr<Node> node, const uint8_t *eid, Ipv4Address peer)
+  {
+    if (m_enabled)
+      {
+        DoLog (kind, node, eid, peer);
+      }
+  }
+
+  /**
+   * \brief Log an event, if the log is enabled.
+   * \param kind the kind of event
+   * \param node the node of the application
+   * \param eid the EID of the event (EIDSIZE bytes), or 0
+   * \param peer the address of the peer, holding an IPv4 address
+   */
+  static void Log (EventKind kind, Ptr<Node> node, const uint8_t *eid, const Address &peer);
+
+private:
+  /**
+   * \brief Append a record to the buffer.
+   * \param kind the kind of event
+   * \param node the node of the application
+   * \param eid the EID of the event (EIDSIZE bytes), or 0
+   * \param peer the address of the peer
+   */
+  static void DoLog (EventKind kind, Ptr<Node> node, const uint8_t *eid, Ipv4Address peer);
+
+  static bool m_enabled; //!< True if the events are being logged
+};
+
+} // namespace ns3
+
+#endif /* SEANET_EVENT_LOG_H */
@@ -29,6 +29,7 @@
 #define GRAFITING_REQUEST 0x03
 #define MULTICAST_DATA_TRANS 0x04
 #define REGIST_TO_DEST_DR 0x05
+#define REGIST_TO_RN_ACK 0x06 // RN acknowledges the REGIST_TO_RN of an EID to the source DR
 
 
 #define IS_DST 0x01
@@ -30,6 +30,7 @@
 #include <cstdlib>
 #include <cstdio>
 #include "storage-client-application-v4.h"
+#include "seanet-event-log.h"
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("StorageClientApplicationv4");
@@ -285,13 +286,7 @@ void StorageClientApplicationv4::ResolutionProtocolHandle(uint8_t* buffer, uint8
   }
 }
 void StorageClientApplicationv4::SwitchReplyHandle(uint8_t* buffer, uint8_t buffer_len, Address from){
-  SeanetEID se(buffer);
-  uint8_t addr[20];
-  from.CopyTo(addr);
-  Ipv4Address ipv4 = Ipv4Address::Deserialize (addr);
-  InetSocketAddress i4a = InetSocketAddress (ipv4, m_switch_port);
-  NS_LOG_INFO("client receive switch reply: switch address"<<i4a.GetIpv4());
-  se.Print();
+  SeanetEventLog::Log (SeanetEventLog::CLIENT_SWITCH_REPLY, GetNode (), buffer, from);
   // NS_ASSERT (m_readEvent.IsExpired ());
   // m_readEvent = Simulator::Schedule (m_interval, &StorageClientApplicationv4::Write, this);
 }
@@ -28,10 +28,12 @@
 #include "ns3/socket-factory.h"
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
+#include "ns3/double.h"
 #include "packet-loss-counter.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/random-variable-stream.h"
 #include "switch-application-v4.h"
+#include "seanet-event-log.h"
 #include <iostream>
 #include <iomanip>
 #include <string.h>
@@ -78,16 +80,67 @@ SwitchApplicationv4::GetTypeId (void)
           .AddAttribute ("TreeType","SPT, RPT, Seanet",
                           StringValue ("Seanet"),
                           MakeStringAccessor (&SwitchApplicationv4::tree_type),
-                          MakeStringChecker ());
+                          MakeStringChecker ())
+          .AddAttribute ("CompletionTimeBinWidth",
+                         "The bin width of the graft and registration completion time histograms, in seconds.",
+                         DoubleValue (0.001),
+                         MakeDoubleAccessor (&SwitchApplicationv4::m_completionTimeBinWidth),
+                         MakeDoubleChecker<double> (0))
+          .AddTraceSource ("Message", "A SEANET message has been received",
+                           MakeTraceSourceAccessor (&SwitchApplicationv4::m_messageTrace),
+                           "ns3::SwitchApplicationv4::MessageTracedCallback")
+          .AddTraceSource ("GraftCompleted", "A graft has completed",
+                           MakeTraceSourceAccessor (&SwitchApplicationv4::m_graftTrace),
+                           "ns3::SwitchApplicationv4::CompletionTracedCallback")
+          .AddTraceSource ("RegistrationCompleted", "A registration has completed",
+                           MakeTraceSourceAccessor (&SwitchApplicationv4::m_registrationTrace),
+                           "ns3::SwitchApplicationv4::CompletionTracedCallback")
+          .AddTraceSource ("Received", "Number of received packets",
+                           MakeTraceSourceAccessor (&SwitchApplicationv4::m_received),
+                           "ns3::TracedValueCallback::Uint64")
+          .AddTraceSource ("GraftsCompleted", "Number of completed grafts",
+                           MakeTraceSourceAccessor (&SwitchApplicationv4::m_graftsCompleted),
+                           "ns3::TracedValueCallback::Uint64")
+          .AddTraceSource ("RegistrationsCompleted", "Number of completed registrations",
+                           MakeTraceSourceAccessor (&SwitchApplicationv4::m_registrationsCompleted),
+                           "ns3::TracedValueCallback::Uint64")
+          .AddTraceSource ("ResolutionHits", "Number of EID lookups found in the resolution table",
+                           MakeTraceSourceAccessor (&SwitchApplicationv4::m_resolutionHits),
+                           "ns3::TracedValueCallback::Uint64")
+          .AddTraceSource ("ResolutionMisses", "Number of EID lookups not found in the resolution table",
+                           MakeTraceSourceAccessor (&SwitchApplicationv4::m_resolutionMisses),
+                           "ns3::TracedValueCallback::Uint64")
+          .AddTraceSource ("EidTableSize", "Number of EIDs stored by this switch",
+                           MakeTraceSourceAccessor (&SwitchApplicationv4::m_eidTableSize),
+                           "ns3::TracedValueCallback::Uint32")
+          .AddTraceSource ("UnicastEntries", "Number of unicast table entries added by this switch",
+                           MakeTraceSourceAccessor (&SwitchApplicationv4::m_unicastEntries),
+                           "ns3::TracedValueCallback::Uint32")
+          .AddTraceSource ("MulticastEntries", "Number of multicast table entries added by this switch",
+                           MakeTraceSourceAccessor (&SwitchApplicationv4::m_multicastEntries),
+                           "ns3::TracedValueCallback::Uint32")
+          .AddTraceSource ("ResolutionEntries", "Number of resolution table entries added by this switch",
+                           MakeTraceSourceAccessor (&SwitchApplicationv4::m_resolutionEntries),
+                           "ns3::TracedValueCallback::Uint32");
                           
   return tid;
 }
 
-SwitchApplicationv4::SwitchApplicationv4 () : m_loss_counter (0)
+SwitchApplicationv4::SwitchApplicationv4 ()
+  : m_loss_counter (0),
+    m_completionTimeBinWidth (0.001),
+    m_graftsCompleted (0),
+    m_registrationsCompleted (0),
+    m_resolutionHits (0),
+    m_resolutionMisses (0),
+    m_eidTableSize (0),
+    m_unicastEntries (0),
+    m_multicastEntries (0),
+    m_resolutionEntries (0)
 {
   NS_LOG_FUNCTION (this);
   m_received = 0;
-
+  memset (m_messageCounts, 0, sizeof (m_messageCounts));
 }
 void SwitchApplicationv4::SetNeighInfoTable
   (sgi::hash_map<Ipv4Address, std::list<uint8_t *>*, Ipv4AddressHash>* sct,
@@ -131,10 +184,138 @@ SwitchApplicationv4::GetReceived (void) const
   return m_received;
 }
 
+uint64_t
+SwitchApplicationv4::GetMessageCount (uint8_t applicationType, uint8_t protocolType) const
+{
+  if (applicationType > MAX_MESSAGE_TYPE || protocolType > MAX_MESSAGE_TYPE)
+    {
+      return 0;
+    }
+  return m_messageCounts[applicationType][protocolType];
+}
+
+const std::map<SeanetEID, Histogram>&
+SwitchApplicationv4::GetGraftTimes (void) const
+{
+  return m_graftTimes;
+}
+
+const std::map<SeanetEID, Histogram>&
+SwitchApplicationv4::GetRegistrationTimes (void) const
+{
+  return m_registrationTimes;
+}
+
+Time
+SwitchApplicationv4::GetGraftTimeSum (void) const
+{
+  return m_graftTimeSum;
+}
+
+Time
+SwitchApplicationv4::GetRegistrationTimeSum (void) const
+{
+  return m_registrationTimeSum;
+}
+
+uint64_t
+SwitchApplicationv4::GetGraftsCompleted (void) const
+{
+  return m_graftsCompleted;
+}
+
+uint64_t
+SwitchApplicationv4::GetRegistrationsCompleted (void) const
+{
+  return m_registrationsCompleted;
+}
+
+uint64_t
+SwitchApplicationv4::GetResolutionHits (void) const
+{
+  return m_resolutionHits;
+}
+
+uint64_t
+SwitchApplicationv4::GetResolutionMisses (void) const
+{
+  return m_resolutionMisses;
+}
+
+uint32_t
+SwitchApplicationv4::GetEidTableSize (void) const
+{
+  return m_eidTableSize;
+}
+
+uint32_t
+SwitchApplicationv4::GetUnicastEntries (void) const
+{
+  return m_unicastEntries;
+}
+
+uint32_t
+SwitchApplicationv4::GetMulticastEntries (void) const
+{
+  return m_multicastEntries;
+}
+
+uint32_t
+SwitchApplicationv4::GetResolutionEntries (void) const
+{
+  return m_resolutionEntries;
+}
+
+void
+SwitchApplicationv4::CompleteGraft (const SeanetEID &se)
+{
+  sgi::hash_map<SeanetEID, Time, SeanetEIDHash>::iterator it = m_pendingGrafts.find (se);
+  if (it == m_pendingGrafts.end ())
+    {
+      return;
+    }
+  Time time = Simulator::Now () - it->second;
+  m_pendingGrafts.erase (it);
+  AddCompletionTime (m_graftTimes, se, time);
+  m_graftTimeSum += time;
+  m_graftsCompleted++;
+  m_graftTrace (se, time);
+}
+
+void
+SwitchApplicationv4::CompleteRegistration (const SeanetEID &se)
+{
+  sgi::hash_map<SeanetEID, Time, SeanetEIDHash>::iterator it = m_pendingRegistrations.find (se);
+  if (it == m_pendingRegistrations.end ())
+    {
+      return;
+    }
+  Time time = Simulator::Now () - it->second;
+  m_pendingRegistrations.erase (it);
+  AddCompletionTime (m_registrationTimes, se, time);
+  m_registrationTimeSum += time;
+  m_registrationsCompleted++;
+  m_registrationTrace (se, time);
+}
+
+void
+SwitchApplicationv4::AddCompletionTime (std::map<SeanetEID, Histogram> &times,
+                                        const SeanetEID &se, Time time)
+{
+  std::map<SeanetEID, Histogram>::iterator it = times.find (se);
+  if (it == times.end ())
+    {
+      it = times.insert (std::make_pair (se, Histogram (m_completionTimeBinWidth))).first;
+    }
+  it->second.AddValue (time.GetSeconds ());
+}
+
 void
 SwitchApplicationv4::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_pendingGrafts.clear ();
+  m_pendingRegistrations.clear ();
   Application::DoDispose ();
 }
 
@@ -292,15 +473,18 @@ SwitchApplicationv4::FrontEnd (Ptr<Socket> socket)
               uint32_t protocol_type = ssenh.GetProtocolType();
               uint32_t is_dst = ssenh.Getdst();
               uint32_t interface_num = ssenh.GetInterface();
+              if (application_type <= MAX_MESSAGE_TYPE && protocol_type <= MAX_MESSAGE_TYPE)
+                {
+                  m_messageCounts[application_type][protocol_type]++;
+                }
+              m_messageTrace (application_type, protocol_type, from);
               //local address 
               Ipv4Address i4a = Ipv4Address::ConvertFrom(local_address);
               i4a.SetInterfaceNum(interface_num);
-              InetSocketAddress mlocal = InetSocketAddress (i4a, m_port);
               //freom address
               uint8_t fromaddr[18];
               from.CopyTo(fromaddr);
               Ipv4Address fromipv4=Ipv4Address::Deserialize (fromaddr);
-              InetSocketAddress fromipv4isa = InetSocketAddress (fromipv4, m_port);
               uint8_t buffer[EIDSIZE];
               uint32_t buffer_len = packet->CopyData(buffer, EIDSIZE);
               if(is_dst == NOT_DST){
@@ -367,9 +551,7 @@ SwitchApplicationv4::FrontEnd (Ptr<Socket> socket)
                         rni4a = i4a;// SPT树的RN节点是自己
                       }
                       if(rni4a == i4a){//如果找到RN是自己，直接进行注册就可以
-                        NS_LOG_INFO("6.3:Source DR "<<mlocal.GetIpv4()<<" find RN is Self "<<" EID "
-                      <<(uint32_t)(buffer[15]-'0')<<" "<<(uint32_t)(buffer[16]-'0')<<" "<<(uint32_t)(buffer[17]-'0')<<" "
-                      <<(uint32_t)(buffer[18]-'0')<<" "<<(uint32_t)(buffer[19]-'0'));
+                        SeanetEventLog::Log (SeanetEventLog::SWITCH_REGIST_SELF, GetNode (), buffer, i4a);
                         uint8_t* buf = new uint8_t[EIDSIZE];
                         packet->CopyData(buf,EIDSIZE);        
                         AddCastTable(multicast_table,i4a,buf);
@@ -379,13 +561,21 @@ SwitchApplicationv4::FrontEnd (Ptr<Socket> socket)
                         AddCastTable(unicast_table,i4a,buf);                      
                         SeanetEID se(buffer);
                         AddEIDNAINFO(se,i4a);     
+                        if (m_pendingRegistrations.find (se) == m_pendingRegistrations.end ())
+                          {
+                            m_pendingRegistrations[se] = Simulator::Now ();
+                          }
+                        CompleteRegistration (se);
                       }else{//找的RN不是自己
-                        InetSocketAddress rni4aisa = InetSocketAddress (rni4a, m_port);
                         SeanetHeader ssenh(MULTICAST_APPLICATION,REGIST_TO_RN);
                         SendPacket(buffer,buffer_len,ssenh,Address(rni4a));
-                        NS_LOG_LOGIC("6.5:Source DR "<<mlocal.GetIpv4()<<" find RN "<<rni4aisa.GetIpv4()<<" EID "
-                        <<(uint32_t)(buffer[15]-'0')<<" "<<(uint32_t)(buffer[16]-'0')<<" "<<(uint32_t)(buffer[17]-'0')<<" "
-                        <<(uint32_t)(buffer[18]-'0')<<" "<<(uint32_t)(buffer[19]-'0'));
+                        // the root node acknowledges the registration with a REGIST_TO_RN_ACK
+                        SeanetEID se(buffer);
+                        if (m_pendingRegistrations.find (se) == m_pendingRegistrations.end ())
+                          {
+                            m_pendingRegistrations[se] = Simulator::Now ();
+                          }
+                        SeanetEventLog::Log (SeanetEventLog::SWITCH_REGIST_TO_RN, GetNode (), buffer, rni4a);
                       }
                     }else if(protocol_type == REGIST_TO_RN){//RN收到该包后，向解析注册  
                       uint8_t* buf = new uint8_t[EIDSIZE];
@@ -398,6 +588,10 @@ SwitchApplicationv4::FrontEnd (Ptr<Socket> socket)
                       SeanetEID se(buffer);
                       AddEIDNAINFO(se,i4a);    
                       NeighInfoReply(fromipv4,m_port);       
+                      SeanetHeader ackh(MULTICAST_APPLICATION,REGIST_TO_RN_ACK);
+                      SendPacket(buffer,buffer_len,ackh,Address(fromipv4));
+                    }else if(protocol_type == REGIST_TO_RN_ACK){//源端DR收到RN的注册确认，注册完成
+                      CompleteRegistration (SeanetEID (buffer));
                     }else if(protocol_type == GRAFITING_REQUEST){//组播节点收到嫁接请求，回复数据,回复时延探测
                       // NS_LOG_INFO("Multicast Node"<< mlocal.GetIpv4()<< " receive request from "<< fromipv4isa.GetIpv4());
                       SeanetHeader ssenh(MULTICAST_APPLICATION,MULTICAST_DATA_TRANS);
@@ -410,10 +604,7 @@ SwitchApplicationv4::FrontEnd (Ptr<Socket> socket)
                       i4a.SetInterfaceNum(0);
                       AddCastTable(multicast_table,i4a,buf);
                       // AddCastTable(unicast_table,i4a,buf);     
-                      NS_LOG_LOGIC("12.3:switch address "<<mlocal.GetIpv4()<<" is_dst "<<is_dst
-              <<" from address "<<fromipv4isa.GetIpv4()<<" application_type "<<application_type
-              <<" protoco type "<<protocol_type<<" interface "<<interface_num<<" EID "<<(uint32_t)(buffer[15]-'0')<<" "<<(uint32_t)(buffer[16]-'0')<<" "<<(uint32_t)(buffer[17]-'0')<<" "
-                        <<(uint32_t)(buffer[18]-'0')<<" "<<(uint32_t)(buffer[19]-'0'));  
+                      SeanetEventLog::Log (SeanetEventLog::SWITCH_GRAFT_REPLY, GetNode (), buffer, fromipv4);
                     }else if(protocol_type == REGIST_TO_DEST_DR){
                       //收端DR收到客户端的组播接收请求,选择最近的组播管理节点。这里可以直接向解析发送请求，解析回复iplist
                       // NS_LOG_INFO("DR receive multicast request");
@@ -426,14 +617,18 @@ SwitchApplicationv4::FrontEnd (Ptr<Socket> socket)
                       // AddCastTable(unicast_table,i4a,buf);     
                       
                       SeanetEID se(buffer);
+                      if (m_pendingGrafts.find (se) == m_pendingGrafts.end ())
+                        {
+                          m_pendingGrafts[se] = Simulator::Now ();
+                        }
                       Ipv4Address neartesti4a = FindNearestNode(se);
                       SeanetHeader ssenh(MULTICAST_APPLICATION,GRAFITING_REQUEST);
                       SendPacket(buffer,buffer_len,ssenh,neartesti4a); 
                       // SeanetHeader ssenh(RESOLUTION_APPLICATION,REQUEST_EID_NA);
                       // SendPacket(buffer,buffer_len,ssenh,resolution_addr); 
-                      NS_LOG_LOGIC("12.5:switch address "<<mlocal.GetIpv4()<<" sendto nearerst "<<
-              " address "<<InetSocketAddress(neartesti4a,m_port).GetIpv4()<<" EID "  <<(uint32_t)(buffer[15]-'0')<<" "<<(uint32_t)(buffer[16]-'0')<<" "<<(uint32_t)(buffer[17]-'0')<<" "
-                      <<(uint32_t)(buffer[18]-'0')<<" "<<(uint32_t)(buffer[19]-'0'));
+                      SeanetEventLog::Log (SeanetEventLog::SWITCH_GRAFT_REQUEST, GetNode (), buffer, neartesti4a);
+                    }else if(protocol_type == MULTICAST_DATA_TRANS){//收端DR收到嫁接节点回复的数据，嫁接完成
+                      CompleteGraft (SeanetEID (buffer));
                     }
                     break;
                   }
@@ -478,15 +673,23 @@ void SwitchApplicationv4::AddCastTable( sgi::hash_map<Ipv4Address, std::list<uin
     }else{
       if(!CheckDuplicate(table->find(i4a)->second,buf)){
         table->find(i4a)->second->push_back(buf);
+      }else{
+        return;
       }
     }
   }
+  if(table == unicast_table){
+    m_unicastEntries++;
+  }else{
+    m_multicastEntries++;
+  }
 
 }
 uint8_t SwitchApplicationv4::AddEIDTable(SeanetEID se, uint8_t value){
   uint8_t v = SwitchApplicationv4::LookupEIDTable(se);
   if(v == 0){
     m_eid_table[se] = value;
+    m_eidTableSize = m_eid_table.size ();
     return value;
   }
   return 0;
@@ -519,13 +722,12 @@ Ipv4Address SwitchApplicationv4::FindNearestNode(SeanetEID se){
   Ipv4Address shortestip;      
   if(resolution_table->find(se)==resolution_table->end() || resolution_table->find(se)->second == NULL){
     
-    uint8_t eid[20];
+    m_resolutionMisses++;
+    uint8_t eid[EIDSIZE];
     se.getSeanetEID(eid);
-    // if(eid[16]=='9' && eid[17]=='2' && eid[18]=='2'){
-      NS_LOG_INFO("EID NA TABLE NOT found ");
-      se.Print();
-    // }
+    SeanetEventLog::Log (SeanetEventLog::SWITCH_RESOLUTION_MISS, GetNode (), eid, Ipv4Address ());
   }else{
+    m_resolutionHits++;
 
     if(this->tree_type == "SPT"){//第一个注册的点肯定是源节点。
       // NS_LOG_LOGIC("SPT "<<InetSocketAddress(Ipv4Address::ConvertFrom(*(resolution_table->find(se)->second->back())),m_port).GetIpv4());
@@ -556,8 +758,7 @@ void SwitchApplicationv4::ResolutionProtocolHandle(uint8_t* buffer, uint8_t buff
       uint32_t ipnum = buffer[EIDSIZE+1];
       Time shortestime(1000000000);
       Ipv4Address shortestip;
-      NS_LOG_INFO("switch "<<InetSocketAddress(Ipv4Address::ConvertFrom(local_address),m_port).GetIpv4()<<" eid "<<buffer[15]<<buffer[16]<<buffer[17]<<buffer[19]<<buffer[19]
-      <<" receive resolve answer "<<ipnum);
+      SeanetEventLog::Log (SeanetEventLog::SWITCH_RESOLUTION_REPLY, GetNode (), buffer, from);
       for(std::size_t i = 0; i < ipnum; i++){
         Ipv4Address ipv4=Ipv4Address::Deserialize (buffer+EIDSIZE+2 + 18 * i);
         if(i == 0){
@@ -578,8 +779,7 @@ void SwitchApplicationv4::ResolutionProtocolHandle(uint8_t* buffer, uint8_t buff
         se.getSeanetEID(buf);
         SeanetHeader ssenh(MULTICAST_APPLICATION,GRAFITING_REQUEST);
         SendPacket(buf,MAX_PAYLOAD_LEN,ssenh,shortestip); 
-        InetSocketAddress i4a = InetSocketAddress (shortestip, m_port);
-        NS_LOG_INFO("grafting to nearest switch "<<i4a.GetIpv4()<<" eid "<<buf[15]<<buf[16]<<buf[17]<<buf[19]<<buf[19]);
+        SeanetEventLog::Log (SeanetEventLog::SWITCH_GRAFT_REQUEST, GetNode (), buf, shortestip);
       }
       // m_resolution_table[se]=shortestip;
 
@@ -656,7 +856,6 @@ void SwitchApplicationv4::NeigthInfoProtocolHandle(uint8_t* buffer, uint8_t buff
       local_address.CopyTo(addr);
       // Ipv4Address lipv4 = Ipv4Address::Deserialize (addr);
       Time delay = Simulator::Now () - stsh.GetTs ();
-
       if(multicast_table->find(ipv4)!=multicast_table->end()){
         delay_table[ipv4]=delay;
       //   NS_LOG_INFO("switch"<< InetSocketAddress(lipv4,m_port).GetIpv4()
@@ -678,9 +877,11 @@ void SwitchApplicationv4::AddEIDNAINFO(SeanetEID se,Ipv4Address i4a){
     *pi4a = i4a;
     std::list<Ipv4Address*>*p = new std::list<Ipv4Address*>;
     p->push_back(pi4a);
-    NS_LOG_LOGIC("Add info into Resolve table");
-    se.Print();
+    uint8_t eid[EIDSIZE];
+    se.getSeanetEID (eid);
+    SeanetEventLog::Log (SeanetEventLog::SWITCH_RESOLUTION_ADD, GetNode (), eid, i4a);
     resolution_table->insert(std::make_pair(se,p));
+    m_resolutionEntries++;
     if(resolution_table->find(se)==resolution_table->end()){
       NS_LOG_INFO("Insert INfo failed");
     }
@@ -697,6 +898,7 @@ void SwitchApplicationv4::AddEIDNAINFO(SeanetEID se,Ipv4Address i4a){
       Ipv4Address* pi4a = new Ipv4Address(i4a);
       *pi4a = i4a;
       resolution_table->find(se)->second->push_back(pi4a);
+      m_resolutionEntries++;
     }
   }
 }
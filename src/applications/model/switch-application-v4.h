@@ -28,6 +28,9 @@
 #include "ns3/ptr.h"
 #include "ns3/seanet-address.h"
 #include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
+#include "ns3/nstime.h"
+#include "ns3/histogram.h"
 #include "packet-loss-counter.h"
 #include "ns3/queue.h"
 #include "ns3/seanet-eid.h"
@@ -35,6 +38,7 @@
 #include "ns3/seanet-protocol.h"
 #include "ns3/seanet-header.h"
 #include "ns3/seq-ts-size-header.h"
+#include <map>
 namespace ns3 {
 /**
  * \ingroup applications
@@ -74,6 +78,115 @@ public:
    */
   uint64_t GetReceived (void) const;
 
+  /**
+   * \brief Returns the number of received messages of a given type
+   * \param applicationType the SEANET application type of the messages
+   * \param protocolType the SEANET protocol type of the messages
+   * \return the number of received messages of this type
+   */
+  uint64_t GetMessageCount (uint8_t applicationType, uint8_t protocolType) const;
+
+  /**
+   * \brief Returns the histograms of the graft completion times, in seconds, by EID.
+   *
+   * A graft starts when this switch, as destination DR, receives a
+   * REGIST_TO_DEST_DR request for an EID, and completes when the first
+   * MULTICAST_DATA_TRANS message for this EID comes back.
+   * \return the histograms of the graft completion times, by EID
+   */
+  const std::map<SeanetEID, Histogram>& GetGraftTimes (void) const;
+
+  /**
+   * \brief Returns the histograms of the registration completion times, in seconds, by EID.
+   *
+   * A registration starts when this switch, as source DR, receives a
+   * REGIST_TO_SOURCE_DR request for an EID, and completes when the root
+   * node acknowledges the REGIST_TO_RN message of this EID with a
+   * REGIST_TO_RN_ACK message (immediately, if this switch is the root
+   * node).
+   * \return the histograms of the registration completion times, by EID
+   */
+  const std::map<SeanetEID, Histogram>& GetRegistrationTimes (void) const;
+
+  /**
+   * \brief Returns the sum of the graft completion times
+   * \return the sum of the graft completion times
+   */
+  Time GetGraftTimeSum (void) const;
+
+  /**
+   * \brief Returns the sum of the registration completion times
+   * \return the sum of the registration completion times
+   */
+  Time GetRegistrationTimeSum (void) const;
+
+  /**
+   * \brief Returns the number of completed grafts
+   * \return the number of completed grafts
+   */
+  uint64_t GetGraftsCompleted (void) const;
+
+  /**
+   * \brief Returns the number of completed registrations
+   * \return the number of completed registrations
+   */
+  uint64_t GetRegistrationsCompleted (void) const;
+
+  /**
+   * \brief Returns the number of EID lookups found in the resolution table
+   * \return the number of EID lookups found in the resolution table
+   */
+  uint64_t GetResolutionHits (void) const;
+
+  /**
+   * \brief Returns the number of EID lookups not found in the resolution table
+   * \return the number of EID lookups not found in the resolution table
+   */
+  uint64_t GetResolutionMisses (void) const;
+
+  /**
+   * \brief Returns the number of EIDs stored by this switch
+   * \return the number of EIDs stored by this switch
+   */
+  uint32_t GetEidTableSize (void) const;
+
+  /**
+   * \brief Returns the number of unicast table entries added by this switch
+   * \return the number of unicast table entries added by this switch
+   */
+  uint32_t GetUnicastEntries (void) const;
+
+  /**
+   * \brief Returns the number of multicast table entries added by this switch
+   * \return the number of multicast table entries added by this switch
+   */
+  uint32_t GetMulticastEntries (void) const;
+
+  /**
+   * \brief Returns the number of resolution table entries added by this switch
+   * \return the number of resolution table entries added by this switch
+   */
+  uint32_t GetResolutionEntries (void) const;
+
+  /**
+   * TracedCallback signature for received messages.
+   *
+   * \param [in] applicationType the SEANET application type of the message
+   * \param [in] protocolType the SEANET protocol type of the message
+   * \param [in] from the sender address
+   */
+  typedef void (* MessageTracedCallback)
+    (uint8_t applicationType, uint8_t protocolType, const Address &from);
+
+  /**
+   * TracedCallback signature for completed grafts and registrations.
+   *
+   * \param [in] eid the EID of the graft or registration
+   * \param [in] time the completion time
+   */
+  typedef void (* CompletionTracedCallback)
+    (const SeanetEID &eid, Time time);
+
   /**
    * \brief Returns the size of the window used for checking loss.
    * \return the size of the window used for checking loss.
@@ -141,6 +254,26 @@ private:
    * \param socket the socket the packet was received to.
    */
   void AferEnd ();
+
+  /**
+   * \brief Records the completion of a pending graft, if any, for an EID.
+   * \param se the EID
+   */
+  void CompleteGraft (const SeanetEID &se);
+
+  /**
+   * \brief Records the completion of a pending registration, if any, for an EID.
+   * \param se the EID
+   */
+  void CompleteRegistration (const SeanetEID &se);
+
+  /**
+   * \brief Adds a completion time to the histogram of an EID.
+   * \param times the histograms, by EID
+   * \param se the EID
+   * \param time the completion time
+   */
+  void AddCompletionTime (std::map<SeanetEID, Histogram> &times, const SeanetEID &se, Time time);
   
   typedef sgi::hash_map<SeanetEID, uint8_t, SeanetEIDHash> EID_table; //the eid this switch stores.
 
@@ -148,7 +281,7 @@ private:
   Ptr<Queue<SeanetAddress>> addressin;
   uint16_t m_port; //!< Port on which we listen for incoming packets.
   Ptr<Socket> m_socket; //!< IPv4 Socket
-  uint64_t m_received; //!< Number of received packets
+  TracedValue<uint64_t> m_received; //!< Number of received packets
   uint16_t m_cache_size; // total cache size;
   uint16_t m_temp_cache_size;
   bool is_entry_switch;// is entry
@@ -163,6 +296,34 @@ private:
   /// Callbacks for tracing the packet Rx events
   TracedCallback<Ptr<const Packet> > rm_rx_trace;
   bool have_detected;
+
+  /// Largest SEANET application or protocol type counted in m_messageCounts
+  static const uint8_t MAX_MESSAGE_TYPE = 7;
+  /// Number of received messages, by application and protocol type
+  uint64_t m_messageCounts[MAX_MESSAGE_TYPE + 1][MAX_MESSAGE_TYPE + 1];
+  /// EID --> start time of the pending graft
+  sgi::hash_map<SeanetEID, Time, SeanetEIDHash> m_pendingGrafts;
+  /// EID --> start time of the pending registration
+  sgi::hash_map<SeanetEID, Time, SeanetEIDHash> m_pendingRegistrations;
+  double m_completionTimeBinWidth; //!< Bin width of the completion time histograms, in seconds
+  std::map<SeanetEID, Histogram> m_graftTimes;        //!< Graft completion times, by EID
+  std::map<SeanetEID, Histogram> m_registrationTimes; //!< Registration completion times, by EID
+  Time m_graftTimeSum;             //!< Sum of the graft completion times
+  Time m_registrationTimeSum;      //!< Sum of the registration completion times
+  TracedValue<uint64_t> m_graftsCompleted;        //!< Number of completed grafts
+  TracedValue<uint64_t> m_registrationsCompleted; //!< Number of completed registrations
+  TracedValue<uint64_t> m_resolutionHits;   //!< EID lookups found in the resolution table
+  TracedValue<uint64_t> m_resolutionMisses; //!< EID lookups not found in the resolution table
+  TracedValue<uint32_t> m_eidTableSize;     //!< Number of EIDs stored by this switch
+  TracedValue<uint32_t> m_unicastEntries;   //!< Unicast table entries added by this switch
+  TracedValue<uint32_t> m_multicastEntries; //!< Multicast table entries added by this switch
+  TracedValue<uint32_t> m_resolutionEntries; //!< Resolution table entries added by this switch
+  /// Callbacks for tracing the received messages
+  TracedCallback<uint8_t, uint8_t, const Address &> m_messageTrace;
+  /// Callbacks for tracing the completed grafts
+  TracedCallback<const SeanetEID &, Time> m_graftTrace;
+  /// Callbacks for tracing the completed registrations
+  TracedCallback<const SeanetEID &, Time> m_registrationTrace;
   /// Callbacks for tracing the packet Rx events, includes source and destination addresses
   TracedCallback<Ptr<const Packet>, const Address &, const Address &> m_rx_trace_with_addresses;
 
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <cstring>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/seanet-event-log.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Check that the events logged by SeanetEventLog are written to the file,
+ * through a buffer smaller than the number of events.
+ */
+class SeanetEventLogTestCase : public TestCase
+{
+public:
+  SeanetEventLogTestCase ();
+  virtual ~SeanetEventLogTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Log an event with an EID filled with a given byte.
+   * \param node the node
+   * \param value the byte of the EID
+   */
+  void LogEvent (Ptr<Node> node, uint8_t value);
+};
+
+SeanetEventLogTestCase::SeanetEventLogTestCase ()
+  : TestCase ("Check the records written by SeanetEventLog")
+{
+}
+
+SeanetEventLogTestCase::~SeanetEventLogTestCase ()
+{
+}
+
+void
+SeanetEventLogTestCase::LogEvent (Ptr<Node> node, uint8_t value)
+{
+  uint8_t eid[EIDSIZE];
+  memset (eid, value, EIDSIZE);
+  SeanetEventLog::Log (SeanetEventLog::SWITCH_GRAFT_REQUEST, node, eid,
+                       InetSocketAddress (Ipv4Address ("10.0.0.1"), 4000));
+}
+
+void
+SeanetEventLogTestCase::DoRun (void)
+{
+  std::string fileName = CreateTempDirFilename ("seanet-event-log.bin");
+  const uint32_t nEvents = 10;
+  Ptr<Node> node = CreateObject<Node> ();
+
+  // events logged while the log is disabled are dropped
+  LogEvent (node, 0xff);
+  SeanetEventLog::Enable (fileName, 4);
+  NS_TEST_ASSERT_MSG_EQ (SeanetEventLog::IsEnabled (), true, "Log not enabled");
+  for (uint32_t i = 0; i < nEvents; i++)
+    {
+      Simulator::Schedule (MilliSeconds (i), &SeanetEventLogTestCase::LogEvent, this, node, i);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (SeanetEventLog::IsEnabled (), false, "Log not disabled by Simulator::Destroy");
+
+  std::ifstream is (fileName.c_str (), std::ios::binary);
+  char magic[8];
+  uint32_t header[3];
+  is.read (magic, 8);
+  is.read (reinterpret_cast<char *> (header), sizeof (header));
+  NS_TEST_ASSERT_MSG_EQ (std::string (magic, 8), "SEANETEV", "Wrong magic");
+  NS_TEST_ASSERT_MSG_EQ (header[1], sizeof (SeanetEventLog::Record), "Wrong record size");
+  NS_TEST_ASSERT_MSG_EQ (header[2], 0x01020304, "Wrong byte order marker");
+  for (uint32_t i = 0; i < nEvents; i++)
+    {
+      SeanetEventLog::Record record;
+      is.read (reinterpret_cast<char *> (&record), sizeof (record));
+      NS_TEST_ASSERT_MSG_EQ (is.good (), true, "Missing record " << i);
+      NS_TEST_ASSERT_MSG_EQ (record.time, MilliSeconds (i).GetNanoSeconds (), "Wrong time");
+      NS_TEST_ASSERT_MSG_EQ (record.node, node->GetId (), "Wrong node");
+      NS_TEST_ASSERT_MSG_EQ (record.peer, Ipv4Address ("10.0.0.1").Get (), "Wrong peer");
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t) record.kind, SeanetEventLog::SWITCH_GRAFT_REQUEST, "Wrong kind");
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t) record.eid[EIDSIZE - 1], i, "Wrong EID");
+    }
+  is.peek ();
+  NS_TEST_ASSERT_MSG_EQ (is.eof (), true, "Unexpected records");
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief SeanetEventLog TestSuite
+ */
+class SeanetEventLogTestSuite : public TestSuite
+{
+public:
+  SeanetEventLogTestSuite ();
+};
+
+SeanetEventLogTestSuite::SeanetEventLogTestSuite ()
+  : TestSuite ("seanet-event-log", UNIT)
+{
+  AddTestCase (new SeanetEventLogTestCase, TestCase::QUICK);
+}
+
+static SeanetEventLogTestSuite seanetEventLogTestSuite; //!< Static variable for test initialization
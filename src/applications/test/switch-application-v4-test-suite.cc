@@ -0,0 +1,361 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/socket.h"
+#include "ns3/socket-factory.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/histogram.h"
+#include "ns3/seanet-protocol.h"
+#include "ns3/seanet-header.h"
+#include "ns3/seq-ts-size-header.h"
+#include "ns3/switch-application-v4.h"
+#include "ns3/storage-switch-resolution-client-helper-v4.h"
+#include "ns3/seanet-metrics-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * Check the control-plane metrics of SwitchApplicationv4.
+ *
+ * Node 0 runs the switch under test, the source and destination DR.
+ * Node 1 runs the switch chosen as root node, and a test socket that
+ * plays the clients and forges messages to node 0.  The channel delay
+ * is 1 ms, so that a request and its answer take 2 ms.
+ */
+class SwitchApplicationv4MetricsTestCase : public TestCase
+{
+public:
+  SwitchApplicationv4MetricsTestCase ();
+  virtual ~SwitchApplicationv4MetricsTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Send a SEANET message from the test socket to the switch of node 0.
+   * \param applicationType the SEANET application type
+   * \param protocolType the SEANET protocol type
+   * \param eid the byte the EID is filled with
+   */
+  void Send (uint8_t applicationType, uint8_t protocolType, uint8_t eid);
+
+  /**
+   * Send a neighbor reply from the test socket to the switch of node 0.
+   */
+  void SendNeighInfoReply (void);
+
+  /**
+   * Record a completed registration.
+   * \param eid the EID
+   * \param time the completion time
+   */
+  void RegistrationCompleted (const SeanetEID &eid, Time time);
+
+  /**
+   * Record a completed graft.
+   * \param eid the EID
+   * \param time the completion time
+   */
+  void GraftCompleted (const SeanetEID &eid, Time time);
+
+  /**
+   * \param value the byte the EID is filled with
+   * \return the EID
+   */
+  static SeanetEID MakeEid (uint8_t value);
+
+  Ptr<Socket> m_socket;      //!< Test socket on node 1
+  Address m_switchAddress;   //!< Address of the switch of node 0
+  std::map<SeanetEID, Time> m_registrations; //!< Completed registrations
+  std::map<SeanetEID, Time> m_grafts;        //!< Completed grafts
+};
+
+SwitchApplicationv4MetricsTestCase::SwitchApplicationv4MetricsTestCase ()
+  : TestCase ("Check the counters, gauges and completion times of SwitchApplicationv4")
+{
+}
+
+SwitchApplicationv4MetricsTestCase::~SwitchApplicationv4MetricsTestCase ()
+{
+}
+
+SeanetEID
+SwitchApplicationv4MetricsTestCase::MakeEid (uint8_t value)
+{
+  uint8_t eid[EIDSIZE];
+  memset (eid, value, EIDSIZE);
+  return SeanetEID (eid);
+}
+
+void
+SwitchApplicationv4MetricsTestCase::Send (uint8_t applicationType, uint8_t protocolType, uint8_t eid)
+{
+  uint8_t buffer[EIDSIZE];
+  memset (buffer, eid, EIDSIZE);
+  Ptr<Packet> p = Create<Packet> (buffer, EIDSIZE);
+  p->AddHeader (SeanetHeader (applicationType, protocolType));
+  m_socket->SendTo (p, 0, m_switchAddress);
+}
+
+void
+SwitchApplicationv4MetricsTestCase::SendNeighInfoReply (void)
+{
+  uint8_t buffer[10];
+  memset (buffer, '6', 10);
+  Ptr<Packet> p = Create<Packet> (buffer, 10);
+  SeqTsSizeHeader stsh;
+  stsh.SetSize (10);
+  p->AddHeader (stsh);
+  p->AddHeader (SeanetHeader (NEIGH_INFO_APPLICATION, NEIGH_INFO_REPLY, IS_DST));
+  m_socket->SendTo (p, 0, m_switchAddress);
+}
+
+void
+SwitchApplicationv4MetricsTestCase::RegistrationCompleted (const SeanetEID &eid, Time time)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_registrations.count (eid), 0, "Registration completed twice");
+  m_registrations[eid] = time;
+}
+
+void
+SwitchApplicationv4MetricsTestCase::GraftCompleted (const SeanetEID &eid, Time time)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_grafts.count (eid), 0, "Graft completed twice");
+  m_grafts[eid] = time;
+}
+
+void
+SwitchApplicationv4MetricsTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  InternetStackHelper internet;
+  internet.Install (n);
+
+  Ptr<SimpleNetDevice> dev0 = CreateObject<SimpleNetDevice> ();
+  Ptr<SimpleNetDevice> dev1 = CreateObject<SimpleNetDevice> ();
+  n.Get (0)->AddDevice (dev0);
+  n.Get (1)->AddDevice (dev1);
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+  dev0->SetChannel (channel);
+  dev1->SetChannel (channel);
+  NetDeviceContainer d;
+  d.Add (dev0);
+  d.Add (dev1);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer i = ipv4.Assign (d);
+
+  uint16_t port = 100;
+  sgi::hash_map<Ipv4Address, std::list<uint8_t *>*, Ipv4AddressHash> unicastTable, multicastTable;
+  sgi::hash_map<SeanetEID, std::list<Ipv4Address*>*, SeanetEIDHash> resolutionTable;
+  SwitchApplicationHelperv4 switchHelper (InetSocketAddress (i.GetAddress (1), port), port);
+  ApplicationContainer apps = switchHelper.Install (n, &unicastTable, &multicastTable,
+                                                    &resolutionTable, false);
+  apps.Start (Seconds (0));
+  Ptr<SwitchApplicationv4> dr = DynamicCast<SwitchApplicationv4> (apps.Get (0));
+  Ptr<SwitchApplicationv4> rn = DynamicCast<SwitchApplicationv4> (apps.Get (1));
+  dr->TraceConnectWithoutContext ("RegistrationCompleted",
+                                  MakeCallback (&SwitchApplicationv4MetricsTestCase::RegistrationCompleted, this));
+  dr->TraceConnectWithoutContext ("GraftCompleted",
+                                  MakeCallback (&SwitchApplicationv4MetricsTestCase::GraftCompleted, this));
+
+  m_socket = Socket::CreateSocket (n.Get (1), UdpSocketFactory::GetTypeId ());
+  m_socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), port + 1));
+  m_switchAddress = InetSocketAddress (i.GetAddress (0), port);
+
+  // Resolve the addresses with ARP in both directions before the
+  // SEANET messages, so that it does not add to the completion times.
+  Ptr<Socket> arpSocket = Socket::CreateSocket (n.Get (0), UdpSocketFactory::GetTypeId ());
+  arpSocket->Bind (InetSocketAddress (Ipv4Address::GetAny (), port + 1));
+  arpSocket->SendTo (Create<Packet> (1), 0, InetSocketAddress (i.GetAddress (1), port + 1));
+  m_socket->SendTo (Create<Packet> (1), 0, InetSocketAddress (i.GetAddress (0), port + 1));
+
+  // The neighbor reply makes node 1 the root node of node 0.
+  Simulator::Schedule (MilliSeconds (10), &SwitchApplicationv4MetricsTestCase::SendNeighInfoReply, this);
+  // Registration of EID 1, which the root node acknowledges 2 ms later.
+  // A neighbor reply of the root node before the acknowledgement must
+  // not complete it.
+  Simulator::Schedule (MilliSeconds (20), &SwitchApplicationv4MetricsTestCase::Send, this,
+                       MULTICAST_APPLICATION, REGIST_TO_SOURCE_DR, 1);
+  Simulator::Schedule (MicroSeconds (20500), &SwitchApplicationv4MetricsTestCase::SendNeighInfoReply, this);
+  // Registrations of EIDs 2 and 3.  A forged acknowledgement of EID 3,
+  // 0.5 ms after its start, completes EID 3 only.  An acknowledgement
+  // of an EID which is not pending is ignored.
+  Simulator::Schedule (MilliSeconds (30), &SwitchApplicationv4MetricsTestCase::Send, this,
+                       MULTICAST_APPLICATION, REGIST_TO_SOURCE_DR, 2);
+  Simulator::Schedule (MilliSeconds (30), &SwitchApplicationv4MetricsTestCase::Send, this,
+                       MULTICAST_APPLICATION, REGIST_TO_SOURCE_DR, 3);
+  Simulator::Schedule (MicroSeconds (30500), &SwitchApplicationv4MetricsTestCase::Send, this,
+                       MULTICAST_APPLICATION, REGIST_TO_RN_ACK, 3);
+  Simulator::Schedule (MilliSeconds (35), &SwitchApplicationv4MetricsTestCase::Send, this,
+                       MULTICAST_APPLICATION, REGIST_TO_RN_ACK, 4);
+  // Graft of EID 1, found in the resolution table, which the root node
+  // answers 2 ms later; graft of EID 4, not found, which never completes.
+  Simulator::Schedule (MilliSeconds (40), &SwitchApplicationv4MetricsTestCase::Send, this,
+                       MULTICAST_APPLICATION, REGIST_TO_DEST_DR, 1);
+  Simulator::Schedule (MilliSeconds (50), &SwitchApplicationv4MetricsTestCase::Send, this,
+                       MULTICAST_APPLICATION, REGIST_TO_DEST_DR, 4);
+  // Data of EID 1, stored twice.
+  Simulator::Schedule (MilliSeconds (60), &SwitchApplicationv4MetricsTestCase::Send, this,
+                       SWITCH_APPLICATION, RESEIVE_DATA, 1);
+  Simulator::Schedule (MilliSeconds (70), &SwitchApplicationv4MetricsTestCase::Send, this,
+                       SWITCH_APPLICATION, RESEIVE_DATA, 1);
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  // Counters
+  NS_TEST_ASSERT_MSG_EQ (dr->GetMessageCount (MULTICAST_APPLICATION, REGIST_TO_SOURCE_DR), 3,
+                         "Wrong number of REGIST_TO_SOURCE_DR");
+  NS_TEST_ASSERT_MSG_EQ (dr->GetMessageCount (MULTICAST_APPLICATION, REGIST_TO_RN_ACK), 5,
+                         "Wrong number of REGIST_TO_RN_ACK");
+  NS_TEST_ASSERT_MSG_EQ (dr->GetMessageCount (MULTICAST_APPLICATION, REGIST_TO_DEST_DR), 2,
+                         "Wrong number of REGIST_TO_DEST_DR");
+  NS_TEST_ASSERT_MSG_EQ (rn->GetMessageCount (MULTICAST_APPLICATION, REGIST_TO_RN), 3,
+                         "Wrong number of REGIST_TO_RN");
+  NS_TEST_ASSERT_MSG_EQ (rn->GetMessageCount (MULTICAST_APPLICATION, GRAFITING_REQUEST), 1,
+                         "Wrong number of GRAFITING_REQUEST");
+  NS_TEST_ASSERT_MSG_EQ (dr->GetMessageCount (MAX_PAYLOAD_LEN, REGIST_TO_RN), 0,
+                         "Message count of an unknown type");
+  NS_TEST_ASSERT_MSG_EQ (dr->GetResolutionHits (), 1, "Wrong number of resolution hits");
+  NS_TEST_ASSERT_MSG_EQ (dr->GetResolutionMisses (), 1, "Wrong number of resolution misses");
+
+  // Registrations are paired with the acknowledgement of their EID
+  NS_TEST_ASSERT_MSG_EQ (dr->GetRegistrationsCompleted (), 3, "Wrong number of registrations");
+  NS_TEST_ASSERT_MSG_EQ (m_registrations.size (), 3, "Wrong number of traced registrations");
+  NS_TEST_ASSERT_MSG_EQ (m_registrations[MakeEid (1)], MilliSeconds (2), "Wrong registration time of EID 1");
+  NS_TEST_ASSERT_MSG_EQ (m_registrations[MakeEid (2)], MilliSeconds (2), "Wrong registration time of EID 2");
+  NS_TEST_ASSERT_MSG_EQ (m_registrations[MakeEid (3)], MicroSeconds (500), "Wrong registration time of EID 3");
+  NS_TEST_ASSERT_MSG_EQ (dr->GetRegistrationTimeSum (), MicroSeconds (4500), "Wrong sum of registration times");
+  NS_TEST_ASSERT_MSG_EQ (dr->GetGraftsCompleted (), 1, "Wrong number of grafts");
+  NS_TEST_ASSERT_MSG_EQ (m_grafts.size (), 1, "Wrong number of traced grafts");
+  NS_TEST_ASSERT_MSG_EQ (m_grafts[MakeEid (1)], MilliSeconds (2), "Wrong graft time of EID 1");
+  NS_TEST_ASSERT_MSG_EQ (rn->GetRegistrationsCompleted (), 0, "Root node completed a registration");
+
+  // Histograms, by EID, with the default bin width of 1 ms
+  const std::map<SeanetEID, Histogram> &registrationTimes = dr->GetRegistrationTimes ();
+  NS_TEST_ASSERT_MSG_EQ (registrationTimes.size (), 3, "Wrong number of registration histograms");
+  Histogram histogram = registrationTimes.find (MakeEid (1))->second;
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetBinCount (2), 1, "Wrong registration histogram of EID 1");
+  histogram = registrationTimes.find (MakeEid (3))->second;
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetBinCount (0), 1, "Wrong registration histogram of EID 3");
+  NS_TEST_ASSERT_MSG_EQ (dr->GetGraftTimes ().size (), 1, "Wrong number of graft histograms");
+  histogram = dr->GetGraftTimes ().find (MakeEid (1))->second;
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetBinCount (2), 1, "Wrong graft histogram of EID 1");
+
+  std::string fileName = CreateTempDirFilename ("seanet-histograms.csv");
+  SeanetMetricsHelper metrics;
+  metrics.Add (apps);
+  metrics.WriteHistogramCsv (fileName);
+  std::ifstream is (fileName.c_str ());
+  std::string line;
+  std::getline (is, line);
+  NS_TEST_ASSERT_MSG_EQ (line, "node,kind,eid,bin_start_s,bin_end_s,count", "Wrong CSV header");
+  std::getline (is, line);
+  NS_TEST_ASSERT_MSG_EQ (line, "0,graft,0101010101010101010101010101010101010101,0.002,0.003,1",
+                         "Wrong graft histogram line");
+  uint32_t lines = 0;
+  while (std::getline (is, line))
+    {
+      NS_TEST_ASSERT_MSG_EQ (line.compare (0, 15, "0,registration,"), 0, "Wrong registration histogram line");
+      lines++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (lines, 3, "Wrong number of registration histogram lines");
+
+  // Gauges
+  NS_TEST_ASSERT_MSG_EQ (dr->GetEidTableSize (), 1, "Wrong EID table size");
+  NS_TEST_ASSERT_MSG_EQ (rn->GetEidTableSize (), 0, "Wrong EID table size of the root node");
+  NS_TEST_ASSERT_MSG_EQ (dr->GetResolutionEntries (), 1, "Wrong number of resolution entries");
+  NS_TEST_ASSERT_MSG_EQ (rn->GetResolutionEntries (), 3, "Wrong number of resolution entries of the root node");
+  NS_TEST_ASSERT_MSG_EQ (dr->GetUnicastEntries (), 0, "Wrong number of unicast entries");
+  NS_TEST_ASSERT_MSG_EQ (rn->GetUnicastEntries (), 6, "Wrong number of unicast entries of the root node");
+  NS_TEST_ASSERT_MSG_EQ (dr->GetMulticastEntries (), 4, "Wrong number of multicast entries");
+  NS_TEST_ASSERT_MSG_EQ (rn->GetMulticastEntries (), 6, "Wrong number of multicast entries of the root node");
+
+  Simulator::Destroy ();
+  m_socket = 0;
+  arpSocket = 0;
+
+  // The tables own their lists and addresses; the EID buffers are
+  // shared between the unicast and multicast tables.
+  std::set<uint8_t *> buffers;
+  sgi::hash_map<Ipv4Address, std::list<uint8_t *>*, Ipv4AddressHash> *tables[] = { &unicastTable, &multicastTable };
+  for (uint32_t t = 0; t < 2; t++)
+    {
+      for (sgi::hash_map<Ipv4Address, std::list<uint8_t *>*, Ipv4AddressHash>::iterator it = tables[t]->begin ();
+           it != tables[t]->end (); ++it)
+        {
+          if (it->second != 0)
+            {
+              buffers.insert (it->second->begin (), it->second->end ());
+              delete it->second;
+            }
+        }
+    }
+  for (std::set<uint8_t *>::iterator it = buffers.begin (); it != buffers.end (); ++it)
+    {
+      delete [] *it;
+    }
+  for (sgi::hash_map<SeanetEID, std::list<Ipv4Address*>*, SeanetEIDHash>::iterator it = resolutionTable.begin ();
+       it != resolutionTable.end (); ++it)
+    {
+      for (std::list<Ipv4Address*>::iterator a = it->second->begin (); a != it->second->end (); ++a)
+        {
+          delete *a;
+        }
+      delete it->second;
+    }
+}
+
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * \brief SwitchApplicationv4 TestSuite
+ */
+class SwitchApplicationv4TestSuite : public TestSuite
+{
+public:
+  SwitchApplicationv4TestSuite ();
+};
+
+SwitchApplicationv4TestSuite::SwitchApplicationv4TestSuite ()
+  : TestSuite ("switch-application-v4", UNIT)
+{
+  AddTestCase (new SwitchApplicationv4MetricsTestCase, TestCase::QUICK);
+}
+
+static SwitchApplicationv4TestSuite switchApplicationv4TestSuite; //!< Static variable for test initialization
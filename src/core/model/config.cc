@@ -25,8 +25,10 @@
 #include "names.h"
 #include "pointer.h"
 #include "log.h"
+#include "simple-ref-count.h"
 
 #include <sstream>
+#include <unordered_map>
 
 /**
  * \file
@@ -182,6 +184,8 @@ MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &
 /**
  * \ingroup config-impl
  * Helper to test if an array entry matches a config path specification.
+ *
+ * The specification is parsed once into a list of index ranges.
  */
 class ArrayMatcher
 {
@@ -201,6 +205,12 @@ public:
   bool Matches (std::size_t i) const;
 
 private:
+  /**
+   * Parse one alternative of the specification.
+   *
+   * \param [in] element The alternative, without any \c |.
+   */
+  void Parse (std::string element);
   /**
    * Convert a string to an \c uint32_t.
    *
@@ -211,75 +221,80 @@ private:
   bool StringToUint32 (std::string str, uint32_t *value) const;
   /** The Config path element. */
   std::string m_element;
+  /** The element matches every index. */
+  bool m_all;
+  /** The [first, last] index ranges matching the element. */
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
 
 };  // class ArrayMatcher
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_element (element),
+    m_all (false)
 {
   NS_LOG_FUNCTION (this << element);
-}
-bool
-ArrayMatcher::Matches (std::size_t i) const
-{
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  std::string::size_type start = 0;
+  std::string::size_type bar;
+  while ((bar = element.find ("|", start)) != std::string::npos)
     {
-      NS_LOG_DEBUG ("Array " << i << " matches *");
-      return true;
+      Parse (element.substr (start, bar - start));
+      start = bar + 1;
     }
-  std::string::size_type tmp;
-  tmp = m_element.find ("|");
-  if (tmp != std::string::npos)
+  Parse (element.substr (start));
+}
+
+void
+ArrayMatcher::Parse (std::string element)
+{
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      std::string left = m_element.substr (0, tmp - 0);
-      std::string right = m_element.substr (tmp + 1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array " << i << " matches " << left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array " << i << " matches " << right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array " << i << " does not match " << m_element);
-      return false;
+      m_all = true;
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1
       && dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min)
-          && StringToUint32 (upperBound, &max)
-          && i >= min && i <= max)
+          && StringToUint32 (upperBound, &max))
         {
-          NS_LOG_DEBUG ("Array " << i << " matches " << m_element);
-          return true;
-        }
-      else
-        {
-          NS_LOG_DEBUG ("Array " << i << " does not " << m_element);
-          return false;
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value)
-      && i == value)
+  if (StringToUint32 (element, &value))
+    {
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+
+bool
+ArrayMatcher::Matches (std::size_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all)
     {
       NS_LOG_DEBUG ("Array " << i << " matches " << m_element);
       return true;
     }
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator range = m_ranges.begin ();
+       range != m_ranges.end (); ++range)
+    {
+      if (i >= range->first && i <= range->second)
+        {
+          NS_LOG_DEBUG ("Array " << i << " matches " << m_element);
+          return true;
+        }
+    }
   NS_LOG_DEBUG ("Array " << i << " does not match " << m_element);
   return false;
 }
@@ -294,6 +309,191 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
   return !iss.bad () && !iss.fail ();
 }
 
+/**
+ * \ingroup config-impl
+ * A Config path split into its elements, parsed once and shared by
+ * all the resolutions of the path.
+ */
+class ConfigPath : public SimpleRefCount<ConfigPath>
+{
+public:
+  /** One element of a Config path. */
+  struct Element
+  {
+    /**
+     * Parse an element.
+     *
+     * \param [in] element The element, without slashes.
+     */
+    Element (std::string element);
+
+    std::string item;     //!< The element.
+    bool isGetObject;     //!< The element is \c $TypeId.
+    bool hasTid;          //!< The \c $TypeId element names a registered TypeId.
+    TypeId tid;           //!< The TypeId of a \c $TypeId element.
+    ArrayMatcher matcher; //!< The element as array indices.
+  };
+
+  /**
+   * Get the parsed form of a path, from a cache of the paths seen so far.
+   *
+   * \param [in] path The canonical Config path, starting and ending with a '/'.
+   * \returns The parsed path.
+   */
+  static Ptr<const ConfigPath> Get (std::string path);
+
+  /** The elements of the path. */
+  std::vector<Element> m_elements;
+};
+
+ConfigPath::Element::Element (std::string element)
+  : item (element),
+    isGetObject (element.find ("$") == 0),
+    hasTid (false),
+    matcher (element)
+{
+  if (isGetObject)
+    {
+      hasTid = TypeId::LookupByNameFailSafe (item.substr (1, item.size () - 1), &tid);
+    }
+}
+
+Ptr<const ConfigPath>
+ConfigPath::Get (std::string path)
+{
+  NS_LOG_FUNCTION (path);
+  typedef std::unordered_map<std::string, Ptr<const ConfigPath> > Cache;
+  static Cache cache;
+  Cache::const_iterator i = cache.find (path);
+  if (i != cache.end ())
+    {
+      return i->second;
+    }
+  // Scripts use a few dozen different paths, but they can build them
+  // on the fly: bound the cache.
+  if (cache.size () >= 1024)
+    {
+      cache.clear ();
+    }
+  Ptr<ConfigPath> parsed = Create<ConfigPath> ();
+  std::string::size_type start = 1;
+  std::string::size_type next;
+  while ((next = path.find ("/", start)) != std::string::npos)
+    {
+      parsed->m_elements.push_back (Element (path.substr (start, next - start)));
+      start = next + 1;
+    }
+  cache[path] = parsed;
+  return parsed;
+}
+
+/**
+ * \ingroup config-impl
+ * The attributes of a TypeId, including the inherited ones, which lead
+ * to other objects on a Config path: pointers and object containers.
+ */
+class PathAttributes
+{
+public:
+  /** Constructor, of a list not built yet. */
+  PathAttributes ()
+    : m_built (false),
+      m_nAttributes (0)
+  {}
+
+  /** An attribute leading to other objects. */
+  struct Attribute
+  {
+    std::string name;                       //!< The attribute name.
+    struct TypeId::AttributeInformation info; //!< The attribute found by name on the instance TypeId.
+    bool isPointer;                         //!< The attribute is a pointer.
+    bool isContainer;                       //!< The attribute is an object container.
+  };
+  /** Attribute list. */
+  typedef std::vector<Attribute> Attributes;
+
+  /**
+   * Get the attributes of a TypeId leading to other objects, in the
+   * order of the TypeId attributes then of the parent ones.
+   *
+   * \param [in] tid The TypeId.
+   * \returns The attributes.
+   */
+  static const Attributes & Get (TypeId tid);
+
+private:
+  /**
+   * Count the attributes of a TypeId and its parents.
+   *
+   * \param [in] tid The TypeId.
+   * \returns The number of attributes.
+   */
+  static uint32_t CountAttributes (TypeId tid);
+
+  bool m_built;            //!< The list was built.
+  uint32_t m_nAttributes;  //!< The attribute count the list was built from.
+  Attributes m_attributes; //!< The attributes leading to other objects.
+};
+
+uint32_t
+PathAttributes::CountAttributes (TypeId tid)
+{
+  uint32_t n = 0;
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      n += tid.GetAttributeN ();
+      nextTid = tid.GetParent ();
+    }
+  while (nextTid != tid);
+  return n;
+}
+
+const PathAttributes::Attributes &
+PathAttributes::Get (TypeId tid)
+{
+  NS_LOG_FUNCTION (tid);
+  // References to the elements of an unordered_map stay valid when it
+  // grows, which the recursive resolution relies upon.
+  static std::unordered_map<uint16_t, PathAttributes> cache;
+  PathAttributes &entry = cache[tid.GetUid ()];
+  // Attributes are normally all added when the TypeId is registered,
+  // the count only guards against late additions.  Most TypeIds have
+  // no attribute leading to other objects: an empty list is cached too.
+  uint32_t nAttributes = CountAttributes (tid);
+  if (entry.m_built && entry.m_nAttributes == nAttributes)
+    {
+      return entry.m_attributes;
+    }
+  entry.m_built = true;
+  entry.m_nAttributes = nAttributes;
+  entry.m_attributes.clear ();
+  TypeId instanceTid = tid;
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          Attribute attribute;
+          attribute.isPointer = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0;
+          attribute.isContainer = dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0;
+          if (!attribute.isPointer && !attribute.isContainer)
+            {
+              continue;
+            }
+          attribute.name = info.name;
+          instanceTid.LookupAttributeByName (info.name, &attribute.info);
+          entry.m_attributes.push_back (attribute);
+        }
+      nextTid = tid.GetParent ();
+    }
+  while (nextTid != tid);
+  return entry.m_attributes;
+}
+
 /**
  * \ingroup config-impl
  * Abstract class to parse Config paths into object references.
@@ -325,18 +525,27 @@ private:
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] level The index of the next element of the Config path.
    * \param [in] root The object corresponding to the current position
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (std::size_t level, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
+   * \param [in] level The index of the next element of the Config path.
    * \param [in,out] vector The resulting list of matching objects.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (std::size_t level, const ObjectPtrContainerValue &vector);
+  /**
+   * Get the value of an attribute leading to other objects.
+   *
+   * \param [in] root The object.
+   * \param [in] attribute The attribute.
+   * \param [out] value The attribute value.
+   */
+  void GetAttribute (Ptr<Object> root, const PathAttributes::Attribute &attribute,
+                     AttributeValue &value) const;
   /**
    * Handle one object found on the path.
    *
@@ -361,6 +570,8 @@ private:
   std::vector<std::string> m_workStack;
   /** The Config path. */
   std::string m_path;
+  /** The parsed Config path. */
+  Ptr<const ConfigPath> m_parsed;
 
 };  // class Resolver
 
@@ -369,6 +580,7 @@ Resolver::Resolver (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
   Canonicalize ();
+  m_parsed = ConfigPath::Get (m_path);
 }
 Resolver::~Resolver ()
 {
@@ -399,7 +611,7 @@ Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -425,13 +637,27 @@ Resolver::DoResolveOne (Ptr<Object> object)
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::GetAttribute (Ptr<Object> root, const PathAttributes::Attribute &attribute,
+                        AttributeValue &value) const
+{
+  NS_LOG_FUNCTION (this << root << attribute.name << &value);
+  if ((attribute.info.flags & TypeId::ATTR_GET)
+      && attribute.info.accessor->HasGetter ()
+      && attribute.info.accessor->Get (PeekPointer (root), value))
+    {
+      return;
+    }
+  // Report the errors as usual.
+  root->GetAttribute (attribute.name, value);
+}
+
+void
+Resolver::DoResolve (std::size_t level, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << level << root);
+  const std::vector<ConfigPath::Element> &elements = m_parsed->m_elements;
 
-  if (next == std::string::npos)
+  if (level == elements.size ())
     {
       //
       // If root is zero, we're beginning to see if we can use the object name
@@ -447,8 +673,8 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
         }
       return;
     }
-  std::string item = path.substr (1, next - 1);
-  std::string pathLeft = path.substr (next, path.size () - next);
+  const ConfigPath::Element &element = elements[level];
+  const std::string &item = element.item;
 
   //
   // If root is zero, we're beginning to see if we can use the object name
@@ -459,11 +685,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (item.compare (0, 5, "Names") == 0)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (level + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -480,7 +705,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (level + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -496,82 +721,65 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       return;
     }
-  std::string::size_type dollarPos = item.find ("$");
-  if (dollarPos == 0)
+  if (element.isGetObject)
     {
       // This is a call to GetObject
-      std::string tidString = item.substr (1, item.size () - 1);
-      NS_LOG_DEBUG ("GetObject=" << tidString << " on path=" << GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
+      NS_LOG_DEBUG ("GetObject=" << item << " on path=" << GetResolvedPath ());
+      // An unknown TypeId is a fatal error, raised here as before.
+      TypeId tid = element.hasTid ? element.tid : TypeId::LookupByName (item.substr (1));
       Ptr<Object> object = root->GetObject<Object> (tid);
       if (object == 0)
         {
-          NS_LOG_DEBUG ("GetObject (" << tidString << ") failed on path=" << GetResolvedPath ());
+          NS_LOG_DEBUG ("GetObject (" << item << ") failed on path=" << GetResolvedPath ());
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (level + 1, object);
       m_workStack.pop_back ();
     }
   else
     {
-      // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
+      // this is a normal attribute: only pointers and object containers
+      // lead further down the path.
+      const PathAttributes::Attributes &attributes = PathAttributes::Get (root->GetInstanceTypeId ());
       bool foundMatch = false;
 
-      do
+      for (PathAttributes::Attributes::const_iterator i = attributes.begin (); i != attributes.end (); ++i)
         {
-          tid = nextTid;
-
-          for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+          const PathAttributes::Attribute &attribute = *i;
+          if (attribute.name != item && item != "*")
+            {
+              continue;
+            }
+          if (attribute.isPointer)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute (i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)=" << attribute.name << " on path=" << GetResolvedPath ());
+              PointerValue pValue;
+              GetAttribute (root, attribute, pValue);
+              Ptr<Object> object = pValue.Get<Object> ();
+              if (object == 0)
                 {
+                  NS_LOG_ERROR ("Requested object name=\"" << item <<
+                                "\" exists on path=\"" << GetResolvedPath () << "\""
+                                " but is null.");
                   continue;
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *pChecker = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (pChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)=" << info.name << " on path=" << GetResolvedPath ());
-                  PointerValue pValue;
-                  root->GetAttribute (info.name, pValue);
-                  Ptr<Object> object = pValue.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\"" << item <<
-                                    "\" exists on path=\"" << GetResolvedPath () << "\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker =
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)=" << info.name << " on path=" << GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              foundMatch = true;
+              m_workStack.push_back (attribute.name);
+              DoResolve (level + 1, object);
+              m_workStack.pop_back ();
+            }
+          if (attribute.isContainer)
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)=" << attribute.name << " on path=" << GetResolvedPath ());
+              foundMatch = true;
+              ObjectPtrContainerValue vector;
+              GetAttribute (root, attribute, vector);
+              m_workStack.push_back (attribute.name);
+              DoArrayResolve (level + 1, vector);
+              m_workStack.pop_back ();
             }
-
-          nextTid = tid.GetParent ();
         }
-      while (nextTid != tid);
 
       if (!foundMatch)
         {
@@ -582,20 +790,15 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (std::size_t level, const ObjectPtrContainerValue &container)
 {
-  NS_LOG_FUNCTION (this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION (this << level << &container);
+  if (level == m_parsed->m_elements.size ())
     {
       return;
     }
-  std::string item = path.substr (1, next - 1);
-  std::string pathLeft = path.substr (next, path.size () - next);
 
-  ArrayMatcher matcher = ArrayMatcher (item);
+  const ArrayMatcher &matcher = m_parsed->m_elements[level].matcher;
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
@@ -604,7 +807,7 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
           std::ostringstream oss;
           oss << (*it).first;
           m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
+          DoResolve (level + 1, (*it).second);
           m_workStack.pop_back ();
         }
     }
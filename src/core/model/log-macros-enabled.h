@@ -27,6 +27,8 @@
  * NS_LOG and related logging macro definitions.
  */
 
+#include <type_traits>
+
 
 // These two implementation macros
 //   NS_LOG_APPEND_TIME_PREFIX_IMPL
@@ -165,6 +167,21 @@
 #define NS_LOG_CONDITION
 #endif
 
+/**
+ * \ingroup logging
+ * Check if \c level is compiled into the current log component.
+ *
+ * This is a constant expression, so the logging statements it guards
+ * are compiled out for the levels excluded by the
+ * \c --log-static-levels configure option.
+ *
+ * \param [in] level The log level.
+ * \internal
+ * Logging implementation macro; should not be called directly.
+ */
+#define NS_LOG_STATIC_ENABLED(level)                            \
+  (std::remove_reference<decltype (g_log)>::type::IsStaticallyEnabled (level))
+
 /**
  * \ingroup logging
  *
@@ -187,7 +204,8 @@
 #define NS_LOG(level, msg)                                      \
   NS_LOG_CONDITION                                              \
   do {                                                          \
-      if (g_log.IsEnabled (level))                              \
+      if (NS_LOG_STATIC_ENABLED (level)                         \
+          && g_log.IsEnabled (level))                           \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
@@ -209,7 +227,8 @@
 #define NS_LOG_FUNCTION_NOARGS()                                \
   NS_LOG_CONDITION                                              \
   do {                                                          \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if (NS_LOG_STATIC_ENABLED (ns3::LOG_FUNCTION)             \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))               \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
@@ -245,7 +264,8 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if (NS_LOG_STATIC_ENABLED (ns3::LOG_FUNCTION)             \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))               \
         {                                                       \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
@@ -27,6 +27,8 @@
 #include <map>
 #include <vector>
 
+#include "ns3/core-config.h"
+
 #include "node-printer.h"
 #include "time-printer.h"
 #include "log-macros-enabled.h"
@@ -203,7 +205,8 @@ void LogComponentDisableAll (enum LogLevel level);
  * \param [in] name The log component name.
  */
 #define NS_LOG_COMPONENT_DEFINE(name)                           \
-  static ns3::LogComponent g_log = ns3::LogComponent (name, __FILE__)
+  static ns3::StaticLogComponent<ns3::LogStaticMask (name)>    \
+  g_log (name, __FILE__)
 
 /**
  * Define a logging component with a mask.
@@ -214,7 +217,8 @@ void LogComponentDisableAll (enum LogLevel level);
  * \param [in] mask The default mask.
  */
 #define NS_LOG_COMPONENT_DEFINE_MASK(name, mask)                \
-  static ns3::LogComponent g_log = ns3::LogComponent (name, __FILE__, mask)
+  static ns3::StaticLogComponent<ns3::LogStaticMask (name)>    \
+  g_log (name, __FILE__, mask)
 
 /**
  * Declare a reference to a Log component.
@@ -355,6 +359,20 @@ public:
    * \return \c true if we are enabled at \c level.
    */
   bool IsEnabled (const enum LogLevel level) const;
+  /**
+   * Check if \c level can be enabled at all in this build.
+   *
+   * Components defined with NS_LOG_COMPONENT_DEFINE hide this with
+   * the levels selected by the \c --log-static-levels configure option;
+   * the base class, used by template classes, keeps every level.
+   *
+   * \param [in] level The level to check for.
+   * \return \c true if \c level is compiled in.
+   */
+  static constexpr bool IsStaticallyEnabled (const uint32_t /* level */)
+  {
+    return true;
+  }
   /**
    * Check if all levels are disabled.
    *
@@ -434,6 +452,125 @@ private:
 
 };  // class LogComponent
 
+/**
+ * Compile-time log levels of a component.
+ *
+ * The configure option
+ * \c --log-static-levels="Component=level,...,*=level" bounds the levels
+ * compiled into each component: the NS_LOG macros test
+ * IsStaticallyEnabled() first, a constant expression, so statically
+ * disabled levels are compiled out while the remaining levels keep
+ * being enabled and disabled at run time.
+ *
+ * \tparam MASK The LogLevels compiled in, see LogStaticMask().
+ */
+template <uint32_t MASK>
+class StaticLogComponent : public LogComponent
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] name The user-visible name for this component.
+   * \param [in] file The source code file which defined this LogComponent.
+   * \param [in] mask LogLevels blocked for this LogComponent.
+   */
+  StaticLogComponent (const std::string & name,
+                      const std::string & file,
+                      const enum LogLevel mask = LOG_NONE)
+    : LogComponent (name, file, mask)
+  {}
+  /**
+   * Check if \c level can be enabled at all in this build.
+   *
+   * \param [in] level The level to check for.
+   * \return \c true if \c level is in \p MASK.
+   */
+  static constexpr bool IsStaticallyEnabled (const uint32_t level)
+  {
+    return (level & MASK) != 0;
+  }
+  /**
+   * Check if this LogComponent is enabled for \c level
+   *
+   * \param [in] level The level to check for.
+   * \return \c true if we are enabled at \c level.
+   */
+  bool IsEnabled (const enum LogLevel level) const
+  {
+    return IsStaticallyEnabled (level) && LogComponent::IsEnabled (level);
+  }
+};  // class StaticLogComponent
+
+/**
+ * \ingroup logging
+ * Compile-time log level of a component, as a (name, LogLevel) pair.
+ */
+struct LogStaticLevel
+{
+  const char * name;  //!< Component name, or \c "*" for all others.
+  uint32_t levels;    //!< LogLevels compiled in.
+};
+
+/**
+ * Component levels selected by \c --log-static-levels,
+ * terminated by a null name.
+ */
+constexpr LogStaticLevel g_logStaticLevels[] = {
+#ifdef NS3_LOG_STATIC_LEVELS
+  NS3_LOG_STATIC_LEVELS,
+#endif
+  { 0, LOG_ALL }
+};
+
+/**
+ * Compare two strings at compile time.
+ *
+ * \param [in] a The first string.
+ * \param [in] b The second string.
+ * \return \c true if the strings are equal.
+ */
+constexpr bool
+LogStaticNameEqual (const char * a, const char * b)
+{
+  return *a == *b && (*a == '\0' || LogStaticNameEqual (a + 1, b + 1));
+}
+
+/**
+ * Find the default (\c "*") entry of g_logStaticLevels.
+ *
+ * \param [in] i The entry to start from.
+ * \return The LogLevels compiled into components without their own entry.
+ */
+constexpr uint32_t
+LogStaticDefault (const uint32_t i = 0)
+{
+  return g_logStaticLevels[i].name == 0
+         ? g_logStaticLevels[i].levels
+         : LogStaticNameEqual (g_logStaticLevels[i].name, "*")
+         ? g_logStaticLevels[i].levels
+         : LogStaticDefault (i + 1);
+}
+
+/**
+ * Get the LogLevels compiled into a component.
+ *
+ * Prefix flags are always kept.
+ *
+ * \param [in] name The name of the LogComponent.
+ * \param [in] i The entry of g_logStaticLevels to start from.
+ * \return The LogLevels compiled into \c name.
+ */
+constexpr uint32_t
+LogStaticMask (const char * name, const uint32_t i = 0)
+{
+  return g_logStaticLevels[i].name == 0
+         ? (LogStaticDefault () | LOG_PREFIX_ALL)
+         : LogStaticNameEqual (g_logStaticLevels[i].name, name)
+         ? (g_logStaticLevels[i].levels | LOG_PREFIX_ALL)
+         : LogStaticMask (name, i + 1);
+}
+
 /**
  * Get the LogComponent registered with the given name.
  *
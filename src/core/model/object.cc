@@ -27,6 +27,7 @@
 #include "string.h"
 #include <vector>
 #include <sstream>
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 
@@ -46,6 +47,25 @@ NS_LOG_COMPONENT_DEFINE ("Object");
 
 NS_OBJECT_ENSURE_REGISTERED (Object);
 
+/**
+ * The results of the recent DoGetObject lookups on a list of
+ * aggregates: a small set-associative table indexed by TypeId uid.
+ * A cached null object records that no aggregate has the TypeId.
+ */
+struct Object::AggregatesCache
+{
+  /** Table dimensions. */
+  enum
+  {
+    SETS = 16, //!< Number of sets, a power of 2.
+    WAYS = 2   //!< Number of entries in each set.
+  };
+  /** The uid of the TypeId of each entry, 0 if the entry is empty. */
+  uint16_t uid[SETS][WAYS];
+  /** The object found for each entry. */
+  Object *object[SETS][WAYS];
+};
+
 Object::AggregateIterator::AggregateIterator ()
   : m_object (0),
     m_current (0)
@@ -102,6 +122,7 @@ Object::Object ()
 {
   NS_LOG_FUNCTION (this);
   m_aggregates->n = 1;
+  m_aggregates->cache = 0;
   m_aggregates->buffer[0] = this;
 }
 Object::~Object ()
@@ -120,10 +141,16 @@ Object::~Object ()
           m_aggregates->n--;
         }
     }
+  // the cached lookups may refer to this object
+  if (m_aggregates->cache != 0)
+    {
+      std::memset (m_aggregates->cache->uid, 0, sizeof (m_aggregates->cache->uid));
+    }
   // finally, if all objects have been removed from the list,
   // delete the aggregate list
   if (m_aggregates->n == 0)
     {
+      std::free (m_aggregates->cache);
       std::free (m_aggregates);
     }
   m_aggregates = 0;
@@ -136,6 +163,7 @@ Object::Object (const Object &o)
     m_getObjectCount (0)
 {
   m_aggregates->n = 1;
+  m_aggregates->cache = 0;
   m_aggregates->buffer[0] = this;
 }
 void
@@ -147,6 +175,71 @@ Object::Construct (const AttributeConstructionList &attributes)
 
 Ptr<Object>
 Object::DoGetObject (TypeId tid) const
+{
+  NS_LOG_FUNCTION (this << tid);
+
+  struct AggregatesCache *cache = m_aggregates->cache;
+  if (cache == 0)
+    {
+      cache = (struct AggregatesCache *) std::calloc (1, sizeof (struct AggregatesCache));
+      m_aggregates->cache = cache;
+    }
+  uint16_t uid = tid.GetUid ();
+  uint16_t *uids = cache->uid[uid & (AggregatesCache::SETS - 1)];
+  Object **objects = cache->object[uid & (AggregatesCache::SETS - 1)];
+  Object *found;
+  if (uids[0] == uid)
+    {
+      found = objects[0];
+    }
+  else if (uids[1] == uid)
+    {
+      // keep the most recently used entry first
+      std::swap (uids[0], uids[1]);
+      std::swap (objects[0], objects[1]);
+      found = objects[0];
+    }
+  else
+    {
+      found = FindObject (tid);
+      uids[1] = uids[0];
+      objects[1] = objects[0];
+      uids[0] = uid;
+      objects[0] = found;
+    }
+  if (found != 0)
+    {
+      UpdateFirstAggregate (found);
+    }
+  return found;
+}
+void
+Object::UpdateFirstAggregate (Object *found) const
+{
+  NS_LOG_FUNCTION (this << found);
+  found->m_getObjectCount++;
+  Object *first = m_aggregates->buffer[0];
+  // The first Object is found by the dynamic_cast of GetObject, which
+  // does not count, so only replace it when found is clearly more popular:
+  // the Objects looked up in turn do not take the first place in turn.
+  if (found == first || found->m_getObjectCount / 2 <= first->m_getObjectCount)
+    {
+      return;
+    }
+  // The cache refers to the Objects, not to their place in the aggregates.
+  uint32_t n = m_aggregates->n;
+  for (uint32_t i = 1; i < n; i++)
+    {
+      if (m_aggregates->buffer[i] == found)
+        {
+          m_aggregates->buffer[i] = first;
+          m_aggregates->buffer[0] = found;
+          return;
+        }
+    }
+}
+Object *
+Object::FindObject (TypeId tid) const
 {
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (CheckLoose ());
@@ -163,18 +256,7 @@ Object::DoGetObject (TypeId tid) const
         }
       if (cur == tid)
         {
-          // This is an attempt to 'cache' the result of this lookup.
-          // the idea is that if we perform a lookup for a TypeId on this object,
-          // we are likely to perform the same lookup later so, we make sure
-          // that the aggregate array is sorted by the number of accesses
-          // to each object.
-
-          // first, increment the access count
-          current->m_getObjectCount++;
-          // then, update the sort
-          UpdateSortedArray (m_aggregates, i);
-          // finally, return the match
-          return const_cast<Object *> (current);
+          return current;
         }
     }
   return 0;
@@ -236,19 +318,6 @@ restart:
     }
 }
 void
-Object::UpdateSortedArray (struct Aggregates *aggregates, uint32_t j) const
-{
-  NS_LOG_FUNCTION (this << aggregates << j);
-  while (j > 0
-         && aggregates->buffer[j]->m_getObjectCount > aggregates->buffer[j - 1]->m_getObjectCount)
-    {
-      Object *tmp = aggregates->buffer[j - 1];
-      aggregates->buffer[j - 1] = aggregates->buffer[j];
-      aggregates->buffer[j] = tmp;
-      j--;
-    }
-}
-void
 Object::AggregateObject (Ptr<Object> o)
 {
   NS_LOG_FUNCTION (this << o);
@@ -263,6 +332,7 @@ Object::AggregateObject (Ptr<Object> o)
   struct Aggregates *aggregates =
     (struct Aggregates *)std::malloc (sizeof(struct Aggregates) + (total - 1) * sizeof(Object*));
   aggregates->n = total;
+  aggregates->cache = 0;
 
   // copy our buffer to the new buffer
   std::memcpy (&aggregates->buffer[0],
@@ -274,14 +344,13 @@ Object::AggregateObject (Ptr<Object> o)
     {
       aggregates->buffer[m_aggregates->n + i] = other->m_aggregates->buffer[i];
       const TypeId typeId = other->m_aggregates->buffer[i]->GetInstanceTypeId ();
-      if (DoGetObject (typeId))
+      if (FindObject (typeId))
         {
           NS_FATAL_ERROR ("Object::AggregateObject(): "
                           "Multiple aggregation of objects of type " <<
                           other->GetInstanceTypeId () <<
                           " on objects of type " << typeId);
         }
-      UpdateSortedArray (aggregates, m_aggregates->n + i);
     }
 
   // keep track of the old aggregate buffers for the iteration
@@ -314,7 +383,9 @@ Object::AggregateObject (Ptr<Object> o)
     }
 
   // Now that we are done with them, we can free our old aggregate buffers
+  std::free (a->cache);
   std::free (a);
+  std::free (b->cache);
   std::free (b);
 }
 /**
@@ -330,6 +330,9 @@ private:
   friend struct ObjectDeleter;
   /**@}*/
 
+  /** The results of the GetObject lookups on a list of aggregates. */
+  struct AggregatesCache;
+
   /**
    * The list of Objects aggregated to this one.
    *
@@ -346,6 +349,12 @@ private:
   {
     /** The number of entries in \c buffer. */
     uint32_t n;
+    /**
+     * The results of the recent lookups, allocated on first use.
+     * It is updated by the const DoGetObject of all the aggregated
+     * Objects, without synchronization: it is not thread-safe.
+     */
+    struct AggregatesCache *cache;
     /** The array of Objects. */
     Object *buffer[1];
   };
@@ -353,10 +362,33 @@ private:
   /**
    * Find an Object of TypeId tid in the aggregates of this Object.
    *
+   * The result is cached with the aggregates: the set of aggregates
+   * only changes when objects are aggregated, which allocates a new
+   * list, and when an object is deleted, which clears the cache.
+   * Although this method is const, it updates the cache and the order
+   * of the aggregates, which are shared by all the aggregated Objects
+   * and not synchronized: two threads must not look up the aggregates
+   * of the same Objects concurrently.
+   *
    * \param [in] tid The TypeId we're looking for
    * \return The matching Object, if it is found
    */
   Ptr<Object> DoGetObject (TypeId tid) const;
+  /**
+   * Search the aggregates of this Object for an Object of TypeId tid.
+   *
+   * \param [in] tid The TypeId we're looking for
+   * \return The matching Object, if it is found
+   */
+  Object * FindObject (TypeId tid) const;
+  /**
+   * Count a lookup which found an aggregated Object, and move that
+   * Object first in the aggregates once it is looked up much more often
+   * than the first one, so that the dynamic_cast of GetObject() finds it.
+   *
+   * \param [in] found The aggregated Object found by a lookup.
+   */
+  void UpdateFirstAggregate (Object *found) const;
   /**
    * Verify that this Object is still live, by checking it's reference count.
    * \return \c true if the reference count is non zero.
@@ -397,13 +429,6 @@ private:
   */
   void Construct (const AttributeConstructionList &attributes);
 
-  /**
-   * Keep the list of aggregates in most-recently-used order
-   *
-   * \param [in,out] aggregates The list of aggregated Objects.
-   * \param [in] i The most recently used entry in the list.
-   */
-  void UpdateSortedArray (struct Aggregates *aggregates, uint32_t i) const;
   /**
    * Attempt to delete this Object.
    *
@@ -436,11 +461,11 @@ private:
    */
   struct Aggregates * m_aggregates;
   /**
-   * The number of times the Object was accessed with a
-   * call to GetObject().
+   * The number of times the Object was found by a call to
+   * DoGetObject().
    *
-   * This integer is used to implement a heuristic to sort
-   * the array of aggregates in most-frequently accessed order.
+   * This integer is used to implement a heuristic to keep
+   * the most frequently accessed Object first in the aggregates.
    */
   uint32_t m_getObjectCount;
 };
@@ -476,7 +501,7 @@ Object::GetObject () const
     {
       return Ptr<T> (result);
     }
-  // if the cast does not work, we try to do a full type check.
+  // if the cast does not work, we look the TypeId up in the cache.
   Ptr<Object> found = DoGetObject (T::GetTypeId ());
   if (found != 0)
     {
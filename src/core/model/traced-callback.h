@@ -89,6 +89,15 @@ public:
    * \param [in] args The arguments to the functor
    */
   void operator() (Ts... args) const;
+  /**
+   * Checks if the Callbacks list is empty.
+   *
+   * Models can skip the work needed only to fire a trace nobody
+   * listens to.
+   *
+   * \return \c true if the Callbacks list is empty.
+   */
+  bool IsEmpty (void) const;
 
   /**
    *  TracedCallback signature for POD.
@@ -126,6 +135,12 @@ TracedCallback<Ts...>::TracedCallback ()
   : m_callbackList ()
 {}
 template<typename... Ts>
+bool
+TracedCallback<Ts...>::IsEmpty (void) const
+{
+  return m_callbackList.empty ();
+}
+template<typename... Ts>
 void
 TracedCallback<Ts...>::ConnectWithoutContext (const CallbackBase & callback)
 {
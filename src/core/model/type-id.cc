@@ -23,7 +23,9 @@
 #include "singleton.h"
 #include "trace-source-accessor.h"
 
+#include <deque>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <sstream>
 #include <iomanip>
@@ -78,6 +80,8 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
 class IidManager : public Singleton<IidManager>
 {
 public:
+  /** Constructor. */
+  IidManager ();
   /**
    * Create a new unique type id.
    * \param [in] name The name of this type id.
@@ -226,9 +230,20 @@ public:
    * Get Attribute information by index.
    * \param [in] uid The id.
    * \param [in] i Index into attribute array
-   * \returns The information associated to attribute whose index is \pname{i}.
+   * \returns The information associated to attribute whose index is \pname{i},
+   *          valid until the next attribute is added to this type id.
    */
-  struct TypeId::AttributeInformation GetAttribute (uint16_t uid, std::size_t i) const;
+  const struct TypeId::AttributeInformation & GetAttribute (uint16_t uid, std::size_t i) const;
+  /**
+   * Find an Attribute by name, on the type id or on its parents.
+   * \param [in] uid The id.
+   * \param [in] name The attribute name.
+   * \returns The information associated to the attribute, or \c 0
+   *          if the type id has no attribute called \pname{name}.
+   *          The information stays valid until the next attribute
+   *          is added to the type id which registered it.
+   */
+  const struct TypeId::AttributeInformation * LookupAttribute (uint16_t uid, std::string name) const;
   /**
    * Record a new TraceSource.
    * \param [in] uid The id.
@@ -314,6 +329,13 @@ private:
     bool mustHideFromDocumentation;
     /** The container of Attributes. */
     std::vector<struct TypeId::AttributeInformation> attributes;
+    /**
+     * The index of the Attributes by name, including the inherited ones:
+     * the type id of the attribute and its index in \c attributes.
+     */
+    std::unordered_map<std::string, std::pair<uint16_t, std::size_t> > attributeIndex;
+    /** The value of IidManager::m_attributeGeneration \c attributeIndex was built at. */
+    uint32_t attributeIndexGeneration;
     /** The container of TraceSources. */
     std::vector<struct TypeId::TraceSourceInformation> traceSources;
     /** Support level/deprecation. */
@@ -322,7 +344,7 @@ private:
     std::string supportMsg;
   };
   /** Iterator type. */
-  typedef std::vector<struct IidInformation>::const_iterator Iterator;
+  typedef std::deque<struct IidInformation>::const_iterator Iterator;
 
   /**
    * Retrieve the information record for a type.
@@ -331,19 +353,30 @@ private:
    */
   struct IidManager::IidInformation * LookupInformation (uint16_t uid) const;
 
-  /** The container of all type id records. */
-  std::vector<struct IidInformation> m_information;
+  /**
+   * The container of all type id records.
+   *
+   * A deque, so registering a type id does not move the records of the
+   * others: references to their attributes stay valid.
+   */
+  std::deque<struct IidInformation> m_information;
 
   /** Type of the by-name index. */
-  typedef std::map<std::string, uint16_t> namemap_t;
+  typedef std::unordered_map<std::string, uint16_t> namemap_t;
   /** The by-name index. */
   namemap_t m_namemap;
 
   /** Type of the by-hash index. */
-  typedef std::map<TypeId::hash_t, uint16_t> hashmap_t;
+  typedef std::unordered_map<TypeId::hash_t, uint16_t> hashmap_t;
   /** The by-hash index. */
   hashmap_t m_hashmap;
 
+  /**
+   * Incremented whenever an attribute or a parent is registered,
+   * which makes the attribute indexes out of date.
+   */
+  uint32_t m_attributeGeneration;
+
 
   /** IidManager constants. */
   enum
@@ -380,6 +413,12 @@ IidManager::Hasher (const std::string name)
  */
 #define IIDL IID << ": "
 
+IidManager::IidManager ()
+  : m_attributeGeneration (1)
+{
+  NS_LOG_FUNCTION (IID);
+}
+
 uint16_t
 IidManager::AllocateUid (std::string name)
 {
@@ -443,6 +482,7 @@ IidManager::AllocateUid (std::string name)
   information.hasConstructor = false;
   information.mustHideFromDocumentation = false;
   information.supportLevel = TypeId::SUPPORTED;
+  information.attributeIndexGeneration = 0;
   m_information.push_back (information);
   std::size_t tuid = m_information.size ();
   NS_ASSERT (tuid <= 0xffff);
@@ -471,6 +511,7 @@ IidManager::SetParent (uint16_t uid, uint16_t parent)
   NS_ASSERT (parent <= m_information.size ());
   struct IidInformation *information = LookupInformation (uid);
   information->parent = parent;
+  m_attributeGeneration++;
 }
 void
 IidManager::SetGroupName (uint16_t uid, std::string groupName)
@@ -681,6 +722,7 @@ IidManager::AddAttribute (uint16_t uid,
   info.supportLevel = supportLevel;
   info.supportMsg = supportMsg;
   information->attributes.push_back (info);
+  m_attributeGeneration++;
   NS_LOG_LOGIC (IIDL << information->attributes.size () - 1);
 }
 void
@@ -705,7 +747,7 @@ IidManager::GetAttributeN (uint16_t uid) const
   NS_LOG_LOGIC (IIDL << size);
   return size;
 }
-struct TypeId::AttributeInformation
+const struct TypeId::AttributeInformation &
 IidManager::GetAttribute (uint16_t uid, std::size_t i) const
 {
   NS_LOG_FUNCTION (IID << uid << i);
@@ -714,6 +756,44 @@ IidManager::GetAttribute (uint16_t uid, std::size_t i) const
   NS_LOG_LOGIC (IIDL << information->name);
   return information->attributes[i];
 }
+const struct TypeId::AttributeInformation *
+IidManager::LookupAttribute (uint16_t uid, std::string name) const
+{
+  NS_LOG_FUNCTION (IID << uid << name);
+  struct IidInformation *information = LookupInformation (uid);
+  if (information->attributeIndexGeneration != m_attributeGeneration)
+    {
+      // Index the attributes of the type id, then those of its parents,
+      // keeping the first attribute found for each name.
+      information->attributeIndex.clear ();
+      struct IidInformation *current = information;
+      uint16_t currentUid = uid;
+      while (true)
+        {
+          for (std::size_t i = 0; i < current->attributes.size (); i++)
+            {
+              information->attributeIndex.insert (std::make_pair (current->attributes[i].name,
+                                                                  std::make_pair (currentUid, i)));
+            }
+          if (current->parent == currentUid)
+            {
+              // top of inheritance tree
+              break;
+            }
+          currentUid = current->parent;
+          current = LookupInformation (currentUid);
+        }
+      information->attributeIndexGeneration = m_attributeGeneration;
+    }
+  std::unordered_map<std::string, std::pair<uint16_t, std::size_t> >::const_iterator it =
+    information->attributeIndex.find (name);
+  if (it == information->attributeIndex.end ())
+    {
+      NS_LOG_LOGIC (IIDL << "not found");
+      return 0;
+    }
+  return &LookupInformation (it->second.first)->attributes[it->second.second];
+}
 
 bool
 IidManager::HasTraceSource (uint16_t uid,
@@ -883,39 +963,30 @@ bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
 {
   NS_LOG_FUNCTION (this << name << info);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do
+  const struct TypeId::AttributeInformation *tmp =
+    IidManager::Get ()->LookupAttribute (m_tid, name);
+  if (tmp == 0)
     {
-      tid = nextTid;
-      for (std::size_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute (i);
-          if (tmp.name == name)
-            {
-              if (tmp.supportLevel == TypeId::SUPPORTED)
-                {
-                  *info = tmp;
-                  return true;
-                }
-              else if (tmp.supportLevel == TypeId::DEPRECATED)
-                {
-                  std::cerr << "Attribute '" << name << "' is deprecated: "
-                            << tmp.supportMsg << std::endl;
-                  *info = tmp;
-                  return true;
-                }
-              else if (tmp.supportLevel == TypeId::OBSOLETE)
-                {
-                  NS_FATAL_ERROR ("Attribute '" << name <<
-                                  "' is obsolete, with no fallback: " <<
-                                  tmp.supportMsg);
-                }
-            }
-        }
-      nextTid = tid.GetParent ();
+      return false;
+    }
+  if (tmp->supportLevel == TypeId::SUPPORTED)
+    {
+      *info = *tmp;
+      return true;
+    }
+  else if (tmp->supportLevel == TypeId::DEPRECATED)
+    {
+      std::cerr << "Attribute '" << name << "' is deprecated: "
+                << tmp->supportMsg << std::endl;
+      *info = *tmp;
+      return true;
+    }
+  else if (tmp->supportLevel == TypeId::OBSOLETE)
+    {
+      NS_FATAL_ERROR ("Attribute '" << name <<
+                      "' is obsolete, with no fallback: " <<
+                      tmp->supportMsg);
     }
-  while (nextTid != tid);
   return false;
 }
 
@@ -1080,7 +1151,7 @@ TypeId::GetAttributeN (void) const
   std::size_t n = IidManager::Get ()->GetAttributeN (m_tid);
   return n;
 }
-struct TypeId::AttributeInformation
+const struct TypeId::AttributeInformation &
 TypeId::GetAttribute (std::size_t i) const
 {
   NS_LOG_FUNCTION (this << i);
@@ -255,9 +255,11 @@ public:
    * Get Attribute information by index.
    *
    * \param [in] i Index into attribute array
-   * \returns The information associated to attribute whose index is \pname{i}.
+   * \returns The information associated to attribute whose index is \pname{i},
+   *          valid until the next attribute is added to this TypeId.
+   *          Registering other TypeIds does not invalidate it.
    */
-  struct TypeId::AttributeInformation GetAttribute (std::size_t i) const;
+  const struct TypeId::AttributeInformation & GetAttribute (std::size_t i) const;
   /**
    * Get the Attribute name by index.
    *
@@ -840,6 +840,75 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test that repeated resolutions of the same paths follow the changes
+ * of the object tree.
+ */
+class RepeatedResolutionConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  RepeatedResolutionConfigTestCase ();
+  /** Destructor. */
+  virtual ~RepeatedResolutionConfigTestCase ()
+  {}
+
+private:
+  virtual void DoRun (void);
+};
+
+RepeatedResolutionConfigTestCase::RepeatedResolutionConfigTestCase ()
+  : TestCase ("Check that repeated resolutions of a path follow the object tree")
+{}
+
+void
+RepeatedResolutionConfigTestCase::DoRun (void)
+{
+  //
+  // Reach the objects through the name service, so that the objects
+  // registered by the other test cases do not match.
+  //
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Names::Add ("ConfigResolutionRoot", root);
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      root->AddNodeA (CreateObject<ConfigTestObject> ());
+    }
+
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/Names/ConfigResolutionRoot/NodesA/[1-2]|4").GetN (),
+                             3, "Wrong number of matches for ranges");
+      NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/Names/ConfigResolutionRoot/NodesA/*").GetN (),
+                             6, "Wrong number of matches for a wildcard index");
+      NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/Names/ConfigResolutionRoot/NodesA/[2-x]").GetN (),
+                             0, "Unexpected matches for an invalid range");
+      NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/Names/ConfigResolutionRoot/*/5").GetN (),
+                             1, "Wrong number of matches for a wildcard attribute");
+    }
+
+  //
+  // The same paths see the objects added since.
+  //
+  root->AddNodeA (CreateObject<ConfigTestObject> ());
+  root->AddNodeB (CreateObject<ConfigTestObject> ());
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/Names/ConfigResolutionRoot/NodesA/*").GetN (),
+                         7, "Added object not matched");
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/Names/ConfigResolutionRoot/*/0").GetN (),
+                         2, "Added object not matched through a wildcard attribute");
+
+  NS_TEST_ASSERT_MSG_EQ (Config::LookupMatches ("/Names/ConfigResolutionRoot/NodeA").GetN (),
+                         0, "Null pointer matched");
+  Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+  root->SetNodeA (a);
+  Config::MatchContainer matches = Config::LookupMatches ("/Names/ConfigResolutionRoot/NodeA");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "Pointer not matched");
+  NS_TEST_ASSERT_MSG_EQ (matches.Get (0), a, "Wrong object matched");
+
+  Names::Clear ();
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -858,6 +927,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new RepeatedResolutionConfigTestCase);
 }
 
 /**
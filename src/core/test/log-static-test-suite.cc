@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup logging
+ * \ingroup log-static-tests
+ * Compile-time log levels test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup log-static-tests Compile-time log levels test suite
+ */
+
+namespace ns3 {
+
+namespace tests {
+
+namespace logstatic {
+
+/**
+ * \ingroup log-static-tests
+ * Log component limited to warnings at compile time.
+ */
+static StaticLogComponent<LOG_LEVEL_WARN | LOG_PREFIX_ALL>
+g_log ("LogStaticTestComponent", __FILE__);
+
+/**
+ * \ingroup log-static-tests
+ * Count the evaluations of logged expressions.
+ */
+static int g_evaluations = 0;
+
+/**
+ * \ingroup log-static-tests
+ * Log expression with a side effect.
+ * \returns The number of evaluations so far.
+ */
+static int
+Evaluate (void)
+{
+  return ++g_evaluations;
+}
+
+/**
+ * \ingroup log-static-tests
+ * Log one message per level of g_log.
+ */
+static void
+LogAllLevels (void)
+{
+  NS_LOG_FUNCTION (Evaluate ());
+  NS_LOG_LOGIC ("logic " << Evaluate ());
+  NS_LOG_INFO ("info " << Evaluate ());
+  NS_LOG_DEBUG ("debug " << Evaluate ());
+  NS_LOG_WARN ("warn " << Evaluate ());
+}
+
+}  // namespace logstatic
+
+
+/**
+ * \ingroup log-static-tests
+ * Compile-time log levels test
+ */
+class LogStaticTestCase : public TestCase
+{
+public:
+  LogStaticTestCase ();
+  virtual ~LogStaticTestCase ()
+  {}
+
+private:
+  virtual void DoRun (void);
+};
+
+LogStaticTestCase::LogStaticTestCase (void)
+  : TestCase ("Check compile-time log levels")
+{}
+
+void
+LogStaticTestCase::DoRun (void)
+{
+  static_assert (LogStaticNameEqual ("Foo", "Foo"), "equal names differ");
+  static_assert (!LogStaticNameEqual ("Foo", "Foobar"), "prefix matches");
+  static_assert (!LogStaticNameEqual ("Foobar", "Foo"), "prefix matches");
+  static_assert (LogStaticMask ("LogStaticTestComponent") & LOG_PREFIX_ALL,
+                 "prefixes are compiled out");
+
+#ifndef NS3_LOG_STATIC_LEVELS
+  NS_TEST_ASSERT_MSG_EQ (LogStaticMask ("LogStaticTestComponent"),
+                         static_cast<uint32_t> (LOG_ALL | LOG_PREFIX_ALL),
+                         "levels compiled out by default");
+#endif
+
+  using logstatic::g_log;
+  g_log.Enable (LOG_LEVEL_ALL);
+  NS_TEST_ASSERT_MSG_EQ (g_log.IsEnabled (LOG_WARN), true,
+                         "warnings compiled out");
+  NS_TEST_ASSERT_MSG_EQ (g_log.IsEnabled (LOG_INFO), false,
+                         "info enabled beyond the static level");
+  NS_TEST_ASSERT_MSG_EQ (g_log.LogComponent::IsEnabled (LOG_INFO), true,
+                         "info not enabled at run time");
+
+  // Capture the log messages, and restore std::clog before checking them
+  std::ostringstream enabledLog;
+  std::ostringstream disabledLog;
+  std::streambuf *clogBuf = std::clog.rdbuf (enabledLog.rdbuf ());
+  logstatic::LogAllLevels ();
+  int evaluations = logstatic::g_evaluations;
+  g_log.Disable (LOG_LEVEL_ALL);
+  std::clog.rdbuf (disabledLog.rdbuf ());
+  logstatic::LogAllLevels ();
+  std::clog.rdbuf (clogBuf);
+
+#ifdef NS3_LOG_ENABLE
+  NS_TEST_ASSERT_MSG_EQ (evaluations, 1,
+                         "statically disabled log statements were evaluated");
+  NS_TEST_ASSERT_MSG_NE (enabledLog.str ().find ("warn 1"), std::string::npos,
+                         "warning not logged");
+  NS_TEST_ASSERT_MSG_EQ (enabledLog.str ().find ("info"), std::string::npos,
+                         "info logged beyond the static level");
+#else
+  NS_TEST_ASSERT_MSG_EQ (evaluations, 0,
+                         "log statements evaluated without logging");
+  NS_TEST_ASSERT_MSG_EQ (enabledLog.str (), "",
+                         "messages logged without logging");
+#endif
+
+  NS_TEST_ASSERT_MSG_EQ (g_log.IsEnabled (LOG_WARN), false,
+                         "warnings not disabled at run time");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (logstatic::g_evaluations, 1,
+                               "disabled log statements were evaluated");
+  NS_TEST_ASSERT_MSG_EQ (disabledLog.str (), "",
+                         "disabled log statements were logged");
+}
+
+/**
+ * \ingroup log-static-tests
+ * Compile-time log levels test suite
+ */
+class LogStaticTestSuite : public TestSuite
+{
+public:
+  LogStaticTestSuite ();
+};
+
+LogStaticTestSuite::LogStaticTestSuite ()
+  : TestSuite ("log-static")
+{
+  AddTestCase (new LogStaticTestCase);
+}
+
+/**
+ * \ingroup log-static-tests
+ * LogStaticTestSuite instance variable.
+ */
+static LogStaticTestSuite g_logStaticTestSuite;
+
+
+}    // namespace tests
+
+}  // namespace ns3
@@ -22,6 +22,7 @@
 #include "ns3/object.h"
 #include "ns3/object-factory.h"
 #include "ns3/assert.h"
+#include <vector>
 
 /**
  * \file
@@ -402,6 +403,96 @@ AggregateObjectTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_NE (baseA, 0, "Unable to GetObject on released object");
 }
 
+/**
+ * \ingroup object-tests
+ * Test the cached lookups of aggregated Objects.
+ */
+class AggregateLookupTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  AggregateLookupTestCase ();
+  /** Destructor. */
+  virtual ~AggregateLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Look up every registered TypeId on an aggregation.
+   * \param [in] object An Object of the aggregation.
+   * \param [in] aggregates The Objects of the aggregation.
+   */
+  void CheckLookups (Ptr<Object> object, std::vector<Ptr<Object> > aggregates);
+};
+
+AggregateLookupTestCase::AggregateLookupTestCase ()
+  : TestCase ("Check cached lookups of aggregated Objects")
+{}
+
+AggregateLookupTestCase::~AggregateLookupTestCase ()
+{}
+
+void
+AggregateLookupTestCase::CheckLookups (Ptr<Object> object, std::vector<Ptr<Object> > aggregates)
+{
+  // Twice, to check the cached results.
+  for (uint32_t pass = 0; pass < 2; pass++)
+    {
+      for (uint32_t i = 0; i < TypeId::GetRegisteredN (); i++)
+        {
+          TypeId tid = TypeId::GetRegistered (i);
+          if (tid == ObjectBase::GetTypeId () || tid == Object::GetTypeId ())
+            {
+              continue;
+            }
+          Ptr<Object> expected = 0;
+          for (std::vector<Ptr<Object> >::const_iterator j = aggregates.begin (); j != aggregates.end (); ++j)
+            {
+              if ((*j)->GetInstanceTypeId () == tid || (*j)->GetInstanceTypeId ().IsChildOf (tid))
+                {
+                  expected = *j;
+                }
+            }
+          NS_TEST_ASSERT_MSG_EQ (object->GetObject<Object> (tid), expected,
+                                 "Wrong lookup of " << tid.GetName () << " in pass " << pass);
+        }
+    }
+}
+
+void
+AggregateLookupTestCase::DoRun (void)
+{
+  std::vector<Ptr<Object> > aggregates;
+  Ptr<BaseA> baseA = CreateObject<BaseA> ();
+  aggregates.push_back (baseA);
+  CheckLookups (baseA, aggregates);
+
+  //
+  // The types which were not found before must be found after a new
+  // aggregation, through any of the aggregated objects.
+  //
+  Ptr<DerivedB> derivedB = CreateObject<DerivedB> ();
+  baseA->AggregateObject (derivedB);
+  aggregates.push_back (derivedB);
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedB> (), derivedB, "DerivedB not found after aggregation");
+  NS_TEST_ASSERT_MSG_EQ (derivedB->GetObject<BaseA> (), baseA, "BaseA not found after aggregation");
+  CheckLookups (baseA, aggregates);
+  CheckLookups (derivedB, aggregates);
+
+  //
+  // An Object looked up much more often than the first aggregate
+  // becomes the first one, and the lookups are not affected.
+  //
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<DerivedB> (), derivedB, "DerivedB not found");
+    }
+  Object::AggregateIterator iterator = baseA->GetAggregateIterator ();
+  NS_TEST_ASSERT_MSG_EQ (iterator.Next (), derivedB, "DerivedB not moved first");
+  CheckLookups (baseA, aggregates);
+  CheckLookups (derivedB, aggregates);
+}
+
 /**
  * \ingroup object-tests
  * Test an Object factory can create Objects
@@ -491,6 +582,7 @@ ObjectTestSuite::ObjectTestSuite ()
 {
   AddTestCase (new CreateObjectTestCase);
   AddTestCase (new AggregateObjectTestCase);
+  AddTestCase (new AggregateLookupTestCase);
   AddTestCase (new ObjectFactoryTestCase);
 }
 
@@ -21,6 +21,7 @@
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <sstream>
 
 #include "ns3/integer.h"
 #include "ns3/double.h"
@@ -334,6 +335,129 @@ DeprecatedAttributeTestCase::DoRun (void)
 }
 
 
+//----------------------------
+//
+// Inherited Attribute lookup test
+
+class DerivedAttribute : public DeprecatedAttribute
+{
+private:
+  int m_derived;
+
+public:
+  DerivedAttribute ()
+    : m_derived (0)
+  {
+    NS_UNUSED (m_derived);
+  }
+  virtual ~DerivedAttribute ()
+  {}
+
+  // Register a type adding an Attribute to DeprecatedAttribute
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("DerivedAttribute")
+      .SetParent<DeprecatedAttribute> ()
+      .AddAttribute ("derivedAttribute",
+                     "the derived Attribute",
+                     IntegerValue (2),
+                     MakeIntegerAccessor (&DerivedAttribute::m_derived),
+                     MakeIntegerChecker<int> ())
+    ;
+    return tid;
+  }
+};
+
+
+class AttributeLookupTestCase : public TestCase
+{
+public:
+  AttributeLookupTestCase ();
+  virtual ~AttributeLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+};
+
+AttributeLookupTestCase::AttributeLookupTestCase ()
+  : TestCase ("Check lookup of own and inherited Attributes")
+{}
+
+AttributeLookupTestCase::~AttributeLookupTestCase ()
+{}
+
+void
+AttributeLookupTestCase::DoRun (void)
+{
+  TypeId tid = DerivedAttribute::GetTypeId ();
+  TypeId parent = DeprecatedAttribute::GetTypeId ();
+
+  struct TypeId::AttributeInformation ainfo;
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("derivedAttribute", &ainfo), true,
+                         "lookup own attribute");
+  NS_TEST_ASSERT_MSG_EQ (ainfo.name, "derivedAttribute", "wrong own attribute");
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("attribute", &ainfo), true,
+                         "lookup inherited attribute");
+  NS_TEST_ASSERT_MSG_EQ (ainfo.help, "the Attribute", "wrong inherited attribute");
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("unknownAttribute", &ainfo), false,
+                         "lookup unknown attribute");
+  NS_TEST_ASSERT_MSG_EQ (parent.LookupAttributeByName ("derivedAttribute", &ainfo), false,
+                         "lookup derived attribute on the parent");
+
+  // Attributes registered late are found by the derived types too.
+  parent.AddAttribute ("lateAttribute",
+                       "the late Attribute",
+                       EmptyAttributeValue (),
+                       MakeEmptyAttributeAccessor (),
+                       MakeEmptyAttributeChecker ());
+  NS_TEST_ASSERT_MSG_EQ (tid.LookupAttributeByName ("lateAttribute", &ainfo), true,
+                         "lookup late inherited attribute");
+  NS_TEST_ASSERT_MSG_EQ (ainfo.help, "the late Attribute", "wrong late attribute");
+}
+
+
+class AttributeStabilityTestCase : public TestCase
+{
+public:
+  AttributeStabilityTestCase ();
+  virtual ~AttributeStabilityTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+};
+
+AttributeStabilityTestCase::AttributeStabilityTestCase ()
+  : TestCase ("Check Attribute references survive new TypeId registrations")
+{}
+
+AttributeStabilityTestCase::~AttributeStabilityTestCase ()
+{}
+
+void
+AttributeStabilityTestCase::DoRun (void)
+{
+  TypeId tid = DerivedAttribute::GetTypeId ();
+  const struct TypeId::AttributeInformation &info = tid.GetAttribute (0);
+  const struct TypeId::AttributeInformation *address = &info;
+
+  // Grow the registry well past its current size, as a setter run by
+  // ObjectBase::ConstructSelf may do while it holds such a reference.
+  uint16_t registered = TypeId::GetRegisteredN ();
+  for (uint16_t i = 0; i < registered + 100; i++)
+    {
+      std::ostringstream oss;
+      oss << "AttributeStability" << i;
+      TypeId (oss.str ().c_str ());
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (&tid.GetAttribute (0), address, "attribute record moved");
+  NS_TEST_ASSERT_MSG_EQ (info.name, "derivedAttribute", "wrong attribute");
+  NS_TEST_ASSERT_MSG_EQ (info.help, "the derived Attribute", "wrong attribute help");
+}
+
+
 //----------------------------
 //
 // Performance test
@@ -447,6 +571,8 @@ TypeIdTestSuite::TypeIdTestSuite ()
   AddTestCase (new UniqueTypeIdTestCase, QUICK);
   AddTestCase (new CollisionTestCase, QUICK);
   AddTestCase (new DeprecatedAttributeTestCase, QUICK);
+  AddTestCase (new AttributeLookupTestCase, QUICK);
+  AddTestCase (new AttributeStabilityTestCase, QUICK);
 }
 
 static TypeIdTestSuite g_TypeIdTestSuite;
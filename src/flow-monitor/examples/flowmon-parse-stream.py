@@ -0,0 +1,149 @@
+## -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+#
+# Reads a streaming file written by FlowMonitor::StartStreaming and prints
+# the statistics of each flow.  The file can be read while the simulation
+# is still running: an incomplete block at the end of the file is ignored.
+#
+# File format (all integers in little endian byte order):
+#   header: "NS3FMSTR", uint32 version, 4 x float64 histogram bin widths
+#           (delay, jitter, packet size, flow interruptions)
+#   block:  int64 time (ns), uint32 number of flows, then for each flow
+#           uint32 flowId, uint64 txBytes, uint64 rxBytes, uint32 txPackets,
+#           uint32 rxPackets, uint32 lostPackets, uint32 timesForwarded,
+#           int64 delaySum (ns), int64 jitterSum (ns), the drops, as a
+#           uint32 number of reason codes followed by (uint32 reason code,
+#           uint32 packets, uint64 bytes) triples, and 4 histograms, each
+#           one a uint32 number of bins followed by uint32 (index, count)
+#           pairs.
+# The values of a block are the changes since the previous block.
+
+from __future__ import division
+import struct
+import sys
+
+MAGIC = b'NS3FMSTR'
+VERSION = 2
+HISTOGRAMS = ('delayHistogram', 'jitterHistogram', 'packetSizeHistogram', 'flowInterruptionsHistogram')
+
+## FlowDelta
+class FlowDelta(object):
+    ## class variables
+    ## @var flowId
+    #  flow identifier
+    ## @var txBytes
+    #  transmitted bytes
+    ## @var rxBytes
+    #  received bytes
+    ## @var txPackets
+    #  transmitted packets
+    ## @var rxPackets
+    #  received packets
+    ## @var lostPackets
+    #  lost packets
+    ## @var timesForwarded
+    #  times forwarded
+    ## @var delaySum
+    #  sum of the delays, in ns
+    ## @var jitterSum
+    #  sum of the jitters, in ns
+    ## @var drops
+    #  reason code --> (packets, bytes) dropped
+    ## @var histograms
+    #  histogram name --> {bin index: count}
+    ## @var __slots__
+    #  class variable list
+    __slots__ = ['flowId', 'txBytes', 'rxBytes', 'txPackets', 'rxPackets', 'lostPackets',
+                 'timesForwarded', 'delaySum', 'jitterSum', 'drops', 'histograms']
+
+
+class _Reader(object):
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def read(self, fmt):
+        size = struct.calcsize(fmt)
+        if self.pos + size > len(self.data):
+            raise EOFError
+        values = struct.unpack_from(fmt, self.data, self.pos)
+        self.pos += size
+        return values
+
+
+def read_stream(fileName):
+    '''Reads a streaming file.
+    @param fileName The name of the file.
+    @return a tuple (binWidths, blocks), binWidths being a dict histogram name --> bin width
+    and blocks a list of (time in ns, list of FlowDelta).
+    '''
+    with open(fileName, 'rb') as f:
+        reader = _Reader(f.read())
+    magic = reader.read('<8s')[0]
+    if magic != MAGIC:
+        raise ValueError('%s is not a FlowMonitor streaming file' % fileName)
+    version = reader.read('<I')[0]
+    if version != VERSION:
+        raise ValueError('unsupported streaming file version %d' % version)
+    binWidths = dict(zip(HISTOGRAMS, reader.read('<4d')))
+    blocks = []
+    while True:
+        start = reader.pos
+        try:
+            time, nFlows = reader.read('<qI')
+            flows = []
+            for i in range(nFlows):
+                flow = FlowDelta()
+                (flow.flowId, flow.txBytes, flow.rxBytes, flow.txPackets, flow.rxPackets,
+                 flow.lostPackets, flow.timesForwarded, flow.delaySum, flow.jitterSum) = reader.read('<IQQIIIIqq')
+                flow.drops = {}
+                nReasons = reader.read('<I')[0]
+                for j in range(nReasons):
+                    reasonCode, packets, bytes = reader.read('<IIQ')
+                    flow.drops[reasonCode] = (packets, bytes)
+                flow.histograms = {}
+                for name in HISTOGRAMS:
+                    nBins = reader.read('<I')[0]
+                    bins = reader.read('<%dI' % (2 * nBins))
+                    flow.histograms[name] = dict(zip(bins[0::2], bins[1::2]))
+                flows.append(flow)
+        except EOFError:
+            # incomplete block, still being written
+            reader.pos = start
+            break
+        blocks.append((time, flows))
+    return binWidths, blocks
+
+
+def main(argv):
+    if len(argv) != 2:
+        print('usage: %s <streaming file>' % argv[0])
+        return 1
+    binWidths, blocks = read_stream(argv[1])
+    totals = {}
+    for time, flows in blocks:
+        print('t=%.3fs: %d flows changed' % (time * 1e-9, len(flows)))
+        for flow in flows:
+            total = totals.setdefault(flow.flowId, [0, 0, 0, 0, 0, 0, {}])
+            total[0] += flow.txBytes
+            total[1] += flow.rxBytes
+            total[2] += flow.txPackets
+            total[3] += flow.rxPackets
+            total[4] += flow.lostPackets
+            total[5] += flow.delaySum
+            for reasonCode, (packets, bytes) in flow.drops.items():
+                dropped = total[6].get(reasonCode, (0, 0))
+                total[6][reasonCode] = (dropped[0] + packets, dropped[1] + bytes)
+    for flowId in sorted(totals):
+        txBytes, rxBytes, txPackets, rxPackets, lostPackets, delaySum, drops = totals[flowId]
+        print('FlowID: %i' % flowId)
+        print('\tTX: %i bytes, %i packets' % (txBytes, txPackets))
+        print('\tRX: %i bytes, %i packets, %i lost' % (rxBytes, rxPackets, lostPackets))
+        for reasonCode in sorted(drops):
+            print('\tDropped (reason %i): %i bytes, %i packets' % (reasonCode, drops[reasonCode][1], drops[reasonCode][0]))
+        if rxPackets:
+            print('\tMean Delay: %.2f ms' % (delaySum * 1e-6 / rxPackets))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -22,10 +22,14 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <cstring>
 
 #define PERIODIC_CHECK_INTERVAL (Seconds (1))
+#define STREAM_FORMAT_VERSION 2
 
 namespace ns3 {
 
@@ -69,6 +73,16 @@ FlowMonitor::GetTypeId (void)
                    TimeValue (Seconds (0.5)),
                    MakeTimeAccessor (&FlowMonitor::m_flowInterruptionsMinTime),
                    MakeTimeChecker ())
+    .AddAttribute ("SamplingInterval", ("Monitor one packet in every SamplingInterval packets of each flow.  "
+                                        "The statistics then describe the sampled packets only."),
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&FlowMonitor::m_samplingInterval),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("StreamInterval", ("The interval between the blocks appended to the streaming file "
+                                      "(see FlowMonitor::StartStreaming)."),
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&FlowMonitor::m_streamInterval),
+                   MakeTimeChecker (TimeStep (1)))
   ;
   return tid;
 }
@@ -80,7 +94,8 @@ FlowMonitor::GetInstanceTypeId (void) const
 }
 
 FlowMonitor::FlowMonitor ()
-  : m_enabled (false)
+  : m_samplingInterval (1),
+    m_enabled (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -91,6 +106,11 @@ FlowMonitor::DoDispose (void)
   NS_LOG_FUNCTION (this);
   Simulator::Cancel (m_startEvent);
   Simulator::Cancel (m_stopEvent);
+  Simulator::Cancel (m_streamEvent);
+  if (m_stream.is_open ())
+    {
+      m_stream.close ();
+    }
   for (std::list<Ptr<FlowClassifier> >::iterator iter = m_classifiers.begin ();
       iter != m_classifiers.end ();
       iter ++)
@@ -102,6 +122,9 @@ FlowMonitor::DoDispose (void)
       m_flowProbes[i]->Dispose ();
       m_flowProbes[i] = 0;
     }
+  m_trackedPackets.clear ();
+  m_flowSlots.clear ();
+  m_streamSnapshots.clear ();
   Object::DoDispose ();
 }
 
@@ -109,30 +132,44 @@ inline FlowMonitor::FlowStats&
 FlowMonitor::GetStatsForFlow (FlowId flowId)
 {
   NS_LOG_FUNCTION (this);
-  FlowStatsContainerI iter;
-  iter = m_flowStats.find (flowId);
-  if (iter == m_flowStats.end ())
-    {
-      FlowMonitor::FlowStats &ref = m_flowStats[flowId];
-      ref.delaySum = Seconds (0);
-      ref.jitterSum = Seconds (0);
-      ref.lastDelay = Seconds (0);
-      ref.txBytes = 0;
-      ref.rxBytes = 0;
-      ref.txPackets = 0;
-      ref.rxPackets = 0;
-      ref.lostPackets = 0;
-      ref.timesForwarded = 0;
-      ref.delayHistogram.SetDefaultBinWidth (m_delayBinWidth);
-      ref.jitterHistogram.SetDefaultBinWidth (m_jitterBinWidth);
-      ref.packetSizeHistogram.SetDefaultBinWidth (m_packetSizeBinWidth);
-      ref.flowInterruptionsHistogram.SetDefaultBinWidth (m_flowInterruptionsBinWidth);
-      return ref;
+  // The classifiers allocate flow identifiers sequentially, so the
+  // stats of a flow are found through a slot indexed by its identifier.
+  if (flowId < m_flowSlots.size () && m_flowSlots[flowId] != 0)
+    {
+      return *m_flowSlots[flowId];
     }
-  else
+  FlowMonitor::FlowStats &ref = m_flowStats[flowId];
+  ref.delaySum = Seconds (0);
+  ref.jitterSum = Seconds (0);
+  ref.lastDelay = Seconds (0);
+  ref.txBytes = 0;
+  ref.rxBytes = 0;
+  ref.txPackets = 0;
+  ref.rxPackets = 0;
+  ref.lostPackets = 0;
+  ref.timesForwarded = 0;
+  ref.delayHistogram.SetDefaultBinWidth (m_delayBinWidth);
+  ref.jitterHistogram.SetDefaultBinWidth (m_jitterBinWidth);
+  ref.packetSizeHistogram.SetDefaultBinWidth (m_packetSizeBinWidth);
+  ref.flowInterruptionsHistogram.SetDefaultBinWidth (m_flowInterruptionsBinWidth);
+  if (flowId >= m_flowSlots.size ())
     {
-      return iter->second;
+      m_flowSlots.resize (std::max<size_t> (flowId + 1, 2 * m_flowSlots.size ()), 0);
     }
+  m_flowSlots[flowId] = &ref;
+  return ref;
+}
+
+inline uint64_t
+FlowMonitor::GetTrackedPacketKey (FlowId flowId, FlowPacketId packetId)
+{
+  return (static_cast<uint64_t> (flowId) << 32) | packetId;
+}
+
+inline bool
+FlowMonitor::IsSampled (FlowPacketId packetId) const
+{
+  return packetId % m_samplingInterval == 0;
 }
 
 
@@ -145,8 +182,12 @@ FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t pack
       NS_LOG_DEBUG ("FlowMonitor not enabled; returning");
       return;
     }
+  if (!IsSampled (packetId))
+    {
+      return;
+    }
   Time now = Simulator::Now ();
-  TrackedPacket &tracked = m_trackedPackets[std::make_pair (flowId, packetId)];
+  TrackedPacket &tracked = m_trackedPackets[GetTrackedPacketKey (flowId, packetId)];
   tracked.firstSeenTime = now;
   tracked.lastSeenTime = tracked.firstSeenTime;
   tracked.timesForwarded = 0;
@@ -175,8 +216,11 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
       NS_LOG_DEBUG ("FlowMonitor not enabled; returning");
       return;
     }
-  std::pair<FlowId, FlowPacketId> key (flowId, packetId);
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (key);
+  if (!IsSampled (packetId))
+    {
+      return;
+    }
+  TrackedPacketMap::iterator tracked = m_trackedPackets.find (GetTrackedPacketKey (flowId, packetId));
   if (tracked == m_trackedPackets.end ())
     {
       NS_LOG_WARN ("Received packet forward report (flowId=" << flowId << ", packetId=" << packetId
@@ -201,7 +245,11 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
       NS_LOG_DEBUG ("FlowMonitor not enabled; returning");
       return;
     }
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
+  if (!IsSampled (packetId))
+    {
+      return;
+    }
+  TrackedPacketMap::iterator tracked = m_trackedPackets.find (GetTrackedPacketKey (flowId, packetId));
   if (tracked == m_trackedPackets.end ())
     {
       NS_LOG_WARN ("Received packet last-tx report (flowId=" << flowId << ", packetId=" << packetId
@@ -267,6 +315,10 @@ FlowMonitor::ReportDrop (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetI
       NS_LOG_DEBUG ("FlowMonitor not enabled; returning");
       return;
     }
+  if (!IsSampled (packetId))
+    {
+      return;
+    }
 
   probe->AddPacketDropStats (flowId, packetSize, reasonCode);
 
@@ -281,7 +333,7 @@ FlowMonitor::ReportDrop (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetI
   stats.bytesDropped[reasonCode] += packetSize;
   NS_LOG_DEBUG ("++stats.packetsDropped[" << reasonCode<< "]; // becomes: " << stats.packetsDropped[reasonCode]);
 
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
+  TrackedPacketMap::iterator tracked = m_trackedPackets.find (GetTrackedPacketKey (flowId, packetId));
   if (tracked != m_trackedPackets.end ())
     {
       // we don't need to track this packet anymore
@@ -311,12 +363,12 @@ FlowMonitor::CheckForLostPackets (Time maxDelay)
       if (now - iter->second.lastSeenTime >= maxDelay)
         {
           // packet is considered lost, add it to the loss statistics
-          FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
-          NS_ASSERT (flow != m_flowStats.end ());
-          flow->second.lostPackets++;
+          FlowId flowId = iter->first >> 32;
+          NS_ASSERT (flowId < m_flowSlots.size () && m_flowSlots[flowId] != 0);
+          m_flowSlots[flowId]->lostPackets++;
 
           // we won't track it anymore
-          m_trackedPackets.erase (iter++);
+          iter = m_trackedPackets.erase (iter);
         }
       else
         {
@@ -521,5 +573,230 @@ FlowMonitor::SerializeToXmlFile (std::string fileName, bool enableHistograms, bo
 }
 
 
-} // namespace ns3
+/**
+ * Writes an integer to a stream, in little endian byte order
+ * \param os the output stream
+ * \param value the value
+ * \param size the number of bytes to write
+ */
+static void
+WriteLittleEndian (std::ostream &os, uint64_t value, uint32_t size)
+{
+  char buf[8];
+  for (uint32_t i = 0; i < size; i++)
+    {
+      buf[i] = static_cast<char> ((value >> (8 * i)) & 0xff);
+    }
+  os.write (buf, size);
+}
+
+/**
+ * Writes the bins of a histogram which changed since a previous copy of
+ * it to a stream, as a count of bins followed by (index, count change)
+ * pairs
+ * \param os the output stream
+ * \param histogram the histogram
+ * \param previous the histogram when the previous block was written
+ */
+static void
+WriteHistogram (std::ostream &os, Histogram &histogram, Histogram &previous)
+{
+  std::vector<std::pair<uint32_t, uint32_t> > bins;
+  for (uint32_t index = 0; index < histogram.GetNBins (); index++)
+    {
+      uint32_t count = histogram.GetBinCount (index);
+      if (index < previous.GetNBins ())
+        {
+          count -= previous.GetBinCount (index);
+        }
+      if (count)
+        {
+          bins.push_back (std::make_pair (index, count));
+        }
+    }
+  WriteLittleEndian (os, bins.size (), 4);
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator i = bins.begin ();
+       i != bins.end (); ++i)
+    {
+      WriteLittleEndian (os, i->first, 4);
+      WriteLittleEndian (os, i->second, 4);
+    }
+}
+
+/**
+ * Writes the drops of a flow since the previous block to a stream, as a
+ * count of reason codes followed by (reason code, packets, bytes) triples
+ * \param os the output stream
+ * \param packetsDropped the dropped packets of the flow, per reason code
+ * \param bytesDropped the dropped bytes of the flow, per reason code
+ * \param previousPackets packetsDropped when the previous block was written
+ * \param previousBytes bytesDropped when the previous block was written
+ */
+static void
+WriteDrops (std::ostream &os,
+            const std::vector<uint32_t> &packetsDropped, const std::vector<uint64_t> &bytesDropped,
+            const std::vector<uint32_t> &previousPackets, const std::vector<uint64_t> &previousBytes)
+{
+  uint32_t nReasons = 0;
+  for (uint32_t reasonCode = 0; reasonCode < packetsDropped.size (); reasonCode++)
+    {
+      if (reasonCode >= previousPackets.size ()
+          || packetsDropped[reasonCode] != previousPackets[reasonCode])
+        {
+          nReasons++;
+        }
+    }
+  WriteLittleEndian (os, nReasons, 4);
+  for (uint32_t reasonCode = 0; reasonCode < packetsDropped.size (); reasonCode++)
+    {
+      uint32_t packets = packetsDropped[reasonCode];
+      uint64_t bytes = bytesDropped[reasonCode];
+      if (reasonCode < previousPackets.size ())
+        {
+          if (packets == previousPackets[reasonCode])
+            {
+              continue;
+            }
+          packets -= previousPackets[reasonCode];
+          bytes -= previousBytes[reasonCode];
+        }
+      WriteLittleEndian (os, reasonCode, 4);
+      WriteLittleEndian (os, packets, 4);
+      WriteLittleEndian (os, bytes, 8);
+    }
+}
+
+/**
+ * Writes a double to a stream, as its IEEE 754 representation in little
+ * endian byte order
+ * \param os the output stream
+ * \param value the value
+ */
+static void
+WriteDouble (std::ostream &os, double value)
+{
+  uint64_t bits;
+  std::memcpy (&bits, &value, sizeof (bits));
+  WriteLittleEndian (os, bits, 8);
+}
+
+void
+FlowMonitor::StartStreaming (std::string fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+  if (m_stream.is_open ())
+    {
+      StopStreaming ();
+    }
+  m_stream.open (fileName.c_str (), std::ios::out|std::ios::binary|std::ios::trunc);
+  if (!m_stream.is_open ())
+    {
+      NS_FATAL_ERROR ("Can not open streaming file " << fileName);
+    }
+  // File header: magic, format version and histogram bin widths
+  m_stream.write ("NS3FMSTR", 8);
+  WriteLittleEndian (m_stream, STREAM_FORMAT_VERSION, 4);
+  WriteDouble (m_stream, m_delayBinWidth);
+  WriteDouble (m_stream, m_jitterBinWidth);
+  WriteDouble (m_stream, m_packetSizeBinWidth);
+  WriteDouble (m_stream, m_flowInterruptionsBinWidth);
+  m_stream.flush ();
+  Simulator::Cancel (m_streamEvent);
+  m_streamEvent = Simulator::Schedule (m_streamInterval, &FlowMonitor::PeriodicStreamFlowStats, this);
+}
+
+void
+FlowMonitor::StopStreaming ()
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_stream.is_open ())
+    {
+      NS_LOG_DEBUG ("FlowMonitor not streaming; returning");
+      return;
+    }
+  Simulator::Cancel (m_streamEvent);
+  StreamFlowStats ();
+  m_stream.close ();
+}
+
+void
+FlowMonitor::PeriodicStreamFlowStats ()
+{
+  StreamFlowStats ();
+  m_streamEvent = Simulator::Schedule (m_streamInterval, &FlowMonitor::PeriodicStreamFlowStats, this);
+}
 
+void
+FlowMonitor::StreamFlowStats ()
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_stream.is_open ())
+    {
+      NS_LOG_DEBUG ("FlowMonitor not streaming; returning");
+      return;
+    }
+  if (m_enabled)
+    {
+      CheckForLostPackets ();
+    }
+
+  // Block: time, number of flows, then the changes of each flow that
+  // changed since the previous block
+  std::ostringstream block;
+  uint32_t nFlows = 0;
+  m_streamSnapshots.resize (m_flowSlots.size ());
+  for (FlowId flowId = 0; flowId < m_flowSlots.size (); flowId++)
+    {
+      FlowStats *flow = m_flowSlots[flowId];
+      if (flow == 0)
+        {
+          continue;
+        }
+      StreamSnapshot &last = m_streamSnapshots[flowId];
+      if (flow->txPackets == last.txPackets && flow->rxPackets == last.rxPackets
+          && flow->lostPackets == last.lostPackets && flow->timesForwarded == last.timesForwarded
+          && flow->packetsDropped == last.packetsDropped)
+        {
+          continue;
+        }
+      WriteLittleEndian (block, flowId, 4);
+      WriteLittleEndian (block, flow->txBytes - last.txBytes, 8);
+      WriteLittleEndian (block, flow->rxBytes - last.rxBytes, 8);
+      WriteLittleEndian (block, flow->txPackets - last.txPackets, 4);
+      WriteLittleEndian (block, flow->rxPackets - last.rxPackets, 4);
+      WriteLittleEndian (block, flow->lostPackets - last.lostPackets, 4);
+      WriteLittleEndian (block, flow->timesForwarded - last.timesForwarded, 4);
+      WriteLittleEndian (block, flow->delaySum.GetNanoSeconds () - last.delaySum, 8);
+      WriteLittleEndian (block, flow->jitterSum.GetNanoSeconds () - last.jitterSum, 8);
+      WriteDrops (block, flow->packetsDropped, flow->bytesDropped,
+                  last.packetsDropped, last.bytesDropped);
+      WriteHistogram (block, flow->delayHistogram, last.delayHistogram);
+      WriteHistogram (block, flow->jitterHistogram, last.jitterHistogram);
+      WriteHistogram (block, flow->packetSizeHistogram, last.packetSizeHistogram);
+      WriteHistogram (block, flow->flowInterruptionsHistogram, last.flowInterruptionsHistogram);
+      nFlows++;
+
+      last.txBytes = flow->txBytes;
+      last.rxBytes = flow->rxBytes;
+      last.txPackets = flow->txPackets;
+      last.rxPackets = flow->rxPackets;
+      last.lostPackets = flow->lostPackets;
+      last.timesForwarded = flow->timesForwarded;
+      last.delaySum = flow->delaySum.GetNanoSeconds ();
+      last.jitterSum = flow->jitterSum.GetNanoSeconds ();
+      last.packetsDropped = flow->packetsDropped;
+      last.bytesDropped = flow->bytesDropped;
+      last.delayHistogram = flow->delayHistogram;
+      last.jitterHistogram = flow->jitterHistogram;
+      last.packetSizeHistogram = flow->packetSizeHistogram;
+      last.flowInterruptionsHistogram = flow->flowInterruptionsHistogram;
+    }
+  NS_LOG_DEBUG ("Streaming " << nFlows << " flows");
+  WriteLittleEndian (m_stream, Simulator::Now ().GetNanoSeconds (), 8);
+  WriteLittleEndian (m_stream, nFlows, 4);
+  m_stream << block.str ();
+  m_stream.flush ();
+}
+
+
+} // namespace ns3
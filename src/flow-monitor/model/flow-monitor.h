@@ -23,6 +23,8 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <fstream>
 
 #include "ns3/ptr.h"
 #include "ns3/object.h"
@@ -258,6 +260,22 @@ public:
   /// \param enableProbes if true, include also the per-probe/flow pair statistics in the output
   void SerializeToXmlFile (std::string fileName, bool enableHistograms, bool enableProbes);
 
+  /// Starts streaming the flow statistics to a binary file.  Every
+  /// StreamInterval, the changes of the flow statistics since the
+  /// previous block are appended to the file.  The statistics kept in
+  /// memory, and thus the XML report, still cover the whole simulation.
+  /// The file can be read with src/flow-monitor/examples/flowmon-parse-stream.py
+  /// while the simulation is running.
+  /// \param fileName name or path of the output file that will be created
+  void StartStreaming (std::string fileName);
+
+  /// Appends a final block to the streaming file and closes it
+  void StopStreaming ();
+
+  /// Appends right now a block with the changes of the flow statistics
+  /// since the previous block to the streaming file
+  void StreamFlowStats ();
+
 
 protected:
 
@@ -277,10 +295,14 @@ private:
   /// FlowId --> FlowStats
   FlowStatsContainer m_flowStats;
 
-  /// (FlowId,PacketId) --> TrackedPacket
-  typedef std::map< std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
+  /// FlowId --> FlowStats, for the flows in m_flowStats
+  std::vector<FlowStats*> m_flowSlots;
+
+  /// (FlowId,PacketId) --> TrackedPacket, keyed by (FlowId << 32) | PacketId
+  typedef std::unordered_map<uint64_t, TrackedPacket> TrackedPacketMap;
   TrackedPacketMap m_trackedPackets; //!< Tracked packets
   Time m_maxPerHopDelay; //!< Minimum per-hop delay
+  uint32_t m_samplingInterval; //!< Monitor one packet in every m_samplingInterval
   FlowProbeContainer m_flowProbes; //!< all the FlowProbes
 
   // note: this is needed only for serialization
@@ -300,8 +322,44 @@ private:
   /// \returns the stats of the flow
   FlowStats& GetStatsForFlow (FlowId flowId);
 
+  /// \param flowId the Flow identification
+  /// \param packetId the Packet identification
+  /// \returns the key of the packet in m_trackedPackets
+  static uint64_t GetTrackedPacketKey (FlowId flowId, FlowPacketId packetId);
+
+  /// \param packetId the Packet identification
+  /// \returns true if the packet is monitored, according to the sampling interval
+  bool IsSampled (FlowPacketId packetId) const;
+
   /// Periodic function to check for lost packets and prune statistics
   void PeriodicCheckForLostPackets ();
+
+  /// Counters of a flow when the previous streaming block was written
+  struct StreamSnapshot
+  {
+    uint64_t txBytes;         //!< Transmitted bytes
+    uint64_t rxBytes;         //!< Received bytes
+    uint32_t txPackets;       //!< Transmitted packets
+    uint32_t rxPackets;       //!< Received packets
+    uint32_t lostPackets;     //!< Lost packets
+    uint32_t timesForwarded;  //!< Times forwarded
+    int64_t delaySum;         //!< Sum of the delays, in ns
+    int64_t jitterSum;        //!< Sum of the jitters, in ns
+    std::vector<uint32_t> packetsDropped; //!< Dropped packets, per reason code
+    std::vector<uint64_t> bytesDropped;   //!< Dropped bytes, per reason code
+    Histogram delayHistogram;             //!< Delay histogram
+    Histogram jitterHistogram;            //!< Jitter histogram
+    Histogram packetSizeHistogram;        //!< Packet size histogram
+    Histogram flowInterruptionsHistogram; //!< Flow interruptions histogram
+  };
+
+  std::ofstream m_stream; //!< Streaming output file
+  std::vector<StreamSnapshot> m_streamSnapshots; //!< FlowId --> counters already streamed
+  Time m_streamInterval; //!< Interval between streaming blocks
+  EventId m_streamEvent; //!< Next streaming block event
+
+  /// Periodic function to append a streaming block
+  void PeriodicStreamFlowStats ();
 };
 
 
@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 #include "ns3/ipv4-header.h"
 #include "ns3/flow-classifier.h"
@@ -92,12 +94,26 @@ public:
 
 private:
 
+  /// Hash function of the five-tuples
+  struct FiveTupleHash
+  {
+    /// \param t the five-tuple
+    /// \returns the hash of the five-tuple
+    size_t operator() (const FiveTuple &t) const;
+  };
+
+  /// State of a flow
+  struct FlowState
+  {
+    FiveTuple tuple;            //!< five-tuple of the flow
+    FlowPacketId lastPacketId;  //!< identifier of the last packet of the flow
+    std::map<Ipv4Header::DscpType, uint32_t> dscpCounts; //!< (DSCP value, packet count) pairs
+  };
+
   /// Map to Flows Identifiers to FlowIds
-  std::map<FiveTuple, FlowId> m_flowMap;
-  /// Map to FlowIds to FlowPacketId
-  std::map<FlowId, FlowPacketId> m_flowPktIdMap;
-  /// Map FlowIds to (DSCP value, packet count) pairs
-  std::map<FlowId, std::map<Ipv4Header::DscpType, uint32_t> > m_flowDscpMap;
+  std::unordered_map<FiveTuple, FlowId, FiveTupleHash> m_flowMap;
+  /// State of the flows, indexed by FlowId - 1
+  std::vector<FlowState> m_flows;
 
 };
 
@@ -0,0 +1,700 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4.h"
+#include "ns3/socket.h"
+#include "ns3/udp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/uinteger.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/flow-monitor.h"
+#include "ns3/flow-monitor-helper.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/ipv6-flow-classifier.h"
+
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup flow-monitor
+ * \defgroup flow-monitor-test FlowMonitor module tests
+ */
+
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Check that the blocks of a streaming file add up to the final
+ * flow statistics.
+ *
+ * A node sends a UDP packet to another one every 10 ms for 3 s, the
+ * statistics being streamed every 500 ms.  The interface of the receiver
+ * goes down for 250 ms, so that the flow also has drops.
+ */
+class FlowMonitorStreamingTestCase : public TestCase
+{
+public:
+  FlowMonitorStreamingTestCase ();
+  virtual ~FlowMonitorStreamingTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Sum of the changes of a flow read from a streaming file
+  struct FlowTotals
+  {
+    uint64_t txBytes;         //!< Transmitted bytes
+    uint64_t rxBytes;         //!< Received bytes
+    uint64_t txPackets;       //!< Transmitted packets
+    uint64_t rxPackets;       //!< Received packets
+    uint64_t lostPackets;     //!< Lost packets
+    uint64_t timesForwarded;  //!< Times forwarded
+    int64_t delaySum;         //!< Sum of the delays, in ns
+    int64_t jitterSum;        //!< Sum of the jitters, in ns
+    std::map<uint32_t, uint64_t> packetsDropped; //!< Dropped packets, per reason code
+    std::map<uint32_t, uint64_t> bytesDropped;   //!< Dropped bytes, per reason code
+    std::map<uint32_t, uint64_t> histograms[4];  //!< Bin counts of the four histograms
+  };
+
+  /**
+   * Reads an integer in little endian byte order.
+   * \param is the input stream
+   * \param size the number of bytes to read
+   * \returns the value
+   */
+  static uint64_t ReadLittleEndian (std::istream &is, uint32_t size);
+
+  /**
+   * Reads a streaming file, adding up the changes of each flow.
+   * \param fileName the streaming file
+   * \param totals FlowId --> sum of the changes
+   * \returns the number of blocks in the file
+   */
+  uint32_t ReadStream (std::string fileName, std::map<FlowId, FlowTotals> &totals);
+
+  /**
+   * Checks the bin counts read from the streaming file against a histogram.
+   * \param bins the bin counts read
+   * \param histogram the histogram
+   * \param name the name of the histogram
+   */
+  void CheckHistogram (std::map<uint32_t, uint64_t> &bins, Histogram &histogram, std::string name);
+
+  /// Sends a packet and schedules the next one
+  void SendPacket (void);
+
+  Ptr<Socket> m_socket; //!< Sending socket
+  uint32_t m_sent;      //!< Packets sent
+};
+
+FlowMonitorStreamingTestCase::FlowMonitorStreamingTestCase ()
+  : TestCase ("Check that the streamed blocks add up to the final flow statistics"),
+    m_sent (0)
+{}
+
+FlowMonitorStreamingTestCase::~FlowMonitorStreamingTestCase ()
+{}
+
+uint64_t
+FlowMonitorStreamingTestCase::ReadLittleEndian (std::istream &is, uint32_t size)
+{
+  unsigned char buf[8];
+  is.read (reinterpret_cast<char *> (buf), size);
+  uint64_t value = 0;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      value |= static_cast<uint64_t> (buf[i]) << (8 * i);
+    }
+  return value;
+}
+
+uint32_t
+FlowMonitorStreamingTestCase::ReadStream (std::string fileName, std::map<FlowId, FlowTotals> &totals)
+{
+  std::ifstream is (fileName.c_str (), std::ios::in|std::ios::binary);
+  NS_TEST_EXPECT_MSG_EQ (is.is_open (), true, "Can not open " << fileName);
+
+  char magic[8];
+  is.read (magic, 8);
+  NS_TEST_EXPECT_MSG_EQ (std::string (magic, 8), "NS3FMSTR", "Bad magic");
+  NS_TEST_EXPECT_MSG_EQ (ReadLittleEndian (is, 4), 2, "Bad format version");
+  // Histogram bin widths
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      ReadLittleEndian (is, 8);
+    }
+
+  uint32_t nBlocks = 0;
+  while (is.peek () != std::char_traits<char>::eof ())
+    {
+      ReadLittleEndian (is, 8);
+      uint32_t nFlows = ReadLittleEndian (is, 4);
+      for (uint32_t i = 0; i < nFlows; i++)
+        {
+          FlowTotals &flow = totals[ReadLittleEndian (is, 4)];
+          flow.txBytes += ReadLittleEndian (is, 8);
+          flow.rxBytes += ReadLittleEndian (is, 8);
+          flow.txPackets += ReadLittleEndian (is, 4);
+          flow.rxPackets += ReadLittleEndian (is, 4);
+          flow.lostPackets += ReadLittleEndian (is, 4);
+          flow.timesForwarded += ReadLittleEndian (is, 4);
+          flow.delaySum += static_cast<int64_t> (ReadLittleEndian (is, 8));
+          flow.jitterSum += static_cast<int64_t> (ReadLittleEndian (is, 8));
+          uint32_t nReasons = ReadLittleEndian (is, 4);
+          for (uint32_t j = 0; j < nReasons; j++)
+            {
+              uint32_t reasonCode = ReadLittleEndian (is, 4);
+              flow.packetsDropped[reasonCode] += ReadLittleEndian (is, 4);
+              flow.bytesDropped[reasonCode] += ReadLittleEndian (is, 8);
+            }
+          for (uint32_t h = 0; h < 4; h++)
+            {
+              uint32_t nBins = ReadLittleEndian (is, 4);
+              for (uint32_t j = 0; j < nBins; j++)
+                {
+                  uint32_t index = ReadLittleEndian (is, 4);
+                  flow.histograms[h][index] += ReadLittleEndian (is, 4);
+                }
+            }
+        }
+      NS_TEST_EXPECT_MSG_EQ (is.good (), true, "Truncated block " << nBlocks);
+      nBlocks++;
+    }
+  return nBlocks;
+}
+
+void
+FlowMonitorStreamingTestCase::CheckHistogram (std::map<uint32_t, uint64_t> &bins, Histogram &histogram,
+                                              std::string name)
+{
+  for (uint32_t index = 0; index < histogram.GetNBins (); index++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (bins[index], histogram.GetBinCount (index),
+                             name << " bin " << index);
+      bins.erase (index);
+    }
+  NS_TEST_EXPECT_MSG_EQ (bins.size (), 0, name << " has extra bins in the stream");
+}
+
+void
+FlowMonitorStreamingTestCase::SendPacket (void)
+{
+  m_socket->Send (Create<Packet> (100 + 10 * (m_sent % 7)));
+  m_sent++;
+  if (Simulator::Now () < Seconds (3))
+    {
+      Simulator::Schedule (MilliSeconds (10), &FlowMonitorStreamingTestCase::SendPacket, this);
+    }
+}
+
+void
+FlowMonitorStreamingTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (2)));
+  NetDeviceContainer devices = simpleHelper.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  m_socket = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  m_socket->Connect (InetSocketAddress (interfaces.GetAddress (1), 9));
+
+  FlowMonitorHelper flowmonHelper;
+  Ptr<FlowMonitor> monitor = flowmonHelper.InstallAll ();
+  monitor->SetAttribute ("StreamInterval", TimeValue (MilliSeconds (500)));
+  std::string fileName = CreateTempDirFilename ("flowmon-stream.bin");
+  monitor->StartStreaming (fileName);
+
+  Ptr<Ipv4> receiver = nodes.Get (1)->GetObject<Ipv4> ();
+  Simulator::Schedule (Seconds (0.1), &FlowMonitorStreamingTestCase::SendPacket, this);
+  Simulator::Schedule (Seconds (1.2), &Ipv4::SetDown, receiver, 1);
+  Simulator::Schedule (Seconds (1.45), &Ipv4::SetUp, receiver, 1);
+  Simulator::Stop (Seconds (4));
+  Simulator::Run ();
+  monitor->StopStreaming ();
+
+  std::map<FlowId, FlowTotals> totals;
+  uint32_t nBlocks = ReadStream (fileName, totals);
+  // One block every 500 ms, and the final one
+  NS_TEST_ASSERT_MSG_GT (nBlocks, 6, "Too few blocks");
+
+  const FlowMonitor::FlowStatsContainer &stats = monitor->GetFlowStats ();
+  NS_TEST_ASSERT_MSG_EQ (stats.size (), 1, "Wrong number of flows");
+  NS_TEST_ASSERT_MSG_EQ (totals.size (), 1, "Wrong number of streamed flows");
+  FlowMonitor::FlowStats flow = stats.begin ()->second;
+  FlowTotals &streamed = totals[stats.begin ()->first];
+
+  NS_TEST_ASSERT_MSG_EQ (flow.txPackets, m_sent, "Wrong number of sent packets");
+  NS_TEST_EXPECT_MSG_EQ (streamed.txBytes, flow.txBytes, "txBytes");
+  NS_TEST_EXPECT_MSG_EQ (streamed.rxBytes, flow.rxBytes, "rxBytes");
+  NS_TEST_EXPECT_MSG_EQ (streamed.txPackets, flow.txPackets, "txPackets");
+  NS_TEST_EXPECT_MSG_EQ (streamed.rxPackets, flow.rxPackets, "rxPackets");
+  NS_TEST_EXPECT_MSG_EQ (streamed.lostPackets, flow.lostPackets, "lostPackets");
+  NS_TEST_EXPECT_MSG_EQ (streamed.timesForwarded, flow.timesForwarded, "timesForwarded");
+  NS_TEST_EXPECT_MSG_EQ (streamed.delaySum, flow.delaySum.GetNanoSeconds (), "delaySum");
+  NS_TEST_EXPECT_MSG_EQ (streamed.jitterSum, flow.jitterSum.GetNanoSeconds (), "jitterSum");
+
+  uint32_t dropped = 0;
+  for (uint32_t reasonCode = 0; reasonCode < flow.packetsDropped.size (); reasonCode++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (streamed.packetsDropped[reasonCode], flow.packetsDropped[reasonCode],
+                             "packetsDropped[" << reasonCode << "]");
+      NS_TEST_EXPECT_MSG_EQ (streamed.bytesDropped[reasonCode], flow.bytesDropped[reasonCode],
+                             "bytesDropped[" << reasonCode << "]");
+      dropped += flow.packetsDropped[reasonCode];
+    }
+  NS_TEST_EXPECT_MSG_GT (dropped, 0, "The flow has no drops");
+  NS_TEST_EXPECT_MSG_EQ (flow.rxPackets + dropped, flow.txPackets, "Packets neither received nor dropped");
+
+  // The histograms kept in memory cover the whole flow
+  CheckHistogram (streamed.histograms[0], flow.delayHistogram, "delayHistogram");
+  CheckHistogram (streamed.histograms[1], flow.jitterHistogram, "jitterHistogram");
+  CheckHistogram (streamed.histograms[2], flow.packetSizeHistogram, "packetSizeHistogram");
+  CheckHistogram (streamed.histograms[3], flow.flowInterruptionsHistogram, "flowInterruptionsHistogram");
+  uint64_t sizes = 0;
+  for (uint32_t index = 0; index < flow.packetSizeHistogram.GetNBins (); index++)
+    {
+      sizes += flow.packetSizeHistogram.GetBinCount (index);
+    }
+  NS_TEST_EXPECT_MSG_EQ (sizes, flow.rxPackets, "The packet size histogram does not cover the whole flow");
+
+  m_socket->Close ();
+  sink->Close ();
+  m_socket = 0;
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Check that the statistics of a sampled flow match the ones of
+ * the whole flow, scaled by the sampling interval.
+ *
+ * The same UDP flow, of packets of seven sizes, is monitored once without
+ * sampling and once with a SamplingInterval of 4.
+ */
+class FlowMonitorSamplingTestCase : public TestCase
+{
+public:
+  FlowMonitorSamplingTestCase ();
+  virtual ~FlowMonitorSamplingTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Runs the flow.
+   * \param samplingInterval the SamplingInterval of the monitor
+   * \returns the statistics of the flow
+   */
+  FlowMonitor::FlowStats RunFlow (uint32_t samplingInterval);
+
+  /// Sends a packet and schedules the next one
+  void SendPacket (void);
+
+  /// Sends a packet of another flow, which resolves the address of the receiver
+  void SendWarmUp (void);
+
+  Ptr<Socket> m_socket; //!< Sending socket
+  Ptr<Socket> m_warmUp; //!< Socket sending the packet of another flow
+  uint32_t m_sent;      //!< Packets sent
+};
+
+FlowMonitorSamplingTestCase::FlowMonitorSamplingTestCase ()
+  : TestCase ("Check that the sampled flow statistics match the unsampled ones"),
+    m_sent (0)
+{}
+
+FlowMonitorSamplingTestCase::~FlowMonitorSamplingTestCase ()
+{}
+
+void
+FlowMonitorSamplingTestCase::SendPacket (void)
+{
+  m_socket->Send (Create<Packet> (100 + 10 * (m_sent % 7)));
+  m_sent++;
+  if (Simulator::Now () < Seconds (3))
+    {
+      Simulator::Schedule (MilliSeconds (10), &FlowMonitorSamplingTestCase::SendPacket, this);
+    }
+}
+
+void
+FlowMonitorSamplingTestCase::SendWarmUp (void)
+{
+  m_warmUp->Send (Create<Packet> (100));
+}
+
+FlowMonitor::FlowStats
+FlowMonitorSamplingTestCase::RunFlow (uint32_t samplingInterval)
+{
+  m_sent = 0;
+  NodeContainer nodes;
+  nodes.Create (2);
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (2)));
+  NetDeviceContainer devices = simpleHelper.Install (nodes);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Ptr<Socket> sink = Socket::CreateSocket (nodes.Get (1), UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  m_socket = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  m_socket->Connect (InetSocketAddress (interfaces.GetAddress (1), 9));
+  m_warmUp = Socket::CreateSocket (nodes.Get (0), UdpSocketFactory::GetTypeId ());
+  m_warmUp->Connect (InetSocketAddress (interfaces.GetAddress (1), 10));
+
+  FlowMonitorHelper flowmonHelper;
+  Ptr<FlowMonitor> monitor = flowmonHelper.InstallAll ();
+  monitor->SetAttribute ("SamplingInterval", UintegerValue (samplingInterval));
+
+  // The first packet of the flow would otherwise wait for ARP, and it
+  // is always sampled
+  Simulator::Schedule (Seconds (0.05), &FlowMonitorSamplingTestCase::SendWarmUp, this);
+  Simulator::Schedule (Seconds (0.1), &FlowMonitorSamplingTestCase::SendPacket, this);
+  Simulator::Stop (Seconds (4));
+  Simulator::Run ();
+
+  Ptr<Ipv4FlowClassifier> classifier = DynamicCast<Ipv4FlowClassifier> (flowmonHelper.GetClassifier ());
+  const FlowMonitor::FlowStatsContainer &stats = monitor->GetFlowStats ();
+  NS_TEST_EXPECT_MSG_EQ (stats.size (), 2, "Wrong number of flows");
+  FlowMonitor::FlowStats flow;
+  bool found = false;
+  for (FlowMonitor::FlowStatsContainerCI i = stats.begin (); i != stats.end (); ++i)
+    {
+      if (classifier->FindFlow (i->first).destinationPort == 9)
+        {
+          flow = i->second;
+          found = true;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (found, true, "The flow is not monitored");
+
+  m_socket->Close ();
+  m_warmUp->Close ();
+  sink->Close ();
+  m_socket = 0;
+  m_warmUp = 0;
+  Simulator::Destroy ();
+  return flow;
+}
+
+void
+FlowMonitorSamplingTestCase::DoRun (void)
+{
+  const uint32_t interval = 4;
+  FlowMonitor::FlowStats all = RunFlow (1);
+  uint32_t sent = m_sent;
+  FlowMonitor::FlowStats sampled = RunFlow (interval);
+
+  NS_TEST_ASSERT_MSG_EQ (all.txPackets, sent, "Wrong number of monitored packets without sampling");
+  NS_TEST_ASSERT_MSG_EQ (all.rxPackets, sent, "The flow has losses");
+  // Packets 0, interval, 2 * interval... of the flow are sampled
+  NS_TEST_EXPECT_MSG_EQ (sampled.txPackets, (sent + interval - 1) / interval, "Wrong number of sampled packets");
+  NS_TEST_EXPECT_MSG_EQ (sampled.rxPackets, sampled.txPackets, "Sampled packets lost");
+  NS_TEST_EXPECT_MSG_EQ (sampled.lostPackets, 0, "Sampled packets lost");
+
+  // Scaled by the sampling interval, the sampled bytes and delays match
+  // the ones of the whole flow within the size of a sample
+  double txBytes = static_cast<double> (sampled.txBytes) * sent / sampled.txPackets;
+  NS_TEST_EXPECT_MSG_EQ_TOL (txBytes, all.txBytes, all.txBytes / (double) sampled.txPackets,
+                             "Sampled txBytes do not match");
+  double rxBytes = static_cast<double> (sampled.rxBytes) * sent / sampled.rxPackets;
+  NS_TEST_EXPECT_MSG_EQ_TOL (rxBytes, all.rxBytes, all.rxBytes / (double) sampled.rxPackets,
+                             "Sampled rxBytes do not match");
+  double delay = sampled.delaySum.GetSeconds () / sampled.rxPackets;
+  double allDelay = all.delaySum.GetSeconds () / all.rxPackets;
+  NS_TEST_EXPECT_MSG_EQ_TOL (delay, allDelay, allDelay / sampled.rxPackets, "Sampled mean delay does not match");
+
+  uint32_t sizes = 0;
+  for (uint32_t index = 0; index < sampled.packetSizeHistogram.GetNBins (); index++)
+    {
+      sizes += sampled.packetSizeHistogram.GetBinCount (index);
+    }
+  NS_TEST_EXPECT_MSG_EQ (sizes, sampled.rxPackets, "The packet size histogram holds unsampled packets");
+}
+
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Check that the IPv4 and IPv6 flow classifiers assign the same
+ * FlowIds and packet ids as an ordered map of the five-tuples.
+ *
+ * Packets of several flows are classified in an irregular order, mixed
+ * with packets that the classifiers must ignore.
+ */
+class FlowMonitorClassifierTestCase : public TestCase
+{
+public:
+  FlowMonitorClassifierTestCase ();
+  virtual ~FlowMonitorClassifierTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// Classifier keeping its flows in ordered maps, as the classifiers did
+  template <class FiveTuple, class DscpType>
+  struct ReferenceClassifier
+  {
+    ReferenceClassifier ()
+      : lastFlowId (0)
+    {}
+    /**
+     * Classifies a packet.
+     * \param tuple the five-tuple of the packet
+     * \param dscp the DSCP of the packet
+     * \param flowId the FlowId of the packet
+     * \param packetId the packet id of the packet
+     */
+    void Classify (const FiveTuple &tuple, DscpType dscp, FlowId *flowId, FlowPacketId *packetId)
+    {
+      typename std::map<FiveTuple, FlowId>::iterator i = flows.find (tuple);
+      if (i == flows.end ())
+        {
+          i = flows.insert (std::make_pair (tuple, ++lastFlowId)).first;
+          packetIds[i->second] = 0;
+        }
+      else
+        {
+          packetIds[i->second]++;
+        }
+      dscpCounts[i->second][dscp]++;
+      *flowId = i->second;
+      *packetId = packetIds[i->second];
+    }
+    std::map<FiveTuple, FlowId> flows;                            //!< FlowId of each five-tuple
+    std::map<FlowId, FlowPacketId> packetIds;                     //!< Last packet id of each flow
+    std::map<FlowId, std::map<DscpType, uint32_t> > dscpCounts;   //!< DSCP counts of each flow
+    FlowId lastFlowId;                                            //!< Last assigned FlowId
+  };
+
+  /**
+   * Creates the payload of a packet.
+   * \param sourcePort the source port
+   * \param destinationPort the destination port
+   * \returns the payload, starting with the ports
+   */
+  static Ptr<Packet> CreatePayload (uint16_t sourcePort, uint16_t destinationPort);
+
+  /// Checks the IPv4 classifier
+  void CheckIpv4 (void);
+  /// Checks the IPv6 classifier
+  void CheckIpv6 (void);
+
+  static const uint32_t N_FLOWS = 12;    //!< Number of flows
+  static const uint32_t N_PACKETS = 600; //!< Number of packets
+};
+
+FlowMonitorClassifierTestCase::FlowMonitorClassifierTestCase ()
+  : TestCase ("Check the FlowIds and packet ids of the flow classifiers")
+{}
+
+FlowMonitorClassifierTestCase::~FlowMonitorClassifierTestCase ()
+{}
+
+Ptr<Packet>
+FlowMonitorClassifierTestCase::CreatePayload (uint16_t sourcePort, uint16_t destinationPort)
+{
+  uint8_t data[8] = { static_cast<uint8_t> (sourcePort >> 8), static_cast<uint8_t> (sourcePort),
+                      static_cast<uint8_t> (destinationPort >> 8), static_cast<uint8_t> (destinationPort),
+                      0, 0, 0, 0 };
+  return Create<Packet> (data, 8);
+}
+
+void
+FlowMonitorClassifierTestCase::CheckIpv4 (void)
+{
+  Ipv4FlowClassifier classifier;
+  ReferenceClassifier<Ipv4FlowClassifier::FiveTuple, Ipv4Header::DscpType> reference;
+
+  for (uint32_t k = 0; k < N_PACKETS; k++)
+    {
+      // An irregular sequence of flows, whose five-tuples vary in every field
+      uint32_t i = (k * (k + 1) / 2 + k / 5) % N_FLOWS;
+      Ipv4FlowClassifier::FiveTuple tuple;
+      tuple.sourceAddress = Ipv4Address (0x0a000001 + i % 3);
+      tuple.destinationAddress = Ipv4Address (0x0a000101 + i % 2);
+      tuple.protocol = (i % 4 < 2) ? 17 : 6;
+      tuple.sourcePort = 1000 + i / 2;
+      tuple.destinationPort = 9 + i % 5;
+      Ipv4Header::DscpType dscp = (k % 3) ? Ipv4Header::DscpDefault : Ipv4Header::DSCP_AF11;
+
+      Ipv4Header header;
+      header.SetSource (tuple.sourceAddress);
+      header.SetDestination (tuple.destinationAddress);
+      header.SetProtocol (tuple.protocol);
+      header.SetDscp (dscp);
+      Ptr<Packet> payload = CreatePayload (tuple.sourcePort, tuple.destinationPort);
+      uint32_t flowId;
+      uint32_t packetId;
+
+      if (k % 25 == 0)
+        {
+          Ipv4Header icmp = header;
+          icmp.SetProtocol (1);
+          NS_TEST_EXPECT_MSG_EQ (classifier.Classify (icmp, payload, &flowId, &packetId), false,
+                                 "ICMP packet classified");
+          Ipv4Header fragment = header;
+          fragment.SetFragmentOffset (8);
+          NS_TEST_EXPECT_MSG_EQ (classifier.Classify (fragment, payload, &flowId, &packetId), false,
+                                 "Non-first fragment classified");
+        }
+
+      NS_TEST_ASSERT_MSG_EQ (classifier.Classify (header, payload, &flowId, &packetId), true,
+                             "Packet " << k << " not classified");
+      FlowId expectedFlowId;
+      FlowPacketId expectedPacketId;
+      reference.Classify (tuple, dscp, &expectedFlowId, &expectedPacketId);
+      NS_TEST_EXPECT_MSG_EQ (flowId, expectedFlowId, "FlowId of packet " << k);
+      NS_TEST_EXPECT_MSG_EQ (packetId, expectedPacketId, "Packet id of packet " << k);
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (reference.flows.size (), N_FLOWS, "Wrong number of flows");
+  for (std::map<Ipv4FlowClassifier::FiveTuple, FlowId>::const_iterator i = reference.flows.begin ();
+       i != reference.flows.end (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((classifier.FindFlow (i->second) == i->first), true,
+                             "FindFlow (" << i->second << ") returns another five-tuple");
+      std::vector<std::pair<Ipv4Header::DscpType, uint32_t> > counts = classifier.GetDscpCounts (i->second);
+      std::map<Ipv4Header::DscpType, uint32_t> countMap (counts.begin (), counts.end ());
+      NS_TEST_EXPECT_MSG_EQ ((countMap == reference.dscpCounts[i->second]), true,
+                             "GetDscpCounts (" << i->second << ") does not match");
+    }
+}
+
+void
+FlowMonitorClassifierTestCase::CheckIpv6 (void)
+{
+  Ipv6FlowClassifier classifier;
+  ReferenceClassifier<Ipv6FlowClassifier::FiveTuple, Ipv6Header::DscpType> reference;
+
+  for (uint32_t k = 0; k < N_PACKETS; k++)
+    {
+      // An irregular sequence of flows, whose five-tuples vary in every field
+      uint32_t i = (k * (k + 1) / 2 + k / 5) % N_FLOWS;
+      std::ostringstream source;
+      source << "2001:db8::" << 1 + i % 3;
+      std::ostringstream destination;
+      destination << "2001:db8:1::" << 1 + i % 2;
+      Ipv6FlowClassifier::FiveTuple tuple;
+      tuple.sourceAddress = Ipv6Address (source.str ().c_str ());
+      tuple.destinationAddress = Ipv6Address (destination.str ().c_str ());
+      tuple.protocol = (i % 4 < 2) ? 17 : 6;
+      tuple.sourcePort = 1000 + i / 2;
+      tuple.destinationPort = 9 + i % 5;
+      Ipv6Header::DscpType dscp = (k % 3) ? Ipv6Header::DscpDefault : Ipv6Header::DSCP_AF11;
+
+      Ipv6Header header;
+      header.SetSourceAddress (tuple.sourceAddress);
+      header.SetDestinationAddress (tuple.destinationAddress);
+      header.SetNextHeader (tuple.protocol);
+      header.SetDscp (dscp);
+      Ptr<Packet> payload = CreatePayload (tuple.sourcePort, tuple.destinationPort);
+      uint32_t flowId;
+      uint32_t packetId;
+
+      if (k % 25 == 0)
+        {
+          Ipv6Header icmp = header;
+          icmp.SetNextHeader (58);
+          NS_TEST_EXPECT_MSG_EQ (classifier.Classify (icmp, payload, &flowId, &packetId), false,
+                                 "ICMPv6 packet classified");
+          Ipv6Header multicast = header;
+          multicast.SetDestinationAddress (Ipv6Address ("ff02::1"));
+          NS_TEST_EXPECT_MSG_EQ (classifier.Classify (multicast, payload, &flowId, &packetId), false,
+                                 "Multicast packet classified");
+        }
+
+      NS_TEST_ASSERT_MSG_EQ (classifier.Classify (header, payload, &flowId, &packetId), true,
+                             "Packet " << k << " not classified");
+      FlowId expectedFlowId;
+      FlowPacketId expectedPacketId;
+      reference.Classify (tuple, dscp, &expectedFlowId, &expectedPacketId);
+      NS_TEST_EXPECT_MSG_EQ (flowId, expectedFlowId, "FlowId of packet " << k);
+      NS_TEST_EXPECT_MSG_EQ (packetId, expectedPacketId, "Packet id of packet " << k);
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (reference.flows.size (), N_FLOWS, "Wrong number of flows");
+  for (std::map<Ipv6FlowClassifier::FiveTuple, FlowId>::const_iterator i = reference.flows.begin ();
+       i != reference.flows.end (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((classifier.FindFlow (i->second) == i->first), true,
+                             "FindFlow (" << i->second << ") returns another five-tuple");
+      std::vector<std::pair<Ipv6Header::DscpType, uint32_t> > counts = classifier.GetDscpCounts (i->second);
+      std::map<Ipv6Header::DscpType, uint32_t> countMap (counts.begin (), counts.end ());
+      NS_TEST_EXPECT_MSG_EQ ((countMap == reference.dscpCounts[i->second]), true,
+                             "GetDscpCounts (" << i->second << ") does not match");
+    }
+}
+
+void
+FlowMonitorClassifierTestCase::DoRun (void)
+{
+  CheckIpv4 ();
+  CheckIpv6 ();
+}
+
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor TestSuite
+ */
+class FlowMonitorTestSuite : public TestSuite
+{
+public:
+  FlowMonitorTestSuite ();
+};
+
+FlowMonitorTestSuite::FlowMonitorTestSuite ()
+  : TestSuite ("flow-monitor", UNIT)
+{
+  AddTestCase (new FlowMonitorStreamingTestCase, TestCase::QUICK);
+  AddTestCase (new FlowMonitorSamplingTestCase, TestCase::QUICK);
+  AddTestCase (new FlowMonitorClassifierTestCase, TestCase::QUICK);
+}
+
+static FlowMonitorTestSuite g_flowMonitorTestSuite; //!< Static variable for test initialization
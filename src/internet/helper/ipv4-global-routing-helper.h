@@ -82,6 +82,10 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * If the GlobalRoutingIncremental global value is set and only link
+   * metrics changed since the last computation, only the routes of the
+   * nodes whose shortest paths may use one of the modified links are
+   * recomputed.
    */
   static void RecomputeRoutingTables (void);
 private:
@@ -34,6 +34,15 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
+#include "ns3/simulator.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
 #include "global-router-interface.h"
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
@@ -43,6 +52,25 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \ingroup globalrouting
+ * \brief Number of threads running the SPF calculations.
+ */
+static GlobalValue g_globalRoutingThreads = GlobalValue ("GlobalRoutingThreads",
+                                                         "The number of threads computing the global routes of the nodes",
+                                                         UintegerValue (1),
+                                                         MakeUintegerChecker<uint32_t> (1));
+
+/**
+ * \ingroup globalrouting
+ * \brief Keep the SPF distances to recompute only the affected nodes
+ * after link metric changes.
+ */
+static GlobalValue g_globalRoutingIncremental = GlobalValue ("GlobalRoutingIncremental",
+                                                             "Recompute only the global routes affected by link metric changes",
+                                                             BooleanValue (false),
+                                                             MakeBooleanChecker ());
+
 /**
  * \brief Stream insertion operator.
  *
@@ -91,9 +119,9 @@ SPFVertex::SPFVertex () :
   m_distanceFromRoot (SPF_INFINITY), 
   m_rootOif (SPF_INFINITY),
   m_nextHop ("0.0.0.0"),
+  m_vertexProcessed (false),
   m_parents (),
-  m_children (),
-  m_vertexProcessed (false)
+  m_children ()
 {
   NS_LOG_FUNCTION (this);
 }
@@ -104,9 +132,9 @@ SPFVertex::SPFVertex (GlobalRoutingLSA* lsa) :
   m_distanceFromRoot (SPF_INFINITY), 
   m_rootOif (SPF_INFINITY),
   m_nextHop ("0.0.0.0"),
+  m_vertexProcessed (false),
   m_parents (),
-  m_children (),
-  m_vertexProcessed (false)
+  m_children ()
 {
   NS_LOG_FUNCTION (this << lsa);
 
@@ -138,9 +166,10 @@ SPFVertex::~SPFVertex ()
       // remove the current vertex from its parent's children list. Check
       // if the size of the list is reduced, or the child<->parent relation
       // is not bidirectional
-      uint32_t orgCount = (*piter)->m_children.size ();
-      (*piter)->m_children.remove (this);
-      uint32_t newCount = (*piter)->m_children.size ();
+      ListOfSPFVertex_t &siblings = (*piter)->m_children;
+      uint32_t orgCount = siblings.size ();
+      siblings.erase (std::remove (siblings.begin (), siblings.end (), this), siblings.end ());
+      uint32_t newCount = siblings.size ();
       if (orgCount > newCount)
         {
           NS_ASSERT_MSG (orgCount > newCount, "Unable to find the current vertex from its parents --- impossible!");
@@ -250,12 +279,7 @@ SPFVertex::GetParent (uint32_t i) const
       NS_LOG_LOGIC ("Index to SPFVertex's parent is out-of-range.");
       return 0;
     }
-  ListOfSPFVertex_t::const_iterator iter = m_parents.begin ();
-  while (i-- > 0) 
-    {
-      iter++;
-    }
-  return *iter;
+  return m_parents[i];
 }
 
 void 
@@ -268,8 +292,8 @@ SPFVertex::MergeParent (const SPFVertex* v)
   m_parents.insert (m_parents.end (), 
                     v->m_parents.begin (), v->m_parents.end ());
   // remove duplication
-  m_parents.sort ();
-  m_parents.unique ();
+  std::sort (m_parents.begin (), m_parents.end ());
+  m_parents.erase (std::unique (m_parents.begin (), m_parents.end ()), m_parents.end ());
   NS_LOG_LOGIC ("After merge, list of parents = " << m_parents);
 }
 
@@ -298,13 +322,9 @@ SPFVertex::NodeExit_t
 SPFVertex::GetRootExitDirection (uint32_t i) const
 {
   NS_LOG_FUNCTION (this << i);
-  typedef ListOfNodeExit_t::const_iterator CIter_t;
 
   NS_ASSERT_MSG (i < m_ecmpRootExits.size (), "Index out-of-range when accessing SPFVertex::m_ecmpRootExits!");
-  CIter_t iter = m_ecmpRootExits.begin ();
-  while (i-- > 0) { iter++; }
-
-  return *iter;
+  return m_ecmpRootExits[i];
 }
 
 SPFVertex::NodeExit_t 
@@ -327,8 +347,9 @@ SPFVertex::MergeRootExitDirections (const SPFVertex* vertex)
   const ListOfNodeExit_t& extList = vertex->m_ecmpRootExits;
   m_ecmpRootExits.insert (m_ecmpRootExits.end (), 
                           extList.begin (), extList.end ());
-  m_ecmpRootExits.sort ();
-  m_ecmpRootExits.unique ();
+  std::sort (m_ecmpRootExits.begin (), m_ecmpRootExits.end ());
+  m_ecmpRootExits.erase (std::unique (m_ecmpRootExits.begin (), m_ecmpRootExits.end ()),
+                         m_ecmpRootExits.end ());
 }
 
 void 
@@ -365,19 +386,8 @@ SPFVertex*
 SPFVertex::GetChild (uint32_t n) const
 {
   NS_LOG_FUNCTION (this << n);
-  uint32_t j = 0;
-
-  for ( ListOfSPFVertex_t::const_iterator i = m_children.begin ();
-        i != m_children.end ();
-        i++, j++)
-    {
-      if (j == n)
-        {
-          return *i;
-        }
-    }
-  NS_ASSERT_MSG (false, "Index <n> out of range.");
-  return 0;
+  NS_ASSERT_MSG (n < m_children.size (), "Index <n> out of range.");
+  return m_children[n];
 }
 
 uint32_t
@@ -422,6 +432,7 @@ SPFVertex::ClearVertexProcessed (void)
 GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
   :
     m_database (),
+    m_linkData (),
     m_extdatabase ()
 {
   NS_LOG_FUNCTION (this);
@@ -430,12 +441,10 @@ GlobalRouteManagerLSDB::GlobalRouteManagerLSDB ()
 GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
 {
   NS_LOG_FUNCTION (this);
-  LSDBMap_t::iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  for (uint32_t i = 0; i < m_lsas.size (); i++)
     {
       NS_LOG_LOGIC ("free LSA");
-      GlobalRoutingLSA* temp = i->second;
-      delete temp;
+      delete m_lsas[i];
     }
   for (uint32_t j = 0; j < m_extdatabase.size (); j++)
     {
@@ -445,17 +454,17 @@ GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
     }
   NS_LOG_LOGIC ("clear map");
   m_database.clear ();
+  m_linkData.clear ();
+  m_lsas.clear ();
 }
 
 void
 GlobalRouteManagerLSDB::Initialize ()
 {
   NS_LOG_FUNCTION (this);
-  LSDBMap_t::iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  for (uint32_t i = 0; i < m_lsas.size (); i++)
     {
-      GlobalRoutingLSA* temp = i->second;
-      temp->SetStatus (GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
+      m_lsas[i]->SetStatus (GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
     }
 }
 
@@ -467,9 +476,17 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
     {
       m_extdatabase.push_back (lsa);
     } 
-  else
+  else if (m_database.insert (LSDBPair_t (addr.Get (), m_lsas.size ())).second)
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              m_linkData.insert (LSDBPair_t (lr->GetLinkData ().Get (), m_lsas.size ()));
+            }
+        }
+      m_lsas.push_back (lsa);
     }
 }
 
@@ -487,6 +504,44 @@ GlobalRouteManagerLSDB::GetNumExtLSAs () const
   return m_extdatabase.size ();
 }
 
+int32_t
+GlobalRouteManagerLSDB::GetIndex (Ipv4Address addr) const
+{
+  NS_LOG_FUNCTION (this << addr);
+  LSDBMap_t::const_iterator i = m_database.find (addr.Get ());
+  if (i == m_database.end ())
+    {
+      return -1;
+    }
+  return i->second;
+}
+
+int32_t
+GlobalRouteManagerLSDB::GetIndexByLinkData (Ipv4Address addr) const
+{
+  NS_LOG_FUNCTION (this << addr);
+  LSDBMap_t::const_iterator i = m_linkData.find (addr.Get ());
+  if (i == m_linkData.end ())
+    {
+      return -1;
+    }
+  return i->second;
+}
+
+GlobalRoutingLSA*
+GlobalRouteManagerLSDB::GetLSAByIndex (uint32_t index) const
+{
+  NS_LOG_FUNCTION (this << index);
+  return m_lsas.at (index);
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetNumLSAs () const
+{
+  NS_LOG_FUNCTION (this);
+  return m_lsas.size ();
+}
+
 GlobalRoutingLSA*
 GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 {
@@ -494,15 +549,12 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  int32_t index = GetIndex (addr);
+  if (index < 0)
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return 0;
     }
-  return 0;
+  return m_lsas[index];
 }
 
 GlobalRoutingLSA*
@@ -510,24 +562,14 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the link data of one of its transit network records.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  int32_t index = GetIndexByLinkData (addr);
+  if (index < 0)
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
-        {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
-            {
-              return temp;
-            }
-        }
+      return 0;
     }
-  return 0;
+  return m_lsas[index];
 }
 
 // ---------------------------------------------------------------------------
@@ -538,16 +580,42 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_lsdb (new GlobalRouteManagerLSDB ()),
+    m_ownsLsdb (true),
+    m_spfrootRouting (0),
+    m_spfrootIpv4 (0),
+    m_spfDistances (0),
+    m_incremental (false),
+    m_statistics (),
+    m_workRoots (0),
+    m_workList (0),
+    m_workNext (0)
 {
   NS_LOG_FUNCTION (this);
-  m_lsdb = new GlobalRouteManagerLSDB ();
+}
+
+GlobalRouteManagerImpl::GlobalRouteManagerImpl (GlobalRouteManagerLSDB* lsdb)
+  :
+    m_spfroot (0),
+    m_lsdb (lsdb),
+    m_ownsLsdb (false),
+    m_spfrootRouting (0),
+    m_spfrootIpv4 (0),
+    m_spfDistances (0),
+    m_incremental (false),
+    m_statistics (),
+    m_workRoots (0),
+    m_workList (0),
+    m_workNext (0)
+{
+  NS_LOG_FUNCTION (this << lsdb);
 }
 
 GlobalRouteManagerImpl::~GlobalRouteManagerImpl ()
 {
   NS_LOG_FUNCTION (this);
-  if (m_lsdb)
+  if (m_lsdb && m_ownsLsdb)
     {
       delete m_lsdb;
     }
@@ -566,6 +634,20 @@ GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
 
 void
 GlobalRouteManagerImpl::DeleteGlobalRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  DeleteRoutes ();
+  m_roots.clear ();
+  if (m_lsdb)
+    {
+      NS_LOG_LOGIC ("Deleting LSDB, creating new one");
+      delete m_lsdb;
+      m_lsdb = new GlobalRouteManagerLSDB ();
+    }
+}
+
+void
+GlobalRouteManagerImpl::DeleteRoutes (void)
 {
   NS_LOG_FUNCTION (this);
   NodeList::Iterator listEnd = NodeList::End ();
@@ -591,12 +673,6 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
         }
       NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
     }
-  if (m_lsdb)
-    {
-      NS_LOG_LOGIC ("Deleting LSDB, creating new one");
-      delete m_lsdb;
-      m_lsdb = new GlobalRouteManagerLSDB ();
-    }
 }
 
 //
@@ -612,6 +688,8 @@ void
 GlobalRouteManagerImpl::BuildGlobalRoutingDatabase () 
 {
   NS_LOG_FUNCTION (this);
+  SystemWallClockMs clock;
+  clock.Start ();
 //
 // Walk the list of nodes looking for the GlobalRouter Interface.  Nodes with
 // global router interfaces are, not too surprisingly, our routers.
@@ -656,6 +734,9 @@ GlobalRouteManagerImpl::BuildGlobalRoutingDatabase ()
           m_lsdb->Insert (lsa->GetLinkStateId (), lsa); 
         }
     }
+  m_statistics.lsdbMs = clock.End ();
+  NS_LOG_INFO ("Built a database of " << m_lsdb->GetNumLSAs () << " LSAs and " <<
+               m_lsdb->GetNumExtLSAs () << " external LSAs in " << m_statistics.lsdbMs << " ms");
 }
 
 //
@@ -695,10 +776,85 @@ void
 GlobalRouteManagerImpl::InitializeRoutes ()
 {
   NS_LOG_FUNCTION (this);
+  BooleanValue incremental;
+  g_globalRoutingIncremental.GetValue (incremental);
+  m_incremental = incremental.Get ();
+  CollectRoots ();
+  std::vector<uint32_t> roots;
+  for (uint32_t i = 0; i < m_roots.size (); i++)
+    {
+      roots.push_back (i);
+    }
+  NS_LOG_INFO ("About to start SPF calculation");
+  CalculateRoots (roots);
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+void
+GlobalRouteManagerImpl::UpdateRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  BooleanValue incremental;
+  g_globalRoutingIncremental.GetValue (incremental);
+  if (!incremental.Get () || !m_incremental || m_roots.empty ())
+    {
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+//
+// Keep the previous database to find out what changed.  The distances
+// recorded by the previous calculation are indexed by LSA, so any change
+// other than link metrics requires a full recomputation.
+//
+  GlobalRouteManagerLSDB* previous = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  std::vector<MetricChange> changes;
+  bool metricsOnly = FindMetricChanges (previous, changes);
+  delete previous;
+  if (!metricsOnly)
+    {
+      NS_LOG_INFO ("Topology changed, recomputing all the routes");
+      DeleteRoutes ();
+      InitializeRoutes ();
+      return;
+    }
+  std::vector<uint32_t> affected;
+  for (uint32_t i = 0; i < m_roots.size (); i++)
+    {
+      if (IsAffected (m_roots[i], changes))
+        {
+          Ptr<Ipv4GlobalRouting> gr = m_roots[i].routing;
+          while (gr->GetNRoutes () > 0)
+            {
+              gr->RemoveRoute (0);
+            }
+          affected.push_back (i);
+        }
+    }
+  NS_LOG_INFO (changes.size () << " link metrics changed, recomputing " <<
+               affected.size () << " of " << m_roots.size () << " routers");
+  CalculateRoots (affected);
+}
+
+GlobalRouteManager::Statistics
+GlobalRouteManagerImpl::GetStatistics (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_statistics;
+}
+
+void
+GlobalRouteManagerImpl::CollectRoots (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_roots.clear ();
 //
 // Walk the list of nodes in the system.
 //
-  NS_LOG_INFO ("About to start SPF calculation");
+  uint32_t systemId = Simulator::GetSystemId ();
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -710,7 +866,6 @@ GlobalRouteManagerImpl::InitializeRoutes ()
       Ptr<GlobalRouter> rtr = 
         node->GetObject<GlobalRouter> ();
 
-      uint32_t systemId = Simulator::GetSystemId ();
       // Ignore nodes that are not assigned to our systemId (distributed sim)
       if (node->GetSystemId () != systemId) 
         {
@@ -723,10 +878,224 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          SPFRoot root;
+          root.routerId = rtr->GetRouterId ();
+          root.routing = rtr->GetRoutingProtocol ();
+          root.ipv4 = node->GetObject<Ipv4> ();
+          m_roots.push_back (root);
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+//
+// The SPF calculations of different roots only share the (read-only)
+// LSDB: the SPF status of the LSAs is kept per calculation, and every
+// root installs routes in its own Ipv4GlobalRouting.  The roots are
+// handed out to the threads one at a time; the calling thread takes part
+// with its own state, and each additional thread gets a worker
+// GlobalRouteManagerImpl sharing the LSDB.  The routes of a root do not
+// depend on the number of threads.
+//
+// The workers only use the raw pointers resolved by CollectRoots (), so
+// that no reference count is touched concurrently.
+//
+void
+GlobalRouteManagerImpl::CalculateRoots (const std::vector<uint32_t> &roots)
+{
+  NS_LOG_FUNCTION (this << roots.size ());
+  SystemWallClockMs clock;
+  clock.Start ();
+  UintegerValue threads;
+  g_globalRoutingThreads.GetValue (threads);
+  uint32_t nThreads = std::max<uint32_t> (1, std::min<uint32_t> (threads.Get (), roots.size ()));
+#ifndef HAVE_PTHREAD_H
+  nThreads = 1;
+#endif
+
+  std::atomic<uint32_t> next (0);
+  m_workRoots = &m_roots;
+  m_workList = &roots;
+  m_workNext = &next;
+#ifdef HAVE_PTHREAD_H
+  std::vector<GlobalRouteManagerImpl*> workers;
+  std::vector<Ptr<SystemThread> > workerThreads;
+  for (uint32_t i = 1; i < nThreads; i++)
+    {
+      GlobalRouteManagerImpl* worker = new GlobalRouteManagerImpl (m_lsdb);
+      worker->m_incremental = m_incremental;
+      worker->m_workRoots = &m_roots;
+      worker->m_workList = &roots;
+      worker->m_workNext = &next;
+      workers.push_back (worker);
+      workerThreads.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::SPFWorker, worker)));
+      workerThreads.back ()->Start ();
+    }
+#endif
+  SPFWorker ();
+#ifdef HAVE_PTHREAD_H
+  for (uint32_t i = 0; i < workers.size (); i++)
+    {
+      workerThreads[i]->Join ();
+      delete workers[i];
+    }
+#endif
+  m_workRoots = 0;
+  m_workList = 0;
+  m_workNext = 0;
+
+  m_statistics.spfMs = clock.End ();
+  m_statistics.nRouters = m_roots.size ();
+  m_statistics.nCalculated = roots.size ();
+  m_statistics.nThreads = nThreads;
+  NS_LOG_INFO ("Computed the routes of " << roots.size () << " of " << m_roots.size () <<
+               " routers with " << nThreads << " threads in " << m_statistics.spfMs << " ms");
+}
+
+void
+GlobalRouteManagerImpl::SPFWorker (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (;;)
+    {
+      uint32_t i = m_workNext->fetch_add (1, std::memory_order_relaxed);
+      if (i >= m_workList->size ())
+        {
+          break;
+        }
+      SPFCalculate ((*m_workRoots)[(*m_workList)[i]]);
+    }
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculate (SPFRoot &root)
+{
+  NS_LOG_FUNCTION (this << root.routerId);
+  m_spfrootRouting = PeekPointer (root.routing);
+  m_spfrootIpv4 = PeekPointer (root.ipv4);
+  m_spfDistances = 0;
+  root.distances.clear ();
+  if (m_incremental)
+    {
+      root.distances.resize (m_lsdb->GetNumLSAs (), SPF_INFINITY);
+      m_spfDistances = &root.distances;
+    }
+  SPFCalculate (root.routerId);
+  m_spfrootRouting = 0;
+  m_spfrootIpv4 = 0;
+  m_spfDistances = 0;
+}
+
+bool
+GlobalRouteManagerImpl::FindMetricChanges (const GlobalRouteManagerLSDB* previous,
+                                           std::vector<MetricChange> &changes) const
+{
+  NS_LOG_FUNCTION (this << previous);
+  if (previous->GetNumLSAs () != m_lsdb->GetNumLSAs ()
+      || previous->GetNumExtLSAs () != m_lsdb->GetNumExtLSAs ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < m_lsdb->GetNumLSAs (); i++)
+    {
+      GlobalRoutingLSA* a = previous->GetLSAByIndex (i);
+      GlobalRoutingLSA* b = m_lsdb->GetLSAByIndex (i);
+      if (a->GetLSType () != b->GetLSType ()
+          || a->GetLinkStateId () != b->GetLinkStateId ()
+          || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+          || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+          || a->GetNAttachedRouters () != b->GetNAttachedRouters ()
+          || a->GetNLinkRecords () != b->GetNLinkRecords ())
+        {
+          return false;
+        }
+      for (uint32_t j = 0; j < a->GetNAttachedRouters (); j++)
+        {
+          if (a->GetAttachedRouter (j) != b->GetAttachedRouter (j))
+            {
+              return false;
+            }
+        }
+      for (uint32_t j = 0; j < a->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord* la = a->GetLinkRecord (j);
+          GlobalRoutingLinkRecord* lb = b->GetLinkRecord (j);
+          if (la->GetLinkType () != lb->GetLinkType ()
+              || la->GetLinkId () != lb->GetLinkId ()
+              || la->GetLinkData () != lb->GetLinkData ())
+            {
+              return false;
+            }
+          // Stub metrics are not used by the route calculation.
+          if (la->GetMetric () == lb->GetMetric ()
+              || la->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              continue;
+            }
+          int32_t to = m_lsdb->GetIndex (lb->GetLinkId ());
+          if (to < 0)
+            {
+              return false;
+            }
+          MetricChange change;
+          change.from = i;
+          change.to = to;
+          change.metric = std::min (la->GetMetric (), lb->GetMetric ());
+          changes.push_back (change);
+        }
+    }
+  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
+    {
+      GlobalRoutingLSA* a = previous->GetExtLSA (i);
+      GlobalRoutingLSA* b = m_lsdb->GetExtLSA (i);
+      if (a->GetLinkStateId () != b->GetLinkStateId ()
+          || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+          || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+//
+// A link from <from> to <to> can only be on a shortest path of the root,
+// before or after the change, if the path through the link with the
+// smaller of the two metrics is no longer than the previous distance to
+// <to>.  Otherwise, neither the distances nor the equal-cost next hops of
+// the root change.
+//
+bool
+GlobalRouteManagerImpl::IsAffected (const SPFRoot &root, const std::vector<MetricChange> &changes)
+{
+  if (root.distances.empty ())
+    {
+      return true;
+    }
+  for (std::vector<MetricChange>::const_iterator i = changes.begin (); i != changes.end (); i++)
+    {
+      uint64_t from = root.distances[i->from];
+      if (from == SPF_INFINITY)
+        {
+          continue;
+        }
+      if (from + i->metric <= root.distances[i->to])
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+GlobalRoutingLSA::SPFStatus
+GlobalRouteManagerImpl::GetStatus (uint32_t index) const
+{
+  return static_cast<GlobalRoutingLSA::SPFStatus> (m_workspace.status[index]);
+}
+
+void
+GlobalRouteManagerImpl::SetStatus (uint32_t index, GlobalRoutingLSA::SPFStatus status)
+{
+  m_workspace.status[index] = status;
 }
 
 //
@@ -749,6 +1118,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
   SPFVertex* w = 0;
   GlobalRoutingLSA* w_lsa = 0;
+  int32_t w_index = -1;
   GlobalRoutingLinkRecord *l = 0;
   uint32_t distance = 0;
   uint32_t numRecordsInVertex = 0;
@@ -796,16 +1166,18 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // Lookup the link state advertisement of the new link -- we call it <w> in
 // the link state database.
 //
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
+              w_index = m_lsdb->GetIndex (l->GetLinkId ());
+              NS_ASSERT (w_index >= 0);
+              w_lsa = m_lsdb->GetLSAByIndex (w_index);
               NS_LOG_LOGIC ("Found a P2P record from " << 
                             v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
             }
           else if (l->GetLinkType () == 
                    GlobalRoutingLinkRecord::TransitNetwork)
             {
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
+              w_index = m_lsdb->GetIndex (l->GetLinkId ());
+              NS_ASSERT (w_index >= 0);
+              w_lsa = m_lsdb->GetLSAByIndex (w_index);
               NS_LOG_LOGIC ("Found a Transit record from " << 
                             v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
             }
@@ -817,12 +1189,13 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // Get w_lsa:  In case of V is Network-LSA
       if (v->GetVertexType () == SPFVertex::VertexNetwork) 
         {
-          w_lsa = m_lsdb->GetLSAByLinkData 
+          w_index = m_lsdb->GetIndexByLinkData 
               (v->GetLSA ()->GetAttachedRouter (i));
-          if (!w_lsa)
+          if (w_index < 0)
             {
               continue;
             }
+          w_lsa = m_lsdb->GetLSAByIndex (w_index);
           NS_LOG_LOGIC ("Found a Network LSA from " << 
                         v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
         }
@@ -835,7 +1208,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If the link is to a router that is already in the shortest path first tree
 // then we have it covered -- ignore it.
 //
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+      if (GetStatus (w_index) == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
         {
           NS_LOG_LOGIC ("Skipping ->  LSA "<< 
                         w_lsa->GetLinkStateId () << " already in SPF tree");
@@ -860,7 +1233,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
       NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
 
 // Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+      if (GetStatus (w_index) == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
 // Calculate nexthop to w
 // We need to figure out how to actually get to the new router represented
@@ -872,7 +1245,8 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
           w = new SPFVertex (w_lsa);
           if (SPFNexthopCalculation (v, w, l, distance))
             {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+              SetStatus (w_index, GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+              m_workspace.candidate[w_index] = w;
 //
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
@@ -887,7 +1261,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (GetStatus (w_index) == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -902,8 +1276,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 * with the cost we just determined (w->distance) to see
 * if we've found a shorter path.
 */
-          SPFVertex* cw;
-          cw = candidate.Find (w_lsa->GetLinkStateId ());
+          SPFVertex* cw = m_workspace.candidate[w_index];
           if (cw->GetDistanceFromRoot () < distance)
             {
 //
@@ -1246,7 +1619,31 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
+  FindRoot (root);
   SPFCalculate (root);
+  m_spfrootRouting = 0;
+  m_spfrootIpv4 = 0;
+}
+
+void
+GlobalRouteManagerImpl::FindRoot (Ipv4Address root)
+{
+  NS_LOG_FUNCTION (this << root);
+  m_spfrootRouting = 0;
+  m_spfrootIpv4 = 0;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr != 0 && rtr->GetRouterId () == root)
+        {
+          m_spfrootRouting = PeekPointer (rtr->GetRoutingProtocol ());
+          m_spfrootIpv4 = PeekPointer (node->GetObject<Ipv4> ());
+          return;
+        }
+    }
+  NS_LOG_LOGIC ("Can't find root node " << root);
 }
 
 //
@@ -1319,11 +1716,8 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-                  NS_ASSERT (gr);
-                  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
+                  NS_ASSERT (m_spfrootRouting);
+                  m_spfrootRouting->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
                                          FindOutgoingInterfaceId (transitLink->GetLinkData ()));
                   NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
                                 lr->GetLinkData () << " via interface " << 
@@ -1344,9 +1738,12 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 
   SPFVertex *v;
 //
-// Initialize the Link State Database.
+// Initialize the SPF status of the Link State Advertisements.  The vertex
+// of an LSA on the candidate list is only looked at while the status of
+// the LSA says so.
 //
-  m_lsdb->Initialize ();
+  m_workspace.status.assign (m_lsdb->GetNumLSAs (), GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
+  m_workspace.candidate.resize (m_lsdb->GetNumLSAs ());
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1359,14 +1756,20 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // calculation.  Each router (and corresponding network) is a vertex in the
 // shortest path first (SPF) tree.
 //
-  v = new SPFVertex (m_lsdb->GetLSA (root));
+  int32_t index = m_lsdb->GetIndex (root);
+  NS_ASSERT_MSG (index >= 0, "No LSA for root " << root);
+  v = new SPFVertex (m_lsdb->GetLSAByIndex (index));
 // 
 // This vertex is the root of the SPF tree and it is distance 0 from the root.
 // We also mark this vertex as being in the SPF tree.
 //
   m_spfroot= v;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  SetStatus (index, GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  if (m_spfDistances)
+    {
+      (*m_spfDistances)[index] = 0;
+    }
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
 
 //
@@ -1379,7 +1782,12 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
   if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
+      if (m_spfDistances)
+        {
+          m_spfDistances->clear ();
+        }
       delete m_spfroot;
+      m_spfroot = 0;
       return;
     }
 
@@ -1427,7 +1835,12 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      index = m_lsdb->GetIndex (v->GetVertexId ());
+      SetStatus (index, GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      if (m_spfDistances)
+        {
+          (*m_spfDistances)[index] = v->GetDistanceFromRoot ();
+        }
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1559,108 +1972,51 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
+// The routing protocol of the node at the root of the SPF tree was looked
+// up before starting the calculation.  This is the one we're going to write
 // the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrootRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
+      NS_LOG_LOGIC ("No GlobalRouter interface on root " << routerId);
+      return;
+    }
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFAddASExternal (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+//
+// The vertex <v> has the next hop addresses and outbound interfaces the
+// root node should use to reach the router advertising the external
+// network.
+//
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
+          m_spfrootRouting->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
-
 // Processing logic from RFC 2328, page 166 and quagga ospf_spf_process_stubs ()
 // stub link records will exist for point-to-point interfaces and for
 // broadcast interfaces for which no neighboring router can be found
@@ -1719,116 +2075,51 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
   NS_LOG_LOGIC ("Stub is on remote host: " << v->GetVertexId () << "; installing");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  Its routing protocol
+// was looked up before starting the calculation.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrootRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
+      NS_LOG_LOGIC ("No GlobalRouter interface on root " << routerId);
+      return;
+    }
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddStub (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
+//
+// The vertex <v> (corresponding to the node that has the stub network) has
+// the next hop addresses and outbound interfaces precalculated for us that
+// the root node should use to forward packets to the stub network.
+//
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
+          m_spfrootRouting->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
@@ -1843,70 +2134,17 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 {
   NS_LOG_FUNCTION (this << a << amask);
 //
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
-// The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
+// We have an IP address <a> and the IPv4 stack of the root of the SPF tree,
+// looked up before starting the calculation.  Look through the interfaces
+// of the root for one that has the IP address we're looking for.  If we
+// find one, return the corresponding interface index, or -1 if not found.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrootIpv4 == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
-//
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Look through the interfaces on this node for one that has the IP address
-// we're looking for.  If we find one, return the corresponding interface
-// index, or -1 if not found.
-//
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
-
-#if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
+      NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << m_spfroot->GetVertexId ());
+      return -1;
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+  return m_spfrootIpv4->GetInterfaceForPrefix (a, amask);
 }
 
 //
@@ -1934,69 +2172,29 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  Its routing protocol
+// was looked up before starting the calculation.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrootRouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("No GlobalRouter interface on root " << routerId);
+      return;
+    }
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2005,18 +2203,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Router " << routerId <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2030,44 +2228,31 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              m_spfrootRouting->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                                outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
-//
-// Done adding the routes for the selected node.
-//
-          return;
-        }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
 void
@@ -2079,104 +2264,53 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  Its routing protocol
+// was looked up before starting the calculation.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrootRouting == 0)
     {
-      Ptr<Node> node = *i;
+      NS_LOG_LOGIC ("No GlobalRouter interface on root " << routerId);
+      return;
+    }
 //
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
+// Get the Global Router Link State Advertisement of the transit network
+// we're adding the route to.
+//
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-      if (rtr == 0)
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
+          m_spfrootRouting->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
         }
-    } 
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
@@ -26,11 +26,14 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <unordered_map>
 #include <vector>
+#include <atomic>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
 #include "global-router-interface.h"
+#include "global-route-manager.h"
 
 namespace ns3 {
 
@@ -38,6 +41,7 @@ const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
 class Ipv4GlobalRouting;
+class Ipv4;
 
 /**
  * \ingroup globalrouting
@@ -532,12 +536,12 @@ private:
   uint32_t m_distanceFromRoot; //!< Distance from root node
   int32_t m_rootOif; //!< root Output Interface
   Ipv4Address m_nextHop; //!< next hop
-  typedef std::list< NodeExit_t > ListOfNodeExit_t; //!< container of Exit nodes
+  bool m_vertexProcessed; //!< Flag to note whether vertex has been processed in stage two of SPF computation
+  typedef std::vector< NodeExit_t > ListOfNodeExit_t; //!< container of Exit nodes
   ListOfNodeExit_t m_ecmpRootExits; //!< store the multiple root's exits for supporting ECMP
-  typedef std::list<SPFVertex*> ListOfSPFVertex_t; //!< container of SPFVertexes
+  typedef std::vector<SPFVertex*> ListOfSPFVertex_t; //!< container of SPFVertexes
   ListOfSPFVertex_t m_parents; //!< parent list
   ListOfSPFVertex_t m_children; //!< Children list
-  bool m_vertexProcessed; //!< Flag to note whether vertex has been processed in stage two of SPF computation
 
 /**
  * @brief The SPFVertex copy construction is disallowed.  There's no need for
@@ -674,12 +678,48 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+  /**
+   * @brief Get the index of a router or network Link State Advertisement.
+   *
+   * Indices are dense and follow the order in which the LSAs were
+   * inserted, so that the SPF calculation can keep its per-LSA state in
+   * arrays.
+   *
+   * @param addr The link state ID of the LSA.
+   * @returns the index of the LSA, or -1 if there is no such LSA.
+   */
+  int32_t GetIndex (Ipv4Address addr) const;
+  /**
+   * @brief Get the index of the router Link State Advertisement with a
+   * TransitNetwork link record whose link data is the given address.
+   *
+   * @see GetLSAByLinkData
+   * @param addr The link data to look for.
+   * @returns the index of the LSA, or -1 if there is no such LSA.
+   */
+  int32_t GetIndexByLinkData (Ipv4Address addr) const;
+  /**
+   * @brief Get a router or network Link State Advertisement by index.
+   *
+   * @see GetIndex
+   * @param index the index of the LSA.
+   * @returns A pointer to the Link State Advertisement.
+   */
+  GlobalRoutingLSA* GetLSAByIndex (uint32_t index) const;
+  /**
+   * @brief Get the number of router and network Link State Advertisements.
+   *
+   * @returns the number of router and network Link State Advertisements.
+   */
+  uint32_t GetNumLSAs () const;
 
 private:
-  typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
-  typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
+  typedef std::unordered_map<uint32_t, uint32_t> LSDBMap_t; //!< container of IPv4 addresses / LSA indices
+  typedef std::pair<uint32_t, uint32_t> LSDBPair_t; //!< pair of IPv4 addresses / LSA indices
 
-  LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
+  LSDBMap_t m_database; //!< index of the Link State Advertisements by IPv4 address
+  LSDBMap_t m_linkData; //!< index of the router LSAs by the link data of their transit network records
+  std::vector<GlobalRoutingLSA*> m_lsas; //!< router and network Link State Advertisements, in insertion order
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
 /**
@@ -735,6 +775,23 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the per-node forwarding
+ * tables after a topology change.
+ *
+ * Without the GlobalRoutingIncremental global value, this deletes all
+ * the routes and recomputes them from scratch.  With it, when the only
+ * differences with the previous database are link metrics, only the
+ * routers whose shortest paths may go through one of the modified links
+ * are recomputed.
+ */
+  virtual void UpdateRoutes ();
+
+/**
+ * @returns the wall-clock cost of the last route computation
+ */
+  GlobalRouteManager::Statistics GetStatistics (void) const;
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -766,8 +823,114 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+  /// A router whose forwarding table is computed by the route manager.
+  struct SPFRoot
+  {
+    Ipv4Address routerId;            //!< router ID of the root
+    Ptr<Ipv4GlobalRouting> routing;  //!< routing protocol receiving the routes
+    Ptr<Ipv4> ipv4;                  //!< IPv4 stack of the root
+    std::vector<uint32_t> distances; //!< distance to every LSA, kept for incremental updates
+  };
+
+  /// A link whose metric differs between two routing databases.
+  struct MetricChange
+  {
+    uint32_t from;   //!< index of the LSA advertising the link
+    uint32_t to;     //!< index of the LSA at the other end of the link
+    uint32_t metric; //!< smaller of the old and new metrics
+  };
+
+  /**
+   * @brief Create an SPF worker sharing the LSDB of the route manager.
+   * @param lsdb the LSDB, which is not owned by the worker
+   */
+  explicit GlobalRouteManagerImpl (GlobalRouteManagerLSDB* lsdb);
+
+  /**
+   * @brief Delete the routes of all nodes that have a GlobalRouter interface.
+   */
+  void DeleteRoutes (void);
+
+  /**
+   * @brief Collect the routers of this system for which routes are computed.
+   */
+  void CollectRoots (void);
+
+  /**
+   * @brief Run the SPF calculation of a set of roots, spreading them over
+   * GlobalRoutingThreads threads.
+   * @param roots indices in m_roots of the roots to compute
+   */
+  void CalculateRoots (const std::vector<uint32_t> &roots);
+
+  /**
+   * @brief Thread body: run the SPF calculation of the shared roots
+   * until there are none left.
+   */
+  void SPFWorker (void);
+
+  /**
+   * @brief Run the SPF calculation of a root and install its routes.
+   * @param root the root
+   */
+  void SPFCalculate (SPFRoot &root);
+
+  /**
+   * @brief Compare the LSDB with a previous one.
+   * @param previous the previous LSDB
+   * @param changes [out] the links whose metric changed
+   * @returns true if the two databases only differ by link metrics
+   */
+  bool FindMetricChanges (const GlobalRouteManagerLSDB* previous,
+                          std::vector<MetricChange> &changes) const;
+
+  /**
+   * @param root a root computed with incremental updates enabled
+   * @param changes the links whose metric changed
+   * @returns true if a shortest path of the root may go through a changed link
+   */
+  static bool IsAffected (const SPFRoot &root, const std::vector<MetricChange> &changes);
+
+  /**
+   * @param index the LSDB index of a router or network LSA
+   * @returns the SPF status of the LSA in the current calculation
+   */
+  GlobalRoutingLSA::SPFStatus GetStatus (uint32_t index) const;
+
+  /**
+   * @param index the LSDB index of a router or network LSA
+   * @param status the SPF status of the LSA in the current calculation
+   */
+  void SetStatus (uint32_t index, GlobalRoutingLSA::SPFStatus status);
+
+  /**
+   * @brief Per-LSA state of an SPF calculation.
+   *
+   * The arrays are indexed like the LSDB and are reused by the successive
+   * calculations of an engine, so that a calculation allocates nothing
+   * but the vertices of its tree.
+   */
+  struct SPFWorkspace
+  {
+    std::vector<uint8_t> status; //!< SPF status of every LSA
+    std::vector<SPFVertex*> candidate; //!< vertex of every LSA on the candidate list
+  };
+
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  bool m_ownsLsdb; //!< true unless this object is an SPF worker
+  Ipv4GlobalRouting* m_spfrootRouting; //!< routing protocol of the root node
+  Ipv4* m_spfrootIpv4; //!< IPv4 stack of the root node
+  std::vector<uint32_t>* m_spfDistances; //!< distances recorded by the current calculation, if any
+  SPFWorkspace m_workspace; //!< per-LSA state of the current calculation
+
+  std::vector<SPFRoot> m_roots; //!< routers of this system
+  bool m_incremental; //!< true if distances are kept for incremental updates
+  GlobalRouteManager::Statistics m_statistics; //!< cost of the last computation
+
+  std::vector<SPFRoot>* m_workRoots; //!< roots shared by the SPF workers
+  const std::vector<uint32_t>* m_workList; //!< indices of the roots to compute
+  std::atomic<uint32_t>* m_workNext; //!< next entry of m_workList to compute
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -789,6 +952,13 @@ private:
    */
   void SPFCalculate (Ipv4Address root);
 
+  /**
+   * \brief Find the routing protocol and IPv4 stack of a router
+   *
+   * \param root the router ID of the root node
+   */
+  void FindRoot (Ipv4Address root);
+
   /**
    * \brief Process Stub nodes
    *
@@ -58,6 +58,22 @@ GlobalRouteManager::InitializeRoutes (void)
   InitializeRoutes ();
 }
 
+void
+GlobalRouteManager::UpdateGlobalRoutes (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  UpdateRoutes ();
+}
+
+GlobalRouteManager::Statistics
+GlobalRouteManager::GetStatistics (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+         GetStatistics ();
+}
+
 uint32_t
 GlobalRouteManager::AllocateRouterId (void)
 {
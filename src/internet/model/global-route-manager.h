@@ -22,6 +22,8 @@
 #ifndef GLOBAL_ROUTE_MANAGER_H
 #define GLOBAL_ROUTE_MANAGER_H
 
+#include <stdint.h>
+
 namespace ns3 {
 
 /**
@@ -40,6 +42,18 @@ namespace ns3 {
 class GlobalRouteManager
 {
 public:
+/**
+ * @brief Wall-clock cost of the last route computation.
+ */
+  struct Statistics
+  {
+    uint64_t lsdbMs;      //!< time spent building the routing database
+    uint64_t spfMs;       //!< time spent in the SPF calculations
+    uint32_t nRouters;    //!< number of routers of this system
+    uint32_t nCalculated; //!< number of routers whose routes were computed
+    uint32_t nThreads;    //!< number of threads running the SPF calculations
+  };
+
 /**
  * @brief Allocate a 32-bit router ID from monotonically increasing counter.
  * @returns A new new RouterId.
@@ -65,6 +79,20 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the forwarding tables
+ * after a topology change, recomputing only the routers affected by
+ * metric changes if the GlobalRoutingIncremental global value is set.
+ */
+  static void UpdateGlobalRoutes ();
+
+/**
+ * @brief Get the wall-clock cost of the last route computation.
+ * @returns the statistics of the last BuildGlobalRoutingDatabase and
+ * InitializeRoutes or UpdateGlobalRoutes calls
+ */
+  static Statistics GetStatistics ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -43,30 +43,71 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_ports.clear ();
+  m_connections.clear ();
+  m_connectionKeys.clear ();
 }
 
 bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+Ipv4EndPointDemux::ConnectionKey::operator == (const ConnectionKey &o) const
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  return localAddress == o.localAddress && peerAddress == o.peerAddress
+         && localPort == o.localPort && peerPort == o.peerPort;
+}
+
+std::size_t
+Ipv4EndPointDemux::ConnectionKeyHash::operator () (const ConnectionKey &key) const
+{
+  uint64_t ports = (static_cast<uint64_t> (key.localPort) << 16) | key.peerPort;
+  uint64_t addresses = (static_cast<uint64_t> (key.localAddress) << 32) | key.peerAddress;
+  return std::hash<uint64_t> () (addresses ^ (ports * 0x9e3779b97f4a7c15ULL));
+}
+
+void
+Ipv4EndPointDemux::Insert (Ipv4EndPoint *endPoint)
+{
+  m_endPoints.push_back (endPoint);
+  m_ports[endPoint->GetLocalPort ()].push_back (endPoint);
+}
+
+const Ipv4EndPointDemux::EndPoints &
+Ipv4EndPointDemux::GetPortEndPoints (uint16_t port) const
+{
+  static const EndPoints none;
+  std::unordered_map<uint16_t, EndPoints>::const_iterator i = m_ports.find (port);
+  if (i == m_ports.end ())
     {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
+      return none;
     }
-  return false;
+  return i->second;
+}
+
+void
+Ipv4EndPointDemux::Forget (Ipv4EndPoint *endPoint)
+{
+  std::unordered_map<Ipv4EndPoint *, ConnectionKey>::iterator i = m_connectionKeys.find (endPoint);
+  if (i != m_connectionKeys.end ())
+    {
+      m_connections.erase (i->second);
+      m_connectionKeys.erase (i);
+    }
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  const EndPoints &endPoints = GetPortEndPoints (port);
+  for (EndPoints::const_iterator i = endPoints.begin (); i != endPoints.end (); i++) 
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr &&
+      if ((*i)->GetLocalAddress () == addr &&
           (*i)->GetBoundNetDevice () == boundNetDevice)
         {
           return true;
@@ -86,7 +127,7 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -102,7 +143,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -125,7 +166,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -136,10 +177,10 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  const EndPoints &endPoints = GetPortEndPoints (localPort);
+  for (EndPoints::const_iterator i = endPoints.begin (); i != endPoints.end (); i++) 
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
+      if ((*i)->GetLocalAddress () == localAddress &&
           (*i)->GetPeerPort () == peerPort &&
           (*i)->GetPeerAddress () == peerAddress &&
           ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
@@ -150,7 +191,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
+  Insert (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -165,6 +206,14 @@ Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
     {
       if (*i == endPoint)
         {
+          std::unordered_map<uint16_t, EndPoints>::iterator port = m_ports.find (endPoint->GetLocalPort ());
+          NS_ASSERT (port != m_ports.end ());
+          port->second.remove (endPoint);
+          if (port->second.empty ())
+            {
+              m_ports.erase (port);
+            }
+          Forget (endPoint);
           delete endPoint;
           m_endPoints.erase (i);
           break;
@@ -208,7 +257,32 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  const EndPoints &endPoints = GetPortEndPoints (dport);
+  if (endPoints.empty ())
+    {
+      return EndPoints ();
+    }
+
+  // An open connection matched before wins over every wildcard match,
+  // provided the endpoint still has the same four-tuple.
+  ConnectionKey key = { daddr.Get (), saddr.Get (), dport, sport };
+  Connections::iterator connection = m_connections.find (key);
+  if (connection != m_connections.end ())
+    {
+      Ipv4EndPoint *endP = connection->second;
+      if (endP->IsRxEnabled () &&
+          endP->GetLocalAddress () == daddr &&
+          endP->GetPeerAddress () == saddr &&
+          endP->GetPeerPort () == sport &&
+          (!endP->GetBoundNetDevice () || endP->GetBoundNetDevice () == incomingInterface->GetDevice ()))
+        {
+          NS_LOG_LOGIC ("Found an endpoint for case 4 in the connection cache");
+          return EndPoints (1, endP);
+        }
+      Forget (endP);
+    }
+
+  for (EndPoints::const_iterator i = endPoints.begin (); i != endPoints.end (); i++) 
     {
       Ipv4EndPoint* endP = *i;
 
@@ -224,14 +298,6 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
           continue;
         }
 
-      if (endP->GetLocalPort () != dport) 
-        {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
-          continue;
-        }
       if (endP->GetBoundNetDevice ())
         {
           if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
@@ -332,6 +398,12 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   else retval = retval1;
 
   NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
+  if (!retval4.empty ())
+    {
+      Forget (retval4.front ());
+      m_connections[key] = retval4.front ();
+      m_connectionKeys[retval4.front ()] = key;
+    }
   return retval;  // might be empty if no matches
 }
 
@@ -347,12 +419,9 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
   // function.
   uint32_t genericity = 3;
   Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  const EndPoints &endPoints = GetPortEndPoints (dport);
+  for (EndPoints::const_iterator i = endPoints.begin (); i != endPoints.end (); i++) 
     {
-      if ((*i)->GetLocalPort () != dport) 
-        {
-          continue;
-        }
       if ((*i)->GetLocalAddress () == daddr &&
           (*i)->GetPeerPort () == sport &&
           (*i)->GetPeerAddress () == saddr) 
@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +41,14 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed by local port, which never changes during
+ * the lifetime of an endpoint, so that lookups only examine the
+ * endpoints sharing the destination port of the packet.  Endpoints
+ * found by an exact four-tuple match (i.e., open connections) are also
+ * remembered in a connection cache, which is checked against the
+ * current state of the endpoint before being trusted since the local
+ * and peer addresses of an endpoint may be changed after allocation.
  */
 
 class Ipv4EndPointDemux {
@@ -188,10 +197,69 @@ private:
    */
   uint16_t m_portFirst;
 
+  /**
+   * \brief Register an end point in the indexes.
+   * \param endPoint the end point
+   */
+  void Insert (Ipv4EndPoint *endPoint);
+  /**
+   * \brief Get the end points bound to a local port.
+   * \param port the local port
+   * \return the end points, possibly none
+   */
+  const EndPoints &GetPortEndPoints (uint16_t port) const;
+
+  /**
+   * \brief Four-tuple of an open connection.
+   */
+  struct ConnectionKey
+  {
+    uint32_t localAddress; //!< local address
+    uint32_t peerAddress;  //!< peer address
+    uint16_t localPort;    //!< local port
+    uint16_t peerPort;     //!< peer port
+    /**
+     * \param o the other key
+     * \return true if the keys are equal
+     */
+    bool operator == (const ConnectionKey &o) const;
+  };
+  /**
+   * \brief Hash function of a ConnectionKey.
+   */
+  struct ConnectionKeyHash
+  {
+    /**
+     * \param key the key
+     * \return the hash of the key
+     */
+    std::size_t operator () (const ConnectionKey &key) const;
+  };
+  /// Connection cache
+  typedef std::unordered_map<ConnectionKey, Ipv4EndPoint *, ConnectionKeyHash> Connections;
+
+  /**
+   * \brief Remove an end point from the connection cache.
+   * \param endPoint the end point
+   */
+  void Forget (Ipv4EndPoint *endPoint);
+
   /**
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+  /**
+   * \brief The end points of every local port in allocation order.
+   */
+  std::unordered_map<uint16_t, EndPoints> m_ports;
+  /**
+   * \brief End points matched by an exact four-tuple lookup.
+   */
+  Connections m_connections;
+  /**
+   * \brief Key of every end point in the connection cache.
+   */
+  std::unordered_map<Ipv4EndPoint *, ConnectionKey> m_connectionKeys;
 };
 
 } // namespace ns3
@@ -28,6 +28,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-routing-table-index.h"
 
 namespace ns3 {
 
@@ -272,6 +273,11 @@ private:
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  Ipv4RoutingTableIndex m_hostIndex;       //!< Prefix index of m_hostRoutes
+  Ipv4RoutingTableIndex m_networkIndex;    //!< Prefix index of m_networkRoutes
+  Ipv4RoutingTableIndex m_externalIndex;   //!< Prefix index of m_ASexternalRoutes
+  Ipv4RoutingTableIndex::Matches m_matches; //!< Scratch space for LookupGlobal
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
@@ -26,6 +26,7 @@
 #include "ns3/node.h"
 #include "ns3/socket.h"
 #include "ns3/net-device.h"
+#include "ns3/segment-offload-tag.h"
 #include "ns3/uinteger.h"
 #include "ns3/string.h"
 #include "ns3/boolean.h"
@@ -989,8 +990,14 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
   if (outInterface->IsUp ())
     {
       NS_LOG_LOGIC ("Send to " << targetLabel << " " << target);
-      if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu () )
+      if ( packet->GetSize () + ipHeader.GetSerializedSize () > outInterface->GetDevice ()->GetMtu ()
+           && !IsOffloaded (packet, ipHeader.GetSerializedSize (), outInterface->GetDevice (),
+                            outInterface->GetDevice ()->GetMtu ()))
         {
+          // A super-segment that the device does not send as wire packets
+          // is fragmented like any other large packet.
+          SegmentOffloadTag offloadTag;
+          packet->RemovePacketTag (offloadTag);
           std::list<Ipv4PayloadHeaderPair> listFragments;
           DoFragmentation (packet, ipHeader, outInterface->GetDevice ()->GetMtu (), listFragments);
           for ( std::list<Ipv4PayloadHeaderPair>::iterator it = listFragments.begin (); it != listFragments.end (); it++ )
@@ -1008,6 +1015,16 @@ Ipv4L3Protocol::SendRealOut (Ptr<Ipv4Route> route,
     }
 }
 
+bool
+Ipv4L3Protocol::IsOffloaded (Ptr<const Packet> packet, uint32_t headerSize,
+                             Ptr<NetDevice> device, uint32_t mtu) const
+{
+  NS_LOG_FUNCTION (this << packet << headerSize << device << mtu);
+  SegmentOffloadTag offloadTag;
+  return device->SupportsSegmentOffload () && packet->PeekPacketTag (offloadTag)
+         && offloadTag.GetMaxWirePacketSize (packet->GetSize () + headerSize) <= mtu;
+}
+
 // This function analogous to Linux ip_mr_forward()
 void
 Ipv4L3Protocol::IpMulticastForward (Ptr<Ipv4MulticastRoute> mrtentry, Ptr<const Packet> p, const Ipv4Header &header)
@@ -407,6 +407,18 @@ private:
    */
   typedef std::pair<Ptr<Packet>, Ipv4Header> Ipv4PayloadHeaderPair;
 
+  /**
+   * \brief Check whether a device sends a packet as the wire packets of a
+   * segment offload, so that the packet does not need to be fragmented.
+   * \param packet the packet
+   * \param headerSize the size of the IPv4 header
+   * \param device the output device
+   * \param mtu the MTU of the output device
+   * \returns true if the packet carries a SegmentOffloadTag, the device
+   * supports segment offload and each wire packet fits in the MTU
+   */
+  bool IsOffloaded (Ptr<const Packet> packet, uint32_t headerSize, Ptr<NetDevice> device, uint32_t mtu) const;
+
   /**
    * \brief Fragment a packet
    * \param packet the packet
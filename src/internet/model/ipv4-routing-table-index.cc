@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ipv4-routing-table-index.h"
+#include "ipv4-routing-table-entry.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RoutingTableIndex");
+
+namespace {
+
+/**
+ * \param a a match
+ * \param b another match
+ * \return true if a was added before b
+ */
+bool
+MatchOrderLess (const Ipv4RoutingTableIndex::Match &a, const Ipv4RoutingTableIndex::Match &b)
+{
+  return a.order < b.order;
+}
+
+} // anonymous namespace
+
+Ipv4RoutingTableIndex::Ipv4RoutingTableIndex ()
+  : m_order (0),
+    m_n (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+Ipv4RoutingTableIndex::Add (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  Ipv4Mask mask = route->GetDestNetworkMask ();
+  uint16_t prefixLength = mask.GetPrefixLength ();
+  std::vector<MaskTable>::iterator table = m_tables.begin ();
+  while (table != m_tables.end () && table->prefixLength > prefixLength)
+    {
+      table++;
+    }
+  if (table == m_tables.end () || table->mask != mask.Get ())
+    {
+      MaskTable newTable;
+      newTable.mask = mask.Get ();
+      newTable.prefixLength = prefixLength;
+      table = m_tables.insert (table, newTable);
+    }
+  Match match;
+  match.route = route;
+  match.metric = metric;
+  match.order = m_order++;
+  table->routes[route->GetDestNetwork ().Get () & table->mask].push_back (match);
+  m_n++;
+}
+
+void
+Ipv4RoutingTableIndex::Remove (Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  uint32_t mask = route->GetDestNetworkMask ().Get ();
+  for (std::vector<MaskTable>::iterator table = m_tables.begin (); table != m_tables.end (); table++)
+    {
+      if (table->mask != mask)
+        {
+          continue;
+        }
+      std::unordered_map<uint32_t, Matches>::iterator bucket =
+        table->routes.find (route->GetDestNetwork ().Get () & mask);
+      if (bucket == table->routes.end ())
+        {
+          break;
+        }
+      for (Matches::iterator i = bucket->second.begin (); i != bucket->second.end (); i++)
+        {
+          if (i->route == route)
+            {
+              bucket->second.erase (i);
+              m_n--;
+              if (bucket->second.empty ())
+                {
+                  table->routes.erase (bucket);
+                  if (table->routes.empty ())
+                    {
+                      m_tables.erase (table);
+                    }
+                }
+              return;
+            }
+        }
+      break;
+    }
+  NS_ASSERT_MSG (false, "Route " << route << " is not in the index");
+}
+
+void
+Ipv4RoutingTableIndex::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_tables.clear ();
+  m_n = 0;
+}
+
+void
+Ipv4RoutingTableIndex::Lookup (Ipv4Address dest, Matches &matches) const
+{
+  NS_LOG_FUNCTION (this << dest);
+  matches.clear ();
+  uint32_t nTables = 0;
+  for (std::vector<MaskTable>::const_iterator table = m_tables.begin (); table != m_tables.end (); table++)
+    {
+      std::unordered_map<uint32_t, Matches>::const_iterator bucket =
+        table->routes.find (dest.Get () & table->mask);
+      if (bucket != table->routes.end ())
+        {
+          matches.insert (matches.end (), bucket->second.begin (), bucket->second.end ());
+          nTables++;
+        }
+    }
+  // Each bucket is already in insertion order; only merge across masks.
+  if (nTables > 1)
+    {
+      std::stable_sort (matches.begin (), matches.end (), MatchOrderLess);
+    }
+}
+
+uint32_t
+Ipv4RoutingTableIndex::GetN (void) const
+{
+  return m_n;
+}
+
+} // namespace ns3
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef IPV4_ROUTING_TABLE_INDEX_H
+#define IPV4_ROUTING_TABLE_INDEX_H
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Prefix index over a set of Ipv4RoutingTableEntry.
+ *
+ * The routes are grouped by network mask, and the routes sharing a
+ * mask are hashed on their masked destination, so that a lookup costs
+ * one hash probe per distinct mask in the table instead of one
+ * comparison per route.  Routing tables usually hold a handful of
+ * distinct masks (host routes, point-to-point subnets, a default
+ * route), and a full Ipv4GlobalRouting table of a large topology
+ * needs a single probe to find its host route.
+ *
+ * The index does not own the routes and does not take any routing
+ * decision: Lookup returns every route matching a destination, in the
+ * order the routes were added, and the routing protocol applies its
+ * own selection rules (longest prefix, metric, ECMP) to that short
+ * list.  Routes must be removed from the index before being deleted.
+ */
+class Ipv4RoutingTableIndex
+{
+public:
+  /// A route matching a destination.
+  struct Match
+  {
+    Ipv4RoutingTableEntry *route; //!< the route
+    uint32_t metric;              //!< the metric given when the route was added
+    uint32_t order;               //!< rank of the route in insertion order
+  };
+  /// Routes matching a destination
+  typedef std::vector<Match> Matches;
+
+  Ipv4RoutingTableIndex ();
+
+  /**
+   * \brief Add a route after all the routes already in the index.
+   * \param route the route
+   * \param metric the metric of the route
+   */
+  void Add (Ipv4RoutingTableEntry *route, uint32_t metric = 0);
+  /**
+   * \brief Remove a route from the index.
+   * \param route the route, which must still be valid
+   */
+  void Remove (Ipv4RoutingTableEntry *route);
+  /**
+   * \brief Remove all the routes from the index.
+   */
+  void Clear (void);
+  /**
+   * \brief Find the routes matching a destination.
+   * \param dest the destination address
+   * \param matches [out] the matching routes, in insertion order
+   */
+  void Lookup (Ipv4Address dest, Matches &matches) const;
+  /**
+   * \return the number of routes in the index
+   */
+  uint32_t GetN (void) const;
+
+private:
+  /// Routes sharing a network mask, hashed on their masked destination.
+  struct MaskTable
+  {
+    uint32_t mask;           //!< network mask
+    uint16_t prefixLength;   //!< prefix length of the mask
+    std::unordered_map<uint32_t, Matches> routes; //!< routes by masked destination
+  };
+
+  std::vector<MaskTable> m_tables; //!< one table per mask, longest prefix first
+  uint32_t m_order;                //!< insertion rank of the next route
+  uint32_t m_n;                    //!< number of routes
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTING_TABLE_INDEX_H */
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-routing-table-index.h"
 
 namespace ns3 {
 
@@ -399,6 +400,16 @@ private:
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the prefix index of m_networkRoutes.
+   */
+  Ipv4RoutingTableIndex m_networkIndex;
+
+  /**
+   * \brief scratch space for LookupStatic.
+   */
+  Ipv4RoutingTableIndex::Matches m_matches;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -30,6 +30,7 @@
 #include "ns3/ipv6-route.h"
 #include "ns3/mac16-address.h"
 #include "ns3/mac64-address.h"
+#include "ns3/segment-offload-tag.h"
 #include "ns3/traffic-control-layer.h"
 
 #include "loopback-net-device.h"
@@ -1093,8 +1094,14 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
       targetMtu = dev->GetMtu ();
     }
 
-  if (packet->GetSize () > targetMtu + 40) /* 40 => size of IPv6 header */
+  if (packet->GetSize () > targetMtu + 40 /* 40 => size of IPv6 header */
+      && !IsOffloaded (packet, ipHeader.GetSerializedSize (), dev, targetMtu))
     {
+      // A super-segment that the device does not send as wire packets
+      // is handled like any other large packet.
+      SegmentOffloadTag offloadTag;
+      packet->RemovePacketTag (offloadTag);
+
       // Router => drop
 
       bool fromMe = false;
@@ -1186,6 +1193,15 @@ void Ipv6L3Protocol::SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6
     }
 }
 
+bool Ipv6L3Protocol::IsOffloaded (Ptr<const Packet> packet, uint32_t headerSize,
+                                  Ptr<NetDevice> device, uint32_t mtu) const
+{
+  NS_LOG_FUNCTION (this << packet << headerSize << device << mtu);
+  SegmentOffloadTag offloadTag;
+  return device->SupportsSegmentOffload () && packet->PeekPacketTag (offloadTag)
+         && offloadTag.GetMaxWirePacketSize (packet->GetSize () + headerSize) <= mtu;
+}
+
 void Ipv6L3Protocol::IpForward (Ptr<const NetDevice> idev, Ptr<Ipv6Route> rtentry, Ptr<const Packet> p, const Ipv6Header& header)
 {
   NS_LOG_FUNCTION (this << rtentry << p << header);
@@ -584,6 +584,18 @@ private:
    */
   void SendRealOut (Ptr<Ipv6Route> route, Ptr<Packet> packet, Ipv6Header const& ipHeader);
 
+  /**
+   * \brief Check whether a device sends a packet as the wire packets of a
+   * segment offload, so that the packet does not need to be fragmented.
+   * \param packet the packet
+   * \param headerSize the size of the IPv6 header
+   * \param device the output device
+   * \param mtu the MTU towards the destination
+   * \returns true if the packet carries a SegmentOffloadTag, the device
+   * supports segment offload and each wire packet fits in the MTU
+   */
+  bool IsOffloaded (Ptr<const Packet> packet, uint32_t headerSize, Ptr<NetDevice> device, uint32_t mtu) const;
+
   /**
    * \brief Forward a packet.
    * \param idev Pointer to ingress network device
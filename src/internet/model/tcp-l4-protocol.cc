@@ -25,6 +25,7 @@
 #include "ns3/object-vector.h"
 
 #include "ns3/packet.h"
+#include "ns3/segment-offload-tag.h"
 #include "ns3/node.h"
 #include "ns3/simulator.h"
 #include "ns3/ipv4-route.h"
@@ -551,7 +552,7 @@ TcpL4Protocol::Receive (Ptr<Packet> packet,
   return IpL4Protocol::RX_OK;
 }
 
-void
+bool
 TcpL4Protocol::SendPacketV4 (Ptr<Packet> packet, const TcpHeader &outgoing,
                              const Ipv4Address &saddr, const Ipv4Address &daddr,
                              Ptr<NetDevice> oif) const
@@ -594,15 +595,29 @@ TcpL4Protocol::SendPacketV4 (Ptr<Packet> packet, const TcpHeader &outgoing,
           NS_LOG_ERROR ("No IPV4 Routing Protocol");
           route = 0;
         }
+      if (route != 0)
+        {
+          std::list<Ptr<Packet> > segments = SplitSuperSegment (packet, outgoingHeader,
+                                                                route->GetOutputDevice ());
+          for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); ++it)
+            {
+              m_downTarget (*it, saddr, daddr, PROT_NUMBER, route);
+            }
+          if (!segments.empty ())
+            {
+              return false;
+            }
+        }
       m_downTarget (packet, saddr, daddr, PROT_NUMBER, route);
     }
   else
     {
       NS_FATAL_ERROR ("Trying to use Tcp on a node without an Ipv4 interface");
     }
+  return true;
 }
 
-void
+bool
 TcpL4Protocol::SendPacketV6 (Ptr<Packet> packet, const TcpHeader &outgoing,
                              const Ipv6Address &saddr, const Ipv6Address &daddr,
                              Ptr<NetDevice> oif) const
@@ -648,15 +663,68 @@ TcpL4Protocol::SendPacketV6 (Ptr<Packet> packet, const TcpHeader &outgoing,
           NS_LOG_ERROR ("No IPV6 Routing Protocol");
           route = 0;
         }
+      if (route != 0)
+        {
+          std::list<Ptr<Packet> > segments = SplitSuperSegment (packet, outgoingHeader,
+                                                                route->GetOutputDevice ());
+          for (std::list<Ptr<Packet> >::iterator it = segments.begin (); it != segments.end (); ++it)
+            {
+              m_downTarget6 (*it, saddr, daddr, PROT_NUMBER, route);
+            }
+          if (!segments.empty ())
+            {
+              return false;
+            }
+        }
       m_downTarget6 (packet, saddr, daddr, PROT_NUMBER, route);
     }
   else
     {
       NS_FATAL_ERROR ("Trying to use Tcp on a node without an Ipv6 interface");
     }
+  return true;
 }
 
-void
+std::list<Ptr<Packet> >
+TcpL4Protocol::SplitSuperSegment (Ptr<Packet> pkt, const TcpHeader &outgoing,
+                                  Ptr<NetDevice> device) const
+{
+  std::list<Ptr<Packet> > segments;
+  SegmentOffloadTag offloadTag;
+  if (device == 0 || device->SupportsSegmentOffload ()
+      || !pkt->RemovePacketTag (offloadTag))
+    {
+      return segments;
+    }
+  NS_LOG_FUNCTION (this << pkt << outgoing << device);
+
+  uint32_t headerSize = pkt->GetSize () - offloadTag.GetPayloadSize ();
+  uint32_t size = offloadTag.GetPayloadSize ();
+  uint32_t segmentSize = offloadTag.GetSegmentSize ();
+  for (uint32_t offset = 0; offset < size; offset += segmentSize)
+    {
+      uint32_t length = std::min (segmentSize, size - offset);
+      Ptr<Packet> segment = pkt->CreateFragment (headerSize + offset, length);
+      TcpHeader header = outgoing;
+      uint8_t flags = outgoing.GetFlags ();
+      if (offset > 0)
+        {
+          flags &= ~TcpHeader::CWR;
+        }
+      if (offset + length < size)
+        {
+          flags &= ~(TcpHeader::FIN | TcpHeader::PSH);
+        }
+      header.SetFlags (flags);
+      header.SetSequenceNumber (outgoing.GetSequenceNumber () + SequenceNumber32 (offset));
+      segment->AddHeader (header);
+      segments.push_back (segment);
+    }
+  NS_LOG_LOGIC ("Super-segment split into " << segments.size () << " segments");
+  return segments;
+}
+
+bool
 TcpL4Protocol::SendPacket (Ptr<Packet> pkt, const TcpHeader &outgoing,
                            const Address &saddr, const Address &daddr,
                            Ptr<NetDevice> oif) const
@@ -666,40 +734,33 @@ TcpL4Protocol::SendPacket (Ptr<Packet> pkt, const TcpHeader &outgoing,
     {
       NS_ASSERT (Ipv4Address::IsMatchingType (daddr));
 
-      SendPacketV4 (pkt, outgoing, Ipv4Address::ConvertFrom (saddr),
-                    Ipv4Address::ConvertFrom (daddr), oif);
-
-      return;
+      return SendPacketV4 (pkt, outgoing, Ipv4Address::ConvertFrom (saddr),
+                           Ipv4Address::ConvertFrom (daddr), oif);
     }
   else if (Ipv6Address::IsMatchingType (saddr))
     {
       NS_ASSERT (Ipv6Address::IsMatchingType (daddr));
 
-      SendPacketV6 (pkt, outgoing, Ipv6Address::ConvertFrom (saddr),
-                    Ipv6Address::ConvertFrom (daddr), oif);
-
-      return;
+      return SendPacketV6 (pkt, outgoing, Ipv6Address::ConvertFrom (saddr),
+                           Ipv6Address::ConvertFrom (daddr), oif);
     }
   else if (InetSocketAddress::IsMatchingType (saddr))
     {
       InetSocketAddress s = InetSocketAddress::ConvertFrom (saddr);
       InetSocketAddress d = InetSocketAddress::ConvertFrom (daddr);
 
-      SendPacketV4 (pkt, outgoing, s.GetIpv4 (), d.GetIpv4 (), oif);
-
-      return;
+      return SendPacketV4 (pkt, outgoing, s.GetIpv4 (), d.GetIpv4 (), oif);
     }
   else if (Inet6SocketAddress::IsMatchingType (saddr))
     {
       Inet6SocketAddress s = Inet6SocketAddress::ConvertFrom (saddr);
       Inet6SocketAddress d = Inet6SocketAddress::ConvertFrom (daddr);
 
-      SendPacketV6 (pkt, outgoing, s.GetIpv6 (), d.GetIpv6 (), oif);
-
-      return;
+      return SendPacketV6 (pkt, outgoing, s.GetIpv6 (), d.GetIpv6 (), oif);
     }
 
   NS_FATAL_ERROR ("Trying to send a packet without IP addresses");
+  return false;
 }
 
 void
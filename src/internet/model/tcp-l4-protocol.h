@@ -22,6 +22,7 @@
 #define TCP_L4_PROTOCOL_H
 
 #include <stdint.h>
+#include <list>
 
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv6-address.h"
@@ -213,8 +214,10 @@ public:
    * \param saddr The source Ipv4Address
    * \param daddr The destination Ipv4Address
    * \param oif The output interface bound. Defaults to null (unspecified).
+   * \returns false if \pname{pkt} is a super-segment which was split into
+   *          its segments (see SplitSuperSegment), true otherwise
    */
-  void SendPacket (Ptr<Packet> pkt, const TcpHeader &outgoing,
+  bool SendPacket (Ptr<Packet> pkt, const TcpHeader &outgoing,
                    const Address &saddr, const Address &daddr,
                    Ptr<NetDevice> oif = 0) const;
 
@@ -346,8 +349,10 @@ private:
    * \param saddr The source Ipv4Address
    * \param daddr The destination Ipv4Address
    * \param oif The output interface bound. Defaults to null (unspecified).
+   * \returns false if \pname{pkt} is a super-segment which was split into
+   *          its segments, true otherwise
    */
-  void SendPacketV4 (Ptr<Packet> pkt, const TcpHeader &outgoing,
+  bool SendPacketV4 (Ptr<Packet> pkt, const TcpHeader &outgoing,
                      const Ipv4Address &saddr, const Ipv4Address &daddr,
                      Ptr<NetDevice> oif = 0) const;
 
@@ -359,10 +364,30 @@ private:
    * \param saddr The source Ipv4Address
    * \param daddr The destination Ipv4Address
    * \param oif The output interface bound. Defaults to null (unspecified).
+   * \returns false if \pname{pkt} is a super-segment which was split into
+   *          its segments, true otherwise
    */
-  void SendPacketV6 (Ptr<Packet> pkt, const TcpHeader &outgoing,
+  bool SendPacketV6 (Ptr<Packet> pkt, const TcpHeader &outgoing,
                      const Ipv6Address &saddr, const Ipv6Address &daddr,
                      Ptr<NetDevice> oif = 0) const;
+
+  /**
+   * \brief Split a super-segment into the segments it stands for
+   *
+   * A super-segment (a packet carrying a SegmentOffloadTag) whose output
+   * device does not support segment offload is split in software before
+   * being passed to IP, as the segments would have been sent without
+   * offload. Each segment carries a copy of the header, with its own
+   * sequence number; FIN and PSH are only kept in the last one, and CWR
+   * in the first one.
+   *
+   * \param pkt The packet, with the header
+   * \param outgoing The packet header
+   * \param device The output device
+   * \returns the segments, or an empty list if the packet is not to be split
+   */
+  std::list<Ptr<Packet> > SplitSuperSegment (Ptr<Packet> pkt, const TcpHeader &outgoing,
+                                             Ptr<NetDevice> device) const;
 };
 
 } // namespace ns3
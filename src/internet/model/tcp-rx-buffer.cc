@@ -18,6 +18,10 @@
  * Author: Adrian Sai-wah Tam <adrian.sw.tam@gmail.com>
  */
 
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
 #include "ns3/packet.h"
 #include "ns3/log.h"
 #include "tcp-rx-buffer.h"
@@ -155,8 +159,14 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
+  // Remove overlapped bytes from packet. The stored packets do not overlap,
+  // so the ones before the last packet starting at or before headSeq end
+  // before headSeq: start from that packet.
+  BufIterator i = m_data.upper_bound (headSeq);
+  if (i != m_data.begin ())
+    {
+      --i;
+    }
   while (i != m_data.end () && i->first <= tailSeq)
     {
       SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
@@ -196,28 +206,41 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   NS_ASSERT (m_data.find (headSeq) == m_data.end ()); // Shouldn't be there yet
   m_data [ headSeq ] = p;
 
+  // Coalesce the new bytes with the out of order intervals they touch
+  SequenceNumber32 start = headSeq;
+  SequenceNumber32 end = tailSeq;
+  IntervalIterator j = m_intervals.upper_bound (headSeq);
+  if (j != m_intervals.begin () && std::prev (j)->second >= headSeq)
+    {
+      --j;
+    }
+  while (j != m_intervals.end () && j->first <= tailSeq)
+    {
+      start = std::min (start, j->first);
+      end = std::max (end, j->second);
+      j = m_intervals.erase (j);
+    }
+
   if (headSeq > m_nextRxSeq)
     {
+      m_intervals [start] = end;
       // Generate a new SACK block
-      UpdateSackList (headSeq, tailSeq);
+      UpdateSackList (start, end);
     }
 
   NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
   // Update variables
   m_size += p->GetSize ();      // Occupancy
-  for (i = m_data.begin (); i != m_data.end (); ++i)
+  if (headSeq == m_nextRxSeq)
     {
-      if (i->first < m_nextRxSeq)
+      // The interval of the new bytes is now in order: walk its packets
+      for (i = m_data.find (headSeq); i != m_data.end () && i->first == m_nextRxSeq; ++i)
         {
-          continue;
+          m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
+          m_availBytes += i->second->GetSize ();
+          ClearSackList (m_nextRxSeq);
         }
-      else if (i->first > m_nextRxSeq)
-        {
-          break;
-        };
-      m_nextRxSeq = i->first + SequenceNumber32 (i->second->GetSize ());
-      m_availBytes += i->second->GetSize ();
-      ClearSackList (m_nextRxSeq);
+      NS_ASSERT (m_nextRxSeq == end);
     }
   NS_LOG_LOGIC ("Updated buffer occupancy=" << m_size << " nextRxSeq=" << m_nextRxSeq);
   if (m_gotFin && m_nextRxSeq == m_finSeq)
@@ -273,50 +296,24 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
 
   m_sackList.push_front (current);
 
-  // We have inserted the block at the beginning of the list. Now, we should
-  // check if any existing blocks overlap with that.
-  bool updated = false;
+  // We have inserted the block at the beginning of the list. The block is
+  // the whole interval of out of order data that contains the new segment,
+  // so the blocks reported before for a part of it (the ones the segment has
+  // merged with) are subsets of it: remove them.
   TcpOptionSack::SackList::iterator it = m_sackList.begin ();
-  TcpOptionSack::SackBlock begin = *it;
-  TcpOptionSack::SackBlock merged;
   ++it;
 
   // Iterates until we examined all blocks in the list (maximum 4)
   while (it != m_sackList.end ())
     {
-      current = *it;
-
-      // This is a left merge:
-      // [current_first; current_second] [beg_first; beg_second]
-      if (begin.first == current.second)
-        {
-          NS_ASSERT (current.first < begin.second);
-          merged = TcpOptionSack::SackBlock (current.first, begin.second);
-          updated = true;
-        }
-      // while this is a right merge
-      // [begin_first; begin_second] [current_first; current_second]
-      else if (begin.second == current.first)
+      if (head <= it->first && it->second <= tail)
         {
-          NS_ASSERT (begin.first < current.second);
-          merged = TcpOptionSack::SackBlock (begin.first, current.second);
-          updated = true;
+          it = m_sackList.erase (it);
         }
-
-      // If we have merged the blocks (and the result is in merged) we should
-      // delete the current block (it), the first block, and insert the merged
-      // one at the beginning.
-      if (updated)
+      else
         {
-          m_sackList.erase (it);
-          m_sackList.pop_front ();
-          m_sackList.push_front (merged);
-          it = m_sackList.begin ();
-          begin = *it;
-          updated = false;
+          ++it;
         }
-
-      ++it;
     }
 
   // Since the maximum blocks that fits into a TCP header are 4, there's no
@@ -327,9 +324,8 @@ TcpRxBuffer::UpdateSackList (const SequenceNumber32 &head, const SequenceNumber3
     }
 
   // Please note that, if a block b is discarded and then a block contiguous
-  // to b is received, only that new block (without the b part) is reported.
-  // This is perfectly fine for the RFC point (a), given that we do not report any
-  // overlapping blocks shortly after.
+  // to b is received, the reported block still includes the b part, as
+  // required by the RFC point (a).
 }
 
 void
@@ -370,6 +366,7 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   if (extractSize == 0) return nullptr;  // No contiguous block to return
   NS_ASSERT (m_data.size ()); // At least we have something to extract
   Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
+  std::vector<Ptr<Packet> > fragments;    // The packets to concatenate into outPkt
   BufIterator i;
   while (extractSize)
     { // Check the buffered data for delivery
@@ -379,7 +376,7 @@ TcpRxBuffer::Extract (uint32_t maxSize)
       uint32_t pktSize = i->second->GetSize ();
       if (pktSize <= extractSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
+          fragments.push_back (i->second);
           m_data.erase (i);
           m_size -= pktSize;
           m_availBytes -= pktSize;
@@ -387,7 +384,7 @@ TcpRxBuffer::Extract (uint32_t maxSize)
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
+          fragments.push_back (i->second->CreateFragment (0, extractSize));
           m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
           m_data.erase (i);
           m_size -= extractSize;
@@ -395,6 +392,26 @@ TcpRxBuffer::Extract (uint32_t maxSize)
           extractSize = 0;
         }
     }
+  // Concatenate the packets two by two, so that a byte is copied once per
+  // level instead of once for each packet appended after it. The first
+  // level appends into copies, so that the buffered packets are never
+  // modified whoever else holds them; a copy shares the buffer of its
+  // packet until the append writes past its end.
+  for (std::size_t step = 1; step < fragments.size (); step *= 2)
+    {
+      for (std::size_t k = 0; k + step < fragments.size (); k += 2 * step)
+        {
+          if (step == 1)
+            {
+              fragments[k] = fragments[k]->Copy ();
+            }
+          fragments[k]->AddAtEnd (fragments[k + step]);
+        }
+    }
+  if (!fragments.empty ())
+    {
+      outPkt->AddAtEnd (fragments.front ());
+    }
   if (outPkt->GetSize () == 0)
     {
       NS_LOG_LOGIC ("Nothing extracted.");
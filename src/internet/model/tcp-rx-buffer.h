@@ -53,6 +53,12 @@ class Packet;
  * To store data, use Add; for retrieving a certain amount of ordered data, use
  * the method Extract.
  *
+ * The received packets are stored as they are, trimmed of the bytes already
+ * stored, and the out of order data is also tracked as a set of coalesced
+ * intervals: adding a packet costs a logarithmic time in the number of
+ * stored packets, and the packets are concatenated only when Extract
+ * delivers them.
+ *
  * SACK list
  * ---------
  *
@@ -197,8 +203,9 @@ private:
    * (or other) options, it is even less. For more detail about this function,
    * please see the source code and in-line comments.
    *
-   * \param head sequence number of the block at the beginning
-   * \param tail sequence number of the block at the end
+   * \param head sequence number of the beginning of the interval of out of
+   * order data that contains the last received segment
+   * \param tail sequence number of the end of that interval
    */
   void UpdateSackList (const SequenceNumber32 &head, const SequenceNumber32 &tail);
 
@@ -226,6 +233,10 @@ private:
   uint32_t m_maxBuffer;                      //!< Upper bound of the number of data bytes in buffer (RCV.WND)
   uint32_t m_availBytes;                     //!< Number of bytes available to read, i.e. contiguous block at head
   std::map<SequenceNumber32, Ptr<Packet> > m_data; //!< Corresponding data (may be null)
+
+  /// container for the intervals of out of order data
+  typedef std::map<SequenceNumber32, SequenceNumber32>::iterator IntervalIterator;
+  std::map<SequenceNumber32, SequenceNumber32> m_intervals; //!< Out of order data, as coalesced [start, end) intervals
 };
 
 } //namespace ns3
@@ -42,6 +42,7 @@
 #include "ns3/pointer.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/data-rate.h"
+#include "ns3/segment-offload-tag.h"
 #include "ns3/object.h"
 #include "tcp-socket-base.h"
 #include "tcp-l4-protocol.h"
@@ -142,6 +143,13 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (true),
                    MakeBooleanAccessor (&TcpSocketBase::m_limitedTx),
                    MakeBooleanChecker ())
+    .AddAttribute ("TsoSegments",
+                   "Maximum number of full segments of new data sent as a "
+                   "single super-segment, which devices supporting segment "
+                   "offload send as that many wire packets; 1 disables it",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&TcpSocketBase::m_tsoSegments),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute ("UseEcn", "Parameter to set ECN functionality",
                    EnumValue (TcpSocketState::Off),
                    MakeEnumAccessor (&TcpSocketBase::SetUseEcn),
@@ -345,6 +353,7 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_recoverActive (sock.m_recoverActive),
     m_retxThresh (sock.m_retxThresh),
     m_limitedTx (sock.m_limitedTx),
+    m_tsoSegments (sock.m_tsoSegments),
     m_isFirstPartialAck (sock.m_isFirstPartialAck),
     m_txTrace (sock.m_txTrace),
     m_rxTrace (sock.m_rxTrace),
@@ -1901,6 +1910,7 @@ TcpSocketBase::ProcessAck(const SequenceNumber32 &ackNumber, bool scoreboardUpda
       // received a dupack.
       bytesAcked = ackNumber - oldHeadSequence;
       uint32_t segsAcked  = bytesAcked / m_tcb->m_segmentSize;
+      uint32_t offloadedAcked = AckOffloadedSegments (ackNumber);
       m_bytesAckedNotProcessed += bytesAcked % m_tcb->m_segmentSize;
       bytesAcked -= bytesAcked % m_tcb->m_segmentSize;
 
@@ -2091,7 +2101,28 @@ TcpSocketBase::ProcessAck(const SequenceNumber32 &ackNumber, bool scoreboardUpda
             }
           if (m_tcb->m_congState == TcpSocketState::CA_OPEN)
             {
-              m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+              offloadedAcked = std::min (offloadedAcked, segsAcked);
+              if (offloadedAcked > 1)
+                {
+                  // The receiver acknowledges a super-segment sent as one
+                  // packet with a single ACK: pass its segments on as the
+                  // ACKs of the wire segments, one every two segments
+                  // (RFC 5681), as the window grows per ACK
+                  if (segsAcked > offloadedAcked)
+                    {
+                      m_congestionControl->IncreaseWindow (m_tcb, segsAcked - offloadedAcked);
+                    }
+                  for (uint32_t left = offloadedAcked; left > 0; )
+                    {
+                      uint32_t acked = std::min<uint32_t> (left, 2);
+                      m_congestionControl->IncreaseWindow (m_tcb, acked);
+                      left -= acked;
+                    }
+                }
+              else
+                {
+                  m_congestionControl->IncreaseWindow (m_tcb, segsAcked);
+                }
 
               m_tcb->m_cWndInfl = m_tcb->m_cWnd;
 
@@ -2111,6 +2142,18 @@ TcpSocketBase::ProcessAck(const SequenceNumber32 &ackNumber, bool scoreboardUpda
   UpdatePacingRate ();
 }
 
+uint32_t
+TcpSocketBase::AckOffloadedSegments (const SequenceNumber32 &ackNumber)
+{
+  uint32_t segments = 0;
+  while (!m_offloadedTx.empty () && m_offloadedTx.front ().first <= ackNumber)
+    {
+      segments += m_offloadedTx.front ().second;
+      m_offloadedTx.pop_front ();
+    }
+  return segments;
+}
+
 /* Received a packet upon LISTEN state. */
 void
 TcpSocketBase::ProcessListen (Ptr<Packet> packet, const TcpHeader& tcpHeader,
@@ -3029,6 +3072,10 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
     }
 
   AddSocketTags (p);
+  if (sz > m_tcb->m_segmentSize)
+    {
+      p->AddPacketTag (SegmentOffloadTag (sz, m_tcb->m_segmentSize));
+    }
 
   if (m_closeOnEmpty && (remainingData == 0))
     {
@@ -3073,23 +3120,30 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
 
   m_txTrace (p, header, this);
 
+  bool whole;
   if (m_endPoint)
     {
-      m_tcp->SendPacket (p, header, m_endPoint->GetLocalAddress (),
-                         m_endPoint->GetPeerAddress (), m_boundnetdevice);
+      whole = m_tcp->SendPacket (p, header, m_endPoint->GetLocalAddress (),
+                                 m_endPoint->GetPeerAddress (), m_boundnetdevice);
       NS_LOG_DEBUG ("Send segment of size " << sz << " with remaining data " <<
                     remainingData << " via TcpL4Protocol to " <<  m_endPoint->GetPeerAddress () <<
                     ". Header " << header);
     }
   else
     {
-      m_tcp->SendPacket (p, header, m_endPoint6->GetLocalAddress (),
-                         m_endPoint6->GetPeerAddress (), m_boundnetdevice);
+      whole = m_tcp->SendPacket (p, header, m_endPoint6->GetLocalAddress (),
+                                 m_endPoint6->GetPeerAddress (), m_boundnetdevice);
       NS_LOG_DEBUG ("Send segment of size " << sz << " with remaining data " <<
                     remainingData << " via TcpL4Protocol to " <<  m_endPoint6->GetPeerAddress () <<
                     ". Header " << header);
     }
 
+  if (whole && sz > m_tcb->m_segmentSize)
+    {
+      m_offloadedTx.push_back (std::make_pair (seq + sz,
+                                               (sz + m_tcb->m_segmentSize - 1) / m_tcb->m_segmentSize));
+    }
+
   UpdateRttHistory (seq, sz, isRetransmission);
 
   // Update bytes sent during recovery phase
@@ -3223,6 +3277,20 @@ TcpSocketBase::SendPendingData (bool withAck)
           uint32_t maxSizeToSend = static_cast<uint32_t> (nextHigh - next);
           s = std::min (s, maxSizeToSend);
 
+          // With segment offload, send the full segments of new data that
+          // the windows allow as one super-segment
+          if (m_tsoSegments > 1 && s == m_tcb->m_segmentSize && next >= m_tcb->m_highTxMark)
+            {
+              uint32_t sent = static_cast<uint32_t> (next - m_txBuffer->HeadSequence ());
+              uint32_t bytes = std::min (availableWindow, availableData);
+              bytes = std::min (bytes, m_rWnd.Get () > sent ? m_rWnd.Get () - sent : 0);
+              uint32_t segments = std::min (bytes / m_tcb->m_segmentSize, m_tsoSegments);
+              if (segments > 1)
+                {
+                  s = segments * m_tcb->m_segmentSize;
+                }
+            }
+
           // (C.2) If any of the data octets sent in (C.1) are below HighData,
           //       HighRxt MUST be set to the highest sequence number of the
           //       retransmitted segment unless NextSeg () rule (4) was
@@ -3376,6 +3444,15 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
   NS_LOG_DEBUG ("Data segment, seq=" << tcpHeader.GetSequenceNumber () <<
                 " pkt size=" << p->GetSize () );
 
+  // A super-segment stands for several segments, but its data is not
+  // passed to the application with the tag
+  uint32_t segments = 1;
+  SegmentOffloadTag offloadTag;
+  if (p->GetSize () > m_tcb->m_segmentSize && p->RemovePacketTag (offloadTag))
+    {
+      segments = offloadTag.GetSegments ();
+    }
+
   // Put into Rx buffer
   SequenceNumber32 expectedSeq = m_tcb->m_rxBuffer->NextRxSequence ();
   if (!m_tcb->m_rxBuffer->Add (p, tcpHeader))
@@ -3429,7 +3506,9 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     }
   else
     { // In-sequence packet: ACK if delayed ack count allows
-      if (++m_delAckCount >= m_delAckMaxCount)
+      // A super-segment counts as the segments it stands for
+      m_delAckCount += segments;
+      if (m_delAckCount >= m_delAckMaxCount)
         {
           m_delAckEvent.Cancel ();
           m_delAckCount = 0;
@@ -3599,6 +3678,9 @@ TcpSocketBase::ReTxTimeout ()
       return;
     }
 
+  // The data is now retransmitted segment by segment
+  m_offloadedTx.clear ();
+
   NS_LOG_DEBUG ("Checking if Connection is Established");
   // If all data are received (non-closing socket and nothing to send), just return
   if (m_state <= ESTABLISHED && m_txBuffer->HeadSequence () >= m_tcb->m_highTxMark && m_txBuffer->Size () == 0)
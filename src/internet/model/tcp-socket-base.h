@@ -23,6 +23,7 @@
 
 #include <stdint.h>
 #include <queue>
+#include <deque>
 #include "ns3/traced-value.h"
 #include "ns3/tcp-socket.h"
 #include "ns3/ipv4-header.h"
@@ -1006,6 +1007,14 @@ protected:
   virtual void ProcessAck (const SequenceNumber32 &ackNumber, bool scoreboardUpdated,
                            uint32_t currentDelivered, const SequenceNumber32 &oldHeadSequence);
 
+  /**
+   * \brief Count the segments of the super-segments sent as one packet
+   * that an ACK acknowledges, and forget these super-segments
+   * \param ackNumber ack number
+   * \return the number of segments
+   */
+  uint32_t AckOffloadedSegments (const SequenceNumber32 &ackNumber);
+
   /**
    * \brief Recv of a data, put into buffer, call L7 to get it if necessary
    * \param packet the packet
@@ -1317,6 +1326,12 @@ protected:
                                                   //!< which was set for handling previous congestion event.
   uint32_t               m_retxThresh {3};   //!< Fast Retransmit threshold
   bool                   m_limitedTx  {true}; //!< perform limited transmit
+  uint32_t               m_tsoSegments {1};  //!< Maximum number of segments sent as one super-segment
+  /**
+   * End sequence number and number of segments of the super-segments sent
+   * as one packet and not yet acknowledged
+   */
+  std::deque<std::pair<SequenceNumber32, uint32_t> > m_offloadedTx;
 
   // Transmission Control Block
   Ptr<TcpSocketState>    m_tcb;               //!< Congestion control information
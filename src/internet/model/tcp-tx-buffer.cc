@@ -61,6 +61,7 @@ TcpTxBuffer::TcpTxBuffer (uint32_t n)
   : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
 {
   m_rWndCallback = MakeNullCallback<uint32_t> ();
+  m_lostHint = m_rule3Hint = m_lostBoundary = m_firstByteSeq;
 }
 
 TcpTxBuffer::~TcpTxBuffer (void)
@@ -173,7 +174,9 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
 
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_highestSack = SequenceNumber32 (0);
+  m_highestSackValid = false;
+  m_lostHint = m_rule3Hint = m_lostBoundary = seq;
 }
 
 bool
@@ -310,36 +313,32 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
+  auto it = FindSentItem (seq);
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  if ((*it)->m_startSeq == seq)
     {
-      if ((*it)->m_startSeq == seq)
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked and have the same value for m_lost ... there is the possibility to merge
+          if ((! (*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
             {
-              // Next is not sacked and have the same value for m_lost ... there is the possibility to merge
-              if ((! (*next)->m_sacked) && ((*it)->m_lost == (*next)->m_lost))
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
@@ -354,6 +353,40 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   return item;
 }
 
+TcpTxBuffer::PacketList::const_iterator
+TcpTxBuffer::FindSentItem (const SequenceNumber32 &seq) const
+{
+  auto it = std::upper_bound (m_sentList.begin (), m_sentList.end (), seq,
+                              [] (const SequenceNumber32 &s, const TcpTxItem *item)
+                              { return s < item->m_startSeq; });
+  if (it != m_sentList.begin ())
+    {
+      --it;
+    }
+  return it;
+}
+
+TcpTxBuffer::PacketList::const_iterator
+TcpTxBuffer::FindSentItemFrom (const SequenceNumber32 &seq) const
+{
+  return std::lower_bound (m_sentList.begin (), m_sentList.end (), seq,
+                           [] (const TcpTxItem *item, const SequenceNumber32 &s)
+                           { return item->m_startSeq < s; });
+}
+
+void
+TcpTxBuffer::LowerHints (const SequenceNumber32 &seq) const
+{
+  if (seq < m_lostHint)
+    {
+      m_lostHint = seq;
+    }
+  if (seq < m_rule3Hint)
+    {
+      m_rule3Hint = seq;
+    }
+}
+
 std::pair <TcpTxBuffer::PacketList::const_iterator, SequenceNumber32>
 TcpTxBuffer::FindHighestSacked () const
 {
@@ -437,11 +470,19 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
 
+  if (&list == &m_sentList && !list.empty ())
+    {
+      // The items of the sent list know their starting sequence, so there is
+      // no need to walk the items before the one that contains seq
+      it += FindSentItem (seq) - m_sentList.begin ();
+      beginOfCurrentPacket = (*it)->m_startSeq;
+    }
+
   while (it != list.end ())
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+      NS_ASSERT_MSG (&list != &m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
                      "start: " << m_firstByteSeq << " currentItem start: " <<
                      currentItem->m_startSeq);
 
@@ -617,6 +658,7 @@ TcpTxBuffer::MergeItems (TcpTxItem *t1, TcpTxItem *t2) const
           self->m_retrans -= t2->m_packet->GetSize ();
           t2->m_retrans = false;
         }
+      LowerHints (t1->m_startSeq);
     }
 
   if (t1->m_lastSent < t2->m_lastSent)
@@ -655,16 +697,15 @@ bool
 TcpTxBuffer::IsRetransmittedDataAcked (const SequenceNumber32& ack) const
 {
   NS_LOG_FUNCTION (this);
-  for (const auto &it : m_sentList)
-     {
-       TcpTxItem *item = it;
-       Ptr<Packet> p = item->m_packet;
-       if (item->m_startSeq + p->GetSize () == ack && !item->m_sacked && item->m_retrans)
-         {
-           return true;
-         }
-     }
-  return false;
+  if (m_sentList.empty ())
+    {
+      return false;
+    }
+
+  // Only the item that contains the byte before ack can end at ack
+  TcpTxItem *item = *FindSentItem (ack - 1);
+  Ptr<Packet> p = item->m_packet;
+  return item->m_startSeq + p->GetSize () == ack && !item->m_sacked && item->m_retrans;
 }
 
 void
@@ -762,6 +803,8 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
           // when adding Reno dupacks in the count.
           head->m_sacked = false;
           m_sackedOut -= head->m_packet->GetSize ();
+          m_lostBoundary = head->m_startSeq;
+          LowerHints (head->m_startSeq);
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
           AddRenoSack ();
           MarkHeadAsLost ();
@@ -772,9 +815,24 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq,
                      m_firstByteSeq << " this is the result: " << *this);
     }
 
-  if (m_highestSack.second <= m_firstByteSeq)
+  if (m_highestSack <= m_firstByteSeq)
+    {
+      m_highestSack = SequenceNumber32 (0);
+      m_highestSackValid = false;
+    }
+
+  // Keep the hints in the sent list, so they compare well with its sequences
+  if (m_lostHint < m_firstByteSeq)
+    {
+      m_lostHint = m_firstByteSeq;
+    }
+  if (m_rule3Hint < m_firstByteSeq)
+    {
+      m_rule3Hint = m_firstByteSeq;
+    }
+  if (m_lostBoundary < m_firstByteSeq)
     {
-      m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+      m_lostBoundary = m_firstByteSeq;
     }
 
   NS_LOG_DEBUG ("Discarded up to " << seq << " lost: " << m_lostOut <<
@@ -796,17 +854,18 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return bytesSacked;
         }
 
+      // The items starting before the block cannot be mapped over it
+      PacketList::const_iterator item_it = FindSentItemFrom ((*option_it).first);
+
       while (item_it != m_sentList.end ())
         {
+          SequenceNumber32 beginOfCurrentPacket = (*item_it)->m_startSeq;
           uint32_t pktSize = (*item_it)->m_packet->GetSize ();
 
           // Check the boundary of this packet ... only mark as sacked if
@@ -836,16 +895,17 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
                   m_sackedOut += (*item_it)->m_packet->GetSize ();
                   bytesSacked += (*item_it)->m_packet->GetSize ();
 
-                  if (m_highestSack.first == m_sentList.end()
-                      || m_highestSack.second <= beginOfCurrentPacket + pktSize)
+                  if (!m_highestSackValid
+                      || m_highestSack <= beginOfCurrentPacket + pktSize)
                     {
-                      m_highestSack = std::make_pair (item_it, beginOfCurrentPacket);
+                      m_highestSack = beginOfCurrentPacket;
+                      m_highestSackValid = true;
                     }
 
                   NS_LOG_INFO ("Received block " << *option_it <<
                                ", checking sentList for block " << *(*item_it) <<
                                ", found in the sackboard, sacking, current highSack: " <<
-                               m_highestSack.second);
+                               m_highestSack);
 
                   if (!sackedCb.IsNull ())
                     {
@@ -862,14 +922,13 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list,
               break;
             }
 
-          beginOfCurrentPacket += pktSize;
           ++item_it;
         }
     }
 
   if (bytesSacked > 0)
     {
-      NS_ASSERT_MSG (m_highestSack.first != m_sentList.end(), "Buffer status: " << *this);
+      NS_ASSERT_MSG (m_highestSackValid, "Buffer status: " << *this);
       UpdateLostCount ();
     }
 
@@ -886,21 +945,22 @@ TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
   uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
-  if (m_highestSack.first == m_sentList.end ())
-    {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from the latest sent item");
-    }
-  else
-    {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from item " << *(*m_highestSack.first));
-    }
+  PacketList::const_iterator highest = FindSentItem (m_highestSack);
+  PacketList::const_iterator threshItem = m_sentList.end ();
+  NS_ASSERT (m_highestSackValid && highest != m_sentList.end ());
+  NS_LOG_INFO ("Status before the update: " << *this <<
+               ", will start from item " << *(*highest));
 
-  for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+  for (auto it = highest; it != m_sentList.begin(); --it)
     {
       TcpTxItem *item = *it;
+      if (sacked >= m_dupAckThresh
+          && item->m_startSeq + item->m_packet->GetSize () <= m_lostBoundary)
+        {
+          // This item and the ones before it are already sacked or lost
+          break;
+        }
+
       if (item->m_sacked)
         {
           sacked++;
@@ -908,13 +968,17 @@ TcpTxBuffer::UpdateLostCount ()
 
       if (sacked >= m_dupAckThresh)
         {
+          if (threshItem == m_sentList.end ())
+            {
+              threshItem = it;
+            }
           if (!item->m_sacked && !item->m_lost)
             {
               item->m_lost = true;
               m_lostOut += item->m_packet->GetSize ();
+              LowerHints (item->m_startSeq);
             }
         }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
     }
 
   if (sacked >= m_dupAckThresh)
@@ -924,6 +988,18 @@ TcpTxBuffer::UpdateLostCount ()
         {
           item->m_lost = true;
           m_lostOut += item->m_packet->GetSize ();
+          LowerHints (item->m_startSeq);
+        }
+
+      // Now every item up to the one that reached the threshold is sacked
+      // or lost
+      if (threshItem != m_sentList.end ())
+        {
+          SequenceNumber32 end = (*threshItem)->m_startSeq + (*threshItem)->m_packet->GetSize ();
+          if (m_lostBoundary < end)
+            {
+              m_lostBoundary = end;
+            }
         }
     }
   NS_LOG_INFO ("Status after the update: " << *this);
@@ -935,35 +1011,26 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
   PacketList::const_iterator it;
 
-  if (seq >= m_highestSack.second)
+  if (seq >= m_highestSack)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  for (it = FindSentItemFrom (seq); it != m_sentList.end (); ++it)
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
+      if ((*it)->m_lost == true)
         {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
-
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
+          NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+          return true;
         }
 
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      if ((*it)->m_sacked == true)
+        {
+          NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+          return false;
+        }
     }
 
   return false;
@@ -991,33 +1058,22 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, SequenceNumber32 *seqHigh, bool isR
   TcpTxItem *item;
   SequenceNumber32 seqPerRule3;
   bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  for (it = FindSentItemFrom (m_lostHint); it != m_sentList.end (); ++it)
     {
       item = *it;
 
       // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
+      if (item->m_retrans == false && item->m_sacked == false && item->m_lost)
         {
-          if (item->m_lost)
-            {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
-              *seqHigh = *seq + m_segmentSize;
-              return true;
-            }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
+          NS_LOG_INFO("IsLost, returning" << item->m_startSeq);
+          m_lostHint = item->m_startSeq;
+          *seq = item->m_startSeq;
+          *seqHigh = *seq + m_segmentSize;
+          return true;
         }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
     }
+  m_lostHint = m_firstByteSeq + m_sentSize;
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
    *     exists available unsent data and the receiver's advertised
@@ -1051,6 +1107,35 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, SequenceNumber32 *seqHigh, bool isR
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
    */
+  if (isRecovery)
+    {
+      // No item is lost, so the first item neither retransmitted nor sacked
+      // is the one for rule 3 (unless it starts at 0, then it is the next
+      // one, if any)
+      for (it = FindSentItemFrom (m_rule3Hint); it != m_sentList.end (); ++it)
+        {
+          item = *it;
+          if (item->m_retrans == false && item->m_sacked == false)
+            {
+              NS_LOG_INFO ("Saving for rule 3 the seq " << item->m_startSeq);
+              if (!isSeqPerRule3Valid)
+                {
+                  m_rule3Hint = item->m_startSeq;
+                }
+              isSeqPerRule3Valid = true;
+              seqPerRule3 = item->m_startSeq;
+              if (seqPerRule3.GetValue () != 0)
+                {
+                  break;
+                }
+            }
+        }
+      if (!isSeqPerRule3Valid)
+        {
+          m_rule3Hint = m_firstByteSeq + m_sentSize;
+        }
+    }
+
   if (isSeqPerRule3Valid)
     {
       NS_LOG_INFO ("Rule3 valid. " << seqPerRule3);
@@ -1200,7 +1285,7 @@ TcpTxBuffer::IsLostRFC (const SequenceNumber32 &seq, const PacketList::const_ite
             }
         }
 
-      if (beginOfCurrentPacket >= m_highestSack.second)
+      if (beginOfCurrentPacket >= m_highestSack)
         {
           if (item->m_lost && !item->m_retrans)
             return true;
@@ -1211,9 +1296,9 @@ TcpTxBuffer::IsLostRFC (const SequenceNumber32 &seq, const PacketList::const_ite
 
       beginOfCurrentPacket += current->GetSize ();
     }
-  if (it == m_highestSack.first)
+  if (!m_highestSackValid)
     {
-      NS_LOG_INFO ("seq=" << seq << " is not lost because there are no sacked segment ahead " << m_highestSack.second);
+      NS_LOG_INFO ("seq=" << seq << " is not lost because there are no sacked segment ahead " << m_highestSack);
     }
   return false;
 }
@@ -1229,7 +1314,10 @@ TcpTxBuffer::ResetRenoSack ()
       (*it)->m_sacked = false;
     }
 
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_highestSack = SequenceNumber32 (0);
+  m_highestSackValid = false;
+  m_lostBoundary = m_firstByteSeq;
+  LowerHints (m_firstByteSeq);
 }
 
 void
@@ -1258,7 +1346,9 @@ TcpTxBuffer::ResetSentList ()
   m_lostOut = 0;
   m_retrans = 0;
   m_sackedOut = 0;
-  m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_highestSack = SequenceNumber32 (0);
+  m_highestSackValid = false;
+  m_lostHint = m_rule3Hint = m_lostBoundary = m_firstByteSeq;
 }
 
 void
@@ -1276,6 +1366,13 @@ TcpTxBuffer::ResetLastSegmentSent ()
           m_retrans -= item->m_packet->GetSize ();
         }
       m_appList.insert (m_appList.begin (), item);
+
+      // The item will be sent again from the same sequence
+      LowerHints (item->m_startSeq);
+      if (item->m_startSeq < m_lostBoundary)
+        {
+          m_lostBoundary = item->m_startSeq;
+        }
     }
   ConsistencyCheck ();
 }
@@ -1290,7 +1387,8 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
     {
       m_sackedOut = 0;
       m_lostOut = m_sentSize;
-      m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+      m_highestSack = SequenceNumber32 (0);
+      m_highestSackValid = false;
     }
   else
     {
@@ -1322,6 +1420,10 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
       (*it)->m_retrans = false;
     }
 
+  // Every item is now sacked or lost, and may be retransmitted
+  m_lostBoundary = m_firstByteSeq + m_sentSize;
+  LowerHints (m_firstByteSeq);
+
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
   NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
   ConsistencyCheck ();
@@ -1354,6 +1456,7 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
     {
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      LowerHints (m_sentList.front ()->m_startSeq);
     }
   ConsistencyCheck ();
 }
@@ -1383,6 +1486,7 @@ TcpTxBuffer::MarkHeadAsLost ()
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
         }
+      LowerHints (m_sentList.front ()->m_startSeq);
     }
   ConsistencyCheck ();
 }
@@ -1417,7 +1521,8 @@ TcpTxBuffer::AddRenoSack (void)
     {
       (*it)->m_sacked = true;
       m_sackedOut += (*it)->m_packet->GetSize ();
-      m_highestSack = std::make_pair (it, (*it)->m_startSeq);
+      m_highestSack = (*it)->m_startSeq;
+      m_highestSackValid = true;
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
     }
   else
@@ -1442,9 +1547,24 @@ TcpTxBuffer::ConsistencyCheck () const
   uint32_t sacked = 0;
   uint32_t lost = 0;
   uint32_t retrans = 0;
+  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
 
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
+      const TcpTxItem *item = *it;
+      NS_ASSERT_MSG (item->m_startSeq == beginOfCurrentPacket,
+                     "Item " << *item << " should start at " << beginOfCurrentPacket);
+      beginOfCurrentPacket += item->m_packet->GetSize ();
+      NS_ASSERT_MSG (item->m_startSeq >= m_lostHint || item->m_retrans
+                     || item->m_sacked || !item->m_lost,
+                     "Item " << *item << " is before the lost hint " << m_lostHint);
+      NS_ASSERT_MSG (item->m_startSeq >= m_rule3Hint || item->m_retrans
+                     || item->m_sacked,
+                     "Item " << *item << " is before the rule 3 hint " << m_rule3Hint);
+      NS_ASSERT_MSG (beginOfCurrentPacket > m_lostBoundary || item->m_sacked
+                     || item->m_lost,
+                     "Item " << *item << " is before the lost boundary " << m_lostBoundary);
+
       if ((*it)->m_sacked)
         {
           sacked += (*it)->m_packet->GetSize ();
@@ -22,6 +22,7 @@
 #ifndef TCP_TX_BUFFER_H
 #define TCP_TX_BUFFER_H
 
+#include <deque>
 #include "ns3/object.h"
 #include "ns3/traced-value.h"
 #include "ns3/sequence-number.h"
@@ -105,6 +106,13 @@ class Packet;
  * of the methods. To have a look how the calculations are made, please see
  * BytesInFlight method.
  *
+ * The sent items are stored in an array, ordered and contiguous by their
+ * starting sequence number, so that a sequence is found with a binary search
+ * instead of a walk. NextSeg and UpdateLostCount remember where their last
+ * walk stopped (see m_lostHint, m_rule3Hint and m_lostBoundary), so that with
+ * a large window the cost of an ACK does not grow with the number of
+ * segments in flight.
+ *
  * Lost segments
  * -------------
  *
@@ -411,7 +419,7 @@ public:
 private:
   friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
 
-  typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  typedef std::deque<TcpTxItem*> PacketList; //!< container for data stored in the buffer
 
   /**
    * \brief Update the lost count
@@ -428,8 +436,9 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
+   * and updates the lost count. The walk starts from the highest SACKed item
+   * and stops at m_lostBoundary, below which every item is already SACKed or
+   * lost, so that the cost of a SACK block does not grow with the window.
    *
    */
   void UpdateLostCount ();
@@ -594,6 +603,37 @@ private:
    */
   void ConsistencyCheck () const;
 
+  /**
+   * \brief Find the item of the sent list that contains a sequence number
+   *
+   * The items of the sent list are contiguous and sorted by their starting
+   * sequence, so this is a binary search.
+   *
+   * \param seq the sequence number
+   * \return the last item starting at or before seq, or the first item if all
+   * the items start after seq (end () if the sent list is empty)
+   */
+  PacketList::const_iterator FindSentItem (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Find the first item of the sent list that starts at or after a
+   * sequence number
+   *
+   * \param seq the sequence number
+   * \return the first item starting at or after seq, or end () if none
+   */
+  PacketList::const_iterator FindSentItemFrom (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Lower the sequence numbers that the scoreboard walks start from
+   *
+   * Called when the item starting at seq may have become a candidate for
+   * the rule 1 or the rule 3 of NextSeg.
+   *
+   * \param seq the starting sequence of the item
+   */
+  void LowerHints (const SequenceNumber32 &seq) const;
+
   /**
    * \brief Find the highest SACK byte
    * \return a pair with the highest byte and an iterator inside m_sentList
@@ -609,7 +649,17 @@ private:
   Callback<uint32_t> m_rWndCallback; //!< Callback to obtain RCV.WND value
 
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
-  std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
+  SequenceNumber32 m_highestSack {0}; //!< Start of the highest SACKed item (0 if none)
+  bool m_highestSackValid {false};     //!< Indicates if m_highestSack refers to an item
+
+  // Every sent item starting before m_lostHint is retransmitted, SACKed, or
+  // not lost, and every sent item starting before m_rule3Hint is
+  // retransmitted or SACKed: NextSeg starts its walks from there. Every sent
+  // item ending at or before m_lostBoundary is SACKed or lost: UpdateLostCount
+  // does not walk below it.
+  mutable SequenceNumber32 m_lostHint {0};  //!< First possible NextSeg rule 1 item
+  mutable SequenceNumber32 m_rule3Hint {0}; //!< First possible NextSeg rule 3 item
+  mutable SequenceNumber32 m_lostBoundary {0}; //!< End of the SACKed or lost prefix
 
   uint32_t m_lostOut   {0}; //!< Number of lost bytes
   uint32_t m_sackedOut {0}; //!< Number of sacked bytes
@@ -202,6 +202,13 @@ GlobalRouteManagerImplTestCase::DoRun (void)
   srmlsdb->Insert (lsa2->GetLinkStateId (), lsa2);
   srmlsdb->Insert (lsa3->GetLinkStateId (), lsa3);
   NS_ASSERT (lsa2 == srmlsdb->GetLSA (lsa2->GetLinkStateId ()));
+  NS_TEST_ASSERT_MSG_EQ (srmlsdb->GetNumLSAs (), 4, "Wrong number of LSAs");
+  NS_TEST_ASSERT_MSG_EQ (srmlsdb->GetIndex (lsa3->GetLinkStateId ()), 3, "LSAs are indexed in insertion order");
+  NS_TEST_ASSERT_MSG_EQ (srmlsdb->GetLSAByIndex (1), lsa1, "Wrong LSA for index 1");
+  NS_TEST_ASSERT_MSG_EQ (srmlsdb->GetIndex ("0.0.0.4"), -1, "Unknown LSA has an index");
+  NS_TEST_ASSERT_MSG_EQ (srmlsdb->GetLSA ("0.0.0.4"), 0, "Unknown LSA found");
+  NS_TEST_ASSERT_MSG_EQ (srmlsdb->GetLSAByLinkData ("10.1.1.1"), 0, "Point-to-point link data found as a transit network");
+  NS_TEST_ASSERT_MSG_EQ (lsa2->GetLinkRecord (3)->GetLinkId (), lr7->GetLinkId (), "Wrong link record");
 
   // next, calculate routes based on the manually created LSDB
   GlobalRouteManagerImpl* srm = new GlobalRouteManagerImpl ();
@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/simple-net-device.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Base class of the Ipv4EndPointDemux tests: owns the demux and
+ * an interface with address 10.0.0.1/24.
+ */
+class Ipv4EndPointDemuxTestBase : public TestCase
+{
+public:
+  /**
+   * \param name the test name
+   */
+  Ipv4EndPointDemuxTestBase (std::string name);
+
+protected:
+  virtual void DoSetup (void);
+  virtual void DoTeardown (void);
+  /**
+   * \brief Look up a packet received on the interface.
+   * \param daddr destination address
+   * \param dport destination port
+   * \param saddr source address
+   * \param sport source port
+   * \return the single matching end point, or 0
+   */
+  Ipv4EndPoint *Lookup (Ipv4Address daddr, uint16_t dport, Ipv4Address saddr, uint16_t sport);
+
+  Ipv4EndPointDemux *m_demux;      //!< the demux under test
+  Ptr<Ipv4Interface> m_interface;  //!< the incoming interface
+};
+
+Ipv4EndPointDemuxTestBase::Ipv4EndPointDemuxTestBase (std::string name)
+  : TestCase (name),
+    m_demux (0)
+{
+}
+
+void
+Ipv4EndPointDemuxTestBase::DoSetup (void)
+{
+  m_demux = new Ipv4EndPointDemux ();
+  m_interface = CreateObject<Ipv4Interface> ();
+  m_interface->SetDevice (CreateObject<SimpleNetDevice> ());
+  m_interface->AddAddress (Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("/24")));
+}
+
+void
+Ipv4EndPointDemuxTestBase::DoTeardown (void)
+{
+  delete m_demux;
+  m_demux = 0;
+  m_interface = 0;
+}
+
+Ipv4EndPoint *
+Ipv4EndPointDemuxTestBase::Lookup (Ipv4Address daddr, uint16_t dport, Ipv4Address saddr, uint16_t sport)
+{
+  Ipv4EndPointDemux::EndPoints endPoints = m_demux->Lookup (daddr, dport, saddr, sport, m_interface);
+  return endPoints.empty () ? 0 : endPoints.front ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief The most specific end point wins: connection, then local
+ * address, then wildcard.
+ */
+class Ipv4EndPointDemuxPrecedenceTest : public Ipv4EndPointDemuxTestBase
+{
+public:
+  Ipv4EndPointDemuxPrecedenceTest ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxPrecedenceTest::Ipv4EndPointDemuxPrecedenceTest ()
+  : Ipv4EndPointDemuxTestBase ("Ipv4EndPointDemux match precedence")
+{
+}
+
+void
+Ipv4EndPointDemuxPrecedenceTest::DoRun (void)
+{
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("10.0.0.2");
+  Ipv4EndPoint *any = m_demux->Allocate (0, 80);
+  Ipv4EndPoint *bound = m_demux->Allocate (0, local, 80);
+  Ipv4EndPoint *connection = m_demux->Allocate (0, local, 80, peer, 1234);
+  Ipv4EndPoint *other = m_demux->Allocate (0, 81);
+
+  NS_TEST_ASSERT_MSG_EQ (Lookup (local, 80, peer, 1234), connection, "Connection should win");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (local, 80, peer, 1234), connection, "Cached connection should win");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (local, 80, peer, 1235), bound, "Bound address should win over wildcard");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (Ipv4Address ("10.0.0.9"), 80, peer, 1234), any, "Wildcard should match other addresses");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (local, 81, peer, 1234), other, "Wrong port");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (local, 82, peer, 1234), 0, "No end point on this port");
+  NS_TEST_ASSERT_MSG_EQ (m_demux->SimpleLookup (local, 80, peer, 1234), connection, "SimpleLookup exact match");
+  NS_TEST_ASSERT_MSG_EQ (m_demux->SimpleLookup (local, 81, peer, 1), other, "SimpleLookup generic match");
+  NS_TEST_ASSERT_MSG_EQ (m_demux->GetAllEndPoints ().size (), 4, "Wrong number of end points");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Changes to an end point after it was matched are honored.
+ */
+class Ipv4EndPointDemuxUpdateTest : public Ipv4EndPointDemuxTestBase
+{
+public:
+  Ipv4EndPointDemuxUpdateTest ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxUpdateTest::Ipv4EndPointDemuxUpdateTest ()
+  : Ipv4EndPointDemuxTestBase ("Ipv4EndPointDemux end point updates")
+{
+}
+
+void
+Ipv4EndPointDemuxUpdateTest::DoRun (void)
+{
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("10.0.0.2");
+  Ipv4EndPoint *listener = m_demux->Allocate (0, local, 80);
+  Ipv4EndPoint *connection = m_demux->Allocate (0, local, 80, peer, 1234);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (local, 80, peer, 1234), connection, "Connection should win");
+
+  connection->SetRxEnabled (false);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (local, 80, peer, 1234), listener, "Disabled end point must be skipped");
+  connection->SetRxEnabled (true);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (local, 80, peer, 1234), connection, "Enabled end point must match again");
+
+  connection->SetPeer (peer, 4321);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (local, 80, peer, 1234), listener, "Old peer must not match");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (local, 80, peer, 4321), connection, "New peer must match");
+
+  connection->BindToNetDevice (CreateObject<SimpleNetDevice> ());
+  NS_TEST_ASSERT_MSG_EQ (Lookup (local, 80, peer, 4321), listener, "End point bound to another device");
+  connection->BindToNetDevice (m_interface->GetDevice ());
+  NS_TEST_ASSERT_MSG_EQ (Lookup (local, 80, peer, 4321), connection, "End point bound to the device");
+
+  m_demux->DeAllocate (connection);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (local, 80, peer, 4321), listener, "Deallocated end point must not match");
+  m_demux->DeAllocate (listener);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (local, 80, peer, 4321), 0, "No end point left");
+  NS_TEST_ASSERT_MSG_EQ (m_demux->LookupPortLocal (80), false, "Port should be free");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Allocation rules: duplicates, ephemeral ports and
+ * subnet-directed broadcast.
+ */
+class Ipv4EndPointDemuxAllocateTest : public Ipv4EndPointDemuxTestBase
+{
+public:
+  Ipv4EndPointDemuxAllocateTest ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxAllocateTest::Ipv4EndPointDemuxAllocateTest ()
+  : Ipv4EndPointDemuxTestBase ("Ipv4EndPointDemux allocation")
+{
+}
+
+void
+Ipv4EndPointDemuxAllocateTest::DoRun (void)
+{
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("10.0.0.2");
+  NS_TEST_ASSERT_MSG_NE (m_demux->Allocate (0, local, 80), 0, "First bind must succeed");
+  NS_TEST_ASSERT_MSG_EQ (m_demux->Allocate (0, local, 80), 0, "Duplicate bind must fail");
+  NS_TEST_ASSERT_MSG_NE (m_demux->Allocate (0, local, 80, peer, 1), 0, "Connection must succeed");
+  NS_TEST_ASSERT_MSG_EQ (m_demux->Allocate (0, local, 80, peer, 1), 0, "Duplicate connection must fail");
+  NS_TEST_ASSERT_MSG_EQ (m_demux->LookupLocal (0, local, 80), true, "Local lookup");
+  NS_TEST_ASSERT_MSG_EQ (m_demux->LookupLocal (0, local, 81), false, "Local lookup on free port");
+
+  Ipv4EndPoint *first = m_demux->Allocate ();
+  Ipv4EndPoint *second = m_demux->Allocate ();
+  NS_TEST_ASSERT_MSG_NE (first->GetLocalPort (), second->GetLocalPort (), "Ephemeral ports must differ");
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (first->GetLocalPort (), 49152, "Ephemeral port out of range");
+
+  Ipv4EndPoint *subnet = m_demux->Allocate (0, Ipv4Address ("10.0.0.0"), 90);
+  NS_TEST_ASSERT_MSG_EQ (Lookup (Ipv4Address ("10.0.0.255"), 90, peer, 1), subnet, "Subnet-directed broadcast");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (Ipv4Address ("10.1.0.255"), 90, peer, 1), 0, "Broadcast of another subnet");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux TestSuite
+ */
+class Ipv4EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  Ipv4EndPointDemuxTestSuite ();
+};
+
+Ipv4EndPointDemuxTestSuite::Ipv4EndPointDemuxTestSuite ()
+  : TestSuite ("ipv4-end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv4EndPointDemuxPrecedenceTest, TestCase::QUICK);
+  AddTestCase (new Ipv4EndPointDemuxUpdateTest, TestCase::QUICK);
+  AddTestCase (new Ipv4EndPointDemuxAllocateTest, TestCase::QUICK);
+}
+
+static Ipv4EndPointDemuxTestSuite g_ipv4EndPointDemuxTestSuite; //!< Static variable for test initialization
@@ -14,6 +14,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <sstream>
 #include <vector>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
@@ -41,6 +42,7 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
+#include "ns3/global-route-manager.h"
 #include "ns3/bridge-helper.h"
 
 using namespace ns3;
@@ -1244,6 +1246,111 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting parallel and incremental SPF test.
+ *
+ * Six routers on a ring of point-to-point links.  The routes computed
+ * with two threads must be the ones computed with one, and after a link
+ * metric change the incremental recomputation must give the routes of a
+ * full recomputation while running the SPF of fewer routers.
+ */
+class Ipv4GlobalRoutingIncrementalTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingIncrementalTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * \param nodes the nodes
+   * \return the global routes of the nodes, one per line
+   */
+  std::string DumpRoutes (NodeContainer nodes);
+};
+
+Ipv4GlobalRoutingIncrementalTestCase::Ipv4GlobalRoutingIncrementalTestCase ()
+  : TestCase ("Global routing with parallel and incremental SPF")
+{
+}
+
+std::string
+Ipv4GlobalRoutingIncrementalTestCase::DumpRoutes (NodeContainer nodes)
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<Ipv4L3Protocol> ()
+        ->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          oss << "n" << i << " " << *routing->GetRoute (j) << std::endl;
+        }
+    }
+  return oss.str ();
+}
+
+void
+Ipv4GlobalRoutingIncrementalTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (6);
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      NetDeviceContainer net = simpleHelper.Install (nodes.Get (i), channel);
+      net.Add (simpleHelper.Install (nodes.Get ((i + 1) % nodes.GetN ()), channel));
+      ipv4.Assign (net);
+      ipv4.NewNetwork ();
+    }
+
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::string reference = DumpRoutes (nodes);
+  NS_TEST_ASSERT_MSG_NE (reference, "", "No global routes");
+
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (2));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (DumpRoutes (nodes), reference, "Routes depend on the number of threads");
+
+  // The first recomputation in incremental mode is a full one, which
+  // records the distances.
+  Config::SetGlobal ("GlobalRoutingIncremental", BooleanValue (true));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (DumpRoutes (nodes), reference, "Routes changed without any link change");
+
+  // Make the link from n0 to n1 expensive: only the routers whose
+  // shortest paths may cross it must be recomputed.
+  Ptr<Ipv4> ipv40 = nodes.Get (0)->GetObject<Ipv4> ();
+  ipv40->SetMetric (1, 10);
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  std::string incremental = DumpRoutes (nodes);
+  NS_TEST_EXPECT_MSG_NE (incremental, reference, "Metric change not taken into account");
+  GlobalRouteManager::Statistics stats = GlobalRouteManager::GetStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (stats.nRouters, 6, "Wrong number of routers");
+  NS_TEST_EXPECT_MSG_GT (stats.nCalculated, 0, "Affected routers were not recomputed");
+  NS_TEST_EXPECT_MSG_LT (stats.nCalculated, stats.nRouters, "Unaffected routers were recomputed");
+
+  Config::SetGlobal ("GlobalRoutingIncremental", BooleanValue (false));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  NS_TEST_EXPECT_MSG_EQ (DumpRoutes (nodes), incremental, "Incremental and full recomputations differ");
+  stats = GlobalRouteManager::GetStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (stats.nCalculated, stats.nRouters, "Full recomputation skipped routers");
+
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1374,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingIncrementalTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
@@ -22,6 +22,9 @@
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/node.h"
 #include "ns3/node-container.h"
 #include "ns3/packet.h"
@@ -201,6 +204,96 @@ Ipv4StaticRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 StaticRouting route selection among overlapping prefixes
+ */
+class Ipv4StaticRoutingLongestPrefixTestCase : public TestCase
+{
+public:
+  Ipv4StaticRoutingLongestPrefixTestCase ();
+
+private:
+  /**
+   * \param dest the destination
+   * \return the gateway of the route selected for dest, or 0.0.0.0
+   */
+  Ipv4Address GetGateway (Ipv4Address dest);
+  virtual void DoRun (void);
+
+  Ptr<Ipv4StaticRouting> m_routing; //!< routing protocol under test
+};
+
+Ipv4StaticRoutingLongestPrefixTestCase::Ipv4StaticRoutingLongestPrefixTestCase ()
+  : TestCase ("Static routing selects the longest prefix, then the lowest metric")
+{
+}
+
+Ipv4Address
+Ipv4StaticRoutingLongestPrefixTestCase::GetGateway (Ipv4Address dest)
+{
+  Ipv4Header header;
+  header.SetDestination (dest);
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv4Route> route = m_routing->RouteOutput (Create<Packet> (), header, 0, sockerr);
+  return route ? route->GetGateway () : Ipv4Address::GetZero ();
+}
+
+void
+Ipv4StaticRoutingLongestPrefixTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  m_routing = CreateObject<Ipv4StaticRouting> ();
+  m_routing->SetIpv4 (node->GetObject<Ipv4> ());
+
+  // Every route goes through the loopback interface.
+  m_routing->AddNetworkRouteTo ("10.0.0.0", "255.0.0.0", "127.0.0.1", 0);
+  m_routing->AddNetworkRouteTo ("10.1.0.0", "255.255.0.0", "127.0.0.2", 0, 5);
+  m_routing->AddNetworkRouteTo ("10.1.0.0", "255.255.0.0", "127.0.0.3", 0, 1);
+  m_routing->AddNetworkRouteTo ("10.1.0.0", "255.255.0.0", "127.0.0.4", 0, 1);
+  m_routing->AddHostRouteTo ("10.1.2.3", "127.0.0.5", 0, 9);
+  m_routing->AddHostRouteTo ("10.1.2.3", "127.0.0.6", 0, 0);
+  m_routing->SetDefaultRoute ("127.0.0.7", 0);
+
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("10.1.2.3"), Ipv4Address ("127.0.0.5"),
+                         "The first host route must win");
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("10.1.9.9"), Ipv4Address ("127.0.0.4"),
+                         "The last of the lowest metric /16 routes must win");
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("10.2.0.1"), Ipv4Address ("127.0.0.1"),
+                         "Only the /8 route matches");
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("11.0.0.1"), Ipv4Address ("127.0.0.7"),
+                         "Only the default route matches");
+
+  for (uint32_t i = 0; i < m_routing->GetNRoutes (); )
+    {
+      Ipv4Address gateway = m_routing->GetRoute (i).GetGateway ();
+      if (gateway == Ipv4Address ("127.0.0.5") || gateway == Ipv4Address ("127.0.0.4"))
+        {
+          m_routing->RemoveRoute (i);
+        }
+      else
+        {
+          i++;
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("10.1.2.3"), Ipv4Address ("127.0.0.6"),
+                         "The remaining host route must win");
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("10.1.9.9"), Ipv4Address ("127.0.0.3"),
+                         "The remaining lowest metric /16 route must win");
+
+  m_routing->NotifyInterfaceDown (0);
+  NS_TEST_ASSERT_MSG_EQ (GetGateway ("10.1.2.3"), Ipv4Address::GetZero (),
+                         "Routes through a down interface must be gone");
+
+  m_routing->Dispose ();
+  m_routing = 0;
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -217,6 +310,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite ()
   : TestSuite ("ipv4-static-routing", UNIT)
 {
   AddTestCase (new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4StaticRoutingLongestPrefixTestCase, TestCase::QUICK);
 }
 
 static Ipv4StaticRoutingTestSuite ipv4StaticRoutingTestSuite; //!< Static variable for test initialization
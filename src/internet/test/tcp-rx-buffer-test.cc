@@ -44,6 +44,14 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+  /**
+   * \brief Test the SACK list update when a block no longer fits the list.
+   */
+  void TestSackBlockOutOfList ();
+  /**
+   * \brief Test that Extract leaves the packets given to Add unchanged.
+   */
+  void TestExtractKeepsPackets ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +63,8 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestSackBlockOutOfList ();
+  TestExtractKeepsPackets ();
 }
 
 void
@@ -338,6 +348,96 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestSackBlockOutOfList ()
+{
+  TcpRxBuffer rxBuf;
+  TcpOptionSack::SackList sackList;
+  TcpOptionSack::SackList::iterator it;
+  Ptr<Packet> p = Create<Packet> (100);
+  TcpHeader h;
+
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+
+  // Five isolated blocks: the oldest one (201-301) does not fit in the list
+  for (uint32_t i = 201; i <= 1001; i += 200)
+    {
+      h.SetSequenceNumber (SequenceNumber32 (i));
+      rxBuf.Add (p, h);
+    }
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 4,
+                         "SACK list should contain four elements");
+  NS_TEST_ASSERT_MSG_EQ (sackList.front ().first, SequenceNumber32 (1001),
+                         "SACK block different than expected");
+
+  // Fill 301-401: the first block must be the whole contiguous interval,
+  // including the data of the block that was out of the list (RFC 2018),
+  // and the block 401-501, now part of it, is removed
+  h.SetSequenceNumber (SequenceNumber32 (301));
+  rxBuf.Add (p, h);
+
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (1),
+                         "Sequence number differs from expected");
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 4,
+                         "SACK list should contain four elements");
+  it = sackList.begin ();
+  NS_TEST_ASSERT_MSG_EQ (it->first, SequenceNumber32 (201),
+                         "SACK block different than expected");
+  NS_TEST_ASSERT_MSG_EQ (it->second, SequenceNumber32 (501),
+                         "SACK block different than expected");
+  ++it;
+  NS_TEST_ASSERT_MSG_EQ (it->first, SequenceNumber32 (1001),
+                         "SACK block different than expected");
+  ++it;
+  NS_TEST_ASSERT_MSG_EQ (it->first, SequenceNumber32 (801),
+                         "SACK block different than expected");
+  ++it;
+  NS_TEST_ASSERT_MSG_EQ (it->first, SequenceNumber32 (601),
+                         "SACK block different than expected");
+
+  // In order data: everything up to 501 is acknowledged, and the
+  // other blocks remain
+  h.SetSequenceNumber (SequenceNumber32 (1));
+  rxBuf.Add (Create<Packet> (200), h);
+
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.NextRxSequence (), SequenceNumber32 (501),
+                         "Sequence number differs from expected");
+  sackList = rxBuf.GetSackList ();
+  NS_TEST_ASSERT_MSG_EQ (sackList.size (), 3,
+                         "SACK list should contain three elements");
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), 500,
+                         "Available bytes differ from expected");
+}
+
+void
+TcpRxBufferTestCase::TestExtractKeepsPackets ()
+{
+  TcpRxBuffer rxBuf;
+  std::vector<Ptr<Packet> > packets;
+  TcpHeader h;
+
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+
+  // Five in order packets, still held here as the Rx trace of the socket
+  // holds them, extracted in one packet
+  for (uint32_t i = 0; i < 5; ++i)
+    {
+      packets.push_back (Create<Packet> (100));
+      h.SetSequenceNumber (SequenceNumber32 (1 + i * 100));
+      rxBuf.Add (packets.back (), h);
+    }
+  Ptr<Packet> out = rxBuf.Extract (500);
+  NS_TEST_ASSERT_MSG_EQ (out->GetSize (), 500,
+                         "Extracted size differs from expected");
+  for (uint32_t i = 0; i < packets.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (packets[i]->GetSize (), 100,
+                             "Extract modified a packet given to Add");
+    }
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
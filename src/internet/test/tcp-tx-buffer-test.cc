@@ -53,6 +53,8 @@ private:
   /** \brief Test the logic of merging items in GetTransmittedSegment()
    * which is triggered by CopyFromSequence()*/
   void TestMergeItemsWhenGetTransmittedSegment ();
+  /** \brief Test the scoreboard of a window with many segments and holes */
+  void TestLargeWindow ();
   /** \brief Callback to provide a value of receiver window */
   uint32_t GetRWnd (void) const;
 };
@@ -98,6 +100,15 @@ TcpTxBufferTestCase::DoRun ()
   Simulator::Schedule (Seconds (0.0),
                          &TcpTxBufferTestCase::TestMergeItemsWhenGetTransmittedSegment, this);
 
+  /*
+   * Case for a large window:
+   *  -> one segment out of two is SACKed, one block per ACK
+   *  -> all the holes but the last two are lost, and retransmitted in order
+   *     (rule 1 of NextSeg), then the last two are retransmitted (rule 3)
+   */
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestLargeWindow, this);
+
   Simulator::Run ();
   Simulator::Destroy ();
 }
@@ -382,6 +393,72 @@ TcpTxBufferTestCase::TestMergeItemsWhenGetTransmittedSegment ()
   txBuf.CopyFromSequence (2000, SequenceNumber32(1));
 }
 
+void
+TcpTxBufferTestCase::TestLargeWindow ()
+{
+  const uint32_t segSize = 1000;
+  const uint32_t nSegments = 2000;
+  Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer> ();
+  txBuf->SetRWndCallback (MakeCallback (&TcpTxBufferTestCase::GetRWnd, this));
+  txBuf->SetHeadSequence (SequenceNumber32 (1));
+  txBuf->SetSegmentSize (segSize);
+  txBuf->SetDupAckThresh (3);
+  txBuf->SetMaxBufferSize (nSegments * segSize);
+
+  txBuf->Add (Create<Packet> (nSegments * segSize));
+  for (uint32_t i = 0; i < nSegments; ++i)
+    {
+      txBuf->CopyFromSequence (segSize, SequenceNumber32 (i * segSize + 1));
+    }
+
+  // SACK the odd segments, as the receiver reports them
+  for (uint32_t i = 1; i < nSegments; i += 2)
+    {
+      Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+      sack->AddSackBlock (TcpOptionSack::SackBlock (SequenceNumber32 (i * segSize + 1),
+                                                    SequenceNumber32 ((i + 1) * segSize + 1)));
+      NS_TEST_ASSERT_MSG_EQ (txBuf->Update (sack->GetSackList ()), segSize,
+                             "Segment " << i << " not sacked");
+    }
+
+  // The holes below the third SACKed segment from the top are lost
+  uint32_t nLost = nSegments / 2 - 2;
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSacked (), nSegments / 2 * segSize,
+                         "Wrong sacked count");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), nLost * segSize, "Wrong lost count");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->BytesInFlight (), 2 * segSize,
+                         "Wrong bytes in flight");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (SequenceNumber32 ((2 * nLost - 2) * segSize + 1)), true,
+                         "The last lost hole is not lost");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->IsLost (SequenceNumber32 (2 * nLost * segSize + 1)), false,
+                         "The first hole not lost is lost");
+
+  // Retransmit every hole, in order
+  SequenceNumber32 seq;
+  SequenceNumber32 seqHigh;
+  for (uint32_t i = 0; i < nSegments; i += 2)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&seq, &seqHigh, true), true,
+                             "No segment to retransmit");
+      NS_TEST_ASSERT_MSG_EQ (seq, SequenceNumber32 (i * segSize + 1),
+                             "Wrong segment to retransmit");
+      txBuf->CopyFromSequence (segSize, seq);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf->NextSeg (&seq, &seqHigh, true), false,
+                         "Segment to retransmit after all the holes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetRetransmitsCount (), nSegments / 2 * segSize,
+                         "Wrong retransmitted count");
+
+  // A cumulative ACK in the middle of the window
+  txBuf->DiscardUpTo (SequenceNumber32 (nSegments / 2 * segSize + 1));
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetSacked (), nSegments / 4 * segSize,
+                         "Wrong sacked count after the cumulative ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetLost (), (nLost - nSegments / 4) * segSize,
+                         "Wrong lost count after the cumulative ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf->GetRetransmitsCount (), nSegments / 4 * segSize,
+                         "Wrong retransmitted count after the cumulative ACK");
+}
+
 void
 TcpTxBufferTestCase::TestTransmittedBlock ()
 {
@@ -0,0 +1,496 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "mpi-partition-helper.h"
+
+#include "ns3/mpi-interface.h"
+
+#include <ns3/assert.h>
+#include <ns3/log.h>
+#include <ns3/uinteger.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <set>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MpiPartitionHelper");
+
+/**
+ * \brief Find the representative of a union-find set, halving the path.
+ * \param parent the union-find forest
+ * \param i the element
+ * \return the representative of the set of \p i
+ */
+static uint32_t
+FindRoot (std::vector<uint32_t> &parent, uint32_t i)
+{
+  while (parent[i] != i)
+    {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+  return i;
+}
+
+MpiPartitionHelper::MpiPartitionHelper ()
+  : m_tolerance (1.05),
+    m_passes (8),
+    m_lookahead (Time::Max ()),
+    m_cutSize (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MpiPartitionHelper::SetImbalanceTolerance (double tolerance)
+{
+  NS_LOG_FUNCTION (this << tolerance);
+  NS_ASSERT_MSG (tolerance >= 1.0, "Imbalance tolerance must be at least 1.0");
+  m_tolerance = tolerance;
+}
+
+void
+MpiPartitionHelper::SetRefinementPasses (uint32_t passes)
+{
+  NS_LOG_FUNCTION (this << passes);
+  m_passes = passes;
+}
+
+uint32_t
+MpiPartitionHelper::GetIndex (Ptr<Node> node, uint32_t weight)
+{
+  NS_ASSERT (node != 0);
+  std::map<uint32_t, uint32_t>::const_iterator it = m_index.find (node->GetId ());
+  if (it != m_index.end ())
+    {
+      return it->second;
+    }
+  uint32_t index = m_nodes.size ();
+  m_index[node->GetId ()] = index;
+  m_nodes.push_back (node);
+  m_weights.push_back (weight);
+  return index;
+}
+
+void
+MpiPartitionHelper::AddNode (Ptr<Node> node, uint32_t weight)
+{
+  NS_LOG_FUNCTION (this << node << weight);
+  NS_ASSERT_MSG (weight > 0, "Node weights must be positive");
+  m_weights[GetIndex (node, weight)] = weight;
+}
+
+void
+MpiPartitionHelper::AddNodes (NodeContainer c)
+{
+  NS_LOG_FUNCTION (this);
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      GetIndex (*i, 1);
+    }
+}
+
+void
+MpiPartitionHelper::AddLink (Ptr<Node> a, Ptr<Node> b, Time delay)
+{
+  NS_LOG_FUNCTION (this << a << b << delay);
+  Link link;
+  link.a = GetIndex (a, 1);
+  link.b = GetIndex (b, 1);
+  link.delay = delay;
+  if (link.a != link.b)
+    {
+      m_links.push_back (link);
+    }
+}
+
+void
+MpiPartitionHelper::Contract (Time threshold, std::vector<uint32_t> &cluster,
+                              std::vector<uint32_t> &clusterWeight) const
+{
+  uint32_t n = m_nodes.size ();
+  std::vector<uint32_t> parent (n);
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      parent[i] = i;
+    }
+  for (std::vector<Link>::const_iterator it = m_links.begin (); it != m_links.end (); ++it)
+    {
+      if (it->delay < threshold)
+        {
+          uint32_t ra = FindRoot (parent, it->a);
+          uint32_t rb = FindRoot (parent, it->b);
+          // Keep the smallest index as representative so that the
+          // cluster numbering does not depend on the link order.
+          if (ra < rb)
+            {
+              parent[rb] = ra;
+            }
+          else if (rb < ra)
+            {
+              parent[ra] = rb;
+            }
+        }
+    }
+
+  std::vector<uint32_t> id (n, std::numeric_limits<uint32_t>::max ());
+  cluster.assign (n, 0);
+  clusterWeight.clear ();
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      uint32_t root = FindRoot (parent, i);
+      if (id[root] == std::numeric_limits<uint32_t>::max ())
+        {
+          id[root] = clusterWeight.size ();
+          clusterWeight.push_back (0);
+        }
+      cluster[i] = id[root];
+      clusterWeight[id[root]] += m_weights[i];
+    }
+}
+
+bool
+MpiPartitionHelper::IsPackable (std::vector<uint32_t> clusterWeight, uint32_t nParts, uint32_t capacity)
+{
+  std::sort (clusterWeight.begin (), clusterWeight.end (), std::greater<uint32_t> ());
+  std::vector<uint64_t> load (nParts, 0);
+  for (std::vector<uint32_t>::const_iterator it = clusterWeight.begin (); it != clusterWeight.end (); ++it)
+    {
+      std::vector<uint64_t>::iterator lightest = std::min_element (load.begin (), load.end ());
+      if (*lightest + *it > capacity)
+        {
+          return false;
+        }
+      *lightest += *it;
+    }
+  return true;
+}
+
+std::vector<uint32_t>
+MpiPartitionHelper::Partition (uint32_t nParts)
+{
+  NS_LOG_FUNCTION (this << nParts);
+  NS_ASSERT_MSG (nParts > 0, "Cannot partition into zero ranks");
+
+  uint32_t n = m_nodes.size ();
+  m_parts.assign (n, 0);
+  m_lookahead = Time::Max ();
+  m_cutSize = 0;
+  if (n == 0)
+    {
+      return m_parts;
+    }
+
+  uint64_t totalWeight = 0;
+  uint32_t maxWeight = 0;
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      totalWeight += m_weights[i];
+      maxWeight = std::max (maxWeight, m_weights[i]);
+    }
+  uint32_t capacity = std::max<uint32_t> (maxWeight,
+                                          std::ceil (m_tolerance * totalWeight / nParts));
+
+  // Select the largest lookahead for which the links that must stay
+  // inside a rank still leave a balanced packing.  Index delays.size ()
+  // stands for "contract every link".
+  std::vector<Time> delays;
+  for (std::vector<Link>::const_iterator it = m_links.begin (); it != m_links.end (); ++it)
+    {
+      delays.push_back (it->delay);
+    }
+  std::sort (delays.begin (), delays.end ());
+  delays.erase (std::unique (delays.begin (), delays.end ()), delays.end ());
+  delays.push_back (Time::Max ());
+
+  std::vector<uint32_t> cluster;
+  std::vector<uint32_t> clusterWeight;
+  uint32_t lo = 0;
+  uint32_t hi = delays.size () - 1;
+  while (lo < hi)
+    {
+      uint32_t mid = (lo + hi + 1) / 2;
+      Contract (delays[mid], cluster, clusterWeight);
+      if (IsPackable (clusterWeight, nParts, capacity))
+        {
+          lo = mid;
+        }
+      else
+        {
+          hi = mid - 1;
+        }
+    }
+  Contract (delays[lo], cluster, clusterWeight);
+  uint32_t nClusters = clusterWeight.size ();
+  NS_LOG_LOGIC ("Lookahead threshold " << delays[lo] << " leaves " << nClusters << " clusters");
+
+  // Links between clusters, with multiplicity.
+  std::vector<std::map<uint32_t, uint32_t> > adjacency (nClusters);
+  for (std::vector<Link>::const_iterator it = m_links.begin (); it != m_links.end (); ++it)
+    {
+      uint32_t ca = cluster[it->a];
+      uint32_t cb = cluster[it->b];
+      if (ca != cb)
+        {
+          adjacency[ca][cb]++;
+          adjacency[cb][ca]++;
+        }
+    }
+
+  // Greedy graph growing: each rank starts from the heaviest free
+  // cluster and absorbs the free cluster with the most links into it
+  // until it reaches its share of the remaining weight.
+  std::vector<uint32_t> part (nClusters, nParts);
+  std::vector<uint64_t> load (nParts, 0);
+  std::vector<uint32_t> frontierLinks (nClusters, 0);
+  uint64_t remaining = totalWeight;
+  uint32_t unassigned = nClusters;
+  for (uint32_t p = 0; p < nParts && unassigned > 0; ++p)
+    {
+      if (p == nParts - 1)
+        {
+          for (uint32_t c = 0; c < nClusters; ++c)
+            {
+              if (part[c] == nParts)
+                {
+                  part[c] = p;
+                  load[p] += clusterWeight[c];
+                }
+            }
+          break;
+        }
+      uint64_t target = (remaining + (nParts - p) - 1) / (nParts - p);
+      // Ordered by decreasing number of links into the rank, then by index.
+      std::set<std::pair<uint32_t, uint32_t> > frontier;
+      std::vector<uint32_t> touched;
+      while (load[p] < target && unassigned > 0)
+        {
+          uint32_t chosen = nClusters;
+          for (std::set<std::pair<uint32_t, uint32_t> >::const_iterator it = frontier.begin ();
+               it != frontier.end (); ++it)
+            {
+              uint64_t after = load[p] + clusterWeight[it->second];
+              if (after <= target || (after <= capacity && after - target < target - load[p]))
+                {
+                  chosen = it->second;
+                  break;
+                }
+            }
+          if (chosen == nClusters)
+            {
+              // Nothing reachable fits: seed from the heaviest free cluster.
+              for (uint32_t c = 0; c < nClusters; ++c)
+                {
+                  if (part[c] != nParts)
+                    {
+                      continue;
+                    }
+                  uint64_t after = load[p] + clusterWeight[c];
+                  bool fits = load[p] == 0 || after <= target
+                    || (after <= capacity && after - target < target - load[p]);
+                  if (fits && (chosen == nClusters || clusterWeight[c] > clusterWeight[chosen]))
+                    {
+                      chosen = c;
+                    }
+                }
+            }
+          if (chosen == nClusters)
+            {
+              break;
+            }
+          frontier.erase (std::make_pair (std::numeric_limits<uint32_t>::max () - frontierLinks[chosen], chosen));
+          part[chosen] = p;
+          load[p] += clusterWeight[chosen];
+          remaining -= clusterWeight[chosen];
+          unassigned--;
+          for (std::map<uint32_t, uint32_t>::const_iterator nb = adjacency[chosen].begin ();
+               nb != adjacency[chosen].end (); ++nb)
+            {
+              if (part[nb->first] != nParts)
+                {
+                  continue;
+                }
+              frontier.erase (std::make_pair (std::numeric_limits<uint32_t>::max () - frontierLinks[nb->first], nb->first));
+              if (frontierLinks[nb->first] == 0)
+                {
+                  touched.push_back (nb->first);
+                }
+              frontierLinks[nb->first] += nb->second;
+              frontier.insert (std::make_pair (std::numeric_limits<uint32_t>::max () - frontierLinks[nb->first], nb->first));
+            }
+        }
+      for (std::vector<uint32_t>::const_iterator it = touched.begin (); it != touched.end (); ++it)
+        {
+          frontierLinks[*it] = 0;
+        }
+    }
+
+  // The last rank takes whatever is left over; shed clusters from any
+  // overloaded rank, cheapest in cut links first.
+  for (uint32_t p = 0; p < nParts; ++p)
+    {
+      if (load[p] <= capacity)
+        {
+          continue;
+        }
+      std::vector<std::pair<int64_t, uint32_t> > candidates;
+      for (uint32_t c = 0; c < nClusters; ++c)
+        {
+          if (part[c] != p)
+            {
+              continue;
+            }
+          int64_t internal = 0;
+          for (std::map<uint32_t, uint32_t>::const_iterator nb = adjacency[c].begin ();
+               nb != adjacency[c].end (); ++nb)
+            {
+              internal += part[nb->first] == p ? nb->second : 0;
+            }
+          candidates.push_back (std::make_pair (internal, c));
+        }
+      std::sort (candidates.begin (), candidates.end ());
+      for (uint32_t i = 0; i < candidates.size () && load[p] > capacity; ++i)
+        {
+          uint32_t c = candidates[i].second;
+          uint32_t to = std::min_element (load.begin (), load.end ()) - load.begin ();
+          if (to == p || load[to] + clusterWeight[c] > capacity)
+            {
+              continue;
+            }
+          part[c] = to;
+          load[p] -= clusterWeight[c];
+          load[to] += clusterWeight[c];
+        }
+    }
+
+  // Boundary refinement: move a cluster to the rank it has the most
+  // links into when this reduces the cut, or keeps the cut and improves
+  // the balance, without exceeding the capacity or emptying a rank.
+  for (uint32_t pass = 0; pass < m_passes; ++pass)
+    {
+      uint32_t moved = 0;
+      for (uint32_t c = 0; c < nClusters; ++c)
+        {
+          uint32_t from = part[c];
+          if (load[from] == clusterWeight[c])
+            {
+              continue;
+            }
+          std::map<uint32_t, int64_t> links;
+          for (std::map<uint32_t, uint32_t>::const_iterator nb = adjacency[c].begin ();
+               nb != adjacency[c].end (); ++nb)
+            {
+              links[part[nb->first]] += nb->second;
+            }
+          int64_t internal = links[from];
+          uint32_t best = from;
+          int64_t bestGain = 0;
+          for (std::map<uint32_t, int64_t>::const_iterator it = links.begin (); it != links.end (); ++it)
+            {
+              uint32_t to = it->first;
+              if (to == from || load[to] + clusterWeight[c] > capacity)
+                {
+                  continue;
+                }
+              int64_t gain = it->second - internal;
+              bool improves = gain > 0 || (gain == 0 && load[to] + clusterWeight[c] < load[from]);
+              if (!improves)
+                {
+                  continue;
+                }
+              if (best == from || gain > bestGain || (gain == bestGain && load[to] < load[best]))
+                {
+                  best = to;
+                  bestGain = gain;
+                }
+            }
+          if (best != from)
+            {
+              part[c] = best;
+              load[from] -= clusterWeight[c];
+              load[best] += clusterWeight[c];
+              moved++;
+            }
+        }
+      NS_LOG_LOGIC ("Refinement pass " << pass << " moved " << moved << " clusters");
+      if (moved == 0)
+        {
+          break;
+        }
+    }
+
+  for (uint32_t i = 0; i < n; ++i)
+    {
+      m_parts[i] = part[cluster[i]];
+    }
+  for (std::vector<Link>::const_iterator it = m_links.begin (); it != m_links.end (); ++it)
+    {
+      if (m_parts[it->a] != m_parts[it->b])
+        {
+          m_cutSize++;
+          m_lookahead = std::min (m_lookahead, it->delay);
+        }
+    }
+  NS_LOG_INFO ("Partitioned " << n << " nodes and " << m_links.size () << " links into "
+               << nParts << " ranks: " << m_cutSize << " cut links, lookahead " << m_lookahead);
+  return m_parts;
+}
+
+void
+MpiPartitionHelper::Assign (uint32_t nParts)
+{
+  NS_LOG_FUNCTION (this << nParts);
+  Partition (nParts);
+  for (uint32_t i = 0; i < m_nodes.size (); ++i)
+    {
+      m_nodes[i]->SetAttribute ("SystemId", UintegerValue (m_parts[i]));
+    }
+}
+
+void
+MpiPartitionHelper::Assign (void)
+{
+  NS_LOG_FUNCTION (this);
+  Assign (MpiInterface::GetSize ());
+}
+
+uint32_t
+MpiPartitionHelper::GetSystemId (Ptr<Node> node) const
+{
+  std::map<uint32_t, uint32_t>::const_iterator it = m_index.find (node->GetId ());
+  NS_ASSERT_MSG (it != m_index.end () && it->second < m_parts.size (),
+                 "Node " << node->GetId () << " has not been partitioned");
+  return m_parts[it->second];
+}
+
+Time
+MpiPartitionHelper::GetLookahead (void) const
+{
+  return m_lookahead;
+}
+
+uint32_t
+MpiPartitionHelper::GetCutSize (void) const
+{
+  return m_cutSize;
+}
+
+} // namespace ns3
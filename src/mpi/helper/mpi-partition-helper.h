@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef NS3_MPI_PARTITION_HELPER_H
+#define NS3_MPI_PARTITION_HELPER_H
+
+#include <ns3/node.h>
+#include <ns3/node-container.h>
+#include <ns3/nstime.h>
+#include <ns3/ptr.h>
+
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Assigns nodes to MPI ranks from a topology edge list.
+ *
+ * The conservative synchronization algorithms can only advance each
+ * rank by the smallest delay of the point-to-point links that cross
+ * ranks (the lookahead), and every cut link turns into remote traffic
+ * carried by a RemoteChannelBundle.  This helper builds a partition
+ * that first maximizes the lookahead and then minimizes the number of
+ * cut links, subject to a balance constraint on the node weights:
+ *
+ * -# links whose delay is below a threshold are contracted so that
+ *    they can never be cut; the largest threshold for which the
+ *    contracted clusters can still be packed into the requested
+ *    number of ranks is selected by binary search;
+ * -# the clusters are grown into ranks by greedy graph growing,
+ *    preferring the cluster with the most links into the rank;
+ * -# boundary clusters are moved between ranks as long as this reduces
+ *    the number of cut links without breaking the balance constraint.
+ *
+ * The result only depends on the order in which nodes and links are
+ * added, so every rank running the same script computes the same
+ * partition.  Nodes are assigned by setting their "SystemId" attribute,
+ * which must happen before the point-to-point links are installed:
+ *
+ * \code
+ *   NodeContainer nodes = reader->Read ();
+ *   MpiPartitionHelper partitioner;
+ *   partitioner.AddNodes (nodes);
+ *   for (TopologyReader::ConstLinksIterator it = reader->LinksBegin ();
+ *        it != reader->LinksEnd (); it++)
+ *     {
+ *       partitioner.AddLink (it->GetFromNode (), it->GetToNode (), MilliSeconds (1));
+ *     }
+ *   partitioner.Assign ();
+ * \endcode
+ */
+class MpiPartitionHelper
+{
+public:
+  MpiPartitionHelper ();
+
+  /**
+   * \param tolerance maximum ratio between the weight of the heaviest
+   * rank and the average rank weight (must be at least 1.0).
+   */
+  void SetImbalanceTolerance (double tolerance);
+  /**
+   * \param passes maximum number of refinement passes over the boundary
+   */
+  void SetRefinementPasses (uint32_t passes);
+
+  /**
+   * \brief Add a node to the graph, even if it has no links.
+   * \param node the node
+   * \param weight the relative load of the node
+   */
+  void AddNode (Ptr<Node> node, uint32_t weight = 1);
+  /**
+   * \brief Add all the nodes of a container with unit weight.
+   * \param c the nodes
+   */
+  void AddNodes (NodeContainer c);
+  /**
+   * \brief Add a link to the graph.  Unknown nodes are added with unit weight.
+   * \param a one end of the link
+   * \param b the other end of the link
+   * \param delay the propagation delay of the link
+   */
+  void AddLink (Ptr<Node> a, Ptr<Node> b, Time delay);
+
+  /**
+   * \brief Compute a partition of the graph.
+   * \param nParts the number of ranks
+   * \return the rank of every node, in the order the nodes were added
+   */
+  std::vector<uint32_t> Partition (uint32_t nParts);
+  /**
+   * \brief Partition the graph and set the "SystemId" attribute of every node.
+   * \param nParts the number of ranks
+   */
+  void Assign (uint32_t nParts);
+  /**
+   * \brief Partition the graph across all the ranks of the running
+   * simulation (MpiInterface::GetSize ()).
+   */
+  void Assign (void);
+
+  /**
+   * \param node a node added to the graph
+   * \return the rank the node was assigned to by the last partition
+   */
+  uint32_t GetSystemId (Ptr<Node> node) const;
+  /**
+   * \return the smallest delay of the cut links of the last partition,
+   * or Time::Max () if no link is cut
+   */
+  Time GetLookahead (void) const;
+  /**
+   * \return the number of links cut by the last partition
+   */
+  uint32_t GetCutSize (void) const;
+
+private:
+  /// A link of the topology graph.
+  struct Link
+  {
+    uint32_t a;   //!< index of one end
+    uint32_t b;   //!< index of the other end
+    Time delay;   //!< link delay
+  };
+
+  /**
+   * \param node the node
+   * \param weight the weight used if the node is new
+   * \return the index of the node, adding it if needed
+   */
+  uint32_t GetIndex (Ptr<Node> node, uint32_t weight);
+  /**
+   * \brief Contract the links whose delay is below a threshold.
+   * \param threshold links with a smaller delay are contracted
+   * \param cluster [out] cluster of every node
+   * \param clusterWeight [out] weight of every cluster
+   */
+  void Contract (Time threshold, std::vector<uint32_t> &cluster,
+                 std::vector<uint32_t> &clusterWeight) const;
+  /**
+   * \param clusterWeight weight of every cluster
+   * \param nParts number of ranks
+   * \param capacity maximum weight of a rank
+   * \return true if the clusters can be packed (largest processing time first)
+   */
+  static bool IsPackable (std::vector<uint32_t> clusterWeight, uint32_t nParts, uint32_t capacity);
+
+  std::vector<Ptr<Node> > m_nodes;        //!< nodes in insertion order
+  std::vector<uint32_t> m_weights;        //!< weight of every node
+  std::map<uint32_t, uint32_t> m_index;   //!< node id to index
+  std::vector<Link> m_links;              //!< links of the graph
+  double m_tolerance;                     //!< allowed imbalance
+  uint32_t m_passes;                      //!< refinement passes
+  std::vector<uint32_t> m_parts;          //!< last computed partition
+  Time m_lookahead;                       //!< lookahead of the last partition
+  uint32_t m_cutSize;                     //!< cut links of the last partition
+};
+
+} // namespace ns3
+
+#endif /* NS3_MPI_PARTITION_HELPER_H */
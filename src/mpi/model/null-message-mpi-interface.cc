@@ -49,6 +49,16 @@ NS_LOG_COMPONENT_DEFINE ("NullMessageMpiInterface");
  */
 const uint32_t NULL_MESSAGE_MAX_MPI_MSG_SIZE = 2000;
 
+/**
+ * Flags of a Null Message, in the field of the destination node of a packet
+ */
+enum NullMessageFlags
+{
+  NULL_MESSAGE_DEMAND = 1,    //!< The sender is blocked on the receiver
+  NULL_MESSAGE_ON_DEMAND = 2, //!< The sender only sends Null Messages on demand
+  NULL_MESSAGE_WAITED = 4     //!< The sender blocked on the receiver since its previous Null Message
+};
+
 NullMessageSentBuffer::NullMessageSentBuffer ()
 {
   m_buffer = 0;
@@ -202,6 +212,7 @@ NullMessageMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t
 
   Time guarantee_update = NullMessageSimulatorImpl::GetInstance ()->CalculateGuaranteeTime (nodeSysId);
   *pTime++ = guarantee_update.GetTimeStep ();
+  RemoteChannelBundleManager::Find (nodeSysId)->RecordSent (guarantee_update, false, false);
 
   uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
   *pData++ = node;
@@ -216,9 +227,10 @@ NullMessageMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t
 }
 
 void
-NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, Ptr<RemoteChannelBundle> bundle)
+NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, Ptr<RemoteChannelBundle> bundle,
+                                          bool demand)
 {
-  NS_LOG_FUNCTION (guarantee_update.GetTimeStep () << bundle);
+  NS_LOG_FUNCTION (guarantee_update.GetTimeStep () << bundle << demand);
 
   NS_ASSERT (g_enabled);
 
@@ -234,11 +246,21 @@ NullMessageMpiInterface::SendNullMessage (const Time& guarantee_update, Ptr<Remo
   *pTime++ = 0;
   *pTime++ = guarantee_update.GetInteger ();
   uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-  *pData++ = 0;
+  uint32_t flags = demand ? NULL_MESSAGE_DEMAND : 0;
+  if (bundle->GetSyncMode () == RemoteChannelBundle::ON_DEMAND)
+    {
+      flags |= NULL_MESSAGE_ON_DEMAND;
+    }
+  if (bundle->IsWaiting ())
+    {
+      flags |= NULL_MESSAGE_WAITED;
+    }
+  *pData++ = flags;
   *pData++ = 0;
 
   // Find the system id for the destination MPI rank
   uint32_t nodeSysId = bundle->GetSystemId ();
+  bundle->RecordSent (guarantee_update, true, demand);
 
   MPI_Isend (reinterpret_cast<void *> (iter->GetBuffer ()), bufferSize, MPI_CHAR, nodeSysId,
              0, MPI_COMM_WORLD, (iter->GetRequest ()));
@@ -346,6 +368,24 @@ NullMessageMpiInterface::ReceiveMessages (bool blocking)
 
           bundle->SetGuaranteeTime (Time (guaranteeUpdate));
 
+          // The node field of a Null Message carries its flags.  A demand
+          // means that the remote task is blocked until it gets a larger
+          // guarantee time.
+          bool isNull = rxTime == Time (0);
+          bool demand = isNull && (node & NULL_MESSAGE_DEMAND);
+          if (isNull)
+            {
+              bundle->SetRemoteSyncMode ((node & NULL_MESSAGE_ON_DEMAND) ?
+                                         RemoteChannelBundle::ON_DEMAND :
+                                         RemoteChannelBundle::PERIODIC);
+            }
+          bool waited = isNull && (node & NULL_MESSAGE_WAITED);
+          bundle->RecordReceived (isNull, demand, waited);
+          if (demand)
+            {
+              bundle->SetDemandPending (true);
+            }
+
           // Re-queue the next read
           MPI_Irecv (g_pRxBuffers[index], NULL_MESSAGE_MAX_MPI_MSG_SIZE, MPI_CHAR, status.MPI_SOURCE, 0,
                      MPI_COMM_WORLD, &g_requests[index]);
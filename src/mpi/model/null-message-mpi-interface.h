@@ -156,10 +156,17 @@ public:
    *
    * uint64_t 0 must be zero for Null Message
    * uint64_t guarantee time
+   * uint32_t flags: 1 if the sender is blocked on the receiver (demand),
+   *          plus 2 if the bundle of the sender is on-demand,
+   *          plus 4 if the sender blocked on the receiver since its
+   *          previous Null Message
    * uint32_t 0 must be zero for Null Message
-   * uint32_t 0 must be zero for Null Message
+   *
+   * \param demand true if this task is blocked waiting for a guarantee
+   * time from the remote task
    */
-  static void SendNullMessage (const Time& guaranteeUpdate, Ptr<RemoteChannelBundle> bundle);
+  static void SendNullMessage (const Time& guaranteeUpdate, Ptr<RemoteChannelBundle> bundle,
+                               bool demand = false);
   /**
    * Non-blocking check for received messages complete.  Will
    * receive all messages that are queued up locally.
@@ -32,15 +32,20 @@
 #include <ns3/channel.h>
 #include <ns3/node-container.h>
 #include <ns3/double.h>
+#include <ns3/boolean.h>
+#include <ns3/string.h>
 #include <ns3/ptr.h>
 #include <ns3/pointer.h>
 #include <ns3/assert.h>
 #include <ns3/log.h>
 
+#include <mpi.h>
+
 #include <cmath>
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <sstream>
 
 namespace ns3 {
 
@@ -61,6 +66,31 @@ NullMessageSimulatorImpl::GetTypeId (void)
                    DoubleValue (1.0),
                    MakeDoubleAccessor (&NullMessageSimulatorImpl::m_schedulerTune),
                    MakeDoubleChecker<double> (0.01,1.0))
+    .AddAttribute ("AdaptiveSync",
+                   "Switch each remote channel bundle between periodic and on-demand "
+                   "Null Messages at run time.  Must be set identically on all tasks.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NullMessageSimulatorImpl::m_adaptive),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AdaptInterval",
+                   "Simulation time between two adaptation decisions",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&NullMessageSimulatorImpl::m_adaptInterval),
+                   MakeTimeChecker (TimeStep (1)))
+    .AddAttribute ("DemandRatio",
+                   "A periodic bundle goes on-demand when it sends more than this many "
+                   "Null Messages per demand received; an on-demand bundle goes back to "
+                   "periodic when the demands received times this ratio reach twice the "
+                   "number of periodic Null Messages of the interval.",
+                   DoubleValue (4.0),
+                   MakeDoubleAccessor (&NullMessageSimulatorImpl::m_demandRatio),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("SyncStatisticsFile",
+                   "If not empty, each task writes its synchronization overhead "
+                   "counters to <SyncStatisticsFile>-<rank>.txt at the end of Run",
+                   StringValue (""),
+                   MakeStringAccessor (&NullMessageSimulatorImpl::m_syncStatisticsFile),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -88,6 +118,10 @@ NullMessageSimulatorImpl::NullMessageSimulatorImpl ()
 
   m_safeTime = Seconds (0);
 
+  m_runTime = 0;
+  m_blockedTime = 0;
+  m_blockCount = 0;
+
   NS_ASSERT (g_instance == 0);
   g_instance = this;
 }
@@ -197,6 +231,16 @@ NullMessageSimulatorImpl::CalculateLookAhead (void)
         }
     }
 
+  m_bundles.clear ();
+  for (uint32_t rank = 0; rank < m_systemCount; ++rank)
+    {
+      Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (rank);
+      if (bundle)
+        {
+          m_bundles.push_back (bundle);
+        }
+    }
+
   // Completed setup of remote channel bundles.  Setup send and receive buffers.
   NullMessageMpiInterface::InitializeSendReceiveBuffers ();
 
@@ -276,6 +320,11 @@ NullMessageSimulatorImpl::RescheduleNullMessageEvent (Ptr<RemoteChannelBundle> b
 
   Simulator::Cancel (bundle->GetEventId ());
 
+  if (bundle->GetSyncMode () == RemoteChannelBundle::ON_DEMAND)
+    {
+      return;
+    }
+
   Time delay (m_schedulerTune * bundle->GetDelay ().GetTimeStep ());
 
   bundle->SetEventId (Simulator::Schedule (delay, &NullMessageSimulatorImpl::NullMessageEventHandler, 
@@ -302,6 +351,13 @@ NullMessageSimulatorImpl::Run (void)
 
   RemoteChannelBundleManager::InitializeNullMessageEvents ();
 
+  if (m_adaptive && !m_bundles.empty ())
+    {
+      Simulator::Schedule (m_adaptInterval, &NullMessageSimulatorImpl::AdaptSynchronization, this);
+    }
+
+  double start = MPI_Wtime ();
+
   // Stop will be set if stop is called by simulation.
   m_stop = false;
   while (!IsFinished ())
@@ -319,6 +375,9 @@ NullMessageSimulatorImpl::Run (void)
           HandleArrivingMessagesBlocking ();
         }
     }
+
+  m_runTime += MPI_Wtime () - start;
+  WriteSyncStatistics ();
 }
 
 void
@@ -330,6 +389,11 @@ NullMessageSimulatorImpl::HandleArrivingMessagesNonBlocking (void)
 
   CalculateSafeTime ();
 
+  if (m_adaptive)
+    {
+      ServePendingDemands ();
+    }
+
   // Check for send completes
   NullMessageMpiInterface::TestSendComplete ();
 }
@@ -339,10 +403,58 @@ NullMessageSimulatorImpl::HandleArrivingMessagesBlocking (void)
 {
   NS_LOG_FUNCTION (this);
 
+  // The bundles holding the safe time back are the ones we block on.
+  std::vector<Ptr<RemoteChannelBundle> > limiting;
+  for (std::vector<Ptr<RemoteChannelBundle> >::const_iterator it = m_bundles.begin ();
+       it != m_bundles.end (); ++it)
+    {
+      if ((*it)->GetGuaranteeTime () == m_safeTime)
+        {
+          limiting.push_back (*it);
+        }
+    }
+
+  // Tell the on-demand remote tasks that we are waiting on them, so
+  // that they answer with a new guarantee time.  Periodic remote tasks
+  // send one anyway; our next Null Message tells them that it was
+  // needed.
+  if (m_adaptive)
+    {
+      for (std::vector<Ptr<RemoteChannelBundle> >::const_iterator it = limiting.begin ();
+           it != limiting.end (); ++it)
+        {
+          if ((*it)->GetRemoteSyncMode () != RemoteChannelBundle::ON_DEMAND)
+            {
+              (*it)->SetWaiting ();
+              continue;
+            }
+          Time guarantee = GetGuaranteeTime (*it);
+          if (guarantee > (*it)->GetLastDemandSent ())
+            {
+              NullMessageMpiInterface::SendNullMessage (guarantee, *it, true);
+            }
+        }
+    }
+
+  double start = MPI_Wtime ();
   NullMessageMpiInterface::ReceiveMessagesBlocking ();
+  double blocked = MPI_Wtime () - start;
+
+  m_blockedTime += blocked;
+  m_blockCount++;
+  for (std::vector<Ptr<RemoteChannelBundle> >::const_iterator it = limiting.begin ();
+       it != limiting.end (); ++it)
+    {
+      (*it)->RecordBlocked (blocked);
+    }
 
   CalculateSafeTime ();
 
+  if (m_adaptive)
+    {
+      ServePendingDemands ();
+    }
+
   // Check for send completes
   NullMessageMpiInterface::TestSendComplete ();
 }
@@ -597,6 +709,128 @@ void NullMessageSimulatorImpl::NullMessageEventHandler(RemoteChannelBundle* bund
 }
 
 
+Time
+NullMessageSimulatorImpl::GetGuaranteeTime (Ptr<RemoteChannelBundle> bundle)
+{
+  Time next = m_events->IsEmpty () ? GetMaximumSimulationTime () : Next ();
+  return Min (next, GetSafeTime ()) + bundle->GetDelay ();
+}
+
+void
+NullMessageSimulatorImpl::ServePendingDemands (void)
+{
+  for (std::vector<Ptr<RemoteChannelBundle> >::const_iterator it = m_bundles.begin ();
+       it != m_bundles.end (); ++it)
+    {
+      Ptr<RemoteChannelBundle> bundle = *it;
+      if (!bundle->IsDemandPending ())
+        {
+          continue;
+        }
+      Time guarantee = GetGuaranteeTime (bundle);
+      if (guarantee > bundle->GetLastGuaranteeSent ())
+        {
+          NS_LOG_LOGIC ("Answering demand from rank " << bundle->GetSystemId () << " with " << guarantee);
+          NullMessageMpiInterface::SendNullMessage (guarantee, bundle);
+          bundle->SetDemandPending (false);
+          RescheduleNullMessageEvent (bundle);
+        }
+    }
+}
+
+void
+NullMessageSimulatorImpl::AdaptSynchronization (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  for (std::vector<Ptr<RemoteChannelBundle> >::const_iterator it = m_bundles.begin ();
+       it != m_bundles.end (); ++it)
+    {
+      Ptr<RemoteChannelBundle> bundle = *it;
+      const RemoteChannelBundle::SyncStatistics &stats = bundle->GetIntervalStatistics ();
+      double demands = stats.demandsReceived * m_demandRatio;
+
+      if (bundle->GetSyncMode () == RemoteChannelBundle::PERIODIC)
+        {
+          // Most periodic Null Messages arrived while the remote task
+          // was not waiting for them.  A remote task blocked on a
+          // periodic bundle does not send demands, it flags its next
+          // Null Message instead.
+          double waits = (stats.demandsReceived + stats.waitsReceived) * m_demandRatio;
+          double unsolicited = stats.nullSent - stats.demandsSent;
+          if (waits < unsolicited)
+            {
+              NS_LOG_INFO ("Rank " << m_myId << " bundle to rank " << bundle->GetSystemId ()
+                                   << " goes on-demand: " << unsolicited << " Null Messages, "
+                                   << stats.demandsReceived << " demands, "
+                                   << stats.waitsReceived << " waits");
+              bundle->SetSyncMode (RemoteChannelBundle::ON_DEMAND);
+              Simulator::Cancel (bundle->GetEventId ());
+              // The remote task only sends demands once it knows
+              NullMessageMpiInterface::SendNullMessage (Max (GetGuaranteeTime (bundle),
+                                                             bundle->GetLastGuaranteeSent ()),
+                                                        bundle);
+            }
+        }
+      else
+        {
+          // The remote task blocks on us often enough that periodic
+          // Null Messages would be cheaper than the round trips.
+          double periodic = m_adaptInterval.GetSeconds ()
+            / (m_schedulerTune * bundle->GetDelay ().GetSeconds ());
+          if (demands >= 2 * periodic)
+            {
+              NS_LOG_INFO ("Rank " << m_myId << " bundle to rank " << bundle->GetSystemId ()
+                                   << " goes periodic: " << stats.demandsReceived << " demands");
+              bundle->SetSyncMode (RemoteChannelBundle::PERIODIC);
+              ScheduleNullMessageEvent (bundle);
+            }
+        }
+      bundle->ResetIntervalStatistics ();
+    }
+
+  Simulator::Schedule (m_adaptInterval, &NullMessageSimulatorImpl::AdaptSynchronization, this);
+}
+
+void
+NullMessageSimulatorImpl::WriteSyncStatistics (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  std::ostringstream oss;
+  oss << "# rank " << m_myId << " run " << m_runTime << " s blocked " << m_blockedTime
+      << " s in " << m_blockCount << " receives, " << m_eventCount << " events" << std::endl;
+  oss << "# remote mode delay nullSent nullReceived packetsSent packetsReceived"
+      << " demandsSent demandsReceived waitsReceived blockedTime modeChanges" << std::endl;
+  for (std::vector<Ptr<RemoteChannelBundle> >::const_iterator it = m_bundles.begin ();
+       it != m_bundles.end (); ++it)
+    {
+      const RemoteChannelBundle::SyncStatistics &stats = (*it)->GetStatistics ();
+      oss << (*it)->GetSystemId () << " "
+          << ((*it)->GetSyncMode () == RemoteChannelBundle::PERIODIC ? "periodic" : "on-demand") << " "
+          << (*it)->GetDelay ().GetSeconds () << " "
+          << stats.nullSent << " " << stats.nullReceived << " "
+          << stats.packetsSent << " " << stats.packetsReceived << " "
+          << stats.demandsSent << " " << stats.demandsReceived << " "
+          << stats.waitsReceived << " "
+          << stats.blockedTime << " " << (*it)->GetSyncModeChanges () << std::endl;
+    }
+  NS_LOG_INFO (oss.str ());
+
+  if (!m_syncStatisticsFile.empty ())
+    {
+      std::ostringstream name;
+      name << m_syncStatisticsFile << "-" << m_myId << ".txt";
+      std::ofstream file (name.str ().c_str ());
+      if (!file.good ())
+        {
+          NS_LOG_WARN ("Cannot open " << name.str () << " for writing");
+          return;
+        }
+      file << oss.str ();
+    }
+}
+
 NullMessageSimulatorImpl*
 NullMessageSimulatorImpl::GetInstance (void)
 {
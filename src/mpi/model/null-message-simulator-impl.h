@@ -30,6 +30,8 @@
 #include <list>
 #include <iostream>
 #include <fstream>
+#include <string>
+#include <vector>
 
 namespace ns3 {
 
@@ -41,6 +43,15 @@ class RemoteChannelBundle;
  * \ingroup mpi
  *
  * \brief Simulator implementation using MPI and a Null Message algorithm.
+ *
+ * With the AdaptiveSync attribute set, each RemoteChannelBundle
+ * switches at run time between periodic Null Messages and on-demand
+ * guarantee exchange, where a task only sends a Null Message when it
+ * blocks (a demand) or when the remote task is blocked on it.  The
+ * switch is driven by the number of Null Messages sent and the number
+ * of demands received over each AdaptInterval.  Per-bundle message
+ * counts and blocked time are written to SyncStatisticsFile at the end
+ * of the run.
  */
 class NullMessageSimulatorImpl : public SimulatorImpl
 {
@@ -168,6 +179,31 @@ private:
    */
   void NullMessageEventHandler(RemoteChannelBundle* bundle);
 
+  /**
+   * \param bundle the remote channel bundle
+   * \return the guarantee time that can be sent across the bundle now
+   */
+  Time GetGuaranteeTime (Ptr<RemoteChannelBundle> bundle);
+
+  /**
+   * Send a Null Message on every bundle whose remote task is blocked
+   * on this task, if the guarantee time has advanced since the last
+   * message sent to it.
+   */
+  void ServePendingDemands (void);
+
+  /**
+   * Periodic adaptation event: move each bundle between periodic and
+   * on-demand Null Messages based on the counters of the last interval.
+   */
+  void AdaptSynchronization (void);
+
+  /**
+   * Log the synchronization overhead counters and write them to
+   * the statistics file if one is configured.
+   */
+  void WriteSyncStatistics (void);
+
   typedef std::list<EventId> DestroyEvents;
 
   DestroyEvents m_destroyEvents;
@@ -204,6 +240,28 @@ private:
    */
   double m_schedulerTune;
 
+  /*
+   * Adaptive synchronization parameters.  See the attribute help.
+   */
+  bool m_adaptive;
+  Time m_adaptInterval;
+  double m_demandRatio;
+  std::string m_syncStatisticsFile;
+
+  /*
+   * Remote channel bundles of this task, cached after the look ahead
+   * calculation.
+   */
+  std::vector<Ptr<RemoteChannelBundle> > m_bundles;
+
+  /*
+   * Wall clock seconds spent in Run and blocked in receives, and the
+   * number of blocking receives.
+   */
+  double m_runTime;
+  double m_blockedTime;
+  uint64_t m_blockCount;
+
   /*
    * Singleton instance.
    */
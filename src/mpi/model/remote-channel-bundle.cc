@@ -39,17 +39,43 @@ TypeId RemoteChannelBundle::GetTypeId (void)
   return tid;
 }
 
+RemoteChannelBundle::SyncStatistics::SyncStatistics ()
+  : nullSent (0),
+    nullReceived (0),
+    packetsSent (0),
+    packetsReceived (0),
+    demandsSent (0),
+    demandsReceived (0),
+    waitsReceived (0),
+    blockedTime (0)
+{
+}
+
 RemoteChannelBundle::RemoteChannelBundle ()
   : m_remoteSystemId (UINT32_MAX),
     m_guaranteeTime (0),
-    m_delay (NS_TIME_INFINITY)
+    m_delay (NS_TIME_INFINITY),
+    m_syncMode (PERIODIC),
+    m_syncModeChanges (0),
+    m_remoteSyncMode (PERIODIC),
+    m_lastGuaranteeSent (0),
+    m_lastDemandSent (0),
+    m_demandPending (false),
+    m_waiting (false)
 {
 }
 
 RemoteChannelBundle::RemoteChannelBundle (const uint32_t remoteSystemId)
   : m_remoteSystemId (remoteSystemId),
     m_guaranteeTime (0),
-    m_delay (NS_TIME_INFINITY)
+    m_delay (NS_TIME_INFINITY),
+    m_syncMode (PERIODIC),
+    m_syncModeChanges (0),
+    m_remoteSyncMode (PERIODIC),
+    m_lastGuaranteeSent (0),
+    m_lastDemandSent (0),
+    m_demandPending (false),
+    m_waiting (false)
 {
 }
 
@@ -104,6 +130,161 @@ RemoteChannelBundle::GetSize (void) const
   return m_channels.size ();
 }
 
+RemoteChannelBundle::SyncMode
+RemoteChannelBundle::GetSyncMode (void) const
+{
+  return m_syncMode;
+}
+
+void
+RemoteChannelBundle::SetSyncMode (SyncMode mode)
+{
+  if (mode != m_syncMode)
+    {
+      m_syncMode = mode;
+      m_syncModeChanges++;
+    }
+}
+
+uint32_t
+RemoteChannelBundle::GetSyncModeChanges (void) const
+{
+  return m_syncModeChanges;
+}
+
+RemoteChannelBundle::SyncMode
+RemoteChannelBundle::GetRemoteSyncMode (void) const
+{
+  return m_remoteSyncMode;
+}
+
+void
+RemoteChannelBundle::SetRemoteSyncMode (SyncMode mode)
+{
+  m_remoteSyncMode = mode;
+}
+
+Time
+RemoteChannelBundle::GetLastGuaranteeSent (void) const
+{
+  return m_lastGuaranteeSent;
+}
+
+Time
+RemoteChannelBundle::GetLastDemandSent (void) const
+{
+  return m_lastDemandSent;
+}
+
+bool
+RemoteChannelBundle::IsDemandPending (void) const
+{
+  return m_demandPending;
+}
+
+void
+RemoteChannelBundle::SetDemandPending (bool pending)
+{
+  m_demandPending = pending;
+}
+
+bool
+RemoteChannelBundle::IsWaiting (void) const
+{
+  return m_waiting;
+}
+
+void
+RemoteChannelBundle::SetWaiting (void)
+{
+  m_waiting = true;
+}
+
+void
+RemoteChannelBundle::RecordSent (Time guarantee, bool isNull, bool demand)
+{
+  // Any message with a larger guarantee time unblocks the remote task.
+  if (guarantee > m_lastGuaranteeSent)
+    {
+      m_demandPending = false;
+    }
+  m_lastGuaranteeSent = guarantee;
+  SyncStatistics *counters[] = { &m_statistics, &m_intervalStatistics };
+  for (std::size_t i = 0; i < 2; ++i)
+    {
+      if (isNull)
+        {
+          counters[i]->nullSent++;
+        }
+      else
+        {
+          counters[i]->packetsSent++;
+        }
+      if (demand)
+        {
+          counters[i]->demandsSent++;
+        }
+    }
+  if (demand)
+    {
+      m_lastDemandSent = guarantee;
+    }
+  if (isNull)
+    {
+      m_waiting = false;
+    }
+}
+
+void
+RemoteChannelBundle::RecordReceived (bool isNull, bool demand, bool waited)
+{
+  SyncStatistics *counters[] = { &m_statistics, &m_intervalStatistics };
+  for (std::size_t i = 0; i < 2; ++i)
+    {
+      if (isNull)
+        {
+          counters[i]->nullReceived++;
+        }
+      else
+        {
+          counters[i]->packetsReceived++;
+        }
+      if (demand)
+        {
+          counters[i]->demandsReceived++;
+        }
+      if (waited)
+        {
+          counters[i]->waitsReceived++;
+        }
+    }
+}
+
+void
+RemoteChannelBundle::RecordBlocked (double seconds)
+{
+  m_statistics.blockedTime += seconds;
+  m_intervalStatistics.blockedTime += seconds;
+}
+
+const RemoteChannelBundle::SyncStatistics &
+RemoteChannelBundle::GetStatistics (void) const
+{
+  return m_statistics;
+}
+
+const RemoteChannelBundle::SyncStatistics &
+RemoteChannelBundle::GetIntervalStatistics (void) const
+{
+  return m_intervalStatistics;
+}
+
+void
+RemoteChannelBundle::ResetIntervalStatistics (void)
+{
+  m_intervalStatistics = SyncStatistics ();
+}
+
 void 
 RemoteChannelBundle::Send(Time time)
 {
@@ -114,7 +295,9 @@ std::ostream& operator<< (std::ostream& out, ns3::RemoteChannelBundle& bundle )
 {
   out << "RemoteChannelBundle Rank = " << bundle.m_remoteSystemId
       << ", GuaranteeTime = "  << bundle.m_guaranteeTime
-      << ", Delay = " << bundle.m_delay << std::endl;
+      << ", Delay = " << bundle.m_delay
+      << ", Mode = " << (bundle.m_syncMode == RemoteChannelBundle::PERIODIC ? "periodic" : "on-demand")
+      << std::endl;
   
   for (std::map < uint32_t, Ptr < Channel > > ::const_iterator pair = bundle.m_channels.begin ();
        pair != bundle.m_channels.end ();
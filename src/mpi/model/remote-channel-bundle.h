@@ -47,6 +47,32 @@ class RemoteChannelBundle : public Object
 public:
   static TypeId GetTypeId (void);
 
+  /**
+   * How guarantee times are pushed to the remote task when the
+   * NullMessageSimulatorImpl runs in adaptive mode.
+   */
+  enum SyncMode
+  {
+    PERIODIC,  //!< Null Messages at regular intervals of the bundle delay
+    ON_DEMAND  //!< Null Messages only when the remote task is blocked on this task
+  };
+
+  /**
+   * Synchronization overhead counters for a bundle.
+   */
+  struct SyncStatistics
+  {
+    SyncStatistics ();
+    uint64_t nullSent;        //!< Null Messages sent, including demands
+    uint64_t nullReceived;    //!< Null Messages received, including demands
+    uint64_t packetsSent;     //!< packet messages sent
+    uint64_t packetsReceived; //!< packet messages received
+    uint64_t demandsSent;     //!< Null Messages sent while blocked on the remote task
+    uint64_t demandsReceived; //!< Null Messages received while the remote task was blocked
+    uint64_t waitsReceived;   //!< Null Messages received after the remote task blocked on a periodic bundle
+    double blockedTime;       //!< wall clock seconds blocked with this bundle limiting the safe time
+  };
+
   RemoteChannelBundle ();
 
   RemoteChannelBundle (const uint32_t remoteSystemId);
@@ -100,6 +126,108 @@ public:
    */
   std::size_t GetSize (void) const;
 
+  /**
+   * \return the current synchronization strategy of the bundle
+   */
+  SyncMode GetSyncMode (void) const;
+
+  /**
+   * \param mode the new synchronization strategy of the bundle
+   *
+   * Only changes the bookkeeping; the caller is responsible for
+   * scheduling or canceling the Null Message event.
+   */
+  void SetSyncMode (SyncMode mode);
+
+  /**
+   * \return number of times the synchronization strategy changed
+   */
+  uint32_t GetSyncModeChanges (void) const;
+
+  /**
+   * \return the synchronization strategy of the remote task towards
+   * this task, as carried by its last Null Message
+   */
+  SyncMode GetRemoteSyncMode (void) const;
+
+  /**
+   * \param mode the synchronization strategy of the remote task
+   * towards this task
+   */
+  void SetRemoteSyncMode (SyncMode mode);
+
+  /**
+   * \return the last guarantee time sent to the remote task
+   */
+  Time GetLastGuaranteeSent (void) const;
+
+  /**
+   * \return the guarantee time carried by the last demand sent to the remote task
+   */
+  Time GetLastDemandSent (void) const;
+
+  /**
+   * \return true if the remote task is blocked waiting for a guarantee
+   * time larger than the last one sent
+   */
+  bool IsDemandPending (void) const;
+
+  /**
+   * \param pending whether the remote task is waiting for a new guarantee time
+   */
+  void SetDemandPending (bool pending);
+
+  /**
+   * \return true if this task blocked on the remote task since the
+   * last Null Message sent to it
+   */
+  bool IsWaiting (void) const;
+
+  /**
+   * Note that this task blocked on the periodic remote task.  The next
+   * Null Message tells it, instead of a demand of its own.
+   */
+  void SetWaiting (void);
+
+  /**
+   * \param guarantee the guarantee time carried by the message
+   * \param isNull true for a Null Message, false for a packet
+   * \param demand true if this task is blocked on the remote task
+   *
+   * Account for a message sent to the remote task.
+   */
+  void RecordSent (Time guarantee, bool isNull, bool demand);
+
+  /**
+   * \param isNull true for a Null Message, false for a packet
+   * \param demand true if the remote task is blocked on this task
+   * \param waited true if the remote task blocked on this task since
+   * its previous Null Message
+   *
+   * Account for a message received from the remote task.
+   */
+  void RecordReceived (bool isNull, bool demand, bool waited);
+
+  /**
+   * \param seconds wall clock time spent blocked on this bundle
+   */
+  void RecordBlocked (double seconds);
+
+  /**
+   * \return counters since the start of the simulation
+   */
+  const SyncStatistics & GetStatistics (void) const;
+
+  /**
+   * \return counters since the last call to ResetIntervalStatistics
+   */
+  const SyncStatistics & GetIntervalStatistics (void) const;
+
+  /**
+   * Restart the interval counters.
+   */
+  void ResetIntervalStatistics (void);
+
   /**
    * \param time 
    *
@@ -144,6 +272,41 @@ private:
    */
   EventId m_nullEventId;
 
+  /*
+   * Synchronization strategy and the number of times it changed.
+   */
+  SyncMode m_syncMode;
+  uint32_t m_syncModeChanges;
+
+  /*
+   * Synchronization strategy of the remote task towards this task:
+   * demands are only sent to remote tasks which are on-demand.
+   */
+  SyncMode m_remoteSyncMode;
+
+  /*
+   * Guarantee times last sent to the remote task, in any message and
+   * in a demand.
+   */
+  Time m_lastGuaranteeSent;
+  Time m_lastDemandSent;
+
+  /*
+   * The remote task is blocked until a larger guarantee time is sent.
+   */
+  bool m_demandPending;
+
+  /*
+   * This task blocked on the remote task since the last Null Message sent.
+   */
+  bool m_waiting;
+
+  /*
+   * Overhead counters, overall and since the last adaptation.
+   */
+  SyncStatistics m_statistics;
+  SyncStatistics m_intervalStatistics;
+
 };
 
 }
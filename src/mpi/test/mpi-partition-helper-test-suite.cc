@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/mpi-partition-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/uinteger.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi
+ * \defgroup mpi-test MPI module tests
+ */
+
+/**
+ * \ingroup mpi-test
+ * \ingroup tests
+ *
+ * \brief Two groups of nodes with short internal links joined by a
+ * long link must be split along the long link.
+ */
+class MpiPartitionLookaheadTestCase : public TestCase
+{
+public:
+  MpiPartitionLookaheadTestCase ();
+  virtual void DoRun (void);
+};
+
+MpiPartitionLookaheadTestCase::MpiPartitionLookaheadTestCase ()
+  : TestCase ("Partition keeps short links inside a rank")
+{
+}
+
+void
+MpiPartitionLookaheadTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (8);
+  MpiPartitionHelper partitioner;
+  partitioner.AddNodes (nodes);
+  // Interleave the groups so that the insertion order does not give the answer away.
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      partitioner.AddLink (nodes.Get (2 * i), nodes.Get (2 * i + 2), MilliSeconds (1));
+      partitioner.AddLink (nodes.Get (2 * i + 1), nodes.Get (2 * i + 3), MilliSeconds (1));
+    }
+  partitioner.AddLink (nodes.Get (6), nodes.Get (7), MilliSeconds (10));
+  partitioner.Assign (2);
+
+  NS_TEST_ASSERT_MSG_EQ (partitioner.GetCutSize (), 1, "Only the long link should be cut");
+  NS_TEST_ASSERT_MSG_EQ (partitioner.GetLookahead (), MilliSeconds (10), "Lookahead is the long link delay");
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (partitioner.GetSystemId (nodes.Get (i)),
+                             partitioner.GetSystemId (nodes.Get (i % 2)),
+                             "Node " << i << " is not with its group");
+      NS_TEST_ASSERT_MSG_EQ (nodes.Get (i)->GetSystemId (), partitioner.GetSystemId (nodes.Get (i)),
+                             "SystemId attribute not assigned");
+    }
+  NS_TEST_ASSERT_MSG_NE (partitioner.GetSystemId (nodes.Get (0)), partitioner.GetSystemId (nodes.Get (1)),
+                         "Groups should be on different ranks");
+}
+
+/**
+ * \ingroup mpi-test
+ * \ingroup tests
+ *
+ * \brief A chain with uniform delays is cut into contiguous, balanced
+ * pieces.
+ */
+class MpiPartitionChainTestCase : public TestCase
+{
+public:
+  MpiPartitionChainTestCase ();
+  virtual void DoRun (void);
+};
+
+MpiPartitionChainTestCase::MpiPartitionChainTestCase ()
+  : TestCase ("Partition of a chain is contiguous and balanced")
+{
+}
+
+void
+MpiPartitionChainTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (12);
+  MpiPartitionHelper partitioner;
+  for (uint32_t i = 0; i + 1 < nodes.GetN (); ++i)
+    {
+      partitioner.AddLink (nodes.Get (i), nodes.Get (i + 1), MilliSeconds (2));
+    }
+  std::vector<uint32_t> parts = partitioner.Partition (3);
+
+  NS_TEST_ASSERT_MSG_EQ (parts.size (), 12, "One rank per node");
+  NS_TEST_ASSERT_MSG_EQ (partitioner.GetCutSize (), 2, "A chain in three pieces has two cuts");
+  NS_TEST_ASSERT_MSG_EQ (partitioner.GetLookahead (), MilliSeconds (2), "Lookahead is the link delay");
+  std::vector<uint32_t> load (3, 0);
+  for (uint32_t i = 0; i < parts.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_LT (parts[i], 3, "Rank out of range");
+      load[parts[i]]++;
+    }
+  for (uint32_t p = 0; p < 3; ++p)
+    {
+      NS_TEST_ASSERT_MSG_EQ (load[p], 4, "Rank " << p << " is not balanced");
+    }
+}
+
+/**
+ * \ingroup mpi-test
+ * \ingroup tests
+ *
+ * \brief Isolated nodes are spread evenly and a single rank takes
+ * everything.
+ */
+class MpiPartitionBalanceTestCase : public TestCase
+{
+public:
+  MpiPartitionBalanceTestCase ();
+  virtual void DoRun (void);
+};
+
+MpiPartitionBalanceTestCase::MpiPartitionBalanceTestCase ()
+  : TestCase ("Partition balances isolated nodes")
+{
+}
+
+void
+MpiPartitionBalanceTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (10);
+  MpiPartitionHelper partitioner;
+  partitioner.AddNodes (nodes);
+
+  std::vector<uint32_t> parts = partitioner.Partition (3);
+  std::vector<uint32_t> load (3, 0);
+  for (uint32_t i = 0; i < parts.size (); ++i)
+    {
+      load[parts[i]]++;
+    }
+  for (uint32_t p = 0; p < 3; ++p)
+    {
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (load[p], 4, "Rank " << p << " is overloaded");
+      NS_TEST_ASSERT_MSG_GT_OR_EQ (load[p], 3, "Rank " << p << " is underloaded");
+    }
+  NS_TEST_ASSERT_MSG_EQ (partitioner.GetCutSize (), 0, "No links to cut");
+  NS_TEST_ASSERT_MSG_EQ (partitioner.GetLookahead (), Time::Max (), "No lookahead bound");
+
+  parts = partitioner.Partition (1);
+  for (uint32_t i = 0; i < parts.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (parts[i], 0, "Single rank must take every node");
+    }
+}
+
+/**
+ * \ingroup mpi-test
+ * \ingroup tests
+ *
+ * \brief MpiPartitionHelper TestSuite
+ */
+class MpiPartitionHelperTestSuite : public TestSuite
+{
+public:
+  MpiPartitionHelperTestSuite ();
+};
+
+MpiPartitionHelperTestSuite::MpiPartitionHelperTestSuite ()
+  : TestSuite ("mpi-partition-helper", UNIT)
+{
+  AddTestCase (new MpiPartitionLookaheadTestCase, TestCase::QUICK);
+  AddTestCase (new MpiPartitionChainTestCase, TestCase::QUICK);
+  AddTestCase (new MpiPartitionBalanceTestCase, TestCase::QUICK);
+}
+
+static MpiPartitionHelperTestSuite g_mpiPartitionHelperTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/example-as-test.h"
+#include "ns3/test.h"
+
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi-test
+ * \ingroup tests
+ *
+ * \brief Run a distributed example on several ranks with mpiexec,
+ * comparing its sorted output to a reference file.
+ *
+ * The output of the ranks interleaves at random, hence the sort.
+ */
+class MpiTestCase : public ExampleAsTestCase
+{
+public:
+  /**
+   * \copydoc ns3::ExampleAsTestCase::ExampleAsTestCase
+   *
+   * \param [in] ranks The number of ranks to run the example on.
+   */
+  MpiTestCase (const std::string name,
+               const std::string program,
+               const std::string dataDir,
+               const int ranks,
+               const std::string args = "");
+
+  /** Destructor */
+  virtual ~MpiTestCase (void)
+  {}
+
+  /**
+   * Run the program under mpiexec.
+   *
+   * \returns The string to be given to the `waf --command-template=` argument.
+   */
+  virtual std::string GetCommandTemplate (void) const;
+
+  /**
+   * Sort the output of the ranks.
+   *
+   * \returns The string of post-processing commands
+   */
+  virtual std::string GetPostProcessingCommand (void) const;
+
+private:
+  /** The number of ranks. */
+  int m_ranks;
+};
+
+MpiTestCase::MpiTestCase (const std::string name,
+                          const std::string program,
+                          const std::string dataDir,
+                          const int ranks,
+                          const std::string args /* = "" */)
+  : ExampleAsTestCase (name, program, dataDir, args),
+    m_ranks (ranks)
+{}
+
+std::string
+MpiTestCase::GetCommandTemplate (void) const
+{
+  std::stringstream ss;
+  ss << "mpiexec ";
+#ifdef NS3_OPENMPI
+  // Run the ranks even if the host has fewer cores
+  ss << "--oversubscribe ";
+#endif
+  ss << "-n " << m_ranks << " %s " << m_args;
+  return ss.str ();
+}
+
+std::string
+MpiTestCase::GetPostProcessingCommand (void) const
+{
+  std::string command ("| sort ");
+  return command;
+}
+
+/**
+ * \ingroup mpi-test
+ * \ingroup tests
+ *
+ * \brief Run a distributed example as a test suite.
+ */
+class MpiTestSuite : public TestSuite
+{
+public:
+  /**
+   * \copydoc MpiTestCase::MpiTestCase
+   *
+   * \param [in] duration Amount of time this test takes to execute
+   *             (defaults to QUICK).
+   */
+  MpiTestSuite (const std::string name,
+                const std::string program,
+                const std::string dataDir,
+                const int ranks,
+                const std::string args = "",
+                const TestDuration duration = QUICK)
+    : TestSuite (name, EXAMPLE)
+  {
+    AddTestCase (new MpiTestCase (name, program, dataDir, ranks, args), duration);
+  }
+};
+
+/**
+ * \ingroup mpi-test
+ * The simple-distributed example with the null message algorithm.
+ */
+static MpiTestSuite g_mpiNullmsg ("mpi-example-simple-distributed-nullmsg",
+                                  "simple-distributed", NS_TEST_SOURCEDIR, 2,
+                                  "--nullmsg=1");
+
+/**
+ * \ingroup mpi-test
+ * The simple-distributed example with adaptive Null Messages, which
+ * must not change its output.
+ */
+static MpiTestSuite g_mpiNullmsgAdaptive ("mpi-example-simple-distributed-nullmsg-adaptive",
+                                          "simple-distributed", NS_TEST_SOURCEDIR, 2,
+                                          "--nullmsg=1 --ns3::NullMessageSimulatorImpl::AdaptiveSync=true");
+
+/**
+ * \ingroup mpi-test
+ * The simple-distributed example with on-demand Null Messages: the
+ * lowest DemandRatio makes both bundles go on-demand.
+ */
+static MpiTestSuite g_mpiNullmsgOnDemand ("mpi-example-simple-distributed-nullmsg-on-demand",
+                                          "simple-distributed", NS_TEST_SOURCEDIR, 2,
+                                          "--nullmsg=1 --ns3::NullMessageSimulatorImpl::AdaptiveSync=true"
+                                          " --ns3::NullMessageSimulatorImpl::DemandRatio=1");
@@ -28,6 +28,7 @@
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/async-trace-stream.h"
 
 #include "trace-helper.h"
 
@@ -56,7 +57,14 @@ PcapHelper::CreateFile (
   NS_LOG_FUNCTION (filename << filemode << dataLinkType << snapLen << tzCorrection);
 
   Ptr<PcapFileWrapper> file = CreateObject<PcapFileWrapper> ();
-  file->Open (filename, filemode);
+  if (AsyncTraceStream::IsEnabled () && (filemode & std::ios::in) == 0)
+    {
+      file->OpenAsync (filename, filemode);
+    }
+  else
+    {
+      file->Open (filename, filemode);
+    }
   NS_ABORT_MSG_IF (file->Fail (), "Unable to Open " << filename << " for mode " << filemode);
 
   file->Init (dataLinkType, snapLen, tzCorrection);
@@ -192,7 +200,15 @@ AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode fil
 {
   NS_LOG_FUNCTION (filename << filemode);
 
-  Ptr<OutputStreamWrapper> StreamWrapper = Create<OutputStreamWrapper> (filename, filemode);
+  Ptr<OutputStreamWrapper> StreamWrapper;
+  if (AsyncTraceStream::IsEnabled ())
+    {
+      StreamWrapper = Create<OutputStreamWrapper> (AsyncTraceStream::Create (filename, filemode));
+    }
+  else
+    {
+      StreamWrapper = Create<OutputStreamWrapper> (filename, filemode);
+    }
 
   //
   // Note that the ascii trace helper promptly forgets all about the trace file.
@@ -20,6 +20,8 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include <atomic>
+#include <mutex>
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -52,93 +54,407 @@ NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
-/* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
- *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
- *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
- *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
- * The key is that in destroyed state, we are careful not re-create it
- * which is a typical weakness of lazy evaluation schemes which use 
- * '0' as a special value to indicate both un-initialized and destroyed.
- * Note that it is important to use '0' as the marker for un-initialized state
- * because the variable holding this state information is initialized to zero
- * which the compiler assigns to zero-memory which is initialized to _zero_
- * before the constructors run so this ensures perfect handling of crazy 
- * constructor orderings.
+/* Recycled Buffer::Data storages are kept in two levels so that packet
+ * creation stays allocation-free in steady state, even when several
+ * threads create and destroy packets:
+ *  - each thread owns a cache with one stack per size class. It is
+ *    only touched by its owner so it needs no synchronization.
+ *  - a global reservoir holds a fixed array of atomic slots per size
+ *    class. Storages are published with a compare-and-swap on an empty
+ *    slot and taken with an exchange, so no thread ever blocks.
+ * A thread cache which overflows hands half of its content to the
+ * reservoir and a thread cache which runs dry takes one storage back.
+ * Storages larger than the biggest size class are never recycled.
+ *
+ * Static and thread-local destruction order matters here: the cache of
+ * the main thread is destroyed before the static destructors run, so it
+ * flushes into the reservoir, and LocalStaticDestructor then frees the
+ * reservoir and marks it destroyed. Any buffer released after that
+ * point goes straight back to the heap.
  */
-#define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
-#define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
+struct Buffer::FreeList
+{
+  /// Size of the smallest size class
+  static const uint32_t MIN_CLASS_SIZE = 32;
+  /// Number of size classes, the largest holds 64 KiB
+  static const uint32_t N_CLASSES = 12;
+  /// Maximum number of reservoir slots per size class
+  static const uint32_t MAX_RESERVOIR_SIZE = 1024;
+
+  /// Buffer data cache of a single thread
+  struct ThreadCache
+  {
+    ThreadCache ();
+    ~ThreadCache ();
+    /**
+     * \brief Increment a counter owned by this thread.
+     * \param counter the counter
+     */
+    static void Increment (std::atomic<uint64_t> &counter);
+
+    std::vector<struct Buffer::Data *> bins[N_CLASSES]; //!< recycled storages per size class
+    std::atomic<uint64_t> threadCacheHits; //!< requests served by this cache
+    std::atomic<uint64_t> reservoirHits;   //!< requests served by the reservoir
+    std::atomic<uint64_t> misses;          //!< requests served by the heap
+    std::atomic<uint64_t> releases;        //!< storages returned to the heap
+    ThreadCache *prev; //!< previous cache in the list of live caches
+    ThreadCache *next; //!< next cache in the list of live caches
+  };
+
+  /**
+   * \param size a storage size
+   * \returns the smallest size class which holds size bytes, or
+   * N_CLASSES if there is none
+   */
+  static uint32_t GetSizeClass (uint32_t size);
+  /**
+   * \param sizeClass a size class
+   * \returns the storage size of the size class
+   */
+  static uint32_t GetClassSize (uint32_t sizeClass);
+  /**
+   * \returns the cache of the calling thread, or 0 if it was destroyed
+   */
+  static ThreadCache *GetThreadCache (void);
+  /**
+   * \brief Publish a storage in the reservoir.
+   * \param sizeClass the size class of the storage
+   * \param data the storage
+   * \returns false if the reservoir is full or destroyed
+   */
+  static bool Push (uint32_t sizeClass, struct Buffer::Data *data);
+  /**
+   * \brief Take a storage from the reservoir.
+   * \param sizeClass the requested size class
+   * \returns a storage, or 0 if the reservoir holds none
+   */
+  static struct Buffer::Data *Pop (uint32_t sizeClass);
+  /**
+   * \returns the counters of the destroyed and of the live caches,
+   * since the first buffer was created
+   *
+   * The caller holds g_cachesMutex.
+   */
+  static FreeListStatistics GetTotals (void);
+
+  /// Reservoir slots, an empty slot holds 0
+  static std::atomic<struct Buffer::Data *> g_reservoir[N_CLASSES][MAX_RESERVOIR_SIZE];
+  /// Approximate number of storages held by each reservoir class
+  static std::atomic<int32_t> g_reservoirCount[N_CLASSES];
+  static std::atomic<bool> g_destroyed;          //!< the reservoir was destroyed
+  static std::atomic<uint32_t> g_threadCacheSize; //!< thread cache limit per size class
+  static std::atomic<uint32_t> g_reservoirSize;   //!< reservoir limit per size class
+  static std::atomic<uint32_t> g_maxSize;         //!< largest recycled storage size
+  static std::mutex g_cachesMutex;     //!< protects the list of live caches
+  static ThreadCache *g_caches;        //!< list of live caches
+  static FreeListStatistics g_retired; //!< counters of the destroyed caches
+  static FreeListStatistics g_baseline; //!< totals at the last ResetFreeListStatistics
+  static thread_local ThreadCache t_cache;     //!< cache of the calling thread, built on first use
+  static thread_local bool t_cacheDestroyed;   //!< the cache of the calling thread was destroyed
+};
+
+const uint32_t Buffer::FreeList::MIN_CLASS_SIZE;
+const uint32_t Buffer::FreeList::N_CLASSES;
+const uint32_t Buffer::FreeList::MAX_RESERVOIR_SIZE;
+std::atomic<struct Buffer::Data *> Buffer::FreeList::g_reservoir[N_CLASSES][MAX_RESERVOIR_SIZE];
+std::atomic<int32_t> Buffer::FreeList::g_reservoirCount[N_CLASSES];
+std::atomic<bool> Buffer::FreeList::g_destroyed (false);
+std::atomic<uint32_t> Buffer::FreeList::g_threadCacheSize (256);
+std::atomic<uint32_t> Buffer::FreeList::g_reservoirSize (256);
+std::atomic<uint32_t> Buffer::FreeList::g_maxSize (0);
+std::mutex Buffer::FreeList::g_cachesMutex;
+Buffer::FreeList::ThreadCache *Buffer::FreeList::g_caches = 0;
+Buffer::FreeListStatistics Buffer::FreeList::g_retired = { 0, 0, 0, 0 };
+Buffer::FreeListStatistics Buffer::FreeList::g_baseline = { 0, 0, 0, 0 };
 struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
+thread_local Buffer::FreeList::ThreadCache Buffer::FreeList::t_cache;
+thread_local bool Buffer::FreeList::t_cacheDestroyed = false;
+
+Buffer::FreeList::ThreadCache::ThreadCache ()
+  : threadCacheHits (0),
+    reservoirHits (0),
+    misses (0),
+    releases (0),
+    prev (0)
+{
+  std::lock_guard<std::mutex> lock (g_cachesMutex);
+  next = g_caches;
+  if (next != 0)
+    {
+      next->prev = this;
+    }
+  g_caches = this;
+}
+
+Buffer::FreeList::ThreadCache::~ThreadCache ()
+{
+  for (uint32_t i = 0; i < N_CLASSES; i++)
+    {
+      for (std::vector<struct Buffer::Data *>::iterator j = bins[i].begin ();
+           j != bins[i].end (); j++)
+        {
+          if (!Push (i, *j))
+            {
+              Buffer::Deallocate (*j);
+            }
+        }
+      bins[i].clear ();
+    }
+  std::lock_guard<std::mutex> lock (g_cachesMutex);
+  g_retired.threadCacheHits += threadCacheHits;
+  g_retired.reservoirHits += reservoirHits;
+  g_retired.misses += misses;
+  g_retired.releases += releases;
+  if (prev != 0)
+    {
+      prev->next = next;
+    }
+  else
+    {
+      g_caches = next;
+    }
+  if (next != 0)
+    {
+      next->prev = prev;
+    }
+  t_cacheDestroyed = true;
+}
+
+void
+Buffer::FreeList::ThreadCache::Increment (std::atomic<uint64_t> &counter)
+{
+  // Only the owner thread writes its counters, which never decrease
+  // (ResetFreeListStatistics moves a baseline instead of clearing
+  // them): a plain load and store avoids a locked read-modify-write
+  // on the fast path.
+  counter.store (counter.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+uint32_t
+Buffer::FreeList::GetSizeClass (uint32_t size)
+{
+  uint32_t sizeClass = 0;
+  uint32_t classSize = MIN_CLASS_SIZE;
+  while (classSize < size && sizeClass < N_CLASSES)
+    {
+      classSize <<= 1;
+      sizeClass++;
+    }
+  return sizeClass;
+}
+
+uint32_t
+Buffer::FreeList::GetClassSize (uint32_t sizeClass)
+{
+  return MIN_CLASS_SIZE << sizeClass;
+}
+
+Buffer::FreeList::ThreadCache *
+Buffer::FreeList::GetThreadCache (void)
+{
+  if (t_cacheDestroyed)
+    {
+      return 0;
+    }
+  return &t_cache;
+}
+
+bool
+Buffer::FreeList::Push (uint32_t sizeClass, struct Buffer::Data *data)
+{
+  if (g_destroyed.load (std::memory_order_acquire))
+    {
+      return false;
+    }
+  uint32_t limit = std::min (g_reservoirSize.load (std::memory_order_relaxed), MAX_RESERVOIR_SIZE);
+  if (g_reservoirCount[sizeClass].load (std::memory_order_relaxed) >= static_cast<int32_t> (limit))
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < limit; i++)
+    {
+      struct Buffer::Data *expected = 0;
+      if (g_reservoir[sizeClass][i].load (std::memory_order_relaxed) == 0
+          && g_reservoir[sizeClass][i].compare_exchange_strong (expected, data,
+                                                                 std::memory_order_release,
+                                                                 std::memory_order_relaxed))
+        {
+          g_reservoirCount[sizeClass].fetch_add (1, std::memory_order_relaxed);
+          return true;
+        }
+    }
+  return false;
+}
+
+struct Buffer::Data *
+Buffer::FreeList::Pop (uint32_t sizeClass)
+{
+  if (g_reservoirCount[sizeClass].load (std::memory_order_relaxed) <= 0)
+    {
+      return 0;
+    }
+  uint32_t limit = std::min (g_reservoirSize.load (std::memory_order_relaxed), MAX_RESERVOIR_SIZE);
+  for (uint32_t i = 0; i < limit; i++)
+    {
+      if (g_reservoir[sizeClass][i].load (std::memory_order_relaxed) != 0)
+        {
+          struct Buffer::Data *data = g_reservoir[sizeClass][i].exchange (0, std::memory_order_acquire);
+          if (data != 0)
+            {
+              g_reservoirCount[sizeClass].fetch_sub (1, std::memory_order_relaxed);
+              return data;
+            }
+        }
+    }
+  return 0;
+}
+
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
 {
   NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
+  FreeList::g_destroyed.store (true, std::memory_order_release);
+  for (uint32_t i = 0; i < FreeList::N_CLASSES; i++)
     {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
+      for (uint32_t j = 0; j < FreeList::MAX_RESERVOIR_SIZE; j++)
         {
-          Buffer::Deallocate (*i);
+          struct Buffer::Data *data = FreeList::g_reservoir[i][j].exchange (0);
+          if (data != 0)
+            {
+              Buffer::Deallocate (data);
+            }
         }
-      delete g_freeList;
-      g_freeList = DESTROYED;
+      FreeList::g_reservoirCount[i].store (0);
     }
 }
 
+void
+Buffer::SetFreeListLimits (uint32_t threadCacheSize, uint32_t reservoirSize)
+{
+  NS_LOG_FUNCTION (threadCacheSize << reservoirSize);
+  NS_ASSERT_MSG (reservoirSize <= FreeList::MAX_RESERVOIR_SIZE,
+                 "The buffer reservoir holds at most " << FreeList::MAX_RESERVOIR_SIZE << " storages per size class");
+  FreeList::g_threadCacheSize.store (threadCacheSize);
+  FreeList::g_reservoirSize.store (reservoirSize);
+}
+
+Buffer::FreeListStatistics
+Buffer::FreeList::GetTotals (void)
+{
+  FreeListStatistics stats = g_retired;
+  for (ThreadCache *cache = g_caches; cache != 0; cache = cache->next)
+    {
+      stats.threadCacheHits += cache->threadCacheHits.load (std::memory_order_relaxed);
+      stats.reservoirHits += cache->reservoirHits.load (std::memory_order_relaxed);
+      stats.misses += cache->misses.load (std::memory_order_relaxed);
+      stats.releases += cache->releases.load (std::memory_order_relaxed);
+    }
+  return stats;
+}
+
+Buffer::FreeListStatistics
+Buffer::GetFreeListStatistics (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::lock_guard<std::mutex> lock (FreeList::g_cachesMutex);
+  FreeListStatistics stats = FreeList::GetTotals ();
+  stats.threadCacheHits -= FreeList::g_baseline.threadCacheHits;
+  stats.reservoirHits -= FreeList::g_baseline.reservoirHits;
+  stats.misses -= FreeList::g_baseline.misses;
+  stats.releases -= FreeList::g_baseline.releases;
+  return stats;
+}
+
+void
+Buffer::ResetFreeListStatistics (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::lock_guard<std::mutex> lock (FreeList::g_cachesMutex);
+  FreeList::g_baseline = FreeList::GetTotals ();
+}
+
 void
 Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
+  uint32_t sizeClass = FreeList::GetSizeClass (data->m_size);
+  if (sizeClass == FreeList::N_CLASSES)
     {
       Buffer::Deallocate (data);
+      return;
     }
-  else
+  NS_ASSERT (data->m_size == FreeList::GetClassSize (sizeClass));
+  if (data->m_size > FreeList::g_maxSize.load (std::memory_order_relaxed))
     {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
+      FreeList::g_maxSize.store (data->m_size, std::memory_order_relaxed);
+    }
+  FreeList::ThreadCache *cache = FreeList::GetThreadCache ();
+  if (cache == 0)
+    {
+      if (!FreeList::Push (sizeClass, data))
+        {
+          Buffer::Deallocate (data);
+        }
+      return;
+    }
+  std::vector<struct Buffer::Data *> &bin = cache->bins[sizeClass];
+  uint32_t limit = FreeList::g_threadCacheSize.load (std::memory_order_relaxed);
+  if (bin.size () >= limit)
+    {
+      /* hand half of the cache, and at least this storage, to the other threads */
+      bin.push_back (data);
+      uint32_t keep = limit / 2;
+      while (bin.size () > keep)
+        {
+          if (!FreeList::Push (sizeClass, bin.back ()))
+            {
+              Buffer::Deallocate (bin.back ());
+              FreeList::ThreadCache::Increment (cache->releases);
+            }
+          bin.pop_back ();
+        }
+      return;
     }
+  bin.push_back (data);
 }
 
 Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
+  /* An empty buffer is given the size class of the largest buffer seen
+   * so far: headers and trailers added later then fit without copy. */
+  uint32_t sizeClass = FreeList::GetSizeClass (std::max (dataSize, FreeList::g_maxSize.load (std::memory_order_relaxed)));
+  if (dataSize != 0 && sizeClass == FreeList::N_CLASSES)
+    {
+      return Buffer::Allocate (dataSize);
+    }
+  sizeClass = std::min (sizeClass, FreeList::N_CLASSES - 1);
+  FreeList::ThreadCache *cache = FreeList::GetThreadCache ();
+  if (cache != 0 && !cache->bins[sizeClass].empty ())
     {
-      g_freeList = new Buffer::FreeList ();
+      struct Buffer::Data *data = cache->bins[sizeClass].back ();
+      cache->bins[sizeClass].pop_back ();
+      FreeList::ThreadCache::Increment (cache->threadCacheHits);
+      data->m_count = 1;
+      return data;
     }
-  else if (IS_INITIALIZED (g_freeList))
+  struct Buffer::Data *data = FreeList::Pop (sizeClass);
+  if (data != 0)
     {
-      while (!g_freeList->empty ()) 
+      if (cache != 0)
         {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
+          FreeList::ThreadCache::Increment (cache->reservoirHits);
         }
+      data->m_count = 1;
+      return data;
+    }
+  if (cache != 0)
+    {
+      FreeList::ThreadCache::Increment (cache->misses);
     }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
+  data = Buffer::Allocate (FreeList::GetClassSize (sizeClass));
   NS_ASSERT (data->m_count == 1);
   return data;
 }
@@ -157,6 +473,26 @@ Buffer::Create (uint32_t size)
   NS_LOG_FUNCTION (size);
   return Allocate (size);
 }
+
+void
+Buffer::SetFreeListLimits (uint32_t threadCacheSize, uint32_t reservoirSize)
+{
+  NS_LOG_FUNCTION (threadCacheSize << reservoirSize);
+}
+
+Buffer::FreeListStatistics
+Buffer::GetFreeListStatistics (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  FreeListStatistics stats = { 0, 0, 0, 0 };
+  return stats;
+}
+
+void
+Buffer::ResetFreeListStatistics (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+}
 #endif /* BUFFER_FREE_LIST */
 
 struct Buffer::Data *
@@ -434,6 +770,36 @@ Buffer::AddAtEnd (const Buffer &o)
   NS_ASSERT (CheckInternalState ());
 }
 
+void
+Buffer::Overwrite (uint32_t start, uint8_t const *data, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << start << &data << size);
+  NS_ASSERT (CheckInternalState ());
+  NS_ASSERT (start + size <= GetSize ());
+  if (m_zeroAreaEnd != m_zeroAreaStart &&
+      start + size > m_zeroAreaStart - m_start &&
+      start < m_zeroAreaEnd - m_start)
+    {
+      /* the bytes overlap the zero area: make it real. */
+      *this = CreateFullCopy ();
+    }
+  if (m_data->m_count > 1)
+    {
+      /* the storage is shared: take a private copy at the same offsets. */
+      struct Buffer::Data *newData = Buffer::Create (m_data->m_size);
+      memcpy (newData->m_data + m_start, m_data->m_data + m_start, GetInternalSize ());
+      m_data->m_count--;
+      m_data = newData;
+      m_data->m_dirtyStart = m_start;
+      m_data->m_dirtyEnd = m_end;
+    }
+  Buffer::Iterator i = Begin ();
+  i.Next (start);
+  i.Write (data, size);
+  LOG_INTERNAL_STATE ("overwrite start=" << start << ", size=" << size << ", ");
+  NS_ASSERT (CheckInternalState ());
+}
+
 void 
 Buffer::RemoveAtStart (uint32_t start)
 {
@@ -529,6 +529,18 @@ private:
    * pointing to this Buffer.
    */
   void AddAtEnd (const Buffer &o);
+  /**
+   * \param start offset of the first byte to overwrite
+   * \param data the new bytes
+   * \param size number of bytes to overwrite
+   *
+   * Overwrite bytes of the Buffer in place. The storage is copied
+   * only if it is shared with another Buffer or if the bytes fall in
+   * the virtual zero area.
+   * Any call to this method invalidates any Iterator
+   * pointing to this Buffer.
+   */
+  void Overwrite (uint32_t start, uint8_t const *data, uint32_t size);
   /**
    * \param start size to remove
    *
@@ -642,6 +654,42 @@ private:
    */
   Buffer (uint32_t dataSize, bool initialize);
   ~Buffer ();
+
+  /**
+   * \brief Counters of the buffer data free list.
+   *
+   * Every data storage request is served, in order, from the cache
+   * of the calling thread, from the global reservoir shared by all
+   * threads, or from the heap.
+   */
+  struct FreeListStatistics
+  {
+    uint64_t threadCacheHits; //!< requests served by the thread cache
+    uint64_t reservoirHits;   //!< requests served by the global reservoir
+    uint64_t misses;          //!< requests served by the heap
+    uint64_t releases;        //!< recycled storages returned to the heap
+  };
+
+  /**
+   * \brief Configure the size of the buffer data free list.
+   *
+   * The limits apply to each size class.  They are meant to be set
+   * before the simulation starts; a thread cache larger than the new
+   * limit is trimmed the next time it overflows.
+   *
+   * \param threadCacheSize number of storages kept by each thread
+   * \param reservoirSize number of storages kept in the global
+   * reservoir shared by all threads (at most 1024)
+   */
+  static void SetFreeListLimits (uint32_t threadCacheSize, uint32_t reservoirSize);
+  /**
+   * \returns the counters of the free list, summed over all threads
+   */
+  static FreeListStatistics GetFreeListStatistics (void);
+  /**
+   * \brief Reset the counters of the free list of all threads.
+   */
+  static void ResetFreeListStatistics (void);
 private:
   /**
    * This data structure is variable-sized through its last member whose size
@@ -791,15 +839,13 @@ private:
   uint32_t m_end;
 
 #ifdef BUFFER_FREE_LIST
-  /// Container for buffer data
-  typedef std::vector<struct Buffer::Data*> FreeList;
+  /// Per-thread caches and global reservoir of buffer data, see buffer.cc
+  struct FreeList;
   /// Local static destructor structure
   struct LocalStaticDestructor 
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
   static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
 };
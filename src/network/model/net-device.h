@@ -359,6 +359,15 @@ public:
    */
   virtual bool SupportsSendFrom (void) const = 0;
 
+  /**
+   * \return true if this interface transmits a packet carrying a
+   *         SegmentOffloadTag as the train of wire packets it stands for,
+   *         so that the layers above do not need to fragment it.
+   *
+   * The default implementation returns false.
+   */
+  virtual bool SupportsSegmentOffload (void) const;
+
 };
 
 } // namespace ns3
@@ -31,6 +31,35 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
+namespace {
+
+/**
+ * \ingroup packet
+ * \param data the storage of the list
+ * \param head the head of the list, 0xffff if empty
+ * \param tail the tail of the list
+ * \param next the next field of the new item
+ * \returns true if linking the new item overwrites a link which no
+ *          other list sharing the storage can follow
+ *
+ * A new item at the head overwrites the prev field of the head, at
+ * the tail the next field of the tail. Another packet sharing the
+ * storage may have removed headers or trailers: the link then joins
+ * two items of its list and must not change.
+ */
+bool
+IsLinkFree (const uint8_t *data, uint16_t head, uint16_t tail, uint32_t next)
+{
+  if (head == 0xffff)
+    {
+      return true;
+    }
+  const uint8_t *link = (next == head) ? &data[head + 2] : &data[tail];
+  return link[0] == 0xff && link[1] == 0xff;
+}
+
+} // anonymous namespace
+
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
@@ -75,12 +104,15 @@ PacketMetadata::ReserveCopy (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
   struct PacketMetadata::Data *newData = PacketMetadata::Create (m_used + size);
-  memcpy (newData->m_data, m_data->m_data, m_used);
   newData->m_dirtyEnd = m_used;
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (m_data != 0)
     {
-      PacketMetadata::Recycle (m_data);
+      memcpy (newData->m_data, m_data->m_data, m_used);
+      m_data->m_count--;
+      if (m_data->m_count == 0) 
+        {
+          PacketMetadata::Recycle (m_data);
+        }
     }
   m_data = newData;
   if (m_head != 0xffff)
@@ -99,8 +131,8 @@ void
 PacketMetadata::Reserve (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  NS_ASSERT (m_data != 0);
-  if (m_data->m_size >= m_used + size &&
+  if (m_data != 0 &&
+      m_data->m_size >= m_used + size &&
       (m_head == 0xffff ||
        m_data->m_count == 1 ||
        m_data->m_dirtyEnd == m_used))
@@ -133,7 +165,7 @@ bool
 PacketMetadata::IsStateOk (void) const
 {
   NS_LOG_FUNCTION (this);
-  bool ok = m_used <= m_data->m_size;
+  bool ok = (m_data == 0) ? (m_used == 0 && m_head == 0xffff) : (m_used <= m_data->m_size);
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
   uint16_t current = m_head;
@@ -374,15 +406,16 @@ uint16_t
 PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
 {
   NS_LOG_FUNCTION (this << item->next << item->prev << item->typeUid << item->size << item->chunkUid);
-  NS_ASSERT (m_data != 0);
   NS_ASSERT (m_used != item->prev && m_used != item->next);
   uint32_t typeUidSize = GetUleb128Size (item->typeUid);
   uint32_t sizeSize = GetUleb128Size (item->size);
   uint32_t n =  2 + 2 + typeUidSize + sizeSize + 2;
-  if (m_used + n > m_data->m_size ||
+  if (m_data == 0 ||
+      m_used + n > m_data->m_size ||
       (m_head != 0xffff &&
        m_data->m_count != 1 &&
-       m_used != m_data->m_dirtyEnd))
+       (m_used != m_data->m_dirtyEnd ||
+        !IsLinkFree (m_data->m_data, m_head, m_tail, item->next))))
     {
       ReserveCopy (n);
     }
@@ -407,7 +440,6 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
   NS_LOG_FUNCTION (this << next << prev <<
                    item->next << item->prev << item->typeUid << item->size << item->chunkUid <<
                    extraItem->fragmentStart << extraItem->fragmentEnd << extraItem->packetUid);
-  NS_ASSERT (m_data != 0);
   uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid+1;
   NS_ASSERT (m_used != prev && m_used != next);
 
@@ -417,10 +449,12 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
   uint32_t fragEndSize = GetUleb128Size (extraItem->fragmentEnd);
   uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
 
-  if (m_used + n > m_data->m_size ||
+  if (m_data == 0 ||
+      m_used + n > m_data->m_size ||
       (m_head != 0xffff &&
        m_data->m_count != 1 &&
-       m_used != m_data->m_dirtyEnd))
+       (m_used != m_data->m_dirtyEnd ||
+        !IsLinkFree (m_data->m_data, m_head, m_tail, next))))
     {
       ReserveCopy (n);
     }
@@ -895,7 +929,6 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       m_metadataSkipped = true;
       return;
     }
-  NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
   while (current != 0xffff && leftToRemove > 0)
@@ -958,7 +991,6 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       m_metadataSkipped = true;
       return;
     }
-  NS_ASSERT (m_data != 0);
 
   uint32_t leftToRemove = end;
   uint16_t current = m_tail;
@@ -23,6 +23,7 @@
 #include "ns3/simulator.h"
 #include <string>
 #include <cstdarg>
+#include <vector>
 
 namespace ns3 {
 
@@ -30,6 +31,66 @@ NS_LOG_COMPONENT_DEFINE ("Packet");
 
 uint32_t Packet::m_globalUid = 0;
 
+namespace {
+
+/**
+ * \ingroup packet
+ * \brief Storages of the destroyed packets of a thread.
+ */
+struct PacketPool
+{
+  ~PacketPool ();
+  std::vector<void *> m_free; //!< recycled packet storages
+};
+
+/// Maximum number of storages kept by each thread
+const std::size_t PACKET_POOL_SIZE = 4096;
+/// Pool of the calling thread, built on first use
+thread_local PacketPool t_packetPool;
+/// True once the pool of the calling thread was destroyed
+thread_local bool t_packetPoolDestroyed = false;
+
+PacketPool::~PacketPool ()
+{
+  for (std::vector<void *>::iterator i = m_free.begin (); i != m_free.end (); i++)
+    {
+      ::operator delete (*i);
+    }
+  m_free.clear ();
+  // Packets released after this point, e.g., by static destructors,
+  // go straight back to the heap.
+  t_packetPoolDestroyed = true;
+}
+
+} // anonymous namespace
+
+void *
+Packet::operator new (size_t size)
+{
+  if (size == sizeof (Packet) && !t_packetPoolDestroyed && !t_packetPool.m_free.empty ())
+    {
+      void *p = t_packetPool.m_free.back ();
+      t_packetPool.m_free.pop_back ();
+      return p;
+    }
+  return ::operator new (size);
+}
+
+void
+Packet::operator delete (void *p, size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  if (size == sizeof (Packet) && !t_packetPoolDestroyed && t_packetPool.m_free.size () < PACKET_POOL_SIZE)
+    {
+      t_packetPool.m_free.push_back (p);
+      return;
+    }
+  ::operator delete (p);
+}
+
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
 {
@@ -303,6 +364,30 @@ Packet::PeekHeader (Header &header, uint32_t size) const
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
   return deserialized;
 }
+void
+Packet::RewriteHeader (const Header &header, uint32_t offset, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << offset << size);
+  NS_ASSERT_MSG (header.GetSerializedSize () == size,
+                 "ModifyHeader cannot change the size of " << header.GetInstanceTypeId ().GetName ());
+  Buffer tmp;
+  tmp.AddAtStart (size);
+  header.Serialize (tmp.Begin ());
+  uint8_t const *bytes = tmp.PeekData ();
+  Buffer::Iterator i = m_buffer.Begin ();
+  i.Next (offset);
+  uint32_t unchanged = 0;
+  while (unchanged < size && i.ReadU8 () == bytes[unchanged])
+    {
+      unchanged++;
+    }
+  if (unchanged == size)
+    {
+      return;
+    }
+  m_buffer.Overwrite (offset, bytes, size);
+}
+
 void
 Packet::AddTrailer (const Trailer &trailer)
 {
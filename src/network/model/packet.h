@@ -356,6 +356,32 @@ public:
    * \returns the number of bytes read from the packet.
    */
   uint32_t PeekHeader (Header &header, uint32_t size) const;
+  /**
+   * \brief Rewrite a header in place.
+   *
+   * The header found at the given offset is deserialized, passed to the
+   * modifier and serialized back into the same bytes. Unlike a
+   * RemoveHeader / AddHeader round trip, the packet metadata and byte
+   * tags are left untouched, and the buffer is only copied if the bytes
+   * actually change while being shared with another packet.
+   *
+   * \code
+   *   UdpHeader udp;
+   *   SeanetHeader_ seanet;
+   *   packet->ModifyHeader (seanet, [] (SeanetHeader_ &h) { h.Setdst (IS_DST); },
+   *                         udp.GetSerializedSize ());
+   * \endcode
+   *
+   * \tparam T \deduced the header type
+   * \tparam F \deduced a callable taking a T&
+   * \param header the header, which holds the rewritten value on return
+   * \param modify the modifier; it must not change the serialized size
+   * of the header
+   * \param offset number of bytes before the header
+   * \returns the number of bytes rewritten
+   */
+  template <typename T, typename F>
+  uint32_t ModifyHeader (T &header, F modify, uint32_t offset = 0);
   /**
    * \brief Add trailer to this packet.
    *
@@ -453,6 +479,24 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief Allocate the storage of a Packet.
+   *
+   * Packets are recycled through a pool owned by the calling thread so
+   * that creating and destroying packets does not touch the heap in
+   * steady state.
+   *
+   * \param size the size of the object to allocate
+   * \returns the storage of the object
+   */
+  static void *operator new (size_t size);
+  /**
+   * \brief Release the storage of a Packet to the pool of the calling thread.
+   * \param p the storage of the object
+   * \param size the size of the object
+   */
+  static void operator delete (void *p, size_t size);
+
   /**
    * \brief Returns the packet's Uid.
    *
@@ -779,6 +823,14 @@ private:
    */
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /**
+   * \brief Serialize a header over the bytes it was read from.
+   * \param header the header
+   * \param offset number of bytes before the header
+   * \param size the serialized size of the header when it was read
+   */
+  void RewriteHeader (const Header &header, uint32_t offset, uint32_t size);
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
@@ -854,6 +906,18 @@ Packet::GetSize (void) const
   return m_buffer.GetSize ();
 }
 
+template <typename T, typename F>
+uint32_t
+Packet::ModifyHeader (T &header, F modify, uint32_t offset)
+{
+  Buffer::Iterator start = m_buffer.Begin ();
+  start.Next (offset);
+  uint32_t size = header.Deserialize (start);
+  modify (header);
+  RewriteHeader (header, offset, size);
+  return size;
+}
+
 } // namespace ns3
 
 #endif /* PACKET_H */
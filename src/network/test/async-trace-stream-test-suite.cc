@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "ns3/test.h"
+#include "ns3/async-trace-stream.h"
+#include "ns3/pcap-file.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that an AsyncTraceStream writes its lines in order
+ * through a small ring of buffers.
+ */
+class AsyncTraceStreamTextTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param compress Whether to compress the file.
+   */
+  AsyncTraceStreamTextTestCase (bool compress);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Read a whole file.
+   * \param filename The file name.
+   * \returns The content of the file, uncompressed.
+   */
+  std::string ReadFile (std::string const &filename);
+
+  bool m_compress; //!< Compress the file.
+};
+
+AsyncTraceStreamTextTestCase::AsyncTraceStreamTextTestCase (bool compress)
+  : TestCase (compress ? "Check compressed asynchronous text traces"
+              : "Check asynchronous text traces"),
+    m_compress (compress)
+{
+}
+
+std::string
+AsyncTraceStreamTextTestCase::ReadFile (std::string const &filename)
+{
+  std::string content;
+  if (m_compress)
+    {
+#ifdef HAVE_ZLIB
+      gzFile file = gzopen (filename.c_str (), "rb");
+      char buffer[4096];
+      int n;
+      while ((n = gzread (file, buffer, sizeof (buffer))) > 0)
+        {
+          content.append (buffer, n);
+        }
+      gzclose (file);
+#endif
+    }
+  else
+    {
+      std::ifstream file (filename.c_str (), std::ios::binary);
+      std::ostringstream oss;
+      oss << file.rdbuf ();
+      content = oss.str ();
+    }
+  return content;
+}
+
+void
+AsyncTraceStreamTextTestCase::DoRun (void)
+{
+  if (m_compress && !AsyncTraceStream::IsCompressionSupported ())
+    {
+      return;
+    }
+  std::string filename = CreateTempDirFilename ("async-trace-stream.tr");
+  std::ostringstream expected;
+  AsyncTraceStream *stream = new AsyncTraceStream (filename, std::ios::out, 4096, 2, m_compress);
+  NS_TEST_ASSERT_MSG_EQ (stream->IsOpen (), true, "Unable to open " << filename);
+  if (m_compress)
+    {
+      NS_TEST_ASSERT_MSG_EQ (stream->GetFileName (), filename + ".gz", "Wrong compressed file name");
+    }
+  for (uint32_t i = 0; i < 20000; i++)
+    {
+      *stream << "+ " << i << " /NodeList/" << i % 7 << "/DeviceList/0" << std::endl;
+      expected << "+ " << i << " /NodeList/" << i % 7 << "/DeviceList/0" << std::endl;
+    }
+  stream->Flush ();
+  NS_TEST_ASSERT_MSG_EQ (ReadFile (stream->GetFileName ()).size (), expected.str ().size (),
+                         "Flush did not write all the lines");
+  *stream << "last line" << std::endl;
+  expected << "last line" << std::endl;
+  filename = stream->GetFileName ();
+  delete stream;
+
+  NS_TEST_ASSERT_MSG_EQ ((ReadFile (filename) == expected.str ()), true, "Wrong file content");
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that a PcapFile written through an AsyncTraceStream
+ * reads back as written.
+ */
+class AsyncTraceStreamPcapTestCase : public TestCase
+{
+public:
+  AsyncTraceStreamPcapTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+AsyncTraceStreamPcapTestCase::AsyncTraceStreamPcapTestCase ()
+  : TestCase ("Check asynchronous pcap traces")
+{
+}
+
+void
+AsyncTraceStreamPcapTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("async-trace-stream.pcap");
+  uint8_t data[1500];
+  for (uint32_t i = 0; i < sizeof (data); i++)
+    {
+      data[i] = i & 0xff;
+    }
+
+  PcapFile out;
+  out.OpenAsync (new AsyncTraceStream (filename, std::ios::out | std::ios::binary, 8192, 3, false));
+  NS_TEST_ASSERT_MSG_EQ (out.Fail (), false, "Unable to open " << filename);
+  out.Init (1, 1000);
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      out.Write (i, 0, data, 100 + i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (out.Fail (), false, "Unable to write " << filename);
+  out.Close ();
+
+  PcapFile in;
+  in.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Unable to read " << filename);
+  NS_TEST_ASSERT_MSG_EQ (in.GetDataLinkType (), 1, "Wrong data link type");
+  NS_TEST_ASSERT_MSG_EQ (in.GetSnapLen (), 1000, "Wrong snap length");
+  uint8_t buffer[1500];
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+      in.Read (buffer, sizeof (buffer), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (in.Fail (), false, "Unable to read record " << i);
+      NS_TEST_ASSERT_MSG_EQ (tsSec, i, "Wrong time stamp");
+      NS_TEST_ASSERT_MSG_EQ (origLen, 100 + i, "Wrong original length");
+      NS_TEST_ASSERT_MSG_EQ (inclLen, std::min<uint32_t> (100 + i, 1000), "Wrong included length");
+      NS_TEST_ASSERT_MSG_EQ (buffer[inclLen - 1], data[inclLen - 1], "Wrong record data");
+    }
+  in.Close ();
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief AsyncTraceStream TestSuite
+ */
+class AsyncTraceStreamTestSuite : public TestSuite
+{
+public:
+  AsyncTraceStreamTestSuite ();
+};
+
+AsyncTraceStreamTestSuite::AsyncTraceStreamTestSuite ()
+  : TestSuite ("async-trace-stream", UNIT)
+{
+  AddTestCase (new AsyncTraceStreamTextTestCase (false), TestCase::QUICK);
+  AddTestCase (new AsyncTraceStreamTextTestCase (true), TestCase::QUICK);
+  AddTestCase (new AsyncTraceStreamPcapTestCase, TestCase::QUICK);
+}
+
+static AsyncTraceStreamTestSuite asyncTraceStreamTestSuite; //!< Static variable for test initialization
@@ -22,6 +22,12 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include "ns3/core-config.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include <vector>
+#endif
 
 using namespace ns3;
 
@@ -389,6 +395,262 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer free list unit tests.
+ */
+class BufferFreeListTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferFreeListTest ();
+};
+
+BufferFreeListTest::BufferFreeListTest ()
+  : TestCase ("Buffer free list")
+{
+}
+
+void
+BufferFreeListTest::DoRun (void)
+{
+  Buffer::ResetFreeListStatistics ();
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Buffer buffer;
+      buffer.AddAtStart (24);
+      buffer.Begin ().WriteU32 (i);
+      NS_TEST_ASSERT_MSG_EQ (buffer.Begin ().ReadU32 (), i, "Recycled buffer content is wrong");
+    }
+  Buffer::FreeListStatistics stats = Buffer::GetFreeListStatistics ();
+  uint64_t requests = stats.threadCacheHits + stats.reservoirHits + stats.misses;
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (requests, 100, "Every buffer needs a data storage");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (stats.misses, 2, "Steady state buffers should not allocate");
+
+  // Without thread cache, storages go through the reservoir.
+  Buffer::SetFreeListLimits (0, 16);
+  Buffer::ResetFreeListStatistics ();
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Buffer buffer;
+      buffer.AddAtEnd (100);
+    }
+  stats = Buffer::GetFreeListStatistics ();
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (stats.reservoirHits, 95, "Reservoir should serve the requests");
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (stats.misses, 2, "Steady state buffers should not allocate");
+  Buffer::SetFreeListLimits (256, 256);
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer::Overwrite unit tests.
+ */
+class BufferOverwriteTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferOverwriteTest ();
+};
+
+BufferOverwriteTest::BufferOverwriteTest ()
+  : TestCase ("Buffer::Overwrite")
+{
+}
+
+void
+BufferOverwriteTest::DoRun (void)
+{
+  uint8_t data[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  uint8_t read[16];
+
+  // An empty zero area is left between the bytes added at the start and
+  // at the end: a write across it is made in place.
+  Buffer buffer;
+  buffer.AddAtStart (8);
+  buffer.AddAtEnd (8);
+  Buffer::Iterator i = buffer.Begin ();
+  for (uint32_t j = 0; j < 16; j++)
+    {
+      i.WriteU8 (0xff);
+    }
+  const uint8_t *storage = buffer.PeekData ();
+  buffer.Overwrite (4, data, 8);
+  NS_TEST_EXPECT_MSG_EQ ((buffer.PeekData () == storage), true, "The storage was copied");
+  buffer.CopyData (read, 16);
+  NS_TEST_EXPECT_MSG_EQ (read[3], 0xff, "Byte before the write modified");
+  for (uint32_t j = 0; j < 8; j++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (read[4 + j], data[j], "Byte " << 4 + j << " not written");
+    }
+  NS_TEST_EXPECT_MSG_EQ (read[12], 0xff, "Byte after the write modified");
+
+  // A write in the zero area makes it real.
+  Buffer zeroes (16);
+  zeroes.Overwrite (6, data, 4);
+  zeroes.CopyData (read, 16);
+  NS_TEST_EXPECT_MSG_EQ (read[5], 0, "Byte before the write modified");
+  NS_TEST_EXPECT_MSG_EQ (read[6], 1, "Byte not written");
+  NS_TEST_EXPECT_MSG_EQ (read[9], 4, "Byte not written");
+  NS_TEST_EXPECT_MSG_EQ (read[10], 0, "Byte after the write modified");
+
+  // A shared storage is copied first.
+  Buffer copy = buffer;
+  copy.Overwrite (0, data, 1);
+  NS_TEST_EXPECT_MSG_EQ ((buffer.PeekData () == storage), true, "The original storage was replaced");
+  buffer.CopyData (read, 1);
+  NS_TEST_EXPECT_MSG_EQ (read[0], 0xff, "The write leaked into the original");
+  copy.CopyData (read, 1);
+  NS_TEST_EXPECT_MSG_EQ (read[0], 1, "Byte not written in the copy");
+}
+
+#ifdef HAVE_PTHREAD_H
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer free list test with several threads allocating and freeing
+ * buffers at the same time.
+ *
+ * A thread cache is only written by its owner, and the storages go
+ * between the threads through the reservoir.  Each thread checks that
+ * the content of its buffers is not overwritten by another thread, and
+ * the statistics of all the threads must add up to the requests made.
+ */
+class BufferFreeListThreadsTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferFreeListThreadsTest ();
+private:
+  /// Number of threads
+  static const uint32_t N_THREADS = 4;
+  /**
+   * Create buffers of several size classes, fill them with values
+   * depending on the thread, check them and free them.
+   * \param id the thread identifier
+   */
+  void Work (uint32_t id);
+  /**
+   * Run Work in a thread.
+   * \param test the test case
+   * \param id the thread identifier
+   */
+  static void Thread (BufferFreeListThreadsTest *test, uint32_t id);
+  /**
+   * \returns the number of storage requests since the last
+   * statistics reset
+   */
+  static uint64_t GetRequests (void);
+
+  uint32_t m_errors[N_THREADS]; //!< content errors seen by each thread
+};
+
+BufferFreeListThreadsTest::BufferFreeListThreadsTest ()
+  : TestCase ("Buffer free list with several threads")
+{
+}
+
+uint64_t
+BufferFreeListThreadsTest::GetRequests (void)
+{
+  Buffer::FreeListStatistics stats = Buffer::GetFreeListStatistics ();
+  return stats.threadCacheHits + stats.reservoirHits + stats.misses;
+}
+
+void
+BufferFreeListThreadsTest::Work (uint32_t id)
+{
+  const uint32_t sizes[] = { 20, 100, 500, 1400, 3000 };
+  const uint32_t nSizes = sizeof (sizes) / sizeof (sizes[0]);
+  for (uint32_t i = 0; i < 2000; i++)
+    {
+      std::vector<Buffer> buffers (nSizes);
+      for (uint32_t k = 0; k < nSizes; k++)
+        {
+          buffers[k].AddAtStart (sizes[k]);
+          Buffer::Iterator it = buffers[k].Begin ();
+          for (uint32_t j = 0; j < sizes[k] / 4; j++)
+            {
+              it.WriteU32 (id * 1000000 + i * 10 + k);
+            }
+        }
+      for (uint32_t k = 0; k < nSizes; k++)
+        {
+          Buffer::Iterator it = buffers[k].Begin ();
+          for (uint32_t j = 0; j < sizes[k] / 4; j++)
+            {
+              if (it.ReadU32 () != id * 1000000 + i * 10 + k)
+                {
+                  m_errors[id]++;
+                  break;
+                }
+            }
+        }
+    }
+}
+
+void
+BufferFreeListThreadsTest::Thread (BufferFreeListThreadsTest *test, uint32_t id)
+{
+  test->Work (id);
+}
+
+void
+BufferFreeListThreadsTest::DoRun (void)
+{
+  // The size class of a new buffer depends on the largest buffer seen,
+  // and so does the number of storages it needs: run the work once
+  // first, then count the requests of a single thread.
+  Work (0);
+  Buffer::ResetFreeListStatistics ();
+  Work (0);
+  uint64_t requests = GetRequests ();
+  NS_TEST_ASSERT_MSG_GT (requests, 0, "The buffers need data storages");
+
+  Buffer::ResetFreeListStatistics ();
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t id = 0; id < N_THREADS; id++)
+    {
+      m_errors[id] = 0;
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&BufferFreeListThreadsTest::Thread, this, id)));
+    }
+  for (uint32_t id = 0; id < N_THREADS; id++)
+    {
+      threads[id]->Start ();
+    }
+  for (uint32_t id = 0; id < N_THREADS; id++)
+    {
+      threads[id]->Join ();
+    }
+  for (uint32_t id = 0; id < N_THREADS; id++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_errors[id], 0, "Thread " << id << " saw a storage used by another thread");
+    }
+
+  // The caches of the threads are destroyed by now, and their counters
+  // retired into the totals.
+  Buffer::FreeListStatistics stats = Buffer::GetFreeListStatistics ();
+  NS_TEST_ASSERT_MSG_EQ (stats.threadCacheHits + stats.reservoirHits + stats.misses, N_THREADS * requests,
+                         "The counters of the threads do not add up to their requests");
+  NS_TEST_ASSERT_MSG_GT (stats.threadCacheHits, stats.misses, "The thread caches are not used");
+
+  // A reset while other threads run does not lose their later requests.
+  threads.clear ();
+  for (uint32_t id = 0; id < N_THREADS; id++)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&BufferFreeListThreadsTest::Thread, this, id)));
+      threads[id]->Start ();
+    }
+  Buffer::ResetFreeListStatistics ();
+  for (uint32_t id = 0; id < N_THREADS; id++)
+    {
+      threads[id]->Join ();
+    }
+  NS_TEST_ASSERT_MSG_LT_OR_EQ (GetRequests (), N_THREADS * requests, "A reset counted requests twice");
+}
+#endif /* HAVE_PTHREAD_H */
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -405,6 +667,11 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferFreeListTest, TestCase::QUICK);
+  AddTestCase (new BufferOverwriteTest, TestCase::QUICK);
+#ifdef HAVE_PTHREAD_H
+  AddTestCase (new BufferFreeListThreadsTest, TestCase::QUICK);
+#endif /* HAVE_PTHREAD_H */
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
@@ -18,7 +18,9 @@
 
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
+#include "ns3/drop-tail-ring-queue.h"
 #include "ns3/string.h"
+#include "ns3/random-variable-stream.h"
 
 using namespace ns3;
 
@@ -83,6 +85,123 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((packet == 0), true, "There are really no packets in there");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * DropTailRingQueue unit tests: the ring queue must enqueue, dequeue, drop
+ * and trace the same packets as DropTailQueue, across wrap-arounds of the
+ * ring buffer and, in byte mode, across its growth.
+ */
+class DropTailRingQueueTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param maxSize the maximum size of the queues
+   */
+  DropTailRingQueueTestCase (std::string maxSize);
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Record a traced packet
+   * \param trace the uids of the traced packets
+   * \param item the traced packet
+   */
+  static void Trace (std::vector<uint64_t> *trace, Ptr<const Packet> item);
+  /**
+   * Connect the trace sources of a queue
+   * \param queue the queue
+   * \param traces the uids of the traced packets, one vector per trace source
+   */
+  static void Connect (Ptr<Queue<Packet> > queue, std::vector<uint64_t> traces[]);
+
+  std::string m_maxSize; //!< the maximum size of the queues
+};
+
+/// The trace sources of Queue
+static const char *g_queueTraceSources[] = {"Enqueue", "Dequeue", "Drop", "DropBeforeEnqueue", "DropAfterDequeue"};
+
+DropTailRingQueueTestCase::DropTailRingQueueTestCase (std::string maxSize)
+  : TestCase ("Check that the ring queue matches the drop tail queue with MaxSize " + maxSize),
+    m_maxSize (maxSize)
+{
+}
+
+void
+DropTailRingQueueTestCase::Trace (std::vector<uint64_t> *trace, Ptr<const Packet> item)
+{
+  trace->push_back (item->GetUid ());
+}
+
+void
+DropTailRingQueueTestCase::Connect (Ptr<Queue<Packet> > queue, std::vector<uint64_t> traces[])
+{
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      queue->TraceConnectWithoutContext (g_queueTraceSources[i],
+                                         MakeBoundCallback (&DropTailRingQueueTestCase::Trace, &traces[i]));
+    }
+}
+
+void
+DropTailRingQueueTestCase::DoRun (void)
+{
+  Ptr<DropTailQueue<Packet> > list = CreateObject<DropTailQueue<Packet> > ();
+  Ptr<DropTailRingQueue<Packet> > ring = CreateObject<DropTailRingQueue<Packet> > ();
+  list->SetAttribute ("MaxSize", StringValue (m_maxSize));
+  ring->SetAttribute ("MaxSize", StringValue (m_maxSize));
+  std::vector<uint64_t> listTraces[5];
+  std::vector<uint64_t> ringTraces[5];
+  Connect (list, listTraces);
+  Connect (ring, ringTraces);
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  for (uint32_t i = 0; i < 5000; i++)
+    {
+      // enqueue slightly more often than dequeue in the first half, so that
+      // the queues fill up and drop, then drain them
+      uint32_t op = rng->GetInteger (0, 9);
+      if ((i < 2500 && op < 5) || (i >= 2500 && op < 3))
+        {
+          Ptr<Packet> p = Create<Packet> (rng->GetInteger (1, 1500));
+          NS_TEST_EXPECT_MSG_EQ (ring->Enqueue (p), list->Enqueue (p), "Different enqueue result");
+        }
+      else if (op < 9)
+        {
+          Ptr<Packet> expected = list->Dequeue ();
+          Ptr<Packet> p = ring->Dequeue ();
+          NS_TEST_EXPECT_MSG_EQ (p, expected, "Different packet dequeued");
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ (ring->Peek (), list->Peek (), "Different packet peeked");
+          Ptr<Packet> expected = list->Remove ();
+          Ptr<Packet> p = ring->Remove ();
+          NS_TEST_EXPECT_MSG_EQ (p, expected, "Different packet removed");
+        }
+      NS_TEST_EXPECT_MSG_EQ (ring->GetCurrentSize (), list->GetCurrentSize (), "Different size");
+    }
+  list->Flush ();
+  ring->Flush ();
+
+  NS_TEST_EXPECT_MSG_GT (listTraces[3].size (), 0, "The queues did not overflow");
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((ringTraces[i] == listTraces[i]), true,
+                             "Different packets traced by " << g_queueTraceSources[i]);
+    }
+  NS_TEST_EXPECT_MSG_EQ (ring->GetTotalReceivedBytes (), list->GetTotalReceivedBytes (), "Different received bytes");
+  NS_TEST_EXPECT_MSG_EQ (ring->GetTotalDroppedBytes (), list->GetTotalDroppedBytes (), "Different dropped bytes");
+  if (ring->GetMaxSize ().GetUnit () == QueueSizeUnit::PACKETS)
+    {
+      NS_TEST_EXPECT_MSG_EQ (ring->GetCapacity (), ring->GetMaxSize ().GetValue (),
+                             "The capacity should be the maximum size");
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -96,6 +215,8 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new DropTailRingQueueTestCase ("20p"), TestCase::QUICK);
+    AddTestCase (new DropTailRingQueueTestCase ("20000B"), TestCase::QUICK);
   }
 };
 
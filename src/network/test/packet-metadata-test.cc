@@ -20,6 +20,7 @@
 #include <cstdarg>
 #include <iostream>
 #include <sstream>
+#include <vector>
 #include "ns3/test.h"
 #include "ns3/header.h"
 #include "ns3/trailer.h"
@@ -526,6 +527,32 @@ PacketMetadataTest::DoRun (void)
   REM_HEADER (p, 1);
   CHECK_HISTORY (p, 1, 10);
 
+  // A copy which removed a header shares the inner items: adding a
+  // header to it must not relink them in the original.
+  p = Create<Packet> (10);
+  ADD_HEADER (p, 1);
+  ADD_HEADER (p, 2);
+  ADD_TRAILER (p, 5);
+  p1 = p->Copy ();
+  REM_HEADER (p1, 2);
+  ADD_HEADER (p1, 4);
+  CHECK_HISTORY (p1, 4,
+                 4, 1, 10, 5);
+  p->RemoveAtEnd (16);
+  CHECK_HISTORY (p, 1, 2);
+
+  p = Create<Packet> (10);
+  ADD_TRAILER (p, 1);
+  ADD_TRAILER (p, 2);
+  ADD_HEADER (p, 5);
+  p1 = p->Copy ();
+  REM_TRAILER (p1, 2);
+  ADD_TRAILER (p1, 4);
+  CHECK_HISTORY (p1, 4,
+                 5, 10, 1, 4);
+  p->RemoveAtStart (16);
+  CHECK_HISTORY (p, 1, 2);
+
   p = Create<Packet> (10);
   ADD_HEADER (p, 1);
   ADD_HEADER (p, 2);
@@ -903,6 +930,130 @@ PacketMetadataTest::DoRun (void)
 }
 
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet Metadata storage unit tests: the storage is only allocated
+ * when the first item is recorded.
+ */
+class PacketMetadataStorageTest : public TestCase {
+public:
+  PacketMetadataStorageTest ();
+  virtual ~PacketMetadataStorageTest ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Checks that the metadata of packets never allocates a storage
+   * when the metadata is disabled, and that the packets still work.
+   */
+  void CheckDisabled (void);
+  /**
+   * Checks that the metadata of empty packets does not allocate a
+   * storage when the metadata is enabled, and that the packets still work.
+   */
+  void CheckEnabled (void);
+};
+
+PacketMetadataStorageTest::PacketMetadataStorageTest ()
+  : TestCase ("Packet metadata storage")
+{
+}
+
+PacketMetadataStorageTest::~PacketMetadataStorageTest ()
+{
+}
+
+void
+PacketMetadataStorageTest::CheckDisabled (void)
+{
+  HistoryHeader<10> header;
+  HistoryTrailer<4> trailer;
+
+  PacketMetadata metadata (1, 100);
+  metadata.AddHeader (header, 10);
+  metadata.AddTrailer (trailer, 4);
+  PacketMetadata copy = metadata;
+  PacketMetadata fragment = metadata.CreateFragment (10, 20);
+  copy.AddAtEnd (fragment);
+  copy.AddPaddingAtEnd (8);
+  metadata.RemoveHeader (header, 10);
+  metadata.RemoveTrailer (trailer, 4);
+  metadata.RemoveAtStart (10);
+  metadata.RemoveAtEnd (10);
+  NS_TEST_ASSERT_MSG_EQ ((metadata.m_data == 0), true, "Storage allocated without metadata");
+  NS_TEST_ASSERT_MSG_EQ ((copy.m_data == 0), true, "Storage allocated by a copy without metadata");
+  NS_TEST_ASSERT_MSG_EQ ((fragment.m_data == 0), true, "Storage allocated by a fragment without metadata");
+  NS_TEST_ASSERT_MSG_EQ (metadata.GetSerializedSize (), 8, "Serialized metadata larger than the uid");
+
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddHeader (header);
+  Ptr<Packet> pCopy = p->Copy ();
+  Ptr<Packet> pFragment = p->CreateFragment (10, 50);
+  NS_TEST_ASSERT_MSG_EQ (pCopy->GetSize (), 110, "Wrong size of the copy");
+  NS_TEST_ASSERT_MSG_EQ (pFragment->GetSize (), 50, "Wrong size of the fragment");
+  NS_TEST_ASSERT_MSG_EQ (pCopy->GetUid (), p->GetUid (), "Wrong uid of the copy");
+  NS_TEST_ASSERT_MSG_EQ (pFragment->GetUid (), p->GetUid (), "Wrong uid of the fragment");
+
+  uint32_t size = p->GetSerializedSize ();
+  std::vector<uint8_t> buffer (size);
+  NS_TEST_ASSERT_MSG_EQ (p->Serialize (&buffer[0], size), 1, "Packet not serialized");
+  Ptr<Packet> deserialized = Create<Packet> (&buffer[0], size, true);
+  NS_TEST_ASSERT_MSG_EQ (deserialized->GetSize (), 110, "Wrong size of the deserialized packet");
+  NS_TEST_ASSERT_MSG_EQ (deserialized->GetUid (), p->GetUid (), "Wrong uid of the deserialized packet");
+  HistoryHeader<10> removed;
+  deserialized->RemoveHeader (removed);
+  NS_TEST_ASSERT_MSG_EQ (removed.IsOk (), true, "Wrong header in the deserialized packet");
+}
+
+void
+PacketMetadataStorageTest::CheckEnabled (void)
+{
+  PacketMetadata empty (2, 0);
+  PacketMetadata copy = empty;
+  PacketMetadata fragment = empty.CreateFragment (0, 0);
+  copy.AddAtEnd (fragment);
+  NS_TEST_ASSERT_MSG_EQ ((empty.m_data == 0), true, "Storage allocated for an empty packet");
+  NS_TEST_ASSERT_MSG_EQ ((copy.m_data == 0), true, "Storage allocated by a copy of an empty packet");
+  NS_TEST_ASSERT_MSG_EQ ((fragment.m_data == 0), true, "Storage allocated by a fragment of an empty packet");
+
+  // The first item allocates the storage, which an empty copy then shares
+  PacketMetadata payload (3, 100);
+  NS_TEST_ASSERT_MSG_EQ ((payload.m_data != 0), true, "No storage for the first item");
+  copy.AddAtEnd (payload);
+  NS_TEST_ASSERT_MSG_EQ ((copy.m_data == payload.m_data), true, "Storage not shared by the empty packet");
+  NS_TEST_ASSERT_MSG_EQ ((empty.m_data == 0), true, "Storage allocated for the original empty packet");
+
+  Ptr<Packet> p = Create<Packet> ();
+  Ptr<Packet> pCopy = p->Copy ();
+  pCopy->AddAtEnd (Create<Packet> (10));
+  NS_TEST_ASSERT_MSG_EQ (p->GetSize (), 0, "The empty packet changed with its copy");
+  NS_TEST_ASSERT_MSG_EQ (pCopy->GetSize (), 10, "Wrong size of the copy");
+  uint32_t size = p->GetSerializedSize ();
+  std::vector<uint8_t> buffer (size);
+  NS_TEST_ASSERT_MSG_EQ (p->Serialize (&buffer[0], size), 1, "Empty packet not serialized");
+  Ptr<Packet> deserialized = Create<Packet> (&buffer[0], size, true);
+  NS_TEST_ASSERT_MSG_EQ (deserialized->GetSize (), 0, "Wrong size of the deserialized packet");
+  NS_TEST_ASSERT_MSG_EQ (deserialized->GetUid (), p->GetUid (), "Wrong uid of the deserialized packet");
+}
+
+void
+PacketMetadataStorageTest::DoRun (void)
+{
+  // The metadata can only be enabled before any packet skipped it, so
+  // restore the state for the other tests
+  bool enable = PacketMetadata::m_enable;
+  bool metadataSkipped = PacketMetadata::m_metadataSkipped;
+
+  PacketMetadata::m_enable = false;
+  CheckDisabled ();
+  PacketMetadata::m_enable = true;
+  CheckEnabled ();
+
+  PacketMetadata::m_enable = enable;
+  PacketMetadata::m_metadataSkipped = metadataSkipped;
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -918,6 +1069,7 @@ public:
 PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
+  AddTestCase (new PacketMetadataStorageTest, TestCase::QUICK);
   AddTestCase (new PacketMetadataTest, TestCase::QUICK);
 }
 
@@ -27,6 +27,7 @@
 #include <iostream>
 #include <iomanip>
 #include <ctime>
+#include <vector>
 
 using namespace ns3;
 
@@ -1146,6 +1147,185 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test header with a single mutable field
+ *
+ * \note Class internal to packet-test-suite.cc
+ */
+class AFieldTestHeader : public Header
+{
+public:
+  AFieldTestHeader () : Header (), m_field (0) {}
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("anon::AFieldTestHeader")
+      .SetParent<Header> ()
+      .SetGroupName ("Network")
+      .HideFromDocumentation ()
+      .AddConstructor<AFieldTestHeader> ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const {
+    return 2;
+  }
+  virtual void Serialize (Buffer::Iterator iter) const {
+    iter.WriteU8 (0xaa);
+    iter.WriteU8 (m_field);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator iter) {
+    iter.ReadU8 ();
+    m_field = iter.ReadU8 ();
+    return 2;
+  }
+  virtual void Print (std::ostream &os) const {
+  }
+  uint8_t m_field; //!< the field rewritten by the tests
+};
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Sets the field of an AFieldTestHeader
+ */
+struct SetField
+{
+  /**
+   * \param value the value to set
+   */
+  SetField (uint8_t value) : m_value (value) {}
+  /**
+   * \param header the header to modify
+   */
+  void operator () (AFieldTestHeader &header) const
+  {
+    header.m_field = m_value;
+  }
+  uint8_t m_value; //!< the value to set
+};
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * In place header rewrite unit tests.
+ */
+class PacketModifyHeaderTest : public TestCase
+{
+public:
+  PacketModifyHeaderTest ();
+private:
+  void DoRun (void);
+};
+
+PacketModifyHeaderTest::PacketModifyHeaderTest ()
+  : TestCase ("Packet::ModifyHeader")
+{
+}
+
+void
+PacketModifyHeaderTest::DoRun (void)
+{
+  Ptr<Packet> p = Create<Packet> (10);
+  AFieldTestHeader field;
+  field.m_field = 1;
+  p->AddHeader (field);
+  p->AddHeader (ATestHeader<3> ());
+  Ptr<Packet> copy = p->Copy ();
+
+  AFieldTestHeader modified;
+  uint32_t size = p->ModifyHeader (modified, SetField (7), 3);
+  NS_TEST_EXPECT_MSG_EQ (size, 2, "Wrong number of bytes rewritten");
+  NS_TEST_EXPECT_MSG_EQ (modified.m_field, 7, "Modifier not applied");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 15, "Packet size changed");
+
+  ATestHeader<3> outer;
+  AFieldTestHeader check;
+  p->RemoveHeader (outer);
+  NS_TEST_EXPECT_MSG_EQ (outer.m_error, false, "Preceding header was corrupted");
+  p->RemoveHeader (check);
+  NS_TEST_EXPECT_MSG_EQ (check.m_field, 7, "Field not rewritten");
+
+  copy->RemoveHeader (outer);
+  copy->RemoveHeader (check);
+  NS_TEST_EXPECT_MSG_EQ (check.m_field, 1, "Rewrite leaked into a copy");
+
+  // A modifier which leaves the bytes untouched is harmless.
+  copy->AddHeader (check);
+  copy->ModifyHeader (modified, SetField (1));
+  copy->RemoveHeader (check);
+  NS_TEST_EXPECT_MSG_EQ (check.m_field, 1, "Unchanged rewrite modified the header");
+  NS_TEST_EXPECT_MSG_EQ (copy->GetSize (), 10, "Unchanged rewrite modified the payload");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet storage pool unit tests.
+ */
+class PacketPoolTest : public TestCase
+{
+public:
+  PacketPoolTest ();
+private:
+  void DoRun (void);
+};
+
+PacketPoolTest::PacketPoolTest ()
+  : TestCase ("Packet storage pool")
+{
+}
+
+void
+PacketPoolTest::DoRun (void)
+{
+  // The number of storages kept by the pool of each thread, in packet.cc
+  const uint32_t poolSize = 4096;
+  const uint32_t extra = 100;
+
+  // Empty the pool, whatever the previous tests left in it
+  std::vector<Ptr<Packet> > drain;
+  for (uint32_t i = 0; i < poolSize; i++)
+    {
+      drain.push_back (Create<Packet> ());
+    }
+
+  std::vector<Ptr<Packet> > released;
+  std::vector<Packet *> storages;
+  for (uint32_t i = 0; i < poolSize + extra; i++)
+    {
+      released.push_back (Create<Packet> (i % 10));
+      storages.push_back (PeekPointer (released.back ()));
+    }
+  // The first poolSize storages fill the pool, the others go to the heap
+  for (uint32_t i = 0; i < released.size (); i++)
+    {
+      released[i] = 0;
+    }
+
+  // The pool hands out the last storage released first
+  std::vector<Ptr<Packet> > recycled;
+  for (uint32_t i = 0; i < poolSize; i++)
+    {
+      recycled.push_back (Create<Packet> (10));
+      NS_TEST_ASSERT_MSG_EQ (PeekPointer (recycled.back ()), storages[poolSize - 1 - i],
+                             "Storage " << i << " not recycled from the pool");
+      NS_TEST_ASSERT_MSG_EQ (recycled.back ()->GetSize (), 10, "Recycled packet not constructed");
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1163,6 +1343,8 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketModifyHeaderTest, TestCase::QUICK);
+  AddTestCase (new PacketPoolTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
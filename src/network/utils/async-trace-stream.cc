@@ -0,0 +1,533 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "async-trace-stream.h"
+#include "ns3/core-config.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <streambuf>
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include <mutex>
+#include <condition_variable>
+#endif
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AsyncTraceStream");
+
+/**
+ * \relates AsyncTraceStream
+ * \anchor GlobalValueTraceWriterAsync
+ * \brief Whether the trace helpers write their files on a background thread.
+ */
+static GlobalValue g_traceWriterAsync = GlobalValue ("TraceWriterAsync",
+                                                     "Write the pcap and ascii trace files of the trace helpers "
+                                                     "on a background thread",
+                                                     BooleanValue (false),
+                                                     MakeBooleanChecker ());
+
+/**
+ * \relates AsyncTraceStream
+ * \brief The size of the buffers of the asynchronous trace files.
+ */
+static GlobalValue g_traceWriterBufferSize = GlobalValue ("TraceWriterBufferSize",
+                                                          "The size in bytes of each buffer of an "
+                                                          "asynchronous trace file",
+                                                          UintegerValue (1 << 20),
+                                                          MakeUintegerChecker<uint32_t> (4096));
+
+/**
+ * \relates AsyncTraceStream
+ * \brief The number of buffers of the asynchronous trace files.
+ */
+static GlobalValue g_traceWriterBuffers = GlobalValue ("TraceWriterBuffers",
+                                                       "The number of buffers of an asynchronous trace file, "
+                                                       "which bounds its memory",
+                                                       UintegerValue (4),
+                                                       MakeUintegerChecker<uint32_t> (2));
+
+/**
+ * \relates AsyncTraceStream
+ * \brief Whether the asynchronous trace files are compressed.
+ */
+static GlobalValue g_traceWriterCompress = GlobalValue ("TraceWriterCompress",
+                                                        "Compress the asynchronous trace files with zlib "
+                                                        "and append .gz to their names",
+                                                        BooleanValue (false),
+                                                        MakeBooleanChecker ());
+
+/**
+ * \ingroup network
+ *
+ * Stream buffer of an AsyncTraceStream: the simulation thread fills the
+ * current buffer of the ring, the writer thread writes the full ones
+ * in order.
+ *
+ * The buffers handed to the writer are m_write, m_write + 1, ...,
+ * m_write + m_full - 1 (modulo the ring size); the buffer being filled
+ * is m_write + m_full.  The simulation thread only takes the lock to
+ * hand over a buffer.
+ */
+class AsyncTraceWriter : public std::streambuf
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param filename The file name.
+   * \param mode The open mode.
+   * \param bufferSize The size of each buffer in bytes.
+   * \param nBuffers The number of buffers in the ring.
+   * \param compress Whether to compress the output with zlib.
+   */
+  AsyncTraceWriter (std::string const &filename, std::ios::openmode mode,
+                    uint32_t bufferSize, uint32_t nBuffers, bool compress);
+  ~AsyncTraceWriter ();
+
+  /** \copydoc AsyncTraceStream::IsOpen */
+  bool IsOpen (void) const;
+  /** \copydoc AsyncTraceStream::GetFileName */
+  std::string GetFileName (void) const;
+  /** \copydoc AsyncTraceStream::Flush */
+  void Flush (void);
+  /** \copydoc AsyncTraceStream::Close */
+  void Close (void);
+
+  /**
+   * Close every open writer; run at exit, since the trace sinks
+   * holding the streams are not always destroyed.
+   */
+  static void CloseAll (void);
+
+protected:
+  virtual int_type overflow (int_type c);
+  virtual int sync (void);
+
+private:
+  /**
+   * Hand the current buffer to the writer and start filling the next
+   * one, waiting for it to be written if every buffer is full.
+   * \returns \c false if the file has failed.
+   */
+  bool HandOver (void);
+  /**
+   * \returns \c true if the file is closed.
+   */
+  bool IsClosed (void) const;
+  /**
+   * \returns The open writers, allocated on first use and never
+   *          destroyed so that CloseAll () can run after the static
+   *          destructors.
+   */
+  static std::list<AsyncTraceWriter *> * GetWriters (void);
+  /**
+   * Wait for the writer to write every full buffer.
+   */
+  void Drain (void);
+  /**
+   * Write a buffer to the file.
+   * \param data The data.
+   * \param size The number of bytes.
+   * \returns \c true on success.
+   */
+  bool WriteFile (const char *data, uint32_t size);
+#ifdef HAVE_PTHREAD_H
+  /**
+   * Body of the writer thread.
+   */
+  void Run (void);
+#endif
+
+  std::string m_fileName;                  //!< Name of the file written.
+  std::FILE *m_file;                       //!< Uncompressed output.
+#ifdef HAVE_ZLIB
+  gzFile m_gzFile;                         //!< Compressed output.
+#endif
+  bool m_ok;                               //!< No error so far, protected by m_mutex.
+  std::vector<std::vector<char> > m_ring;  //!< The buffers.
+  std::vector<uint32_t> m_sizes;           //!< Bytes in each full buffer.
+  uint32_t m_write;                        //!< Next buffer to write.
+  uint32_t m_full;                         //!< Buffers waiting to be written.
+  bool m_stop;                             //!< Writer thread must exit.
+#ifdef HAVE_PTHREAD_H
+  mutable std::mutex m_mutex;              //!< Protects m_ok, m_write, m_full and m_stop.
+  std::condition_variable m_writerCv;      //!< Signals the writer thread.
+  std::condition_variable m_producerCv;    //!< Signals the simulation thread.
+  Ptr<SystemThread> m_thread;              //!< The writer thread.
+#endif
+};
+
+AsyncTraceWriter::AsyncTraceWriter (std::string const &filename, std::ios::openmode mode,
+                                    uint32_t bufferSize, uint32_t nBuffers, bool compress)
+  : m_fileName (filename),
+    m_file (0),
+#ifdef HAVE_ZLIB
+    m_gzFile (0),
+#endif
+    m_ok (false),
+    m_ring (std::max<uint32_t> (nBuffers, 2), std::vector<char> (bufferSize)),
+    m_sizes (m_ring.size (), 0),
+    m_write (0),
+    m_full (0),
+    m_stop (false)
+{
+  NS_LOG_FUNCTION (this << filename << mode << bufferSize << nBuffers << compress);
+  NS_ASSERT (bufferSize > 0);
+  bool append = (mode & std::ios::app) != 0;
+  if (compress)
+    {
+#ifdef HAVE_ZLIB
+      m_fileName += ".gz";
+      m_gzFile = gzopen (m_fileName.c_str (), append ? "ab1" : "wb1");
+      m_ok = m_gzFile != 0;
+#else
+      NS_LOG_WARN ("zlib not available, writing " << filename << " uncompressed");
+      compress = false;
+#endif
+    }
+  if (!compress)
+    {
+      m_file = std::fopen (m_fileName.c_str (), append ? "ab" : "wb");
+      m_ok = m_file != 0;
+    }
+  setp (&m_ring[0][0], &m_ring[0][0] + bufferSize);
+  if (!m_ok)
+    {
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  m_thread = Create<SystemThread> (MakeCallback (&AsyncTraceWriter::Run, this));
+  m_thread->Start ();
+#endif
+  GetWriters ()->push_back (this);
+}
+
+std::list<AsyncTraceWriter *> *
+AsyncTraceWriter::GetWriters (void)
+{
+  static std::list<AsyncTraceWriter *> *writers = 0;
+  if (writers == 0)
+    {
+      writers = new std::list<AsyncTraceWriter *> ();
+      std::atexit (&AsyncTraceWriter::CloseAll);
+    }
+  return writers;
+}
+
+void
+AsyncTraceWriter::CloseAll (void)
+{
+  std::list<AsyncTraceWriter *> *writers = GetWriters ();
+  while (!writers->empty ())
+    {
+      writers->front ()->Close ();
+    }
+}
+
+AsyncTraceWriter::~AsyncTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+bool
+AsyncTraceWriter::IsOpen (void) const
+{
+#ifdef HAVE_PTHREAD_H
+  std::lock_guard<std::mutex> lock (m_mutex);
+#endif
+  return m_ok;
+}
+
+std::string
+AsyncTraceWriter::GetFileName (void) const
+{
+  return m_fileName;
+}
+
+bool
+AsyncTraceWriter::IsClosed (void) const
+{
+#ifdef HAVE_ZLIB
+  return m_file == 0 && m_gzFile == 0;
+#else
+  return m_file == 0;
+#endif
+}
+
+AsyncTraceWriter::int_type
+AsyncTraceWriter::overflow (int_type c)
+{
+  if (IsClosed () || !HandOver ())
+    {
+      return traits_type::eof ();
+    }
+  if (!traits_type::eq_int_type (c, traits_type::eof ()))
+    {
+      *pptr () = traits_type::to_char_type (c);
+      pbump (1);
+    }
+  return traits_type::not_eof (c);
+}
+
+int
+AsyncTraceWriter::sync (void)
+{
+  // std::endl flushes after every line of the ascii traces: keep
+  // batching, the data are written by Flush () and Close ().
+  return IsClosed () ? -1 : 0;
+}
+
+bool
+AsyncTraceWriter::HandOver (void)
+{
+  uint32_t size = pptr () - pbase ();
+#ifdef HAVE_PTHREAD_H
+  std::unique_lock<std::mutex> lock (m_mutex);
+  if (size == 0)
+    {
+      return m_ok;
+    }
+  uint32_t current = (m_write + m_full) % m_ring.size ();
+  m_sizes[current] = size;
+  m_full++;
+  m_writerCv.notify_one ();
+  m_producerCv.wait (lock, [this] { return m_full < m_ring.size (); });
+  char *begin = &m_ring[(m_write + m_full) % m_ring.size ()][0];
+#else
+  if (size == 0)
+    {
+      return m_ok;
+    }
+  m_ok = WriteFile (pbase (), size) && m_ok;
+  char *begin = &m_ring[0][0];
+#endif
+  setp (begin, begin + m_ring[0].size ());
+  return m_ok;
+}
+
+void
+AsyncTraceWriter::Drain (void)
+{
+#ifdef HAVE_PTHREAD_H
+  std::unique_lock<std::mutex> lock (m_mutex);
+  m_producerCv.wait (lock, [this] { return m_full == 0; });
+#endif
+}
+
+void
+AsyncTraceWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (IsClosed ())
+    {
+      return;
+    }
+  HandOver ();
+  Drain ();
+  if (m_file != 0)
+    {
+      std::fflush (m_file);
+    }
+#ifdef HAVE_ZLIB
+  if (m_gzFile != 0)
+    {
+      gzflush (m_gzFile, Z_SYNC_FLUSH);
+    }
+#endif
+}
+
+void
+AsyncTraceWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (IsClosed ())
+    {
+      return;
+    }
+  GetWriters ()->remove (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_thread)
+    {
+      HandOver ();
+      {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_stop = true;
+        m_writerCv.notify_one ();
+      }
+      m_thread->Join ();
+      m_thread = 0;
+    }
+#else
+  HandOver ();
+#endif
+  setp (0, 0);
+  if (m_file != 0)
+    {
+      m_ok = std::fclose (m_file) == 0 && m_ok;
+      m_file = 0;
+    }
+#ifdef HAVE_ZLIB
+  if (m_gzFile != 0)
+    {
+      m_ok = gzclose (m_gzFile) == Z_OK && m_ok;
+      m_gzFile = 0;
+    }
+#endif
+}
+
+bool
+AsyncTraceWriter::WriteFile (const char *data, uint32_t size)
+{
+  bool ok = false;
+  if (m_file != 0)
+    {
+      ok = std::fwrite (data, 1, size, m_file) == size;
+    }
+#ifdef HAVE_ZLIB
+  else if (m_gzFile != 0)
+    {
+      ok = gzwrite (m_gzFile, data, size) == static_cast<int> (size);
+    }
+#endif
+  return ok;
+}
+
+#ifdef HAVE_PTHREAD_H
+void
+AsyncTraceWriter::Run (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      m_writerCv.wait (lock, [this] { return m_full > 0 || m_stop; });
+      if (m_full == 0)
+        {
+          break;
+        }
+      uint32_t index = m_write;
+      lock.unlock ();
+      bool ok = WriteFile (&m_ring[index][0], m_sizes[index]);
+      lock.lock ();
+      m_ok = ok && m_ok;
+      m_write = (m_write + 1) % m_ring.size ();
+      m_full--;
+      m_producerCv.notify_one ();
+    }
+}
+#endif
+
+
+AsyncTraceStream::AsyncTraceStream (std::string const &filename, std::ios::openmode mode,
+                                    uint32_t bufferSize, uint32_t nBuffers, bool compress)
+  : std::ostream (0),
+    m_writer (new AsyncTraceWriter (filename, mode, bufferSize, nBuffers, compress))
+{
+  NS_LOG_FUNCTION (this << filename << mode << bufferSize << nBuffers << compress);
+  rdbuf (m_writer);
+  if (!m_writer->IsOpen ())
+    {
+      setstate (std::ios::failbit);
+    }
+}
+
+AsyncTraceStream::~AsyncTraceStream ()
+{
+  NS_LOG_FUNCTION (this);
+  rdbuf (0);
+  delete m_writer;
+  m_writer = 0;
+}
+
+AsyncTraceStream *
+AsyncTraceStream::Create (std::string const &filename, std::ios::openmode mode)
+{
+  NS_LOG_FUNCTION (filename << mode);
+  UintegerValue bufferSize;
+  g_traceWriterBufferSize.GetValue (bufferSize);
+  UintegerValue nBuffers;
+  g_traceWriterBuffers.GetValue (nBuffers);
+  BooleanValue compress;
+  g_traceWriterCompress.GetValue (compress);
+  return new AsyncTraceStream (filename, mode, bufferSize.Get (), nBuffers.Get (), compress.Get ());
+}
+
+bool
+AsyncTraceStream::IsEnabled (void)
+{
+  BooleanValue async;
+  g_traceWriterAsync.GetValue (async);
+  return async.Get ();
+}
+
+bool
+AsyncTraceStream::IsCompressionSupported (void)
+{
+#ifdef HAVE_ZLIB
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool
+AsyncTraceStream::IsOpen (void) const
+{
+  return m_writer->IsOpen ();
+}
+
+std::string
+AsyncTraceStream::GetFileName (void) const
+{
+  return m_writer->GetFileName ();
+}
+
+void
+AsyncTraceStream::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_writer->Flush ();
+  if (!m_writer->IsOpen ())
+    {
+      setstate (std::ios::badbit);
+    }
+}
+
+void
+AsyncTraceStream::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_writer->Close ();
+  if (!m_writer->IsOpen ())
+    {
+      setstate (std::ios::badbit);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ASYNC_TRACE_STREAM_H
+#define ASYNC_TRACE_STREAM_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+class AsyncTraceWriter;
+
+/**
+ * \ingroup network
+ *
+ * \brief An output file stream written by a background thread.
+ *
+ * The stream serializes its output into a ring of large buffers; a
+ * full buffer is handed to a background thread which writes it to the
+ * file, optionally compressed with zlib, while the simulation keeps
+ * filling the next buffer.  Memory is bounded by the ring: when every
+ * buffer is waiting to be written, the simulation blocks until the
+ * writer thread frees one.
+ *
+ * Flushing the stream, e.g. with std::endl, does not write anything:
+ * the data reach the file when a buffer fills up, on Flush (), on
+ * Close () and when the program exits.  In builds without threads the
+ * buffers are written on the calling thread.
+ *
+ * The trace helpers (PcapHelper::CreateFile and
+ * AsciiTraceHelper::CreateFileStream) use this stream instead of a
+ * std::fstream when the global value \c TraceWriterAsync is \c true,
+ * e.g. with
+ * \verbatim
+   NS_GLOBAL_VALUE="TraceWriterAsync=true" ./waf --run ...
+   \endverbatim
+ * The global values \c TraceWriterBufferSize, \c TraceWriterBuffers and
+ * \c TraceWriterCompress configure the streams created by the helpers.
+ */
+class AsyncTraceStream : public std::ostream
+{
+public:
+  /**
+   * Open a file for writing.
+   *
+   * \param filename The file name; \c ".gz" is appended when compressing.
+   * \param mode The open mode; only std::ios::app and std::ios::binary
+   *        are meaningful.
+   * \param bufferSize The size of each buffer in bytes.
+   * \param nBuffers The number of buffers in the ring, at least 2.
+   * \param compress Whether to compress the output with zlib.
+   */
+  AsyncTraceStream (std::string const &filename, std::ios::openmode mode,
+                    uint32_t bufferSize, uint32_t nBuffers, bool compress);
+  /**
+   * Write the pending data and close the file.
+   */
+  virtual ~AsyncTraceStream ();
+
+  /**
+   * Open a file configured by the \c TraceWriter* global values.
+   *
+   * \param filename The file name.
+   * \param mode The open mode.
+   * \returns A new stream, owned by the caller.
+   */
+  static AsyncTraceStream * Create (std::string const &filename, std::ios::openmode mode);
+  /**
+   * \returns \c true if the trace helpers should use asynchronous streams,
+   *          as set by the \c TraceWriterAsync global value.
+   */
+  static bool IsEnabled (void);
+  /**
+   * \returns \c true if the output can be compressed in this build.
+   */
+  static bool IsCompressionSupported (void);
+
+  /**
+   * \returns \c true if the file was opened successfully.
+   */
+  bool IsOpen (void) const;
+  /**
+   * \returns The name of the file actually written.
+   */
+  std::string GetFileName (void) const;
+  /**
+   * Write all the data streamed so far to the file and wait for the
+   * writer thread to finish.
+   */
+  void Flush (void);
+  /**
+   * Write the pending data, stop the writer thread and close the file.
+   */
+  void Close (void);
+
+private:
+  AsyncTraceWriter *m_writer; //!< The stream buffer and its writer thread.
+};
+
+} // namespace ns3
+
+#endif /* ASYNC_TRACE_STREAM_H */
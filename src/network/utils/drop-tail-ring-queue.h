@@ -0,0 +1,268 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DROPTAIL_RING_H
+#define DROPTAIL_RING_H
+
+#include "ns3/queue.h"
+#include <vector>
+#include <algorithm>
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ *
+ * \brief A FIFO packet queue that drops tail-end packets on overflow,
+ * storing the packets in a ring buffer
+ *
+ * This queue behaves like DropTailQueue and fires the same trace sources,
+ * but keeps its packets in a contiguous ring buffer instead of a list, so
+ * that enqueue and dequeue do not allocate memory.  When the maximum size
+ * is expressed in packets, the ring buffer is allocated with that capacity
+ * by the first enqueue (or the first enqueue after the maximum size grew);
+ * when it is expressed in bytes, the capacity doubles whenever the ring
+ * buffer is full.
+ */
+template <typename Item>
+class DropTailRingQueue : public Queue<Item>
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief DropTailRingQueue Constructor
+   *
+   * Creates a droptail queue with a maximum size of 100 packets by default
+   */
+  DropTailRingQueue ();
+
+  virtual ~DropTailRingQueue ();
+
+  virtual bool Enqueue (Ptr<Item> item);
+  virtual Ptr<Item> Dequeue (void);
+  virtual Ptr<Item> Remove (void);
+  virtual Ptr<const Item> Peek (void) const;
+
+  /**
+   * \return the number of items the ring buffer can hold without growing
+   */
+  uint32_t GetCapacity (void) const;
+
+private:
+  using Queue<Item>::DropBeforeEnqueue;
+  using Queue<Item>::DropAfterDequeue;
+  using Queue<Item>::PacketEnqueued;
+  using Queue<Item>::PacketDequeued;
+
+  /**
+   * \brief Move the items to a ring buffer of the given capacity
+   * \param capacity the new capacity, not less than the number of items
+   */
+  void Reserve (uint32_t capacity);
+
+  /**
+   * \brief Take the item at the head of the ring buffer
+   * \return the item, or 0 if the queue is empty
+   */
+  Ptr<Item> PopFront (void);
+
+  std::vector<Ptr<Item> > m_ring; //!< the ring buffer
+  uint32_t m_head;                //!< the index of the first item
+
+  NS_LOG_TEMPLATE_DECLARE;     //!< redefinition of the log component
+};
+
+
+/**
+ * Implementation of the templates declared above.
+ */
+
+template <typename Item>
+TypeId
+DropTailRingQueue<Item>::GetTypeId (void)
+{
+  static TypeId tid = TypeId (("ns3::DropTailRingQueue<" + GetTypeParamName<DropTailRingQueue<Item> > () + ">").c_str ())
+    .SetParent<Queue<Item> > ()
+    .SetGroupName ("Network")
+    .template AddConstructor<DropTailRingQueue<Item> > ()
+    .AddAttribute ("MaxSize",
+                   "The max queue size",
+                   QueueSizeValue (QueueSize ("100p")),
+                   MakeQueueSizeAccessor (&QueueBase::SetMaxSize,
+                                          &QueueBase::GetMaxSize),
+                   MakeQueueSizeChecker ())
+  ;
+  return tid;
+}
+
+template <typename Item>
+DropTailRingQueue<Item>::DropTailRingQueue () :
+  Queue<Item> (),
+  m_head (0),
+  NS_LOG_TEMPLATE_DEFINE ("DropTailRingQueue")
+{
+  NS_LOG_FUNCTION (this);
+}
+
+template <typename Item>
+DropTailRingQueue<Item>::~DropTailRingQueue ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+template <typename Item>
+uint32_t
+DropTailRingQueue<Item>::GetCapacity (void) const
+{
+  return m_ring.size ();
+}
+
+template <typename Item>
+void
+DropTailRingQueue<Item>::Reserve (uint32_t capacity)
+{
+  NS_LOG_FUNCTION (this << capacity);
+
+  uint32_t n = this->GetNPackets ();
+  NS_ASSERT (capacity >= n);
+  std::vector<Ptr<Item> > ring (capacity);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      ring[i] = m_ring[(m_head + i) % m_ring.size ()];
+    }
+  m_ring.swap (ring);
+  m_head = 0;
+}
+
+template <typename Item>
+bool
+DropTailRingQueue<Item>::Enqueue (Ptr<Item> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  if (this->GetCurrentSize () + item > this->GetMaxSize ())
+    {
+      NS_LOG_LOGIC ("Queue full -- dropping pkt");
+      DropBeforeEnqueue (item);
+      return false;
+    }
+
+  uint32_t n = this->GetNPackets ();
+  if (n == m_ring.size ())
+    {
+      QueueSize maxSize = this->GetMaxSize ();
+      Reserve (maxSize.GetUnit () == QueueSizeUnit::PACKETS ? maxSize.GetValue ()
+                                                           : std::max<uint32_t> (2 * n, 16));
+    }
+
+  uint32_t tail = m_head + n;
+  if (tail >= m_ring.size ())
+    {
+      tail -= m_ring.size ();
+    }
+  m_ring[tail] = item;
+  PacketEnqueued (item);
+
+  return true;
+}
+
+template <typename Item>
+Ptr<Item>
+DropTailRingQueue<Item>::PopFront (void)
+{
+  if (this->IsEmpty ())
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  Ptr<Item> item = m_ring[m_head];
+  m_ring[m_head] = 0;
+  if (++m_head == m_ring.size ())
+    {
+      m_head = 0;
+    }
+  return item;
+}
+
+template <typename Item>
+Ptr<Item>
+DropTailRingQueue<Item>::Dequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<Item> item = PopFront ();
+
+  if (item != 0)
+    {
+      PacketDequeued (item);
+    }
+
+  NS_LOG_LOGIC ("Popped " << item);
+
+  return item;
+}
+
+template <typename Item>
+Ptr<Item>
+DropTailRingQueue<Item>::Remove (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<Item> item = PopFront ();
+
+  if (item != 0)
+    {
+      // packets are first dequeued and then dropped
+      PacketDequeued (item);
+      DropAfterDequeue (item);
+    }
+
+  NS_LOG_LOGIC ("Removed " << item);
+
+  return item;
+}
+
+template <typename Item>
+Ptr<const Item>
+DropTailRingQueue<Item>::Peek (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (this->IsEmpty ())
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  return m_ring[m_head];
+}
+
+// The following explicit template instantiation declarations prevent all the
+// translation units including this header file to implicitly instantiate the
+// DropTailRingQueue classes. The unique instances of these classes are
+// explicitly created through the NS_OBJECT_TEMPLATE_CLASS_DEFINE macros
+// included in drop-tail-ring-queue.cc
+extern template class DropTailRingQueue<Packet>;
+extern template class DropTailRingQueue<QueueDiscItem>;
+extern template class DropTailRingQueue<SeanetAddress>;
+} // namespace ns3
+
+#endif /* DROPTAIL_RING_H */
@@ -20,6 +20,7 @@
 #include "ns3/log.h"
 #include "ns3/fatal-impl.h"
 #include "ns3/abort.h"
+#include "async-trace-stream.h"
 #include <fstream>
 
 namespace ns3 {
@@ -46,6 +47,15 @@ OutputStreamWrapper::OutputStreamWrapper (std::ostream* os)
   NS_ABORT_MSG_UNLESS (m_ostream->good (), "Output stream is not valid for writing.");
 }
 
+OutputStreamWrapper::OutputStreamWrapper (AsyncTraceStream* os)
+  : m_ostream (os), m_destroyable (true)
+{
+  NS_LOG_FUNCTION (this << os);
+  FatalImpl::RegisterStream (m_ostream);
+  NS_ABORT_MSG_UNLESS (os->IsOpen (), "AsciiTraceHelper::CreateFileStream():  " <<
+                       "Unable to Open " << os->GetFileName ());
+}
+
 OutputStreamWrapper::~OutputStreamWrapper ()
 {
   NS_LOG_FUNCTION (this);
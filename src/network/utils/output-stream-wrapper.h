@@ -26,6 +26,8 @@
 
 namespace ns3 {
 
+class AsyncTraceStream;
+
 /**
  * @brief A class encapsulating an output stream.
  *
@@ -81,6 +83,11 @@ public:
    * \param os output stream
    */
   OutputStreamWrapper (std::ostream* os);
+  /**
+   * Constructor
+   * \param os asynchronous file stream, owned by the wrapper from now on
+   */
+  OutputStreamWrapper (AsyncTraceStream* os);
   ~OutputStreamWrapper ();
 
   /**
@@ -22,6 +22,7 @@
 #include "ns3/buffer.h"
 #include "ns3/header.h"
 #include "pcap-file-wrapper.h"
+#include "async-trace-stream.h"
 
 namespace ns3 {
 
@@ -96,6 +97,14 @@ PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
   m_file.Open (filename, mode);
 }
 
+void
+PcapFileWrapper::OpenAsync (std::string const &filename, std::ios::openmode mode)
+{
+  NS_LOG_FUNCTION (this << filename << mode);
+  NS_ASSERT ((mode & std::ios::in) == 0);
+  m_file.OpenAsync (AsyncTraceStream::Create (filename, mode | std::ios::binary));
+}
+
 void
 PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrection)
 {
@@ -77,6 +77,15 @@ public:
    */
   void Open (std::string const &filename, std::ios::openmode mode);
 
+  /**
+   * Create a pcap file written on a background thread by an
+   * AsyncTraceStream configured by the \c TraceWriter* global values.
+   *
+   * \param filename String containing the name of the file.
+   * \param mode The access mode for the file, without std::ios::in.
+   */
+  void OpenAsync (std::string const &filename, std::ios::openmode mode);
+
   /**
    * Close the underlying pcap file.
    */
@@ -30,6 +30,7 @@ namespace ns3 {
 
 class Packet;
 class Header;
+class AsyncTraceStream;
 
 
 /**
@@ -80,6 +81,16 @@ public:
    */
   void Open (std::string const &filename, std::ios::openmode mode);
 
+  /**
+   * Write the file through an AsyncTraceStream instead of opening it.
+   *
+   * The file is written on a background thread and can only be
+   * written: Init() must be called next, then the Write() methods.
+   *
+   * \param stream The opened stream, now owned by this PcapFile.
+   */
+  void OpenAsync (AsyncTraceStream *stream);
+
   /**
    * Close the underlying file.
    */
@@ -368,6 +379,8 @@ private:
 
   std::string    m_filename;    //!< file name
   std::fstream   m_file;        //!< file stream
+  AsyncTraceStream *m_async;    //!< asynchronous output stream, if any
+  std::ostream   *m_stream;     //!< output stream, m_file or m_async
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
@@ -418,6 +418,25 @@ protected:
    */
   void DropAfterDequeue (Ptr<Item> item);
 
+  /**
+   * \brief Update the statistics and fire the trace after an enqueue
+   * \param item item that was enqueued
+   *
+   * DoEnqueue calls this method; subclasses storing the items by themselves
+   * must call it when they store an item.
+   */
+  void PacketEnqueued (Ptr<Item> item);
+
+  /**
+   * \brief Update the statistics and fire the trace after a dequeue
+   * \param item item that was dequeued
+   *
+   * DoDequeue and DoRemove call this method; subclasses storing the items by
+   * themselves must call it when they take an item out, including an item
+   * about to be dropped after dequeue.
+   */
+  void PacketDequeued (Ptr<Item> item);
+
 private:
   std::list<Ptr<Item> > m_packets;          //!< the items in the queue
   NS_LOG_TEMPLATE_DECLARE;                  //!< the log component
@@ -491,7 +510,15 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
     }
 
   m_packets.insert (pos, item);
+  PacketEnqueued (item);
+
+  return true;
+}
 
+template <typename Item>
+void
+Queue<Item>::PacketEnqueued (Ptr<Item> item)
+{
   uint32_t size = item->GetSize ();
   m_nBytes += size;
   m_nTotalReceivedBytes += size;
@@ -501,8 +528,20 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
 
   NS_LOG_LOGIC ("m_traceEnqueue (p)");
   m_traceEnqueue (item);
+}
 
-  return true;
+template <typename Item>
+void
+Queue<Item>::PacketDequeued (Ptr<Item> item)
+{
+  NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
+  NS_ASSERT (m_nPackets.Get () > 0);
+
+  m_nBytes -= item->GetSize ();
+  m_nPackets--;
+
+  NS_LOG_LOGIC ("m_traceDequeue (p)");
+  m_traceDequeue (item);
 }
 
 template <typename Item>
@@ -522,14 +561,7 @@ Queue<Item>::DoDequeue (ConstIterator pos)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
-
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
-
-      NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
+      PacketDequeued (item);
     }
   return item;
 }
@@ -551,16 +583,8 @@ Queue<Item>::DoRemove (ConstIterator pos)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
-
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
-
       // packets are first dequeued and then dropped
-      NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
-
+      PacketDequeued (item);
       DropAfterDequeue (item);
     }
   return item;
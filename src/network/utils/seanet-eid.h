@@ -22,6 +22,14 @@ namespace ns3 {
          * \returns true if the operands are equal.
          */
         friend bool operator == (const SeanetEID &a, const  SeanetEID &b);
+          /**
+         * \brief Less than operator, in the byte order of the EIDs.
+         *
+         * \param a the first operand.
+         * \param b the second operand.
+         * \returns true if the first operand is less than the second.
+         */
+        friend bool operator < (const SeanetEID &a, const  SeanetEID &b);
         private:
         uint8_t eidbuf[EIDSIZE];
             
@@ -47,5 +55,13 @@ namespace ns3 {
         }
         return true;
     }
+    inline bool operator < (const SeanetEID &a, const  SeanetEID &b)
+    {
+        uint8_t bufa[EIDSIZE];
+        uint8_t bufb[EIDSIZE];
+        a.getSeanetEID(bufa);
+        b.getSeanetEID(bufb);
+        return memcmp(bufa,bufb,EIDSIZE) < 0;
+    }
 }
 #endif
\ No newline at end of file
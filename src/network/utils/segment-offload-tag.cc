@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "segment-offload-tag.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SegmentOffloadTag");
+
+NS_OBJECT_ENSURE_REGISTERED (SegmentOffloadTag);
+
+TypeId
+SegmentOffloadTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::SegmentOffloadTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Network")
+    .AddConstructor<SegmentOffloadTag> ()
+  ;
+  return tid;
+}
+TypeId
+SegmentOffloadTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+uint32_t
+SegmentOffloadTag::GetSerializedSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return 8;
+}
+void
+SegmentOffloadTag::Serialize (TagBuffer buf) const
+{
+  NS_LOG_FUNCTION (this << &buf);
+  buf.WriteU32 (m_payloadSize);
+  buf.WriteU32 (m_segmentSize);
+}
+void
+SegmentOffloadTag::Deserialize (TagBuffer buf)
+{
+  NS_LOG_FUNCTION (this << &buf);
+  m_payloadSize = buf.ReadU32 ();
+  m_segmentSize = buf.ReadU32 ();
+}
+void
+SegmentOffloadTag::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  os << "PayloadSize=" << m_payloadSize << " SegmentSize=" << m_segmentSize;
+}
+SegmentOffloadTag::SegmentOffloadTag ()
+  : Tag (),
+    m_payloadSize (0),
+    m_segmentSize (1)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+SegmentOffloadTag::SegmentOffloadTag (uint32_t payloadSize, uint32_t segmentSize)
+  : Tag (),
+    m_payloadSize (payloadSize),
+    m_segmentSize (segmentSize)
+{
+  NS_LOG_FUNCTION (this << payloadSize << segmentSize);
+  NS_ASSERT (segmentSize > 0);
+}
+
+void
+SegmentOffloadTag::SetPayloadSize (uint32_t payloadSize)
+{
+  NS_LOG_FUNCTION (this << payloadSize);
+  m_payloadSize = payloadSize;
+}
+uint32_t
+SegmentOffloadTag::GetPayloadSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_payloadSize;
+}
+
+void
+SegmentOffloadTag::SetSegmentSize (uint32_t segmentSize)
+{
+  NS_LOG_FUNCTION (this << segmentSize);
+  NS_ASSERT (segmentSize > 0);
+  m_segmentSize = segmentSize;
+}
+uint32_t
+SegmentOffloadTag::GetSegmentSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_segmentSize;
+}
+
+uint32_t
+SegmentOffloadTag::GetSegments (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_payloadSize == 0)
+    {
+      return 1;
+    }
+  return (m_payloadSize + m_segmentSize - 1) / m_segmentSize;
+}
+
+uint32_t
+SegmentOffloadTag::GetWireSize (uint32_t packetSize) const
+{
+  NS_LOG_FUNCTION (this << packetSize);
+  NS_ASSERT (packetSize >= m_payloadSize);
+  return packetSize + (GetSegments () - 1) * (packetSize - m_payloadSize);
+}
+
+uint32_t
+SegmentOffloadTag::GetMaxWirePacketSize (uint32_t packetSize) const
+{
+  NS_LOG_FUNCTION (this << packetSize);
+  NS_ASSERT (packetSize >= m_payloadSize);
+  if (m_payloadSize <= m_segmentSize)
+    {
+      return packetSize;
+    }
+  return packetSize - m_payloadSize + m_segmentSize;
+}
+
+} // namespace ns3
@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef SEGMENT_OFFLOAD_TAG_H
+#define SEGMENT_OFFLOAD_TAG_H
+
+#include "ns3/tag.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Mark a packet as a super-segment of a large segment offload.
+ *
+ * A transport protocol that emits a payload of several segments in one
+ * packet attaches this tag to it. A device that supports segment offload
+ * (see NetDevice::SupportsSegmentOffload) accounts for the packet as the
+ * train of wire packets it stands for: each of them carries at most
+ * the segment size of the payload, plus a copy of all the headers of the
+ * packet.
+ */
+class SegmentOffloadTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer buf) const;
+  virtual void Deserialize (TagBuffer buf);
+  virtual void Print (std::ostream &os) const;
+  SegmentOffloadTag ();
+
+  /**
+   * Constructs a SegmentOffloadTag
+   *
+   * \param payloadSize the size of the payload, without the headers
+   * \param segmentSize the maximum size of the payload of a wire packet
+   */
+  SegmentOffloadTag (uint32_t payloadSize, uint32_t segmentSize);
+  /**
+   * \param payloadSize the size of the payload, without the headers
+   */
+  void SetPayloadSize (uint32_t payloadSize);
+  /**
+   * \returns the size of the payload, without the headers
+   */
+  uint32_t GetPayloadSize (void) const;
+  /**
+   * \param segmentSize the maximum size of the payload of a wire packet
+   */
+  void SetSegmentSize (uint32_t segmentSize);
+  /**
+   * \returns the maximum size of the payload of a wire packet
+   */
+  uint32_t GetSegmentSize (void) const;
+  /**
+   * \returns the number of wire packets
+   */
+  uint32_t GetSegments (void) const;
+  /**
+   * \param packetSize the size of the tagged packet, headers included
+   * \returns the total size of the wire packets, with the headers
+   *          repeated in each of them
+   */
+  uint32_t GetWireSize (uint32_t packetSize) const;
+  /**
+   * \param packetSize the size of the tagged packet, headers included
+   * \returns the size of the largest wire packet
+   */
+  uint32_t GetMaxWirePacketSize (uint32_t packetSize) const;
+private:
+  uint32_t m_payloadSize; //!< Size of the payload
+  uint32_t m_segmentSize; //!< Maximum size of the payload of a wire packet
+};
+
+} // namespace ns3
+
+#endif /* SEGMENT_OFFLOAD_TAG_H */
@@ -689,13 +689,12 @@ Ipv4NixVectorRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
           NS_LOG_LOGIC ("Local delivery to " << header.GetDestination ());
           Ptr<Packet> packetCopy = p->Copy ();
           UdpHeader uh;
-          packetCopy->RemoveHeader(uh);
           SeanetHeader_ sh;
-          packetCopy->RemoveHeader(sh);
-          sh.Setdst(IS_DST);
-          sh.SetInterface(iif);
-          packetCopy->AddHeader(sh);
-          packetCopy->AddHeader(uh);
+          packetCopy->ModifyHeader (sh, [iif] (SeanetHeader_ &h)
+                                  {
+                                    h.Setdst (IS_DST);
+                                    h.SetInterface (iif);
+                                  }, uh.GetSerializedSize ());
           lcb (packetCopy, header, iif);
           return true;
          }
@@ -712,13 +711,12 @@ Ipv4NixVectorRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
        NS_LOG_INFO("isSeanet");
         Ptr<Packet> packetCopy = p->Copy ();
         UdpHeader uh;
-        packetCopy->RemoveHeader(uh);
         SeanetHeader_ sh;
-        packetCopy->RemoveHeader(sh);
-        sh.Setdst(NOT_DST);
-        sh.SetInterface(iif);
-        packetCopy->AddHeader(sh);
-        packetCopy->AddHeader(uh);
+        packetCopy->ModifyHeader (sh, [iif] (SeanetHeader_ &h)
+                                  {
+                                    h.Setdst (NOT_DST);
+                                    h.SetInterface (iif);
+                                  }, uh.GetSerializedSize ());
         lcb (packetCopy, header, iif);
      }
 
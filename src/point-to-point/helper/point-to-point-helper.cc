@@ -23,6 +23,7 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-fluid-background.h"
 #include "ns3/queue.h"
 #include "ns3/net-device-queue-interface.h"
 #include "ns3/config.h"
@@ -47,6 +48,7 @@ PointToPointHelper::PointToPointHelper ()
   m_queueFactory.SetTypeId ("ns3::DropTailQueue<Packet>");
   m_deviceFactory.SetTypeId ("ns3::PointToPointNetDevice");
   m_channelFactory.SetTypeId ("ns3::PointToPointChannel");
+  m_fluidFactory.SetTypeId ("ns3::PointToPointFluidBackground");
 }
 
 void 
@@ -77,6 +79,33 @@ PointToPointHelper::SetChannelAttribute (std::string n1, const AttributeValue &v
   m_channelFactory.Set (n1, v1);
 }
 
+void 
+PointToPointHelper::SetFluidBackgroundAttribute (std::string n1, const AttributeValue &v1)
+{
+  m_fluidFactory.Set (n1, v1);
+}
+
+void
+PointToPointHelper::AddFluidFlow (NetDeviceContainer devices, DataRate rate, Time start, Time stop)
+{
+  NS_LOG_FUNCTION (this << rate << start << stop);
+  for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+      Ptr<PointToPointNetDevice> device = DynamicCast<PointToPointNetDevice> (*i);
+      if (device == 0)
+        {
+          continue;
+        }
+      Ptr<PointToPointFluidBackground> background = device->GetFluidBackground ();
+      if (background == 0)
+        {
+          background = m_fluidFactory.Create<PointToPointFluidBackground> ();
+          device->SetFluidBackground (background);
+        }
+      background->AddFlow (rate, start, stop);
+    }
+}
+
 void 
 PointToPointHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename)
 {
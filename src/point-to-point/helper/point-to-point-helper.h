@@ -25,6 +25,8 @@
 #include "ns3/object-factory.h"
 #include "ns3/net-device-container.h"
 #include "ns3/node-container.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
 
 #include "ns3/trace-helper.h"
 
@@ -99,6 +101,33 @@ public:
    */
   void SetChannelAttribute (std::string name, const AttributeValue &value);
 
+  /**
+   * Set an attribute value to be propagated to each
+   * PointToPointFluidBackground created by the helper.
+   *
+   * \param name the name of the attribute to set
+   * \param value the value of the attribute to set
+   *
+   * Set these attributes on each ns3::PointToPointFluidBackground created
+   * by PointToPointHelper::AddFluidFlow
+   */
+  void SetFluidBackgroundAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * \param devices the transmitting devices along the path of the flow
+   * \param rate the rate of the flow
+   * \param start the time the flow starts
+   * \param stop the time the flow stops
+   *
+   * Declare a background flow carried as a fluid by the links of the
+   * devices in the container, in their transmit direction.  A
+   * ns3::PointToPointFluidBackground is attached to each device without
+   * one, with the attributes configured by
+   * PointToPointHelper::SetFluidBackgroundAttribute.  Devices other than
+   * ns3::PointToPointNetDevice are ignored.
+   */
+  void AddFluidFlow (NetDeviceContainer devices, DataRate rate, Time start, Time stop);
+
   /**
    * \param c a set of nodes
    * \return a NetDeviceContainer for nodes
@@ -184,6 +213,7 @@ private:
   ObjectFactory m_queueFactory;         //!< Queue Factory
   ObjectFactory m_channelFactory;       //!< Channel Factory
   ObjectFactory m_deviceFactory;        //!< Device Factory
+  ObjectFactory m_fluidFactory;         //!< Fluid background Factory
 };
 
 } // namespace ns3
@@ -106,6 +106,52 @@ PointToPointChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointChannel::TransmitTrain (
+  Ptr<const PointToPointTrain> train,
+  Ptr<PointToPointNetDevice> src)
+{
+  NS_LOG_FUNCTION (this << train << src);
+  NS_LOG_LOGIC ("Train of " << train->GetN () << " packets");
+
+  NS_ASSERT (m_link[0].m_state != INITIALIZING);
+  NS_ASSERT (m_link[1].m_state != INITIALIZING);
+
+  uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+  Ptr<PointToPointNetDevice> dst = m_link[wire].m_dst;
+
+  // The receiver walks through the train one packet after the other
+  Ptr<PointToPointTrain> copy = Create<PointToPointTrain> ();
+  for (std::size_t i = 0; i < train->GetN (); i++)
+    {
+      copy->Add (train->GetPacket (i)->Copy (), train->GetTxStart (i), train->GetTxTime (i));
+    }
+  Simulator::ScheduleWithContext (dst->GetNode ()->GetId (),
+                                  copy->GetTxEnd (0) + m_delay, &PointToPointNetDevice::ReceiveTrain,
+                                  dst, copy, 0);
+
+  // Call the tx anim callback on the net device
+  m_txrxPointToPoint (train->GetPacket (0), src, dst, train->GetTxTime (0),
+                      train->GetTxTime (0) + m_delay);
+  if (!m_txrxPointToPoint.IsEmpty ())
+    {
+      for (std::size_t i = 1; i < train->GetN (); i++)
+        {
+          Simulator::Schedule (train->GetTxStart (i), &PointToPointChannel::TrainTxAnimation,
+                               this, train->GetPacket (i), src, dst, train->GetTxTime (i));
+        }
+    }
+  return true;
+}
+
+void
+PointToPointChannel::TrainTxAnimation (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src,
+                                       Ptr<PointToPointNetDevice> dst, Time txTime)
+{
+  NS_LOG_FUNCTION (this << p << src << dst << txTime);
+  m_txrxPointToPoint (p, src, dst, txTime, txTime + m_delay);
+}
+
 std::size_t
 PointToPointChannel::GetNDevices (void) const
 {
@@ -29,6 +29,7 @@
 namespace ns3 {
 
 class PointToPointNetDevice;
+class PointToPointTrain;
 class Packet;
 
 /**
@@ -80,6 +81,19 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src, Time txTime);
 
+  /**
+   * \brief Transmit a train of back-to-back packets over this channel
+   *
+   * The destination device receives each packet of the train when its
+   * last bit arrives, as if it had been sent with TransmitStart.
+   *
+   * \param train The packets to transmit and their transmission times,
+   *        relative to now
+   * \param src Source PointToPointNetDevice
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitTrain (Ptr<const PointToPointTrain> train, Ptr<PointToPointNetDevice> src);
+
   /**
    * \brief Get number of devices on this channel
    * \returns number of devices on this channel
@@ -146,6 +160,18 @@ protected:
      Time duration, Time lastBitTime);
                     
 private:
+  /**
+   * Fire the animation trace for a packet of a train when its
+   * transmission starts.
+   *
+   * \param p The packet.
+   * \param src The transmitting device.
+   * \param dst The receiving device.
+   * \param txTime The transmission time of the packet.
+   */
+  void TrainTxAnimation (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src,
+                         Ptr<PointToPointNetDevice> dst, Time txTime);
+
   /** Each point to point link has exactly two net devices. */
   static const std::size_t N_DEVICES = 2;
 
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "point-to-point-fluid-background.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointFluidBackground");
+
+NS_OBJECT_ENSURE_REGISTERED (PointToPointFluidBackground);
+
+TypeId
+PointToPointFluidBackground::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::PointToPointFluidBackground")
+    .SetParent<Object> ()
+    .SetGroupName ("PointToPoint")
+    .AddConstructor<PointToPointFluidBackground> ()
+    .AddAttribute ("Epoch",
+                   "The interval over which the aggregate background rate "
+                   "is constant",
+                   TimeValue (MilliSeconds (10)),
+                   MakeTimeAccessor (&PointToPointFluidBackground::m_epoch),
+                   MakeTimeChecker (NanoSeconds (1)))
+    .AddAttribute ("MaxBytes",
+                   "The size of the buffer in front of the transmitter, "
+                   "in bytes",
+                   UintegerValue (100000),
+                   MakeUintegerAccessor (&PointToPointFluidBackground::m_maxBytes),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+PointToPointFluidBackground::PointToPointFluidBackground ()
+  : m_lastUpdate (Seconds (0)),
+    m_currentEpoch (-1),
+    m_rate (0),
+    m_backlog (0),
+    m_lost (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_uniform = CreateObject<UniformRandomVariable> ();
+}
+
+PointToPointFluidBackground::~PointToPointFluidBackground ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+PointToPointFluidBackground::AddFlow (DataRate rate, Time start, Time stop)
+{
+  NS_LOG_FUNCTION (this << rate << start << stop);
+  NS_ASSERT_MSG (start >= m_lastUpdate, "Flow declared after its start");
+  Flow flow;
+  flow.rate = rate.GetBitRate ();
+  flow.start = start;
+  flow.stop = stop;
+  m_flows.push_back (flow);
+  m_currentEpoch = -1;
+}
+
+double
+PointToPointFluidBackground::GetEpochRate (int64_t epoch) const
+{
+  Time begin = m_epoch * epoch;
+  Time end = begin + m_epoch;
+  double rate = 0;
+  for (std::vector<Flow>::const_iterator i = m_flows.begin (); i != m_flows.end (); i++)
+    {
+      Time overlap = std::min (end, i->stop) - std::max (begin, i->start);
+      if (overlap.IsStrictlyPositive ())
+        {
+          rate += i->rate * overlap.GetSeconds () / m_epoch.GetSeconds ();
+        }
+    }
+  return rate;
+}
+
+void
+PointToPointFluidBackground::Update (DataRate capacity)
+{
+  Time now = Simulator::Now ();
+  double service = capacity.GetBitRate ();
+  while (m_lastUpdate < now)
+    {
+      int64_t epoch = m_lastUpdate.GetTimeStep () / m_epoch.GetTimeStep ();
+      if (epoch != m_currentEpoch)
+        {
+          m_rate = GetEpochRate (epoch);
+          m_currentEpoch = epoch;
+        }
+      Time end = std::min (now, m_epoch * (epoch + 1));
+      // The rates are constant until the end of the epoch, so the backlog
+      // moves linearly and crosses each bound at most once.
+      double backlog = m_backlog + (m_rate - service) * (end - m_lastUpdate).GetSeconds () / 8;
+      if (backlog > m_maxBytes)
+        {
+          m_lost += backlog - std::max<double> (m_backlog, m_maxBytes);
+          backlog = m_maxBytes;
+        }
+      m_backlog = std::max (backlog, 0.0);
+      m_lastUpdate = end;
+    }
+}
+
+bool
+PointToPointFluidBackground::Transmit (uint32_t bytes, DataRate capacity, Time &wait)
+{
+  NS_LOG_FUNCTION (this << bytes << capacity);
+  Update (capacity);
+  if (m_backlog + bytes > m_maxBytes && m_rate > capacity.GetBitRate ()
+      && m_uniform->GetValue () < 1 - capacity.GetBitRate () / m_rate)
+    {
+      NS_LOG_LOGIC ("Packet lost with a backlog of " << m_backlog << " bytes");
+      wait = Seconds (0);
+      return false;
+    }
+  wait = Seconds (m_backlog * 8 / capacity.GetBitRate ());
+  NS_LOG_LOGIC ("Packet waits " << wait.As (Time::US) << " behind " << m_backlog << " bytes");
+  m_backlog += bytes;
+  return true;
+}
+
+double
+PointToPointFluidBackground::GetBacklog (DataRate capacity)
+{
+  Update (capacity);
+  return m_backlog;
+}
+
+double
+PointToPointFluidBackground::GetLostBytes (DataRate capacity)
+{
+  Update (capacity);
+  return m_lost;
+}
+
+int64_t
+PointToPointFluidBackground::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_uniform->SetStream (stream);
+  return 1;
+}
+
+} // namespace ns3
@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef POINT_TO_POINT_FLUID_BACKGROUND_H
+#define POINT_TO_POINT_FLUID_BACKGROUND_H
+
+#include <vector>
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/data-rate.h"
+#include "ns3/random-variable-stream.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point
+ * \brief Background traffic carried as a fluid by one direction of a link.
+ *
+ * Instead of simulating each packet of bulk background flows, the flows
+ * are declared with AddFlow as constant rates over time intervals.  The
+ * aggregate background rate is evaluated once per epoch, and the backlog
+ * of background bytes waiting in front of the transmitter is computed in
+ * closed form: within an epoch it grows or drains linearly, and it is
+ * bounded by the buffer size, the excess being lost.  Nothing is
+ * scheduled; the state is brought up to date when a foreground packet is
+ * sent.
+ *
+ * A PointToPointNetDevice with a fluid background, set with the
+ * FluidBackground attribute, applies its effect to each discrete packet
+ * it sends: the packet first waits for the background backlog to be
+ * served at the device data rate, and its own bytes join the backlog
+ * seen by the following traffic.  When the buffer is full and the
+ * background is arriving faster than the link serves it, the packet is
+ * dropped with the probability that a byte of the background is lost.
+ */
+class PointToPointFluidBackground : public Object
+{
+public:
+  /**
+   * \brief Get the TypeId
+   *
+   * \return The TypeId for this class
+   */
+  static TypeId GetTypeId (void);
+
+  PointToPointFluidBackground ();
+  virtual ~PointToPointFluidBackground ();
+
+  /**
+   * Declare a background flow.
+   *
+   * The flows must be declared before the simulation time reaches their
+   * start.
+   *
+   * \param rate The rate at which the flow sends.
+   * \param start The time the flow starts.
+   * \param stop The time the flow stops.
+   */
+  void AddFlow (DataRate rate, Time start, Time stop);
+
+  /**
+   * Account for a foreground packet sent over the link now.
+   *
+   * \param bytes The size of the packet.
+   * \param capacity The data rate of the link.
+   * \param [out] wait The time the packet waits for the background
+   *        backlog before its transmission starts.
+   * \returns false if the packet is lost.
+   */
+  bool Transmit (uint32_t bytes, DataRate capacity, Time &wait);
+
+  /**
+   * \param capacity The data rate of the link.
+   * \returns The background backlog now, in bytes.
+   */
+  double GetBacklog (DataRate capacity);
+
+  /**
+   * \param capacity The data rate of the link.
+   * \returns The number of background bytes lost so far.
+   */
+  double GetLostBytes (DataRate capacity);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+private:
+  /**
+   * Bring the backlog up to date.
+   *
+   * \param capacity The data rate of the link.
+   */
+  void Update (DataRate capacity);
+
+  /**
+   * \param epoch The index of an epoch.
+   * \returns The aggregate rate of the flows during the epoch, in bit/s.
+   */
+  double GetEpochRate (int64_t epoch) const;
+
+  /** A declared background flow. */
+  struct Flow
+  {
+    double rate; //!< The rate, in bit/s.
+    Time start;  //!< The start of the flow.
+    Time stop;   //!< The end of the flow.
+  };
+
+  std::vector<Flow> m_flows;   //!< The declared flows.
+  Time m_epoch;                //!< The duration of an epoch.
+  uint32_t m_maxBytes;         //!< The buffer size.
+  Time m_lastUpdate;           //!< The time the backlog was computed.
+  int64_t m_currentEpoch;      //!< The epoch m_rate was computed for.
+  double m_rate;               //!< The aggregate rate in the current epoch, in bit/s.
+  double m_backlog;            //!< The backlog, in bytes.
+  double m_lost;               //!< The background bytes lost, in bytes.
+  Ptr<UniformRandomVariable> m_uniform; //!< Draws the foreground losses.
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_FLUID_BACKGROUND_H */
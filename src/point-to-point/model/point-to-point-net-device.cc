@@ -24,8 +24,11 @@
 #include "ns3/error-model.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/pointer.h"
+#include "ns3/segment-offload-tag.h"
 #include "point-to-point-net-device.h"
+#include "point-to-point-fluid-background.h"
 #include "point-to-point-channel.h"
 #include "ppp-header.h"
 
@@ -67,6 +70,26 @@ PointToPointNetDevice::GetTypeId (void)
                    TimeValue (Seconds (0.0)),
                    MakeTimeAccessor (&PointToPointNetDevice::m_tInterframeGap),
                    MakeTimeChecker ())
+    .AddAttribute ("BurstSize",
+                   "The maximum number of queued packets sent back to back "
+                   "as a single train, with one channel call and one "
+                   "transmit complete event; 1 disables the burst mode",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&PointToPointNetDevice::m_burstSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("SegmentOffload",
+                   "Whether the packets larger than the MTU that carry a "
+                   "SegmentOffloadTag are accepted and sent as the train "
+                   "of wire packets they stand for",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointNetDevice::m_segmentOffload),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FluidBackground",
+                   "The background traffic modeled as a fluid on the "
+                   "transmit side of the link, if any",
+                   PointerValue (),
+                   MakePointerAccessor (&PointToPointNetDevice::m_fluidBackground),
+                   MakePointerChecker<PointToPointFluidBackground> ())
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -172,6 +195,47 @@ PointToPointNetDevice::GetTypeId (void)
 }
 
 
+void
+PointToPointTrain::Add (Ptr<Packet> p, Time txStart, Time txTime)
+{
+  Item item;
+  item.packet = p;
+  item.txStart = txStart;
+  item.txTime = txTime;
+  m_items.push_back (item);
+}
+
+std::size_t
+PointToPointTrain::GetN (void) const
+{
+  return m_items.size ();
+}
+
+Ptr<Packet>
+PointToPointTrain::GetPacket (std::size_t i) const
+{
+  return m_items[i].packet;
+}
+
+Time
+PointToPointTrain::GetTxStart (std::size_t i) const
+{
+  return m_items[i].txStart;
+}
+
+Time
+PointToPointTrain::GetTxTime (std::size_t i) const
+{
+  return m_items[i].txTime;
+}
+
+Time
+PointToPointTrain::GetTxEnd (std::size_t i) const
+{
+  return m_items[i].txStart + m_items[i].txTime;
+}
+
+
 PointToPointNetDevice::PointToPointNetDevice () 
   :
     m_txMachineState (READY),
@@ -213,6 +277,7 @@ PointToPointNetDevice::DoDispose ()
   m_node = 0;
   m_channel = 0;
   m_receiveErrorModel = 0;
+  m_fluidBackground = 0;
   m_currentPkt = 0;
   m_queue = 0;
   NetDevice::DoDispose ();
@@ -245,10 +310,58 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   //
   NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
   m_txMachineState = BUSY;
+  if (m_fluidBackground)
+    {
+      return TransmitFluid (p);
+    }
+  if (m_burstSize > 1 && !m_queue->IsEmpty ())
+    {
+      return TransmitTrain (p);
+    }
+  return TransmitWire (p);
+}
+
+bool
+PointToPointNetDevice::TransmitFluid (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  //
+  // The packet first waits for the background traffic in front of it.
+  // Lost packets are replaced with the next ones from the queue.
+  //
+  Time wait;
+  uint32_t frames;
+  while (!m_fluidBackground->Transmit (GetWireSize (p, frames), m_bps, wait))
+    {
+      NS_LOG_LOGIC ("Packet lost to the fluid background");
+      m_phyTxDropTrace (p);
+      p = m_queue->Dequeue ();
+      if (p == 0)
+        {
+          m_txMachineState = READY;
+          return false;
+        }
+      m_snifferTrace (p);
+      m_promiscSnifferTrace (p);
+    }
+  if (wait.IsZero ())
+    {
+      return TransmitWire (p);
+    }
+  NS_LOG_LOGIC ("Wait " << wait.GetSeconds () << "sec for the fluid background");
+  Simulator::Schedule (wait, &PointToPointNetDevice::TransmitWire, this, p);
+  return true;
+}
+
+bool
+PointToPointNetDevice::TransmitWire (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
 
-  Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  Time txTime = GetTxTime (p);
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
@@ -262,6 +375,97 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   return result;
 }
 
+bool
+PointToPointNetDevice::TransmitTrain (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  //
+  // Take the packets waiting in the queue out with this one and lay them
+  // back to back on the wire.
+  //
+  Ptr<PointToPointTrain> train = Create<PointToPointTrain> ();
+  Time txStart = Seconds (0);
+  while (p != 0)
+    {
+      Time txTime = GetTxTime (p);
+      train->Add (p, txStart, txTime);
+      txStart += txTime + m_tInterframeGap;
+      p = 0;
+      if (train->GetN () < m_burstSize && !m_queue->IsEmpty ())
+        {
+          p = m_queue->Dequeue ();
+        }
+    }
+  std::size_t n = train->GetN ();
+  NS_LOG_LOGIC ("Train of " << n << " packets");
+
+  m_currentPkt = train->GetPacket (n - 1);
+  m_phyTxBeginTrace (train->GetPacket (0));
+
+  //
+  // The other packets only need events of their own when somebody
+  // listens to their transmission.
+  //
+  if (!m_phyTxBeginTrace.IsEmpty () || !m_phyTxEndTrace.IsEmpty ()
+      || !m_snifferTrace.IsEmpty () || !m_promiscSnifferTrace.IsEmpty ())
+    {
+      for (std::size_t i = 1; i < n; i++)
+        {
+          Simulator::Schedule (train->GetTxStart (i), &PointToPointNetDevice::TrainTxNext,
+                               this, train->GetPacket (i - 1), train->GetPacket (i));
+        }
+    }
+
+  NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txStart.GetSeconds () << "sec");
+  Simulator::Schedule (txStart, &PointToPointNetDevice::TransmitComplete, this);
+
+  bool result = m_channel->TransmitTrain (train, this);
+  if (result == false)
+    {
+      for (std::size_t i = 0; i < n; i++)
+        {
+          m_phyTxDropTrace (train->GetPacket (i));
+        }
+    }
+  return result;
+}
+
+void
+PointToPointNetDevice::TrainTxNext (Ptr<Packet> previous, Ptr<Packet> next)
+{
+  NS_LOG_FUNCTION (this << previous << next);
+  m_phyTxEndTrace (previous);
+  m_snifferTrace (next);
+  m_promiscSnifferTrace (next);
+  m_phyTxBeginTrace (next);
+}
+
+uint32_t
+PointToPointNetDevice::GetWireSize (Ptr<const Packet> p, uint32_t &frames) const
+{
+  SegmentOffloadTag tag;
+  if (m_segmentOffload && p->PeekPacketTag (tag))
+    {
+      frames = tag.GetSegments ();
+      return tag.GetWireSize (p->GetSize ());
+    }
+  frames = 1;
+  return p->GetSize ();
+}
+
+Time
+PointToPointNetDevice::GetTxTime (Ptr<const Packet> p) const
+{
+  uint32_t frames;
+  Time txTime = m_bps.CalculateBytesTxTime (GetWireSize (p, frames));
+  if (frames > 1)
+    {
+      txTime += m_tInterframeGap * (frames - 1);
+    }
+  return txTime;
+}
+
 void
 PointToPointNetDevice::TransmitComplete (void)
 {
@@ -328,6 +532,19 @@ PointToPointNetDevice::SetReceiveErrorModel (Ptr<ErrorModel> em)
   m_receiveErrorModel = em;
 }
 
+void
+PointToPointNetDevice::SetFluidBackground (Ptr<PointToPointFluidBackground> background)
+{
+  NS_LOG_FUNCTION (this << background);
+  m_fluidBackground = background;
+}
+
+Ptr<PointToPointFluidBackground>
+PointToPointNetDevice::GetFluidBackground (void) const
+{
+  return m_fluidBackground;
+}
+
 void
 PointToPointNetDevice::Receive (Ptr<Packet> packet)
 {
@@ -378,6 +595,18 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
     }
 }
 
+void
+PointToPointNetDevice::ReceiveTrain (Ptr<PointToPointTrain> train, std::size_t i)
+{
+  NS_LOG_FUNCTION (this << train << i);
+  if (i + 1 < train->GetN ())
+    {
+      Simulator::Schedule (train->GetTxEnd (i + 1) - train->GetTxEnd (i),
+                           &PointToPointNetDevice::ReceiveTrain, this, train, i + 1);
+    }
+  Receive (train->GetPacket (i));
+}
+
 Ptr<Queue<Packet> >
 PointToPointNetDevice::GetQueue (void) const
 { 
@@ -605,6 +834,13 @@ PointToPointNetDevice::SupportsSendFrom (void) const
   return false;
 }
 
+bool
+PointToPointNetDevice::SupportsSegmentOffload (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_segmentOffload;
+}
+
 void
 PointToPointNetDevice::DoMpiReceive (Ptr<Packet> p)
 {
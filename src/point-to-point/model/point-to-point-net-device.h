@@ -20,6 +20,7 @@
 #define POINT_TO_POINT_NET_DEVICE_H
 
 #include <cstring>
+#include <vector>
 #include "ns3/address.h"
 #include "ns3/node.h"
 #include "ns3/net-device.h"
@@ -29,6 +30,7 @@
 #include "ns3/nstime.h"
 #include "ns3/data-rate.h"
 #include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
 #include "ns3/mac48-address.h"
 
 namespace ns3 {
@@ -36,6 +38,7 @@ namespace ns3 {
 template <typename Item> class Queue;
 class PointToPointChannel;
 class ErrorModel;
+class PointToPointFluidBackground;
 
 /**
  * \defgroup point-to-point Point-To-Point Network Device
@@ -46,6 +49,61 @@ class ErrorModel;
  * Be sure to read the manual BEFORE going down to the API.
  */
 
+/**
+ * \ingroup point-to-point
+ * \brief Back-to-back packets sent over a PointToPointChannel as a whole.
+ *
+ * A PointToPointNetDevice in burst mode takes the packets waiting in its
+ * queue out together and computes when each of them is sent.  The
+ * times are relative to the start of the transmission of the train.
+ */
+class PointToPointTrain : public SimpleRefCount<PointToPointTrain>
+{
+public:
+  /**
+   * Append a packet to the train.
+   *
+   * \param p The packet.
+   * \param txStart The time the transmission of the packet starts.
+   * \param txTime The transmission time of the packet.
+   */
+  void Add (Ptr<Packet> p, Time txStart, Time txTime);
+  /**
+   * \returns The number of packets in the train.
+   */
+  std::size_t GetN (void) const;
+  /**
+   * \param i The index of a packet.
+   * \returns The packet.
+   */
+  Ptr<Packet> GetPacket (std::size_t i) const;
+  /**
+   * \param i The index of a packet.
+   * \returns The time the transmission of the packet starts.
+   */
+  Time GetTxStart (std::size_t i) const;
+  /**
+   * \param i The index of a packet.
+   * \returns The transmission time of the packet.
+   */
+  Time GetTxTime (std::size_t i) const;
+  /**
+   * \param i The index of a packet.
+   * \returns The time the last bit of the packet is sent.
+   */
+  Time GetTxEnd (std::size_t i) const;
+
+private:
+  /** A packet of the train. */
+  struct Item
+  {
+    Ptr<Packet> packet; //!< The packet.
+    Time txStart;       //!< The start of its transmission.
+    Time txTime;        //!< Its transmission time.
+  };
+  std::vector<Item> m_items; //!< The packets, in transmission order.
+};
+
 /**
  * \ingroup point-to-point
  * \class PointToPointNetDevice
@@ -137,6 +195,19 @@ public:
    */
   void SetReceiveErrorModel (Ptr<ErrorModel> em);
 
+  /**
+   * Attach a fluid model of the background traffic sharing the transmit
+   * side of the link.
+   *
+   * \param background Ptr to the PointToPointFluidBackground.
+   */
+  void SetFluidBackground (Ptr<PointToPointFluidBackground> background);
+
+  /**
+   * \returns Ptr to the PointToPointFluidBackground, if any.
+   */
+  Ptr<PointToPointFluidBackground> GetFluidBackground (void) const;
+
   /**
    * Receive a packet from a connected PointToPointChannel.
    *
@@ -149,6 +220,18 @@ public:
    */
   void Receive (Ptr<Packet> p);
 
+  /**
+   * Receive a packet of a train from a connected PointToPointChannel.
+   *
+   * The channel calls this method when the last bit of the first packet
+   * of a train arrives; the device then receives each following packet
+   * of the train when its own last bit arrives.
+   *
+   * \param train The train, with the packets owned by this device.
+   * \param i The index of the packet arriving now.
+   */
+  void ReceiveTrain (Ptr<PointToPointTrain> train, std::size_t i);
+
   // The remaining methods are documented in ns3::NetDevice*
 
   virtual void SetIfIndex (const uint32_t index);
@@ -189,6 +272,7 @@ public:
 
   virtual void SetPromiscReceiveCallback (PromiscReceiveCallback cb);
   virtual bool SupportsSendFrom (void) const;
+  virtual bool SupportsSegmentOffload (void) const;
 
 protected:
   /**
@@ -275,6 +359,72 @@ private:
    */
   void TransmitComplete (void);
 
+  /**
+   * Start sending a packet after the fluid background in front of it.
+   *
+   * The packet waits until the background backlog is served, or is
+   * dropped, as computed by the PointToPointFluidBackground; a dropped
+   * packet is replaced with the next packet in the queue.
+   *
+   * \param p Packet to send
+   * \returns true if a packet is sent, false if the queue ran empty
+   */
+  bool TransmitFluid (Ptr<Packet> p);
+
+  /**
+   * Put a packet on the wire now.
+   *
+   * \param p Packet to send
+   * \returns true if success, false on failure
+   */
+  bool TransmitWire (Ptr<Packet> p);
+
+  /**
+   * Start sending the packets waiting in the queue along with a packet.
+   *
+   * In burst mode the packets in the queue are sent back to back with the
+   * packet being started, up to the burst size, as a single train: the
+   * channel is called once for the train and TransmitComplete is only
+   * scheduled at the end of the train.  The transmit and sniffer traces
+   * of the other packets are fired at their exact times, if connected.
+   *
+   * \param p The first packet of the train.
+   * \returns true if success, false on failure
+   */
+  bool TransmitTrain (Ptr<Packet> p);
+
+  /**
+   * Fire the traces of the end of the transmission of a packet of a
+   * train and of the start of the following one, as TransmitComplete and
+   * TransmitStart would do between two packets.
+   *
+   * \param previous The packet whose transmission is complete.
+   * \param next The packet whose transmission starts.
+   */
+  void TrainTxNext (Ptr<Packet> previous, Ptr<Packet> next);
+
+  /**
+   * Get the number of bytes that a packet takes on the wire.
+   *
+   * With segment offload, a packet carrying a SegmentOffloadTag is sent as
+   * a train of wire packets, each with a copy of the headers.
+   *
+   * \param p The packet.
+   * \param frames Set to the number of wire packets.
+   * \returns the number of bytes of the wire packets.
+   */
+  uint32_t GetWireSize (Ptr<const Packet> p, uint32_t &frames) const;
+
+  /**
+   * Get the time that the wire packets of a packet take to be sent,
+   * including the interframe gaps between them, but not the one after
+   * the last.
+   *
+   * \param p The packet.
+   * \returns the transmission time.
+   */
+  Time GetTxTime (Ptr<const Packet> p) const;
+
   /**
    * \brief Make the link up and running
    *
@@ -307,6 +457,18 @@ private:
    */
   Time           m_tInterframeGap;
 
+  /**
+   * The maximum number of packets sent as a single train, 1 to send
+   * each packet on its own.
+   */
+  uint32_t       m_burstSize;
+
+  /**
+   * True if the packets carrying a SegmentOffloadTag are accounted for as
+   * the wire packets they stand for.
+   */
+  bool           m_segmentOffload;
+
   /**
    * The PointToPointChannel to which this PointToPointNetDevice has been
    * attached.
@@ -326,6 +488,11 @@ private:
    */
   Ptr<ErrorModel> m_receiveErrorModel;
 
+  /**
+   * Background traffic sharing the transmit side of the link
+   */
+  Ptr<PointToPointFluidBackground> m_fluidBackground;
+
   /**
    * The trace source fired when packets come into the "top" of the device
    * at the L3/L2 transition, before being queued for transmission.
@@ -73,4 +73,26 @@ PointToPointRemoteChannel::TransmitStart (
   return true;
 }
 
+bool
+PointToPointRemoteChannel::TransmitTrain (
+  Ptr<const PointToPointTrain> train,
+  Ptr<PointToPointNetDevice> src)
+{
+  NS_LOG_FUNCTION (this << train << src);
+
+  IsInitialized ();
+
+  uint32_t wire = src == GetSource (0) ? 0 : 1;
+  Ptr<PointToPointNetDevice> dst = GetDestination (wire);
+
+  for (std::size_t i = 0; i < train->GetN (); i++)
+    {
+      // Calculate the rxTime (absolute)
+      Time rxTime = Simulator::Now () + train->GetTxEnd (i) + GetDelay ();
+      MpiInterface::SendPacket (train->GetPacket (i)->Copy (), rxTime,
+                                dst->GetNode ()->GetId (), dst->GetIfIndex ());
+    }
+  return true;
+}
+
 } // namespace ns3
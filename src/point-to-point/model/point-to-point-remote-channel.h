@@ -68,6 +68,17 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src,
                               Time txTime);
+
+  /**
+   * \brief Transmit a train of packets
+   *
+   * Each packet of the train is sent to the remote system on its own.
+   *
+   * \param train The packets to transmit and their transmission times
+   * \param src Source PointToPointNetDevice
+   * \returns true if successful (currently always true)
+   */
+  virtual bool TransmitTrain (Ptr<const PointToPointTrain> train, Ptr<PointToPointNetDevice> src);
 };
 
 } // namespace ns3
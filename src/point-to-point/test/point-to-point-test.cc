@@ -23,7 +23,12 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-fluid-background.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include <sstream>
+#include <vector>
 
 using namespace ns3;
 
@@ -94,6 +99,299 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test the burst mode of PointToPointNetDevice
+ *
+ * A backlog of packets of different sizes is sent with and without the
+ * burst mode; the packets must be received, and the transmit traces
+ * fired, at the same times in both cases.
+ */
+class PointToPointBurstTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   *
+   * \param traced Whether the transmit traces are connected.
+   */
+  PointToPointBurstTest (bool traced);
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send packets of growing sizes to the device specified
+   *
+   * \param device NetDevice to send to
+   * \param n Number of packets to send
+   */
+  void SendPackets (Ptr<PointToPointNetDevice> device, uint32_t n);
+
+  /**
+   * \brief Send a backlog of packets over a link and record what happens
+   *
+   * \param burstSize The burst size of the transmitting device.
+   * \returns The events seen, one per line.
+   */
+  std::string RunLink (uint32_t burstSize);
+
+  /**
+   * \brief Record the reception of a packet
+   *
+   * \param device The receiving device.
+   * \param p The packet.
+   * \param protocol The protocol number.
+   * \param from The sender address.
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  /**
+   * \brief Record a transmit trace
+   *
+   * \param event The name of the trace.
+   * \param p The packet.
+   */
+  void Trace (std::string event, Ptr<const Packet> p);
+
+  bool m_traced;            //!< Whether the transmit traces are connected.
+  std::ostringstream m_log; //!< The events seen.
+};
+
+PointToPointBurstTest::PointToPointBurstTest (bool traced)
+  : TestCase (traced ? "PointToPoint burst mode with traces" : "PointToPoint burst mode"),
+    m_traced (traced)
+{
+}
+
+void
+PointToPointBurstTest::SendPackets (Ptr<PointToPointNetDevice> device, uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (100 + 50 * i);
+      device->Send (p, device->GetBroadcast (), 0x800);
+    }
+}
+
+bool
+PointToPointBurstTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                                const Address &from)
+{
+  m_log << "rx " << p->GetSize () << " " << Simulator::Now ().GetNanoSeconds () << std::endl;
+  return true;
+}
+
+void
+PointToPointBurstTest::Trace (std::string event, Ptr<const Packet> p)
+{
+  m_log << event << " " << p->GetSize () << " " << Simulator::Now ().GetNanoSeconds () << std::endl;
+}
+
+std::string
+PointToPointBurstTest::RunLink (uint32_t burstSize)
+{
+  m_log.str ("");
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2)));
+
+  devA->SetAttribute ("DataRate", DataRateValue (DataRate ("1Mbps")));
+  devA->SetAttribute ("InterframeGap", TimeValue (MicroSeconds (3)));
+  devA->SetAttribute ("BurstSize", UintegerValue (burstSize));
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointBurstTest::Receive, this));
+
+  if (m_traced)
+    {
+      devA->TraceConnect ("PhyTxBegin", "begin", MakeCallback (&PointToPointBurstTest::Trace, this));
+      devA->TraceConnect ("PhyTxEnd", "end", MakeCallback (&PointToPointBurstTest::Trace, this));
+      devA->TraceConnect ("Sniffer", "sniffer", MakeCallback (&PointToPointBurstTest::Trace, this));
+    }
+
+  Simulator::Schedule (Seconds (1.0), &PointToPointBurstTest::SendPackets, this, devA, 20);
+  Simulator::Schedule (Seconds (2.0), &PointToPointBurstTest::SendPackets, this, devA, 1);
+  Simulator::Schedule (Seconds (3.0), &PointToPointBurstTest::SendPackets, this, devA, 7);
+
+  Simulator::Run ();
+
+  Simulator::Destroy ();
+  return m_log.str ();
+}
+
+void
+PointToPointBurstTest::DoRun (void)
+{
+  std::string expected = RunLink (1);
+  NS_TEST_ASSERT_MSG_NE (expected.find ("rx 1050 "), std::string::npos, "Packets not received");
+  NS_TEST_ASSERT_MSG_EQ (RunLink (4), expected, "Burst of 4 packets changed the timing");
+  NS_TEST_ASSERT_MSG_EQ (RunLink (64), expected, "Burst of 64 packets changed the timing");
+}
+
+/**
+ * \brief Test the fluid background model of PointToPointNetDevice
+ *
+ * A 2 Mbit/s background flow overloads a 1 Mbit/s link for one second;
+ * the backlog, the losses and the delay of a foreground packet are
+ * checked against their closed-form values.
+ */
+class PointToPointFluidTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointFluidTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send one packet to the device specified
+   *
+   * \param device NetDevice to send to
+   */
+  void SendOnePacket (Ptr<PointToPointNetDevice> device);
+
+  /**
+   * \brief Record the reception of a packet
+   *
+   * \param device The receiving device.
+   * \param p The packet.
+   * \param protocol The protocol number.
+   * \param from The sender address.
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  /**
+   * \brief Check the background state once the flow has stopped
+   *
+   * \param background The fluid background model.
+   */
+  void CheckDrained (Ptr<PointToPointFluidBackground> background);
+
+  /**
+   * \brief Check the loss rate of packets sent while the buffer is full
+   *
+   * \param background The fluid background model.
+   */
+  void CheckLoss (Ptr<PointToPointFluidBackground> background);
+
+  Time m_rxTime; //!< The time the foreground packet is received.
+};
+
+PointToPointFluidTest::PointToPointFluidTest ()
+  : TestCase ("PointToPoint fluid background")
+{
+}
+
+void
+PointToPointFluidTest::SendOnePacket (Ptr<PointToPointNetDevice> device)
+{
+  Ptr<Packet> p = Create<Packet> (1000);
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointFluidTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol,
+                                const Address &from)
+{
+  m_rxTime = Simulator::Now ();
+  return true;
+}
+
+void
+PointToPointFluidTest::CheckDrained (Ptr<PointToPointFluidBackground> background)
+{
+  DataRate rate ("1Mbps");
+  // The backlog reaches 50000 bytes 0.292 s after the foreground packet
+  // is sent at 0.1 s; the background loses 125000 bytes/s from then on
+  // until 1 s, which is 75000 bytes plus the size of the packet.
+  NS_TEST_ASSERT_MSG_EQ_TOL (background->GetLostBytes (rate), 76002, 1, "Wrong background losses");
+  NS_TEST_ASSERT_MSG_EQ_TOL (background->GetBacklog (rate), 0, 1e-6, "Backlog not drained");
+}
+
+void
+PointToPointFluidTest::CheckLoss (Ptr<PointToPointFluidBackground> background)
+{
+  DataRate rate ("1Mbps");
+  uint32_t sent = 0;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Time wait;
+      if (background->Transmit (100, rate, wait))
+        {
+          sent++;
+          NS_TEST_ASSERT_MSG_GT (wait, MilliSeconds (399), "Wrong wait for a full buffer");
+        }
+    }
+  // Half of the traffic offered to the full buffer is lost
+  NS_TEST_ASSERT_MSG_EQ_TOL (sent, 500, 60, "Wrong number of lost packets");
+}
+
+void
+PointToPointFluidTest::DoRun (void)
+{
+  Ptr<Node> a = CreateObject<Node> ();
+  Ptr<Node> b = CreateObject<Node> ();
+  Ptr<PointToPointNetDevice> devA = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointNetDevice> devB = CreateObject<PointToPointNetDevice> ();
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2)));
+
+  devA->SetAttribute ("DataRate", DataRateValue (DataRate ("1Mbps")));
+  devA->Attach (channel);
+  devA->SetAddress (Mac48Address::Allocate ());
+  devA->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+  devB->Attach (channel);
+  devB->SetAddress (Mac48Address::Allocate ());
+  devB->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+
+  a->AddDevice (devA);
+  b->AddDevice (devB);
+  devB->SetReceiveCallback (MakeCallback (&PointToPointFluidTest::Receive, this));
+
+  Ptr<PointToPointFluidBackground> background = CreateObject<PointToPointFluidBackground> ();
+  background->SetAttribute ("MaxBytes", UintegerValue (50000));
+  background->AddFlow (DataRate ("2Mbps"), Seconds (0), Seconds (1));
+  devA->SetFluidBackground (background);
+
+  Ptr<PointToPointFluidBackground> full = CreateObject<PointToPointFluidBackground> ();
+  full->SetAttribute ("MaxBytes", UintegerValue (50000));
+  full->AssignStreams (1);
+  full->AddFlow (DataRate ("2Mbps"), Seconds (0), Seconds (1));
+
+  Simulator::Schedule (Seconds (0.1), &PointToPointFluidTest::SendOnePacket, this, devA);
+  Simulator::Schedule (Seconds (0.5), &PointToPointFluidTest::CheckLoss, this, full);
+  Simulator::Schedule (Seconds (1.5), &PointToPointFluidTest::CheckDrained, this, background);
+
+  Simulator::Run ();
+
+  // 12500 bytes of background are waiting when the packet is sent
+  NS_TEST_ASSERT_MSG_EQ (m_rxTime, Seconds (0.1) + Seconds (0.1) + MicroSeconds (8016) + MilliSeconds (2),
+                         "Wrong foreground delay");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -110,6 +408,9 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointBurstTest (false), TestCase::QUICK);
+  AddTestCase (new PointToPointBurstTest (true), TestCase::QUICK);
+  AddTestCase (new PointToPointFluidTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
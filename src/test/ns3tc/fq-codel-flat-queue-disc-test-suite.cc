@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/fq-codel-queue-disc.h"
+#include "ns3/fq-codel-flat-queue-disc.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief Check that FqCoDelFlatQueueDisc enqueues, dequeues, drops and
+ * marks the same packets as FqCoDelQueueDisc.
+ *
+ * Both queue discs are fed the same random traffic of many flows, faster
+ * than it is dequeued for a while so that CoDel and the overlimit drops
+ * kick in.  Every dequeued packet and the final statistics must match.
+ */
+class FqCoDelFlatQueueDiscMatchTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param name the name of the test case
+   * \param nFlows the number of flows of the traffic
+   * \param ect the ECN codepoint of the packets of every other flow
+   * \param n1 the name of an attribute set on both queue discs
+   * \param v1 the value of the attribute
+   * \param n2 the name of an attribute set on both queue discs
+   * \param v2 the value of the attribute
+   * \param n3 the name of an attribute set on both queue discs
+   * \param v3 the value of the attribute
+   * \param n4 the name of an attribute set on both queue discs
+   * \param v4 the value of the attribute
+   */
+  FqCoDelFlatQueueDiscMatchTestCase (std::string name, uint32_t nFlows, Ipv4Header::EcnType ect,
+                                     std::string n1, const AttributeValue &v1,
+                                     std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+                                     std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue (),
+                                     std::string n4 = "", const AttributeValue &v4 = EmptyAttributeValue ());
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Enqueue packets into both queue discs
+   * \param n the number of packets
+   */
+  void Enqueue (uint32_t n);
+  /**
+   * Dequeue packets from both queue discs and compare them
+   * \param n the number of packets
+   */
+  void Dequeue (uint32_t n);
+  /**
+   * \param reason the reason of a drop or mark of FqCoDelQueueDisc
+   * \return the reason without the prefix added to the reasons of the child queue discs
+   */
+  static std::string StripChild (std::string reason);
+
+  uint32_t m_nFlows;                  //!< Number of flows of the traffic
+  Ipv4Header::EcnType m_ect;          //!< ECN codepoint of every other flow
+  ObjectFactory m_fqFactory;          //!< Creates the reference queue disc
+  ObjectFactory m_flatFactory;        //!< Creates the queue disc under test
+  Ptr<FqCoDelQueueDisc> m_fq;         //!< The reference queue disc
+  Ptr<FqCoDelFlatQueueDisc> m_flat;   //!< The queue disc under test
+  Ptr<UniformRandomVariable> m_rng;   //!< Draws the flows and sizes of the packets
+  uint32_t m_dequeued;                //!< Number of packets dequeued
+};
+
+FqCoDelFlatQueueDiscMatchTestCase::FqCoDelFlatQueueDiscMatchTestCase (std::string name, uint32_t nFlows,
+                                                                      Ipv4Header::EcnType ect,
+                                                                      std::string n1, const AttributeValue &v1,
+                                                                      std::string n2, const AttributeValue &v2,
+                                                                      std::string n3, const AttributeValue &v3,
+                                                                      std::string n4, const AttributeValue &v4)
+  : TestCase ("Match FqCoDelQueueDisc: " + name),
+    m_nFlows (nFlows),
+    m_ect (ect),
+    m_dequeued (0)
+{
+  m_fqFactory.SetTypeId ("ns3::FqCoDelQueueDisc");
+  m_flatFactory.SetTypeId ("ns3::FqCoDelFlatQueueDisc");
+  ObjectFactory *factories[] = {&m_fqFactory, &m_flatFactory};
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      factories[i]->Set (n1, v1);
+      factories[i]->Set (n2, v2);
+      factories[i]->Set (n3, v3);
+      factories[i]->Set (n4, v4);
+    }
+}
+
+std::string
+FqCoDelFlatQueueDiscMatchTestCase::StripChild (std::string reason)
+{
+  std::string drop (QueueDisc::CHILD_QUEUE_DISC_DROP);
+  std::string mark (QueueDisc::CHILD_QUEUE_DISC_MARK);
+  if (reason.compare (0, drop.size (), drop) == 0)
+    {
+      return reason.substr (drop.size ());
+    }
+  if (reason.compare (0, mark.size (), mark) == 0)
+    {
+      return reason.substr (mark.size ());
+    }
+  return reason;
+}
+
+void
+FqCoDelFlatQueueDiscMatchTestCase::Enqueue (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      uint32_t flow = m_rng->GetInteger (0, m_nFlows - 1);
+      Ipv4Header hdr;
+      hdr.SetPayloadSize (100);
+      hdr.SetSource (Ipv4Address ("10.10.1.1"));
+      hdr.SetDestination (Ipv4Address (0x0a140000 + flow));
+      hdr.SetProtocol (7);
+      hdr.SetEcn (flow % 2 ? m_ect : Ipv4Header::ECN_NotECT);
+      Ptr<Packet> p = Create<Packet> (m_rng->GetInteger (40, 1500));
+      Address dest;
+      m_fq->Enqueue (Create<Ipv4QueueDiscItem> (p, dest, 0, hdr));
+      m_flat->Enqueue (Create<Ipv4QueueDiscItem> (p->Copy (), dest, 0, hdr));
+      NS_TEST_ASSERT_MSG_EQ (m_flat->GetNPackets (), m_fq->GetNPackets (), "Different number of packets");
+    }
+}
+
+void
+FqCoDelFlatQueueDiscMatchTestCase::Dequeue (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<QueueDiscItem> expected = m_fq->Dequeue ();
+      Ptr<QueueDiscItem> item = m_flat->Dequeue ();
+      NS_TEST_ASSERT_MSG_EQ ((item == 0), (expected == 0), "Only one queue disc returned a packet");
+      if (item)
+        {
+          m_dequeued++;
+          NS_TEST_ASSERT_MSG_EQ (item->GetPacket ()->GetUid (), expected->GetPacket ()->GetUid (),
+                                 "Different packet dequeued");
+          uint8_t tos, expectedTos;
+          item->GetUint8Value (QueueItem::IP_DSFIELD, tos);
+          expected->GetUint8Value (QueueItem::IP_DSFIELD, expectedTos);
+          NS_TEST_ASSERT_MSG_EQ ((uint32_t) tos, (uint32_t) expectedTos, "Different ECN marking");
+        }
+    }
+}
+
+void
+FqCoDelFlatQueueDiscMatchTestCase::DoRun (void)
+{
+  m_fq = m_fqFactory.Create<FqCoDelQueueDisc> ();
+  m_flat = m_flatFactory.Create<FqCoDelFlatQueueDisc> ();
+  m_fq->SetQuantum (1514);
+  m_flat->SetQuantum (1514);
+  m_fq->Initialize ();
+  m_flat->Initialize ();
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (7);
+
+  // 2 packets per ms for 2 s, dequeued at 1.5 packets per ms, then drained
+  for (uint32_t ms = 0; ms < 4000; ms++)
+    {
+      if (ms < 2000)
+        {
+          Simulator::Schedule (MilliSeconds (ms), &FqCoDelFlatQueueDiscMatchTestCase::Enqueue, this, 2);
+        }
+      Simulator::Schedule (MilliSeconds (ms) + MicroSeconds (500),
+                           &FqCoDelFlatQueueDiscMatchTestCase::Dequeue, this, ms % 2 + 1);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  QueueDisc::Stats expected = m_fq->GetStats ();
+  QueueDisc::Stats stats = m_flat->GetStats ();
+  NS_TEST_ASSERT_MSG_GT (m_dequeued, 1000, "Too few packets dequeued");
+  NS_TEST_ASSERT_MSG_EQ (stats.nTotalReceivedPackets, expected.nTotalReceivedPackets, "Different received packets");
+  NS_TEST_ASSERT_MSG_EQ (stats.nTotalDequeuedPackets, expected.nTotalDequeuedPackets, "Different dequeued packets");
+  NS_TEST_ASSERT_MSG_EQ (stats.nTotalDequeuedBytes, expected.nTotalDequeuedBytes, "Different dequeued bytes");
+  NS_TEST_ASSERT_MSG_EQ (stats.nTotalDroppedPackets, expected.nTotalDroppedPackets, "Different dropped packets");
+  NS_TEST_ASSERT_MSG_EQ (stats.nTotalMarkedPackets, expected.nTotalMarkedPackets, "Different marked packets");
+  NS_TEST_ASSERT_MSG_GT (stats.nTotalDroppedPackets + stats.nTotalMarkedPackets, 0,
+                         "The traffic did not trigger any drop or mark");
+  for (std::map<std::string, uint32_t>::const_iterator it = expected.nDroppedPacketsAfterDequeue.begin ();
+       it != expected.nDroppedPacketsAfterDequeue.end (); it++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (stats.GetNDroppedPackets (StripChild (it->first).c_str ()),
+                             expected.GetNDroppedPackets (it->first.c_str ()),
+                             "Different drops: " << it->first);
+    }
+  for (std::map<std::string, uint32_t>::const_iterator it = expected.nMarkedPackets.begin ();
+       it != expected.nMarkedPackets.end (); it++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (stats.GetNMarkedPackets (StripChild (it->first).c_str ()),
+                             expected.GetNMarkedPackets (it->first.c_str ()),
+                             "Different marks: " << it->first);
+    }
+}
+
+/**
+ * \ingroup traffic-control-test
+ * \ingroup tests
+ *
+ * \brief FqCoDelFlatQueueDisc TestSuite
+ */
+class FqCoDelFlatQueueDiscTestSuite : public TestSuite
+{
+public:
+  FqCoDelFlatQueueDiscTestSuite ();
+};
+
+FqCoDelFlatQueueDiscTestSuite::FqCoDelFlatQueueDiscTestSuite ()
+  : TestSuite ("fq-codel-flat-queue-disc", UNIT)
+{
+  AddTestCase (new FqCoDelFlatQueueDiscMatchTestCase ("drops", 50, Ipv4Header::ECN_NotECT,
+                                                      "UseEcn", BooleanValue (false),
+                                                      "MaxSize", StringValue ("400p")),
+               TestCase::QUICK);
+  AddTestCase (new FqCoDelFlatQueueDiscMatchTestCase ("ECN and CE threshold", 50, Ipv4Header::ECN_ECT0,
+                                                      "UseEcn", BooleanValue (true),
+                                                      "CeThreshold", TimeValue (MilliSeconds (2))),
+               TestCase::QUICK);
+  AddTestCase (new FqCoDelFlatQueueDiscMatchTestCase ("L4S", 50, Ipv4Header::ECN_ECT1,
+                                                      "UseL4s", BooleanValue (true),
+                                                      "CeThreshold", TimeValue (MilliSeconds (1))),
+               TestCase::QUICK);
+  AddTestCase (new FqCoDelFlatQueueDiscMatchTestCase ("set associative hash", 100, Ipv4Header::ECN_ECT0,
+                                                      "EnableSetAssociativeHash", BooleanValue (true),
+                                                      "Flows", UintegerValue (64),
+                                                      "MaxSize", StringValue ("200p"),
+                                                      "DropBatchSize", UintegerValue (16)),
+               TestCase::QUICK);
+}
+
+static FqCoDelFlatQueueDiscTestSuite g_fqCoDelFlatQueueDiscTestSuite; ///< the test suite
@@ -0,0 +1,232 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <string>
+
+#include "ns3/log.h"
+#include "ns3/test.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/bulk-send-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Ns3TcpTsoTest");
+
+// ===========================================================================
+// Tests of the large segment offload emulation
+// ===========================================================================
+//
+// A bulk transfer from n0 to n2 through the router n1:
+//
+//        100Mb/s, 1ms          10Mb/s, 10ms
+//    n0 -------------- n1 -------------- n2
+//
+// The transfer is run without offload, then with the TCP super-segments
+// and with the segment offload enabled on the devices of each link.  When
+// the device of the sender does not support the offload, TCP splits the
+// super-segments into the exact segments; when the device of the router
+// does not, IP fragments them.  A receiver acknowledging more than two
+// segments per ACK checks that the sender handles its stretch ACKs as
+// without offload, when they do not acknowledge super-segments.
+//
+class Ns3TcpTsoTestCase : public TestCase
+{
+public:
+  /**
+   * \param tsoSegments the TsoSegments attribute of the sockets
+   * \param offload1 the SegmentOffload attribute of the devices of n0-n1
+   * \param offload2 the SegmentOffload attribute of the devices of n1-n2
+   * \param rxDelAckCount the DelAckCount attribute of the receiver sockets
+   */
+  Ns3TcpTsoTestCase (uint32_t tsoSegments, bool offload1, bool offload2, uint32_t rxDelAckCount = 2);
+  virtual ~Ns3TcpTsoTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Run the transfer.
+   * \param tsoSegments the TsoSegments attribute of the sockets
+   * \param offload1 the SegmentOffload attribute of the devices of n0-n1
+   * \param offload2 the SegmentOffload attribute of the devices of n1-n2
+   * \param time set to the time when the last byte is received
+   * \param packets set to the number of packets sent by n0
+   * \returns the number of bytes received
+   */
+  uint64_t Run (uint32_t tsoSegments, bool offload1, bool offload2, Time &time, uint32_t &packets);
+
+  void SinkRx (Ptr<const Packet> p, const Address &address);
+  void MacTx (Ptr<const Packet> p);
+
+  uint32_t m_tsoSegments;
+  bool m_offload1;
+  bool m_offload2;
+  uint32_t m_rxDelAckCount;
+  uint64_t m_rxBytes;
+  Time m_lastRx;
+  uint32_t m_txPackets;
+};
+
+Ns3TcpTsoTestCase::Ns3TcpTsoTestCase (uint32_t tsoSegments, bool offload1, bool offload2,
+                                      uint32_t rxDelAckCount)
+  : TestCase ("Check a transfer with TCP segment offload against the exact one, device offload "
+              + std::string (offload1 ? "on" : "off") + " on the first link, "
+              + std::string (offload2 ? "on" : "off") + " on the second, receiver DelAckCount "
+              + std::to_string (rxDelAckCount)),
+    m_tsoSegments (tsoSegments),
+    m_offload1 (offload1),
+    m_offload2 (offload2),
+    m_rxDelAckCount (rxDelAckCount)
+{
+}
+
+void
+Ns3TcpTsoTestCase::SinkRx (Ptr<const Packet> p, const Address &address)
+{
+  m_rxBytes += p->GetSize ();
+  m_lastRx = Simulator::Now ();
+}
+
+void
+Ns3TcpTsoTestCase::MacTx (Ptr<const Packet> p)
+{
+  m_txPackets++;
+}
+
+uint64_t
+Ns3TcpTsoTestCase::Run (uint32_t tsoSegments, bool offload1, bool offload2, Time &time, uint32_t &packets)
+{
+  uint16_t sinkPort = 50000;
+  uint32_t totalBytes = 2000000;
+  m_rxBytes = 0;
+  m_lastRx = Seconds (0);
+  m_txPackets = 0;
+
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1400));
+  Config::SetDefault ("ns3::TcpSocketBase::TsoSegments", UintegerValue (tsoSegments));
+
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("100Mbps"));
+  pointToPoint.SetDeviceAttribute ("SegmentOffload", BooleanValue (offload1));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer devices1 = pointToPoint.Install (nodes.Get (0), nodes.Get (1));
+
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  pointToPoint.SetDeviceAttribute ("SegmentOffload", BooleanValue (offload2));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("10ms"));
+  NetDeviceContainer devices2 = pointToPoint.Install (nodes.Get (1), nodes.Get (2));
+
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  address.Assign (devices1);
+  address.SetBase ("10.1.2.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces2 = address.Assign (devices2);
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  BulkSendHelper source ("ns3::TcpSocketFactory",
+                         InetSocketAddress (interfaces2.GetAddress (1), sinkPort));
+  source.SetAttribute ("MaxBytes", UintegerValue (totalBytes));
+  ApplicationContainer sourceApps = source.Install (nodes.Get (0));
+  sourceApps.Start (Seconds (0.0));
+
+  PacketSinkHelper sink ("ns3::TcpSocketFactory",
+                         InetSocketAddress (Ipv4Address::GetAny (), sinkPort));
+  ApplicationContainer sinkApps = sink.Install (nodes.Get (2));
+  sinkApps.Start (Seconds (0.0));
+  // Before the connection is accepted, so that the accepted socket inherits it
+  Simulator::Schedule (MilliSeconds (1), &Config::Set,
+                       "/NodeList/2/$ns3::TcpL4Protocol/SocketList/*/DelAckCount",
+                       UintegerValue (m_rxDelAckCount));
+  sinkApps.Get (0)->TraceConnectWithoutContext ("Rx", MakeCallback (&Ns3TcpTsoTestCase::SinkRx, this));
+  devices1.Get (0)->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&Ns3TcpTsoTestCase::MacTx, this));
+
+  Simulator::Stop (Seconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  time = m_lastRx;
+  packets = m_txPackets;
+  return m_rxBytes;
+}
+
+void
+Ns3TcpTsoTestCase::DoRun (void)
+{
+  Time exactTime;
+  uint32_t exactPackets;
+  uint64_t exactBytes = Run (1, false, false, exactTime, exactPackets);
+  NS_TEST_ASSERT_MSG_EQ (exactBytes, 2000000, "The exact transfer is not complete");
+
+  Time tsoTime;
+  uint32_t tsoPackets;
+  uint64_t tsoBytes = Run (m_tsoSegments, m_offload1, m_offload2, tsoTime, tsoPackets);
+  NS_TEST_ASSERT_MSG_EQ (tsoBytes, 2000000, "The transfer with offload is not complete");
+
+  if (!m_offload1)
+    {
+      // The super-segments are split by TCP into the exact segments
+      NS_TEST_ASSERT_MSG_EQ (tsoTime, exactTime, "The split super-segments differ from the segments");
+      NS_TEST_ASSERT_MSG_EQ (tsoPackets, exactPackets, "The split super-segments differ from the segments");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_LT (tsoPackets * 4, exactPackets,
+                             "The super-segments are not sent as single packets");
+    }
+  if (m_offload1 && m_offload2)
+    {
+      // Each hop stores and forwards a whole super-segment, which delays
+      // its last bytes by less than a super-segment time at the bottleneck
+      NS_TEST_ASSERT_MSG_EQ_TOL (tsoTime.GetSeconds (), exactTime.GetSeconds (), exactTime.GetSeconds () * 0.03,
+                                 "The transfer time with offload differs from the exact one");
+    }
+
+  Config::Reset ();
+}
+
+class Ns3TcpTsoTestSuite : public TestSuite
+{
+public:
+  Ns3TcpTsoTestSuite ();
+};
+
+Ns3TcpTsoTestSuite::Ns3TcpTsoTestSuite ()
+  : TestSuite ("ns3-tcp-tso", SYSTEM)
+{
+  AddTestCase (new Ns3TcpTsoTestCase (16, true, true), TestCase::QUICK);
+  AddTestCase (new Ns3TcpTsoTestCase (16, true, false), TestCase::QUICK);
+  AddTestCase (new Ns3TcpTsoTestCase (16, false, false), TestCase::QUICK);
+  AddTestCase (new Ns3TcpTsoTestCase (16, false, false, 4), TestCase::QUICK);
+}
+
+static Ns3TcpTsoTestSuite ns3TcpTsoTestSuite;
@@ -0,0 +1,777 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/log.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "fq-codel-flat-queue-disc.h"
+#include "codel-queue-disc.h"
+#include "ns3/net-device-queue-interface.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FqCoDelFlatQueueDisc");
+
+/// Marks the end of the lists of flows and slots
+static const uint32_t NONE = 0xffffffff;
+
+/**
+ * Performs a reciprocal divide, similar to the
+ * Linux kernel reciprocal_divide function
+ * \param A numerator
+ * \param R reciprocal of the denominator B
+ * \return the value of A/B
+ */
+/* borrowed from the linux kernel */
+static inline uint32_t ReciprocalDivide (uint32_t A, uint32_t R)
+{
+  return (uint32_t)(((uint64_t)A * R) >> 32);
+}
+
+/* end kernel borrowings */
+
+/**
+ * Calculate the reciprocal square root of count by Newton's method
+ * \param recInvSqrt reciprocal value of sqrt (count)
+ * \param count count value
+ * \return The new recInvSqrt value
+ */
+static uint16_t NewtonStep (uint16_t recInvSqrt, uint32_t count)
+{
+  uint32_t invsqrt = ((uint32_t) recInvSqrt) << REC_INV_SQRT_SHIFT;
+  uint32_t invsqrt2 = ((uint64_t) invsqrt * invsqrt) >> 32;
+  uint64_t val = (3ll << 32) - ((uint64_t) count * invsqrt2);
+
+  val >>= 2; /* avoid overflow */
+  val = (val * invsqrt) >> (32 - 2 + 1);
+  return static_cast<uint16_t>(val >> REC_INV_SQRT_SHIFT);
+}
+
+/**
+ * Determine the time for next drop
+ * \param t Current next drop time
+ * \param interval interval in CoDel time units
+ * \param recInvSqrt reciprocal value of sqrt (count)
+ * \return Time for next drop
+ */
+static uint32_t ControlLaw (uint32_t t, uint32_t interval, uint32_t recInvSqrt)
+{
+  return t + ReciprocalDivide (interval, recInvSqrt << REC_INV_SQRT_SHIFT);
+}
+
+/**
+ * \param a first CoDel time
+ * \param b second CoDel time
+ * \return true if a is after b
+ */
+static inline bool CoDelTimeAfter (uint32_t a, uint32_t b)
+{
+  return ((int64_t)(a) - (int64_t)(b) > 0);
+}
+
+/**
+ * \param a first CoDel time
+ * \param b second CoDel time
+ * \return true if a is after or equal to b
+ */
+static inline bool CoDelTimeAfterEq (uint32_t a, uint32_t b)
+{
+  return ((int64_t)(a) - (int64_t)(b) >= 0);
+}
+
+/**
+ * \param a first CoDel time
+ * \param b second CoDel time
+ * \return true if a is before b
+ */
+static inline bool CoDelTimeBefore (uint32_t a, uint32_t b)
+{
+  return ((int64_t)(a) - (int64_t)(b) < 0);
+}
+
+/**
+ * \param t a time
+ * \return the time in CoDel time units
+ */
+static inline uint32_t Time2CoDel (Time t)
+{
+  return static_cast<uint32_t>(t.GetNanoSeconds () >> CODEL_SHIFT);
+}
+
+NS_OBJECT_ENSURE_REGISTERED (FqCoDelFlatQueueDisc);
+
+TypeId FqCoDelFlatQueueDisc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FqCoDelFlatQueueDisc")
+    .SetParent<QueueDisc> ()
+    .SetGroupName ("TrafficControl")
+    .AddConstructor<FqCoDelFlatQueueDisc> ()
+    .AddAttribute ("UseEcn",
+                   "True to use ECN (packets are marked instead of being dropped)",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&FqCoDelFlatQueueDisc::m_useEcn),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Interval",
+                   "The CoDel algorithm interval for each FQCoDel queue",
+                   StringValue ("100ms"),
+                   MakeStringAccessor (&FqCoDelFlatQueueDisc::m_interval),
+                   MakeStringChecker ())
+    .AddAttribute ("Target",
+                   "The CoDel algorithm target queue delay for each FQCoDel queue",
+                   StringValue ("5ms"),
+                   MakeStringAccessor (&FqCoDelFlatQueueDisc::m_target),
+                   MakeStringChecker ())
+    .AddAttribute ("MinBytes",
+                   "The CoDel algorithm minbytes parameter for each FQCoDel queue",
+                   UintegerValue (1500),
+                   MakeUintegerAccessor (&FqCoDelFlatQueueDisc::m_minBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxSize",
+                   "The maximum number of packets accepted by this queue disc",
+                   QueueSizeValue (QueueSize ("10240p")),
+                   MakeQueueSizeAccessor (&QueueDisc::SetMaxSize,
+                                          &QueueDisc::GetMaxSize),
+                   MakeQueueSizeChecker ())
+    .AddAttribute ("Flows",
+                   "The number of queues into which the incoming packets are classified",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&FqCoDelFlatQueueDisc::m_flows),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("DropBatchSize",
+                   "The maximum number of packets dropped from the fat flow",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&FqCoDelFlatQueueDisc::m_dropBatchSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Perturbation",
+                   "The salt used as an additional input to the hash function used to classify packets",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&FqCoDelFlatQueueDisc::m_perturbation),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("CeThreshold",
+                   "The FqCoDel CE threshold for marking packets",
+                   TimeValue (Time::Max ()),
+                   MakeTimeAccessor (&FqCoDelFlatQueueDisc::m_ceThreshold),
+                   MakeTimeChecker ())
+    .AddAttribute ("EnableSetAssociativeHash",
+                   "Enable/Disable Set Associative Hash",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&FqCoDelFlatQueueDisc::m_enableSetAssociativeHash),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SetWays",
+                   "The size of a set of queues (used by set associative hash)",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&FqCoDelFlatQueueDisc::m_setWays),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("UseL4s",
+                   "True to use L4S (only ECT1 packets are marked at CE threshold)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&FqCoDelFlatQueueDisc::m_useL4s),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+FqCoDelFlatQueueDisc::FqCoDelFlatQueueDisc ()
+  : QueueDisc (QueueDiscSizePolicy::MULTIPLE_QUEUES, QueueSizeUnit::PACKETS),
+    m_quantum (0),
+    m_freeSlot (NONE)
+{
+  NS_LOG_FUNCTION (this);
+  m_newFlows.head = m_newFlows.tail = NONE;
+  m_oldFlows.head = m_oldFlows.tail = NONE;
+}
+
+FqCoDelFlatQueueDisc::~FqCoDelFlatQueueDisc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FqCoDelFlatQueueDisc::SetQuantum (uint32_t quantum)
+{
+  NS_LOG_FUNCTION (this << quantum);
+  m_quantum = quantum;
+}
+
+uint32_t
+FqCoDelFlatQueueDisc::GetQuantum (void) const
+{
+  return m_quantum;
+}
+
+uint32_t
+FqCoDelFlatQueueDisc::GetNFlowQueues (void) const
+{
+  return m_created.size ();
+}
+
+uint32_t
+FqCoDelFlatQueueDisc::GetFlowQueueNPackets (uint32_t i) const
+{
+  NS_ASSERT (i < m_created.size ());
+  return m_flowTable[m_created[i]].nPackets;
+}
+
+void
+FqCoDelFlatQueueDisc::PushBack (FlowList &list, uint32_t index)
+{
+  m_flowTable[index].next = NONE;
+  if (list.tail == NONE)
+    {
+      list.head = index;
+    }
+  else
+    {
+      m_flowTable[list.tail].next = index;
+    }
+  list.tail = index;
+}
+
+void
+FqCoDelFlatQueueDisc::PopFront (FlowList &list)
+{
+  NS_ASSERT (list.head != NONE);
+  list.head = m_flowTable[list.head].next;
+  if (list.head == NONE)
+    {
+      list.tail = NONE;
+    }
+}
+
+void
+FqCoDelFlatQueueDisc::FlowEnqueue (Flow &flow, Ptr<QueueDiscItem> item)
+{
+  uint32_t slot = m_freeSlot;
+  if (slot == NONE)
+    {
+      slot = m_slots.size ();
+      m_slots.push_back (Slot ());
+    }
+  else
+    {
+      m_freeSlot = m_slots[slot].next;
+    }
+  m_slots[slot].item = item;
+  m_slots[slot].next = NONE;
+  if (flow.tail == NONE)
+    {
+      flow.head = slot;
+    }
+  else
+    {
+      m_slots[flow.tail].next = slot;
+    }
+  flow.tail = slot;
+  flow.nPackets++;
+  flow.nBytes += item->GetSize ();
+  PacketEnqueued (item);
+}
+
+Ptr<QueueDiscItem>
+FqCoDelFlatQueueDisc::FlowDequeue (Flow &flow)
+{
+  if (flow.head == NONE)
+    {
+      return 0;
+    }
+  uint32_t slot = flow.head;
+  Ptr<QueueDiscItem> item = m_slots[slot].item;
+  m_slots[slot].item = 0;
+  flow.head = m_slots[slot].next;
+  if (flow.head == NONE)
+    {
+      flow.tail = NONE;
+    }
+  m_slots[slot].next = m_freeSlot;
+  m_freeSlot = slot;
+  flow.nPackets--;
+  flow.nBytes -= item->GetSize ();
+  PacketDequeued (item);
+  return item;
+}
+
+uint32_t
+FqCoDelFlatQueueDisc::SetAssociativeHash (uint32_t flowHash)
+{
+  NS_LOG_FUNCTION (this << flowHash);
+
+  uint32_t h = (flowHash % m_flows);
+  uint32_t innerHash = h % m_setWays;
+  uint32_t outerHash = h - innerHash;
+
+  for (uint32_t i = outerHash; i < outerHash + m_setWays; i++)
+    {
+      Flow &flow = m_flowTable[i];
+
+      if (!flow.created || (flow.tagged && flow.tag == flowHash) || flow.status == INACTIVE)
+        {
+          // this queue has not been created yet or is associated with this flow
+          // or is inactive, hence we can use it
+          flow.tagged = true;
+          flow.tag = flowHash;
+          return i;
+        }
+    }
+
+  // all the queues of the set are used. Use the first queue of the set
+  m_flowTable[outerHash].tagged = true;
+  m_flowTable[outerHash].tag = flowHash;
+  return outerHash;
+}
+
+bool
+FqCoDelFlatQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
+{
+  NS_LOG_FUNCTION (this << item);
+
+  uint32_t flowHash, h;
+
+  if (GetNPacketFilters () == 0)
+    {
+      flowHash = item->Hash (m_perturbation);
+    }
+  else
+    {
+      int32_t ret = Classify (item);
+
+      if (ret != PacketFilter::PF_NO_MATCH)
+        {
+          flowHash = static_cast<uint32_t> (ret);
+        }
+      else
+        {
+          NS_LOG_ERROR ("No filter has been able to classify this packet, drop it.");
+          DropBeforeEnqueue (item, UNCLASSIFIED_DROP);
+          return false;
+        }
+    }
+
+  if (m_enableSetAssociativeHash)
+    {
+      h = SetAssociativeHash (flowHash);
+    }
+  else
+    {
+      h = flowHash % m_flows;
+    }
+
+  Flow &flow = m_flowTable[h];
+  if (!flow.created)
+    {
+      NS_LOG_DEBUG ("Using flow queue " << h << " for the first time");
+      flow.created = true;
+      m_created.push_back (h);
+    }
+
+  if (flow.status == INACTIVE)
+    {
+      flow.status = NEW_FLOW;
+      flow.deficit = m_quantum;
+      PushBack (m_newFlows, h);
+    }
+
+  // Each flow queue accepts as many packets as the whole queue disc, as the
+  // CoDel queue disc of a FqCoDelQueueDisc flow does
+  if (flow.nPackets >= GetMaxSize ().GetValue ())
+    {
+      NS_LOG_LOGIC ("Flow queue full -- dropping pkt");
+      DropBeforeEnqueue (item, CoDelQueueDisc::OVERLIMIT_DROP);
+      return false;
+    }
+
+  item->SetTimeStamp (Simulator::Now ());
+  FlowEnqueue (flow, item);
+
+  NS_LOG_DEBUG ("Packet enqueued into flow " << h);
+
+  if (GetCurrentSize () > GetMaxSize ())
+    {
+      NS_LOG_DEBUG ("Overload; enter FqCodelDrop ()");
+      FqCoDelDrop ();
+    }
+
+  return true;
+}
+
+bool
+FqCoDelFlatQueueDisc::OkToDrop (Flow &flow, Ptr<QueueDiscItem> item, uint32_t now)
+{
+  NS_LOG_FUNCTION (this);
+  bool okToDrop;
+
+  if (!item)
+    {
+      flow.firstAboveTime = 0;
+      return false;
+    }
+
+  uint32_t sojournTime = Time2CoDel (Simulator::Now () - item->GetTimeStamp ());
+
+  if (CoDelTimeBefore (sojournTime, m_codelTarget) || flow.nBytes < m_minBytes)
+    {
+      // went below so we'll stay below for at least q->interval
+      flow.firstAboveTime = 0;
+      return false;
+    }
+  okToDrop = false;
+  if (flow.firstAboveTime == 0)
+    {
+      /* just went above from below. If we stay above
+       * for at least q->interval we'll say it's ok to drop
+       */
+      flow.firstAboveTime = now + m_codelInterval;
+    }
+  else if (CoDelTimeAfter (now, flow.firstAboveTime))
+    {
+      okToDrop = true;
+    }
+  return okToDrop;
+}
+
+Ptr<QueueDiscItem>
+FqCoDelFlatQueueDisc::CoDelDequeue (Flow &flow)
+{
+  NS_LOG_FUNCTION (this);
+
+  // This is CoDelQueueDisc::DoDequeue, working on the state of the flow
+  Ptr<QueueDiscItem> item = FlowDequeue (flow);
+  if (!item)
+    {
+      // Leave dropping state when queue is empty
+      flow.dropping = false;
+      return 0;
+    }
+  uint32_t ldelay = Time2CoDel (Simulator::Now () - item->GetTimeStamp ());
+  if (m_useL4s)
+    {
+      uint8_t tosByte = 0;
+      if (item->GetUint8Value (QueueItem::IP_DSFIELD, tosByte) && (((tosByte & 0x3) == 1) || (tosByte & 0x3) == 3))
+        {
+          if (CoDelTimeAfter (ldelay, m_codelCeThreshold) && Mark (item, CoDelQueueDisc::CE_THRESHOLD_EXCEEDED_MARK))
+            {
+              NS_LOG_LOGIC ("Marking due to CeThreshold " << m_ceThreshold.GetSeconds ());
+            }
+          return item;
+        }
+    }
+
+  uint32_t now = static_cast<uint32_t> (Simulator::Now ().GetNanoSeconds () >> CODEL_SHIFT);
+
+  // Determine if item should be dropped
+  bool okToDrop = OkToDrop (flow, item, now);
+  bool isMarked = false;
+
+  if (flow.dropping)
+    {
+      if (!okToDrop)
+        {
+          /* sojourn time fell below target - leave dropping state */
+          flow.dropping = false;
+        }
+      else if (CoDelTimeAfterEq (now, flow.dropNext))
+        {
+          while (flow.dropping && CoDelTimeAfterEq (now, flow.dropNext))
+            {
+              ++flow.count;
+              flow.recInvSqrt = NewtonStep (flow.recInvSqrt, flow.count);
+              if (m_useEcn && Mark (item, CoDelQueueDisc::TARGET_EXCEEDED_MARK))
+                {
+                  isMarked = true;
+                  flow.dropNext = ControlLaw (now, m_codelInterval, flow.recInvSqrt);
+                  break;
+                }
+              NS_LOG_LOGIC ("Sojourn time is still above target and it's time for next drop; dropping " << item);
+              DropAfterDequeue (item, CoDelQueueDisc::TARGET_EXCEEDED_DROP);
+
+              item = FlowDequeue (flow);
+
+              if (!OkToDrop (flow, item, now))
+                {
+                  /* leave dropping state */
+                  flow.dropping = false;
+                }
+              else
+                {
+                  /* schedule the next drop */
+                  flow.dropNext = ControlLaw (flow.dropNext, m_codelInterval, flow.recInvSqrt);
+                }
+            }
+        }
+    }
+  else if (okToDrop)
+    {
+      // Not in the dropping state: enter it and drop or mark the first packet
+      if (m_useEcn && Mark (item, CoDelQueueDisc::TARGET_EXCEEDED_MARK))
+        {
+          isMarked = true;
+        }
+      else
+        {
+          NS_LOG_LOGIC ("Sojourn time goes above target, dropping the first packet " << item << " and entering the dropping state");
+          DropAfterDequeue (item, CoDelQueueDisc::TARGET_EXCEEDED_DROP);
+          item = FlowDequeue (flow);
+          OkToDrop (flow, item, now);
+        }
+      flow.dropping = true;
+      /*
+       * if min went above target close to when we last went below it
+       * assume that the drop rate that controlled the queue on the
+       * last cycle is a good starting point to control it now.
+       */
+      int delta = flow.count - flow.lastCount;
+      if (delta > 1 && CoDelTimeBefore (now - flow.dropNext, 16 * m_codelInterval))
+        {
+          flow.count = delta;
+          flow.recInvSqrt = NewtonStep (flow.recInvSqrt, flow.count);
+        }
+      else
+        {
+          flow.count = 1;
+          flow.recInvSqrt = ~0U >> REC_INV_SQRT_SHIFT;
+        }
+      flow.lastCount = flow.count;
+      flow.dropNext = ControlLaw (now, m_codelInterval, flow.recInvSqrt);
+    }
+
+  // As in Linux, the CE threshold applies to packets not marked above
+  if (!isMarked && item && !m_useL4s && m_useEcn)
+    {
+      ldelay = Time2CoDel (Simulator::Now () - item->GetTimeStamp ());
+      if (CoDelTimeAfter (ldelay, m_codelCeThreshold) && Mark (item, CoDelQueueDisc::CE_THRESHOLD_EXCEEDED_MARK))
+        {
+          NS_LOG_LOGIC ("Marking due to CeThreshold " << m_ceThreshold.GetSeconds ());
+        }
+    }
+  return item;
+}
+
+Ptr<QueueDiscItem>
+FqCoDelFlatQueueDisc::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t index = NONE;
+  Ptr<QueueDiscItem> item;
+
+  do
+    {
+      bool found = false;
+
+      while (!found && m_newFlows.head != NONE)
+        {
+          index = m_newFlows.head;
+          Flow &flow = m_flowTable[index];
+
+          if (flow.deficit <= 0)
+            {
+              NS_LOG_DEBUG ("Increase deficit for new flow index " << index);
+              flow.deficit += m_quantum;
+              flow.status = OLD_FLOW;
+              PopFront (m_newFlows);
+              PushBack (m_oldFlows, index);
+            }
+          else
+            {
+              NS_LOG_DEBUG ("Found a new flow " << index << " with positive deficit");
+              found = true;
+            }
+        }
+
+      while (!found && m_oldFlows.head != NONE)
+        {
+          index = m_oldFlows.head;
+          Flow &flow = m_flowTable[index];
+
+          if (flow.deficit <= 0)
+            {
+              NS_LOG_DEBUG ("Increase deficit for old flow index " << index);
+              flow.deficit += m_quantum;
+              PopFront (m_oldFlows);
+              PushBack (m_oldFlows, index);
+            }
+          else
+            {
+              NS_LOG_DEBUG ("Found an old flow " << index << " with positive deficit");
+              found = true;
+            }
+        }
+
+      if (!found)
+        {
+          NS_LOG_DEBUG ("No flow found to dequeue a packet");
+          return 0;
+        }
+
+      Flow &flow = m_flowTable[index];
+      item = CoDelDequeue (flow);
+
+      if (!item)
+        {
+          NS_LOG_DEBUG ("Could not get a packet from the selected flow queue");
+          if (m_newFlows.head != NONE)
+            {
+              flow.status = OLD_FLOW;
+              PopFront (m_newFlows);
+              PushBack (m_oldFlows, index);
+            }
+          else
+            {
+              flow.status = INACTIVE;
+              PopFront (m_oldFlows);
+            }
+        }
+      else
+        {
+          NS_LOG_DEBUG ("Dequeued packet " << item->GetPacket ());
+        }
+    } while (item == 0);
+
+  m_flowTable[index].deficit -= item->GetSize ();
+
+  return item;
+}
+
+bool
+FqCoDelFlatQueueDisc::CheckConfig (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (GetNQueueDiscClasses () > 0)
+    {
+      NS_LOG_ERROR ("FqCoDelFlatQueueDisc cannot have classes");
+      return false;
+    }
+
+  if (GetNInternalQueues () > 0)
+    {
+      NS_LOG_ERROR ("FqCoDelFlatQueueDisc cannot have internal queues");
+      return false;
+    }
+
+  // we are at initialization time. If the user has not set a quantum value,
+  // set the quantum to the MTU of the device (if any)
+  if (!m_quantum)
+    {
+      Ptr<NetDeviceQueueInterface> ndqi = GetNetDeviceQueueInterface ();
+      Ptr<NetDevice> dev;
+      // if the NetDeviceQueueInterface object is aggregated to a
+      // NetDevice, get the MTU of such NetDevice
+      if (ndqi && (dev = ndqi->GetObject<NetDevice> ()))
+        {
+          m_quantum = dev->GetMtu ();
+          NS_LOG_DEBUG ("Setting the quantum to the MTU of the device: " << m_quantum);
+        }
+
+      if (!m_quantum)
+        {
+          NS_LOG_ERROR ("The quantum parameter cannot be null");
+          return false;
+        }
+    }
+
+  if (m_flows == 0)
+    {
+      NS_LOG_ERROR ("The number of queues cannot be null");
+      return false;
+    }
+
+  if (m_enableSetAssociativeHash && (m_flows % m_setWays != 0))
+    {
+      NS_LOG_ERROR ("The number of queues must be an integer multiple of the size "
+                    "of the set of queues used by set associative hash");
+      return false;
+    }
+
+  if (m_useL4s)
+    {
+      NS_ABORT_MSG_IF (m_ceThreshold == Time::Max (), "CE threshold not set");
+      if (m_useEcn == false)
+        {
+          NS_LOG_WARN ("Enabling ECN as L4S mode is enabled");
+        }
+    }
+  return true;
+}
+
+void
+FqCoDelFlatQueueDisc::InitializeParams (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_codelInterval = Time2CoDel (Time (m_interval));
+  m_codelTarget = Time2CoDel (Time (m_target));
+  m_codelCeThreshold = Time2CoDel (m_ceThreshold);
+
+  Flow flow;
+  flow.deficit = 0;
+  flow.status = INACTIVE;
+  flow.next = NONE;
+  flow.head = NONE;
+  flow.tail = NONE;
+  flow.nPackets = 0;
+  flow.nBytes = 0;
+  flow.created = false;
+  flow.tagged = false;
+  flow.tag = 0;
+  flow.count = 0;
+  flow.lastCount = 0;
+  flow.dropping = false;
+  flow.recInvSqrt = ~0U >> REC_INV_SQRT_SHIFT;
+  flow.firstAboveTime = 0;
+  flow.dropNext = 0;
+  m_flowTable.assign (m_flows, flow);
+
+  // one more slot than the maximum size, taken by the packet which makes
+  // the queue disc overflow until the fat flow is trimmed
+  m_slots.reserve (GetMaxSize ().GetValue () + 1);
+}
+
+uint32_t
+FqCoDelFlatQueueDisc::FqCoDelDrop (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t maxBacklog = 0, index = m_created.front ();
+
+  /* Queue is full! Find the fat flow and drop packet(s) from it */
+  for (std::vector<uint32_t>::const_iterator i = m_created.begin (); i != m_created.end (); i++)
+    {
+      uint32_t bytes = m_flowTable[*i].nBytes;
+      if (bytes > maxBacklog)
+        {
+          maxBacklog = bytes;
+          index = *i;
+        }
+    }
+
+  /* Our goal is to drop half of this fat flow backlog */
+  uint32_t len = 0, count = 0, threshold = maxBacklog >> 1;
+  Flow &flow = m_flowTable[index];
+  Ptr<QueueDiscItem> item;
+
+  do
+    {
+      NS_LOG_DEBUG ("Drop packet (overflow); count: " << count << " len: " << len << " threshold: " << threshold);
+      item = FlowDequeue (flow);
+      DropAfterDequeue (item, OVERLIMIT_DROP);
+      len += item->GetSize ();
+    } while (++count < m_dropBatchSize && len < threshold);
+
+  return index;
+}
+
+} // namespace ns3
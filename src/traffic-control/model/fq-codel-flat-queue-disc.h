@@ -0,0 +1,230 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FQ_CODEL_FLAT_QUEUE_DISC
+#define FQ_CODEL_FLAT_QUEUE_DISC
+
+#include "ns3/queue-disc.h"
+#include "ns3/nstime.h"
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup traffic-control
+ *
+ * \brief A FqCoDel packet queue disc with flat flow state
+ *
+ * This queue disc schedules, marks and drops packets exactly like
+ * FqCoDelQueueDisc, but keeps the state of the flow queues in arrays
+ * instead of creating a FqCoDelFlow class and a CoDelQueueDisc for each
+ * flow:
+ *
+ * - the flow queue of a packet is the entry of a table indexed by the
+ *   hash of the packet, which holds the deficit, the status and the
+ *   CoDel state of the flow;
+ * - the new and old flows lists are linked through the table entries;
+ * - the packets are stored in a pool of slots shared by all the flows,
+ *   each flow queue being a list of slots.
+ *
+ * Nothing is allocated per flow or per packet once the pool has grown to
+ * the maximum size of the queue disc.  The attributes are those of
+ * FqCoDelQueueDisc, plus the MinBytes parameter of the CoDel algorithm,
+ * which FqCoDelQueueDisc takes from the defaults of CoDelQueueDisc.  The
+ * drops and marks of the CoDel algorithm are recorded with the reasons
+ * defined by CoDelQueueDisc, without the prefix FqCoDelQueueDisc adds to
+ * the reasons of its child queue discs.
+ */
+class FqCoDelFlatQueueDisc : public QueueDisc {
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief FqCoDelFlatQueueDisc constructor
+   */
+  FqCoDelFlatQueueDisc ();
+
+  virtual ~FqCoDelFlatQueueDisc ();
+
+  /**
+   * \brief Set the quantum value.
+   *
+   * \param quantum The number of bytes each queue gets to dequeue on each round of the scheduling algorithm
+   */
+  void SetQuantum (uint32_t quantum);
+
+  /**
+   * \brief Get the quantum value.
+   *
+   * \returns The number of bytes each queue gets to dequeue on each round of the scheduling algorithm
+   */
+  uint32_t GetQuantum (void) const;
+
+  /**
+   * \brief Get the number of flow queues used so far.
+   *
+   * \returns The number of flow queues that have received a packet
+   */
+  uint32_t GetNFlowQueues (void) const;
+
+  /**
+   * \brief Get the number of packets in a flow queue.
+   *
+   * \param i The index of the flow queue, in the order the flow queues
+   *        received their first packet
+   * \returns The number of packets in the flow queue
+   */
+  uint32_t GetFlowQueueNPackets (uint32_t i) const;
+
+  // Reasons for dropping packets
+  static constexpr const char* UNCLASSIFIED_DROP = "Unclassified drop";  //!< No packet filter able to classify packet
+  static constexpr const char* OVERLIMIT_DROP = "Overlimit drop";        //!< Overlimit dropped packets
+
+private:
+  virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
+  virtual Ptr<QueueDiscItem> DoDequeue (void);
+  virtual bool CheckConfig (void);
+  virtual void InitializeParams (void);
+
+  /// Used to determine the status of a flow queue
+  enum FlowStatus
+    {
+      INACTIVE,
+      NEW_FLOW,
+      OLD_FLOW
+    };
+
+  /// The state of a flow queue
+  struct Flow
+  {
+    int32_t deficit;          //!< the deficit for this flow
+    FlowStatus status;        //!< the status of this flow
+    uint32_t next;            //!< the next flow in the list of new or old flows
+    uint32_t head;            //!< the slot of the first packet
+    uint32_t tail;            //!< the slot of the last packet
+    uint32_t nPackets;        //!< the number of packets
+    uint32_t nBytes;          //!< the number of bytes
+    bool created;             //!< whether this flow received a packet
+    bool tagged;              //!< whether tag is set
+    uint32_t tag;             //!< the hash of the flow, used by set associative hash
+    uint32_t count;           //!< CoDel count
+    uint32_t lastCount;       //!< CoDel lastcount
+    bool dropping;            //!< True if in CoDel dropping state
+    uint16_t recInvSqrt;      //!< Reciprocal inverse square root
+    uint32_t firstAboveTime;  //!< Time to declare sojourn time above target
+    uint32_t dropNext;        //!< Time to drop next packet
+  };
+
+  /// A list of flows linked through Flow::next
+  struct FlowList
+  {
+    uint32_t head; //!< the first flow
+    uint32_t tail; //!< the last flow
+  };
+
+  /// A slot of the packet pool
+  struct Slot
+  {
+    Ptr<QueueDiscItem> item; //!< the packet
+    uint32_t next;           //!< the next slot of the flow queue, or of the free list
+  };
+
+  /**
+   * \brief Append a flow to a list
+   * \param list the list
+   * \param index the index of the flow
+   */
+  void PushBack (FlowList &list, uint32_t index);
+  /**
+   * \brief Remove the first flow of a list
+   * \param list the list
+   */
+  void PopFront (FlowList &list);
+
+  /**
+   * \brief Append a packet to a flow queue
+   * \param flow the flow
+   * \param item the packet
+   */
+  void FlowEnqueue (Flow &flow, Ptr<QueueDiscItem> item);
+  /**
+   * \brief Take the first packet out of a flow queue
+   * \param flow the flow
+   * \return the packet, or 0 if the flow queue is empty
+   */
+  Ptr<QueueDiscItem> FlowDequeue (Flow &flow);
+
+  /**
+   * \brief Dequeue a packet from a flow queue with the CoDel algorithm
+   * \param flow the flow
+   * \return the packet, or 0 if the flow queue is empty
+   */
+  Ptr<QueueDiscItem> CoDelDequeue (Flow &flow);
+  /**
+   * \brief Check if a packet needs to be dropped due to sojourn time
+   * \param flow the flow
+   * \param item the packet
+   * \param now the current time in CoDel time units
+   * \return true if the packet may be dropped
+   */
+  bool OkToDrop (Flow &flow, Ptr<QueueDiscItem> item, uint32_t now);
+
+  /**
+   * \brief Drop a packet from the head of the queue with the largest current byte count
+   * \return the index of the queue with the largest current byte count
+   */
+  uint32_t FqCoDelDrop (void);
+
+  /**
+   * Compute the index of the queue for the flow having the given flowHash,
+   * according to the set associative hash approach.
+   *
+   * \param flowHash the hash of the flow 5-tuple
+   * \return the index of the queue for the given flow
+   */
+  uint32_t SetAssociativeHash (uint32_t flowHash);
+
+  bool m_useEcn;             //!< True if ECN is used (packets are marked instead of being dropped)
+  std::string m_interval;    //!< CoDel interval attribute
+  std::string m_target;      //!< CoDel target attribute
+  uint32_t m_minBytes;       //!< CoDel minbytes attribute
+  uint32_t m_quantum;        //!< Deficit assigned to flows at each round
+  uint32_t m_flows;          //!< Number of flow queues
+  uint32_t m_setWays;        //!< size of a set of queues (used by set associative hash)
+  uint32_t m_dropBatchSize;  //!< Max number of packets dropped from the fat flow
+  uint32_t m_perturbation;   //!< hash perturbation value
+  Time m_ceThreshold;        //!< Threshold above which to CE mark
+  bool m_enableSetAssociativeHash; //!< whether to enable set associative hash
+  bool m_useL4s;             //!< True if L4S is used (ECT1 packets are marked at CE threshold)
+
+  uint32_t m_codelInterval;  //!< CoDel interval in CoDel time units
+  uint32_t m_codelTarget;    //!< CoDel target in CoDel time units
+  uint32_t m_codelCeThreshold; //!< CE threshold in CoDel time units
+
+  std::vector<Flow> m_flowTable;    //!< The flow queues, indexed by hash
+  std::vector<uint32_t> m_created;  //!< The flows that received a packet, in order
+  std::vector<Slot> m_slots;        //!< The packet pool
+  uint32_t m_freeSlot;              //!< The first free slot of the pool
+  FlowList m_newFlows;              //!< The list of new flows
+  FlowList m_oldFlows;              //!< The list of old flows
+};
+
+} // namespace ns3
+
+#endif /* FQ_CODEL_FLAT_QUEUE_DISC */
@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// This program measures the time taken by Config::Set, Config::Connect
+// and Config::LookupMatches on wildcard paths as the NodeList grows.
+// Each node has two SimpleNetDevices.
+// Sample usage:
+//   ./waf --run 'bench-config --sizes=100,1000,3000,10000 --repeat=10'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include <sys/time.h>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \returns the wall clock time in milliseconds
+ */
+static double
+GetMs (void)
+{
+  struct timeval tv;
+  gettimeofday (&tv, 0);
+  return tv.tv_sec * 1e3 + tv.tv_usec / 1e3;
+}
+
+/**
+ * Trace sink connected by the benchmark.
+ * \param context The trace context.
+ * \param p The packet.
+ */
+static void
+Drop (std::string context, Ptr<const Packet> p)
+{
+}
+
+int main (int argc, char *argv[])
+{
+  std::string sizes ("100,1000,3000");
+  uint32_t repeat = 10;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the resolution of Config paths");
+  cmd.AddValue ("sizes", "Comma-separated numbers of nodes", sizes);
+  cmd.AddValue ("repeat", "Number of times each operation is run", repeat);
+  cmd.Parse (argc, argv);
+
+  const char *setPath = "/NodeList/*/DeviceList/*/$ns3::SimpleNetDevice/DataRate";
+  const char *connectPath = "/NodeList/*/DeviceList/*/PhyRxDrop";
+  const char *indexPath = "/NodeList/[10-19]|42/DeviceList/1";
+
+  std::cout << std::setw (8) << "nodes" << std::setw (14) << "Set (ms)"
+            << std::setw (14) << "Connect (ms)" << std::setw (14) << "Index (ms)"
+            << std::setw (10) << "matches" << std::endl;
+
+  NodeContainer nodes;
+  SimpleNetDeviceHelper helper;
+  std::istringstream iss (sizes);
+  std::string size;
+  while (std::getline (iss, size, ','))
+    {
+      uint32_t n = std::atoi (size.c_str ());
+      if (n > nodes.GetN ())
+        {
+          NodeContainer added;
+          added.Create (n - nodes.GetN ());
+          helper.Install (added);
+          helper.Install (added);
+          nodes.Add (added);
+        }
+
+      double start = GetMs ();
+      for (uint32_t i = 0; i < repeat; i++)
+        {
+          Config::Set (setPath, DataRateValue (DataRate (1000000 + i)));
+        }
+      double setMs = (GetMs () - start) / repeat;
+
+      start = GetMs ();
+      for (uint32_t i = 0; i < repeat; i++)
+        {
+          Config::Connect (connectPath, MakeCallback (&Drop));
+          Config::Disconnect (connectPath, MakeCallback (&Drop));
+        }
+      double connectMs = (GetMs () - start) / repeat / 2;
+
+      uint32_t matches = 0;
+      start = GetMs ();
+      for (uint32_t i = 0; i < repeat; i++)
+        {
+          matches = Config::LookupMatches (indexPath).GetN ();
+        }
+      double indexMs = (GetMs () - start) / repeat;
+
+      std::cout << std::setw (8) << nodes.GetN () << std::fixed << std::setprecision (3)
+                << std::setw (14) << setMs << std::setw (14) << connectMs
+                << std::setw (14) << indexMs << std::setw (10) << matches << std::endl;
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
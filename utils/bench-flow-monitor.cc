@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// This program measures the cost of a FlowMonitor: it runs many UDP flows
+// over a point-to-point link, with or without a FlowMonitor installed on
+// both nodes, and reports the wall clock time of the simulation.
+// Sample usage:
+//   ./waf --run 'bench-flow-monitor --flows=1000 --monitor=1 --sampling=1'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/flow-monitor-module.h"
+#include <sys/time.h>
+#include <iostream>
+
+using namespace ns3;
+
+/**
+ * \return the wall clock time, in ms
+ */
+static double
+GetWallTimeMs (void)
+{
+  struct timeval tv;
+  gettimeofday (&tv, 0);
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nFlows = 1000;
+  bool monitor = true;
+  uint32_t sampling = 1;
+  double stop = 10;
+  std::string stream;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the overhead of a FlowMonitor");
+  cmd.AddValue ("flows", "Number of UDP flows", nFlows);
+  cmd.AddValue ("monitor", "Install a FlowMonitor", monitor);
+  cmd.AddValue ("sampling", "FlowMonitor sampling interval", sampling);
+  cmd.AddValue ("stop", "Simulation duration, in seconds", stop);
+  cmd.AddValue ("stream", "Stream the flow statistics to this file", stream);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Gbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  NetDeviceContainer devices = p2p.Install (nodes);
+
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+  PacketSinkHelper sink ("ns3::UdpSocketFactory", Address ());
+  OnOffHelper onoff ("ns3::UdpSocketFactory", Address ());
+  onoff.SetConstantRate (DataRate ("1Mbps"), 500);
+  ApplicationContainer apps;
+  for (uint32_t i = 0; i < nFlows; i++)
+    {
+      uint16_t port = 1000 + i;
+      sink.SetAttribute ("Local", AddressValue (InetSocketAddress (Ipv4Address::GetAny (), port)));
+      apps.Add (sink.Install (nodes.Get (1)));
+      onoff.SetAttribute ("Remote", AddressValue (InetSocketAddress (interfaces.GetAddress (1), port)));
+      apps.Add (onoff.Install (nodes.Get (0)));
+    }
+  apps.Start (Seconds (0));
+  apps.Stop (Seconds (stop));
+
+  FlowMonitorHelper flowmon;
+  Ptr<FlowMonitor> monitorPtr;
+  if (monitor)
+    {
+      flowmon.SetMonitorAttribute ("SamplingInterval", UintegerValue (sampling));
+      monitorPtr = flowmon.InstallAll ();
+      if (!stream.empty ())
+        {
+          monitorPtr->StartStreaming (stream);
+        }
+    }
+
+  Simulator::Stop (Seconds (stop + 1));
+  double start = GetWallTimeMs ();
+  Simulator::Run ();
+  double end = GetWallTimeMs ();
+  if (monitorPtr && !stream.empty ())
+    {
+      monitorPtr->StopStreaming ();
+    }
+
+  std::cout << "bench-flow-monitor " << nFlows << " flows, monitor " << monitor
+            << ", sampling " << sampling << ": " << end - start << " ms";
+  if (monitor)
+    {
+      std::cout << ", " << monitorPtr->GetFlowStats ().size () << " flows monitored";
+    }
+  std::cout << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
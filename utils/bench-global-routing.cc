@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// This program measures the time and the peak memory needed to populate
+// the global routing tables of a topology read by a TopologyReader, with
+// one point-to-point link per link of the topology.
+// Sample usage:
+//   ./waf --run 'bench-global-routing --format=Rocketfuel
+//       --input=src/topology-read/examples/RocketFuel_toposample_1239_weights.txt'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/topology-read-module.h"
+#include "ns3/global-route-manager.h"
+#include <sys/resource.h>
+#include <iostream>
+
+using namespace ns3;
+
+/**
+ * \return the peak resident set size of the process, in kB
+ */
+static long
+GetPeakRss (void)
+{
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string format ("Inet");
+  std::string input ("src/topology-read/examples/Inet_small_toposample.txt");
+  uint32_t threads = 1;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the global routing table computation");
+  cmd.AddValue ("format", "Format of the input file [Orbis|Inet|Rocketfuel]", format);
+  cmd.AddValue ("input", "Name of the input file", input);
+  cmd.AddValue ("threads", "Number of threads running the SPF calculations", threads);
+  cmd.Parse (argc, argv);
+
+  TopologyReaderHelper topoHelp;
+  topoHelp.SetFileName (input);
+  topoHelp.SetFileType (format);
+  Ptr<TopologyReader> reader = topoHelp.GetTopologyReader ();
+  if (reader == 0)
+    {
+      std::cerr << "Error-- unknown topology format " << format << std::endl;
+      exit (1);
+    }
+  NodeContainer nodes = reader->Read ();
+  if (reader->LinksSize () == 0)
+    {
+      std::cerr << "Error-- could not read any link from " << input << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-global-routing with " << nodes.GetN () << " nodes and "
+            << reader->LinksSize () << " links from " << input << std::endl;
+
+  InternetStackHelper stack;
+  Ipv4GlobalRoutingHelper globalRouting;
+  stack.SetRoutingHelper (globalRouting);
+  stack.Install (nodes);
+
+  PointToPointHelper p2p;
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.252");
+  for (TopologyReader::ConstLinksIterator i = reader->LinksBegin (); i != reader->LinksEnd (); i++)
+    {
+      NetDeviceContainer devices = p2p.Install (i->GetFromNode (), i->GetToNode ());
+      address.Assign (devices);
+      address.NewNetwork ();
+    }
+
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (threads));
+  long rssBefore = GetPeakRss ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  long rssLsdb = GetPeakRss ();
+  GlobalRouteManager::InitializeRoutes ();
+  long rssAfter = GetPeakRss ();
+
+  uint64_t nRoutes = 0;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<Ipv4> ()
+        ->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+      nRoutes += routing->GetNRoutes ();
+    }
+  GlobalRouteManager::Statistics stats = GlobalRouteManager::GetStatistics ();
+  std::cout << "LSDB " << stats.lsdbMs << " ms, SPF " << stats.spfMs << " ms ("
+            << stats.nThreads << " threads), " << nRoutes << " routes" << std::endl;
+  std::cout << "peak RSS " << rssBefore << " kB before routing, +"
+            << rssLsdb - rssBefore << " kB for the LSDB, +"
+            << rssAfter - rssLsdb << " kB for the SPF and the routes" << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// This program measures the object construction throughput of a bulk
+// topology build: objects created by an ObjectFactory with attributes,
+// nodes, internet stacks and point-to-point links in a chain.  It then
+// measures the cost of Object::GetObject on the aggregates of the nodes.
+// Sample usage:  ./waf --run 'bench-objects --nodes=10000'
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/tcp-l4-protocol.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/point-to-point-helper.h"
+#include <iostream>
+
+using namespace ns3;
+
+/**
+ * \brief Print the throughput of a benchmark phase.
+ * \param name the name of the phase
+ * \param n the number of items built
+ * \param ms the elapsed time in milliseconds
+ */
+static void
+Report (char const *name, uint32_t n, int64_t ms)
+{
+  std::cout << name << ": " << n << " in " << ms << " ms";
+  if (ms > 0)
+    {
+      std::cout << " (" << n * 1000 / ms << "/s)";
+    }
+  std::cout << std::endl;
+}
+
+/**
+ * \brief Look up an aggregated object on the nodes in turn.
+ * \param nodes the nodes
+ * \param n the number of lookups
+ * \param name the name printed with the result
+ */
+template <typename T>
+static void
+LookupBench (const NodeContainer &nodes, uint32_t n, char const *name)
+{
+  uint32_t found = 0;
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      if (nodes.Get (i % nodes.GetN ())->GetObject<T> () != 0)
+        {
+          found++;
+        }
+    }
+  double ns = time.End ();
+  ns *= 1000000;
+  ns /= n;
+  std::cout << "GetObject<" << name << ">: " << ns << " ns/lookup ("
+            << found << " found)" << std::endl;
+}
+
+/**
+ * \brief Look up several aggregated objects in turn on each node,
+ * as the layers of a stack processing a packet do.
+ * \param nodes the nodes
+ * \param n the number of lookups
+ */
+static void
+MixedLookupBench (const NodeContainer &nodes, uint32_t n)
+{
+  uint32_t found = 0;
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i += 5)
+    {
+      Ptr<Node> node = nodes.Get ((i / 5) % nodes.GetN ());
+      found += (node->GetObject<TrafficControlLayer> () != 0);
+      found += (node->GetObject<Ipv4L3Protocol> () != 0);
+      found += (node->GetObject<Ipv4> () != 0);
+      found += (node->GetObject<UdpL4Protocol> () != 0);
+      found += (node->GetObject<TcpL4Protocol> () != 0);
+    }
+  double ns = time.End ();
+  ns *= 1000000;
+  ns /= n;
+  std::cout << "GetObject (mixed types): " << ns << " ns/lookup ("
+            << found << " found)" << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nNodes = 10000;
+  uint32_t nObjects = 100000;
+  uint32_t nLookups = 10000000;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the construction of objects and topologies");
+  cmd.AddValue ("nodes", "Number of nodes of the topology", nNodes);
+  cmd.AddValue ("objects", "Number of objects built by an ObjectFactory", nObjects);
+  cmd.AddValue ("lookups", "Number of GetObject calls per aggregated type", nLookups);
+  cmd.Parse (argc, argv);
+
+  SystemWallClockMs time;
+
+  time.Start ();
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::SimpleNetDevice");
+  factory.Set ("DataRate", DataRateValue (DataRate ("5Mbps")));
+  factory.Set ("ReceiveErrorModel", PointerValue ());
+  factory.Set ("PointToPointMode", BooleanValue (true));
+  for (uint32_t i = 0; i < nObjects; i++)
+    {
+      factory.Create<NetDevice> ();
+    }
+  Report ("ObjectFactory::Create", nObjects, time.End ());
+
+  time.Start ();
+  for (uint32_t i = 0; i < nObjects; i++)
+    {
+      ObjectFactory f ("ns3::SimpleNetDevice");
+      f.Set ("DataRate", DataRateValue (DataRate ("5Mbps")));
+      f.Set ("PointToPointMode", BooleanValue (true));
+    }
+  Report ("ObjectFactory::SetTypeId+Set", nObjects, time.End ());
+
+  time.Start ();
+  NodeContainer nodes;
+  nodes.Create (nNodes);
+  Report ("Nodes", nNodes, time.End ());
+
+  time.Start ();
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Report ("Internet stacks", nNodes, time.End ());
+
+  time.Start ();
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  for (uint32_t i = 1; i < nNodes; i++)
+    {
+      p2p.Install (nodes.Get (i - 1), nodes.Get (i));
+    }
+  Report ("Point-to-point links", nNodes - 1, time.End ());
+
+  std::cout << "Aggregate size: ";
+  uint32_t size = 0;
+  for (Object::AggregateIterator i = nodes.Get (0)->GetAggregateIterator (); i.HasNext (); i.Next ())
+    {
+      size++;
+    }
+  std::cout << size << std::endl;
+  LookupBench<Node> (nodes, nLookups, "Node");
+  LookupBench<Ipv4> (nodes, nLookups, "Ipv4");
+  LookupBench<Ipv4L3Protocol> (nodes, nLookups, "Ipv4L3Protocol");
+  LookupBench<UdpL4Protocol> (nodes, nLookups, "UdpL4Protocol");
+  LookupBench<TcpL4Protocol> (nodes, nLookups, "TcpL4Protocol");
+  LookupBench<TrafficControlLayer> (nodes, nLookups, "TrafficControlLayer");
+  LookupBench<Ipv4StaticRouting> (nodes, nLookups / 100, "Ipv4StaticRouting (missing)");
+  MixedLookupBench (nodes, nLookups);
+
+  Simulator::Destroy ();
+  return 0;
+}
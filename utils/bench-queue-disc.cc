@@ -0,0 +1,123 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// This program measures the enqueue and dequeue cost of FqCoDelQueueDisc
+// and FqCoDelFlatQueueDisc when 'flows' flows are queued at once.
+// Sample usage:  ./waf --run 'bench-queue-disc --flows=10000 --n=1000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/object-factory.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-queue-disc-item.h"
+#include "ns3/fq-codel-queue-disc.h"
+#include "ns3/fq-codel-flat-queue-disc.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \brief Enqueue and dequeue packets of many flows through a queue disc.
+ * \tparam T the class of the queue disc
+ * \param typeId the type of the queue disc
+ * \param flows the number of flows
+ * \param batch the number of packets enqueued before the queue disc is drained
+ * \param n the number of packets
+ */
+template <class T>
+static void
+RunBench (std::string typeId, uint32_t flows, uint32_t batch, uint32_t n)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (typeId);
+  factory.Set ("Flows", UintegerValue (flows));
+  std::ostringstream maxSize;
+  maxSize << batch << "p";
+  factory.Set ("MaxSize", StringValue (maxSize.str ()));
+  Ptr<T> qd = factory.Create<T> ();
+  qd->SetQuantum (1514);
+  qd->Initialize ();
+
+  Ipv4Header hdr;
+  hdr.SetSource (Ipv4Address ("10.0.0.1"));
+  hdr.SetProtocol (17);
+  Address dest;
+  std::vector<Ptr<QueueDiscItem> > items (batch);
+  uint32_t dequeued = 0;
+  uint64_t deltaMs = 0;
+  for (uint32_t done = 0; done < n; done += batch)
+    {
+      // The items are consumed by the queue disc, so build a new batch
+      // outside of the measured time.
+      for (uint32_t i = 0; i < batch; i++)
+        {
+          hdr.SetDestination (Ipv4Address ((11u << 24) | ((done + i) % flows)));
+          items[i] = Create<Ipv4QueueDiscItem> (Create<Packet> (1000), dest, 0, hdr);
+        }
+      SystemWallClockMs time;
+      time.Start ();
+      for (uint32_t i = 0; i < batch; i++)
+        {
+          qd->Enqueue (items[i]);
+        }
+      while (qd->Dequeue ())
+        {
+          dequeued++;
+        }
+      deltaMs += time.End ();
+      items.assign (batch, 0);
+    }
+  double ns = deltaMs;
+  ns *= 1000000;
+  ns /= dequeued;
+  std::cout << ns << " ns/packet"
+            << " (" << deltaMs << " ms elapsed, " << dequeued << " packets)\t"
+            << typeId
+            << std::endl;
+  qd->Dispose ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t flows = 1024;
+  uint32_t batch = 10240;
+  uint32_t n = 1000000;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the FqCoDel queue discs with many concurrent flows");
+  cmd.AddValue ("flows", "number of flows", flows);
+  cmd.AddValue ("batch", "number of packets queued at once", batch);
+  cmd.AddValue ("n", "number of packets", n);
+  cmd.Parse (argc, argv);
+
+  if (flows == 0 || batch == 0 || n == 0)
+    {
+      std::cerr << "Error-- the number of flows, batch and packets must be positive" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-queue-disc with flows=" << flows
+            << " batch=" << batch << " n=" << n << std::endl;
+
+  RunBench<FqCoDelQueueDisc> ("ns3::FqCoDelQueueDisc", flows, batch, n);
+  RunBench<FqCoDelFlatQueueDisc> ("ns3::FqCoDelFlatQueueDisc", flows, batch, n);
+  return 0;
+}
@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// This program measures the enqueue and dequeue cost of the device
+// queues DropTailQueue and DropTailRingQueue, holding 'depth' packets
+// in steady state.
+// Sample usage:  ./waf --run 'bench-queue --depth=1000 --n=10000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/object-factory.h"
+#include "ns3/packet.h"
+#include "ns3/queue.h"
+#include "ns3/string.h"
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \brief Move packets through a queue holding a given number of packets.
+ * \param typeId the type of the queue
+ * \param depth the number of packets in the queue
+ * \param n the number of packets enqueued and dequeued
+ */
+static void
+RunBench (std::string typeId, uint32_t depth, uint32_t n)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (typeId);
+  std::ostringstream maxSize;
+  maxSize << depth + 1 << "p";
+  factory.Set ("MaxSize", StringValue (maxSize.str ()));
+  Ptr<Queue<Packet> > queue = factory.Create<Queue<Packet> > ();
+
+  // The same packets go round, so that the packets are not allocated
+  // in the measured loop.
+  for (uint32_t i = 0; i < depth; i++)
+    {
+      queue->Enqueue (Create<Packet> (1000));
+    }
+  queue->Enqueue (Create<Packet> (1000));
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      queue->Enqueue (queue->Dequeue ());
+    }
+  uint64_t deltaMs = time.End ();
+  double ns = deltaMs;
+  ns *= 1000000;
+  ns /= n;
+  std::cout << ns << " ns/packet"
+            << " (" << deltaMs << " ms elapsed, " << queue->GetTotalDroppedPackets () << " drops)\t"
+            << typeId
+            << std::endl;
+  queue->Dispose ();
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t depth = 100;
+  uint32_t n = 1000000;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the device queues");
+  cmd.AddValue ("depth", "number of packets in the queue", depth);
+  cmd.AddValue ("n", "number of packets", n);
+  cmd.Parse (argc, argv);
+
+  if (n == 0)
+    {
+      std::cerr << "Error-- the number of packets must be positive" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-queue with depth=" << depth << " n=" << n << std::endl;
+
+  RunBench ("ns3::DropTailQueue<Packet>", depth, n);
+  RunBench ("ns3::DropTailRingQueue<Packet>", depth, n);
+  return 0;
+}
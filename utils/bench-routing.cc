@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// This program measures the per-lookup latency of Ipv4GlobalRouting
+// and Ipv4StaticRouting for tables holding 'routes' host routes plus
+// a few network routes and a default route.
+// Sample usage:  ./waf --run 'bench-routing --routes=5000 --n=1000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/internet-stack-helper.h"
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \param i the index of a host route
+ * \return the destination of the host route
+ */
+static Ipv4Address
+HostAddress (uint32_t i)
+{
+  return Ipv4Address ((10u << 24) | (i + 1));
+}
+
+/**
+ * \brief Look up destinations through a routing protocol.
+ * \param routing the routing protocol
+ * \param dests the destinations, looked up in turn
+ * \param n the number of lookups
+ * \param name the name printed with the result
+ */
+static void
+RunBench (Ptr<Ipv4RoutingProtocol> routing, const std::vector<Ipv4Address> &dests,
+          uint32_t n, char const *name)
+{
+  Ptr<Packet> p = Create<Packet> ();
+  Ipv4Header header;
+  Socket::SocketErrno sockerr;
+  uint32_t found = 0;
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      header.SetDestination (dests[i % dests.size ()]);
+      if (routing->RouteOutput (p, header, 0, sockerr) != 0)
+        {
+          found++;
+        }
+    }
+  uint64_t deltaMs = time.End ();
+  double ns = deltaMs;
+  ns *= 1000000;
+  ns /= n;
+  std::cout << ns << " ns/lookup"
+            << " (" << deltaMs << " ms elapsed, " << found << " routes found)\t"
+            << name
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t routes = 5000;
+  uint32_t n = 1000000;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark IPv4 unicast route lookups");
+  cmd.AddValue ("routes", "number of host routes", routes);
+  cmd.AddValue ("n", "number of lookups", n);
+  cmd.Parse (argc, argv);
+
+  if (routes == 0 || n == 0)
+    {
+      std::cerr << "Error-- the number of routes and lookups must be positive" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-routing with routes=" << routes << " n=" << n << std::endl;
+
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper stack;
+  stack.Install (node);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+
+  // All the routes go through the loopback interface, which is the
+  // only interface of the node.
+  Ptr<Ipv4GlobalRouting> global = CreateObject<Ipv4GlobalRouting> ();
+  global->SetIpv4 (ipv4);
+  Ptr<Ipv4StaticRouting> local = CreateObject<Ipv4StaticRouting> ();
+  local->SetIpv4 (ipv4);
+  Ipv4Address gateway ("127.0.0.2");
+  for (uint32_t i = 0; i < routes; i++)
+    {
+      global->AddHostRouteTo (HostAddress (i), gateway, 0);
+      local->AddHostRouteTo (HostAddress (i), gateway, 0);
+    }
+  for (uint32_t i = 0; i < 16; i++)
+    {
+      Ipv4Address network ((172u << 24) | (i << 16));
+      global->AddNetworkRouteTo (network, Ipv4Mask ("255.255.0.0"), gateway, 0);
+      local->AddNetworkRouteTo (network, Ipv4Mask ("255.255.0.0"), gateway, 0);
+    }
+  global->AddNetworkRouteTo (Ipv4Address::GetZero (), Ipv4Mask::GetZero (), gateway, 0);
+  local->SetDefaultRoute (gateway, 0);
+
+  // Walk the host routes with a stride so that successive lookups do
+  // not hit neighbouring entries.
+  std::vector<Ipv4Address> hosts;
+  for (uint32_t i = 0; i < routes; i++)
+    {
+      hosts.push_back (HostAddress ((i * 7919) % routes));
+    }
+  std::vector<Ipv4Address> misses;
+  for (uint32_t i = 0; i < 256; i++)
+    {
+      misses.push_back (Ipv4Address ((192u << 24) | (168u << 16) | i));
+    }
+
+  RunBench (global, hosts, n, "Ipv4GlobalRouting, host routes");
+  RunBench (global, misses, n, "Ipv4GlobalRouting, default route");
+  RunBench (local, hosts, n, "Ipv4StaticRouting, host routes");
+  RunBench (local, misses, n, "Ipv4StaticRouting, default route");
+
+  global->Dispose ();
+  local->Dispose ();
+  return 0;
+}
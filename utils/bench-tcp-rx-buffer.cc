@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+// This program measures the cost of the reassembly in TcpRxBuffer when
+// 'holes' segments of each window of 'window' segments are lost: the other
+// segments are received out of order, then the lost ones are received, and
+// the whole window is extracted at once.
+// Sample usage:  ./waf --run 'bench-tcp-rx-buffer --window=4000 --holes=10'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-rx-buffer.h"
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  uint32_t window = 4000;
+  uint32_t holes = 10;
+  uint32_t rounds = 10;
+  uint32_t segSize = 1448;
+
+  CommandLine cmd (__FILE__);
+  cmd.Usage ("Benchmark the reassembly of out-of-order segments in TcpRxBuffer");
+  cmd.AddValue ("window", "number of segments in a window", window);
+  cmd.AddValue ("holes", "number of lost segments in a window", holes);
+  cmd.AddValue ("rounds", "number of windows", rounds);
+  cmd.AddValue ("segSize", "size of a segment", segSize);
+  cmd.Parse (argc, argv);
+
+  if (window == 0 || holes == 0 || holes > window || segSize == 0)
+    {
+      std::cerr << "Error-- the window and the segment size must be positive, "
+                << "and the holes between 1 and the window" << std::endl;
+      exit (1);
+    }
+  std::cout << "Running bench-tcp-rx-buffer with window=" << window
+            << " holes=" << holes << " rounds=" << rounds
+            << " segSize=" << segSize << std::endl;
+
+  // Use a payload with real bytes, so that copies are not optimized away
+  std::vector<uint8_t> data (segSize, 0x5a);
+  Ptr<Packet> payload = Create<Packet> (&data[0], segSize);
+
+  TcpRxBuffer rxBuf (1);
+  rxBuf.SetMaxBufferSize (window * segSize);
+  TcpHeader h;
+  uint32_t spacing = window / holes;
+  uint64_t extracted = 0;
+  uint64_t sackBlocks = 0;
+  uint64_t addMs = 0;
+  uint64_t extractMs = 0;
+
+  SystemWallClockMs time;
+  for (uint32_t round = 0; round < rounds; round++)
+    {
+      time.Start ();
+      SequenceNumber32 base = rxBuf.NextRxSequence ();
+      for (uint32_t i = 0; i < window; i++)
+        {
+          if (i % spacing != 0)
+            {
+              h.SetSequenceNumber (base + SequenceNumber32 (i * segSize));
+              rxBuf.Add (payload, h);
+              sackBlocks += rxBuf.GetSackListSize ();
+            }
+        }
+      for (uint32_t i = 0; i < window; i += spacing)
+        {
+          h.SetSequenceNumber (base + SequenceNumber32 (i * segSize));
+          rxBuf.Add (payload, h);
+          sackBlocks += rxBuf.GetSackListSize ();
+        }
+      addMs += time.End ();
+      time.Start ();
+      Ptr<Packet> p = rxBuf.Extract (window * segSize);
+      extracted += p->GetSize ();
+      extractMs += time.End ();
+    }
+
+  double ns = addMs + extractMs;
+  ns *= 1000000;
+  ns /= static_cast<double> (window) * rounds;
+  std::cout << ns << " ns/segment"
+            << " (" << addMs << " ms in Add, " << extractMs << " ms in Extract, "
+            << extracted << " bytes extracted, " << sackBlocks << " SACK blocks)"
+            << std::endl;
+  return 0;
+}
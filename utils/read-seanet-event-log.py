@@ -0,0 +1,105 @@
+#! /usr/bin/env python3
+## -*- Mode: python; py-indent-offset: 4; indent-tabs-mode: nil; coding: utf-8; -*-
+#
+# Reads an event log written by ns3::SeanetEventLog and prints it as CSV,
+# or prints the number of events of each kind with --summary.
+#
+# Usage: read-seanet-event-log.py [--summary] [--kind=NAME] [--node=ID] <file>
+
+import struct
+import sys
+
+MAGIC = b'SEANETEV'
+VERSION = 1
+EIDSIZE = 20
+
+## Event kinds, as in SeanetEventLog::EventKind
+KINDS = {
+    1: 'CLIENT_WRITE',
+    2: 'CLIENT_READ',
+    3: 'CLIENT_MULTICAST_REPLY',
+    4: 'CLIENT_SWITCH_REPLY',
+    5: 'SWITCH_REGIST_SELF',
+    6: 'SWITCH_REGIST_TO_RN',
+    7: 'SWITCH_GRAFT_REPLY',
+    8: 'SWITCH_GRAFT_REQUEST',
+    9: 'SWITCH_RESOLUTION_MISS',
+    10: 'SWITCH_RESOLUTION_ADD',
+    11: 'SWITCH_RESOLUTION_REPLY',
+    12: 'RESOLUTION_ADD',
+    13: 'RESOLUTION_REPLY',
+}
+
+
+def read_events(fileName):
+    '''Iterates over the events of a log file.
+    @param fileName The name of the file.
+    @return tuples (time in ns, node, peer as an int, kind, eid as bytes)
+    '''
+    with open(fileName, 'rb') as f:
+        header = f.read(20)
+        if len(header) < 20 or header[:8] != MAGIC:
+            raise ValueError('%s is not a SEANET event log' % fileName)
+        order = '<'
+        if struct.unpack('<I', header[16:20])[0] != 0x01020304:
+            order = '>'
+        version, recordSize = struct.unpack(order + 'II', header[8:16])
+        if version != VERSION:
+            raise ValueError('unsupported event log version %d' % version)
+        record = struct.Struct(order + 'qIIB3x%ds' % EIDSIZE)
+        if record.size != recordSize:
+            raise ValueError('unexpected record size %d' % recordSize)
+        while True:
+            data = f.read(recordSize * 4096)
+            if not data:
+                break
+            # ignore an incomplete record at the end of the file
+            for values in record.iter_unpack(data[:len(data) - len(data) % recordSize]):
+                yield values
+
+
+def format_ipv4(address):
+    return '%d.%d.%d.%d' % ((address >> 24) & 0xff, (address >> 16) & 0xff,
+                            (address >> 8) & 0xff, address & 0xff)
+
+
+def main(argv):
+    summary = False
+    kind = None
+    node = None
+    files = []
+    for arg in argv[1:]:
+        if arg == '--summary':
+            summary = True
+        elif arg.startswith('--kind='):
+            names = dict((name, value) for value, name in KINDS.items())
+            kind = names[arg[len('--kind='):]]
+        elif arg.startswith('--node='):
+            node = int(arg[len('--node='):])
+        else:
+            files.append(arg)
+    if len(files) != 1:
+        print('usage: %s [--summary] [--kind=NAME] [--node=ID] <file>' % argv[0])
+        return 1
+
+    counts = {}
+    if not summary:
+        print('time_ns,node,kind,eid,peer')
+    for time, eventNode, peer, eventKind, eid in read_events(files[0]):
+        if kind is not None and eventKind != kind:
+            continue
+        if node is not None and eventNode != node:
+            continue
+        if summary:
+            counts[eventKind] = counts.get(eventKind, 0) + 1
+        else:
+            print('%d,%d,%s,%s,%s' % (time, eventNode, KINDS.get(eventKind, eventKind),
+                                      eid.hex(), format_ipv4(peer)))
+    if summary:
+        for eventKind in sorted(counts):
+            print('%s %d' % (KINDS.get(eventKind, eventKind), counts[eventKind]))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))